@@ -1,11 +1,16 @@
 #include <string.h>
 #include <algorithm>
+#include <cmath>
+#include <string>
 #include <vector>
 #include <benchmark/benchmark.h>
 
 #include <surf/pixel_data.hpp>
 #include <surf/blit.hpp>
 #include <surf/fill.hpp>
+#include <surf/scale_filter.hpp>
+#include <surf/software_surface.hpp>
+#include <surf/sprite_batch.hpp>
 
 using namespace surf;
 
@@ -140,6 +145,168 @@ void BM_blit__slow_convert_self(benchmark::State& state)
   }
 }
 
+void BM_blit__swizzle(benchmark::State& state)
+{
+  PixelData<RGBA8Pixel> src(DSTSIZE, RGBA8Pixel{1, 2, 3, 4});
+  PixelData<BGRA8Pixel> dst(DSTSIZE, no_init);
+
+  while (state.KeepRunning()) {
+    blit(src, dst, geom::ipoint(0, 0));
+  }
+}
+
+void BM_blit__swizzle_registry(benchmark::State& state)
+{
+  SoftwareSurface const src(PixelData<RGBA8Pixel>(DSTSIZE, RGBA8Pixel{1, 2, 3, 4}));
+  SoftwareSurface dst = SoftwareSurface::create(PixelFormat::BGRA8, DSTSIZE, no_init);
+
+  while (state.KeepRunning()) {
+    blit(src, dst, geom::ipoint(0, 0));
+  }
+}
+
+void BM_blit__blend_straight(benchmark::State& state)
+{
+  SoftwareSurface const src(PixelData<RGBA8Pixel>(DSTSIZE, RGBA8Pixel{255, 128, 64, 100}));
+  SoftwareSurface dst(PixelData<RGBA8Pixel>(DSTSIZE, RGBA8Pixel{0, 64, 128, 200}));
+
+  while (state.KeepRunning()) {
+    blend(BlendFunc::BLEND, src, dst, geom::ipoint(0, 0));
+  }
+}
+
+/** A 64x64 disc with an antialiased edge, transparent around it */
+template<typename Pixel>
+PixelData<Pixel> make_sprite()
+{
+  using value_type = typename Pixel::value_type;
+  PixelData<Pixel> sprite(SRCSIZE);
+  for (int y = 0; y < SRCSIZE.height(); ++y) {
+    for (int x = 0; x < SRCSIZE.width(); ++x) {
+      float const dist = std::hypot(static_cast<float>(x) - 31.5f, static_cast<float>(y) - 31.5f);
+      float const coverage = std::clamp(28.0f - dist, 0.0f, 1.0f);
+      value_type const max = Pixel::max();
+      sprite.put_pixel(geom::ipoint(x, y), Pixel{max, static_cast<value_type>(max / 2), 0,
+                                                 static_cast<value_type>(coverage * max)});
+    }
+  }
+  return sprite;
+}
+
+template<typename SrcPixel, typename DstPixel>
+void BM_blit__blend_sprite(benchmark::State& state)
+{
+  SoftwareSurface const src(make_sprite<SrcPixel>());
+  SoftwareSurface dst(PixelData<DstPixel>(DSTSIZE, DstPixel{}));
+
+  while (state.KeepRunning()) {
+    for (int y = 0; y < 1024; y += 50) {
+      for (int x = 0; x < 1024; x += 50) {
+        blend(BlendFunc::BLEND, src, dst, geom::ipoint(x, y));
+      }
+    }
+  }
+}
+
+template<typename SrcPixel, typename DstPixel>
+void BM_blit__blend_mode(benchmark::State& state)
+{
+  BlendFunc const op = static_cast<BlendFunc>(state.range(0));
+  SoftwareSurface const src(make_sprite<SrcPixel>());
+  SoftwareSurface dst(PixelData<DstPixel>(DSTSIZE, DstPixel{}));
+  state.SetLabel(std::string(to_string(op)));
+
+  while (state.KeepRunning()) {
+    for (int y = 0; y < 1024; y += 50) {
+      for (int x = 0; x < 1024; x += 50) {
+        blend(op, src, dst, geom::ipoint(x, y));
+      }
+    }
+  }
+}
+
+/** 8x12 cells of the sprite, covering the destination like text */
+template<typename Func>
+void for_each_glyph(Func func)
+{
+  int i = 0;
+  for (int y = 0; y < DSTSIZE.height(); y += 12) {
+    for (int x = 0; x < DSTSIZE.width(); x += 8, ++i) {
+      func(geom::irect(geom::ipoint(i * 8 % 56, i * 12 % 52), geom::isize(8, 12)), geom::ipoint(x, y));
+    }
+  }
+}
+
+void BM_blit__glyphs(benchmark::State& state)
+{
+  SoftwareSurface const src(make_sprite<RGBA8Pixel>());
+  SoftwareSurface dst(PixelData<RGBA8Pixel>(DSTSIZE, RGBA8Pixel{}));
+
+  while (state.KeepRunning()) {
+    for_each_glyph([&](geom::irect const& srcrect, geom::ipoint const& pos) {
+      blend(BlendFunc::BLEND, src, srcrect, dst, pos);
+    });
+  }
+}
+
+void BM_blit__glyphs_batch(benchmark::State& state)
+{
+  SoftwareSurface const src(make_sprite<RGBA8Pixel>());
+  SoftwareSurface dst(PixelData<RGBA8Pixel>(DSTSIZE, RGBA8Pixel{}));
+
+  SpriteBatch batch;
+  for_each_glyph([&](geom::irect const& srcrect, geom::ipoint const& pos) {
+    batch.blend(BlendFunc::BLEND, src, srcrect, pos);
+  });
+
+  while (state.KeepRunning()) {
+    batch.render(dst, static_cast<unsigned int>(state.range(0)));
+  }
+}
+
+void BM_blit__blend_premultiplied(benchmark::State& state)
+{
+  SoftwareSurface const src(PixelData<PRGBA8Pixel>(DSTSIZE, PRGBA8Pixel{100, 50, 25, 100}));
+  SoftwareSurface dst(PixelData<PRGBA8Pixel>(DSTSIZE, PRGBA8Pixel{0, 50, 100, 200}));
+
+  while (state.KeepRunning()) {
+    blend(BlendFunc::BLEND, src, dst, geom::ipoint(0, 0));
+  }
+}
+
+void BM_blit__half(benchmark::State& state)
+{
+  PixelData<RGBA32fPixel> src(DSTSIZE, RGBA32fPixel{0.25f, 0.5f, 0.75f, 1.0f});
+  PixelData<RGBA16fPixel> dst(DSTSIZE, no_init);
+
+  while (state.KeepRunning()) {
+    blit(src, dst, geom::ipoint(0, 0));
+  }
+}
+
+void BM_blit__half_registry(benchmark::State& state)
+{
+  SoftwareSurface const src(PixelData<RGBA32fPixel>(DSTSIZE, RGBA32fPixel{0.25f, 0.5f, 0.75f, 1.0f}));
+  SoftwareSurface dst = SoftwareSurface::create(PixelFormat::RGBA16f, DSTSIZE, no_init);
+
+  while (state.KeepRunning()) {
+    blit(src, dst, geom::ipoint(0, 0));
+  }
+}
+
+void BM_blit__blend_scaled(benchmark::State& state)
+{
+  ScaleFilter const filter = static_cast<ScaleFilter>(state.range(0));
+  int const srcsize = static_cast<int>(state.range(1));
+  SoftwareSurface const src(PixelData<RGBA8Pixel>(geom::isize(srcsize, srcsize), RGBA8Pixel{100, 50, 25, 200}));
+  SoftwareSurface dst = SoftwareSurface::create(PixelFormat::RGBA8, geom::isize(512, 512));
+  state.SetLabel(std::string(to_string(filter)));
+
+  while (state.KeepRunning()) {
+    blend_scaled(BlendFunc::BLEND, src, geom::irect(src.get_size()), dst, geom::irect(0, 0, 512, 512), filter);
+  }
+}
+
 } // namespace
 
 BENCHMARK(BM_blit);
@@ -153,4 +320,35 @@ BENCHMARK(BM_blit__convert);
 BENCHMARK(BM_blit__slow_convert);
 BENCHMARK(BM_blit__slow_convert_self);
 
+BENCHMARK(BM_blit__swizzle);
+BENCHMARK(BM_blit__swizzle_registry);
+
+BENCHMARK(BM_blit__blend_straight);
+BENCHMARK(BM_blit__blend_premultiplied);
+BENCHMARK(BM_blit__blend_sprite<RGBA8Pixel, RGBA8Pixel>);
+BENCHMARK(BM_blit__blend_sprite<RGBA8Pixel, RGB8Pixel>);
+BENCHMARK(BM_blit__blend_sprite<RGBA16Pixel, RGBA16Pixel>);
+BENCHMARK(BM_blit__blend_sprite<RGBA16Pixel, RGB16Pixel>);
+BENCHMARK(BM_blit__blend_sprite<RGBA32fPixel, RGBA32fPixel>);
+BENCHMARK(BM_blit__blend_sprite<RGBA16fPixel, RGBA16fPixel>);
+BENCHMARK(BM_blit__blend_mode<RGBA8Pixel, RGBA8Pixel>)
+  ->Arg(static_cast<int>(BlendFunc::SCREEN))
+  ->Arg(static_cast<int>(BlendFunc::SOFT_LIGHT))
+  ->Arg(static_cast<int>(BlendFunc::XOR));
+BENCHMARK(BM_blit__blend_mode<RGBA8Pixel, RGB8Pixel>)
+  ->Arg(static_cast<int>(BlendFunc::SCREEN));
+
+BENCHMARK(BM_blit__glyphs);
+BENCHMARK(BM_blit__glyphs_batch)->Arg(1)->Arg(4)->UseRealTime();
+BENCHMARK(BM_blit__blend_scaled)
+  ->Args({static_cast<int>(ScaleFilter::NEAREST), 128})
+  ->Args({static_cast<int>(ScaleFilter::BILINEAR), 128})
+  ->Args({static_cast<int>(ScaleFilter::BOX), 128})
+  ->Args({static_cast<int>(ScaleFilter::NEAREST), 2048})
+  ->Args({static_cast<int>(ScaleFilter::BILINEAR), 2048})
+  ->Args({static_cast<int>(ScaleFilter::BOX), 2048});
+
+BENCHMARK(BM_blit__half);
+BENCHMARK(BM_blit__half_registry);
+
 /* EOF */
@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <benchmark/benchmark.h>
+
+#include <surf/convert.hpp>
+#include <surf/kernel_registry.hpp>
+#include <surf/pixel_data.hpp>
+
+using namespace surf;
+
+namespace {
+
+const geom::isize SIZE(1024, 1024);
+
+template<typename SrcPixel>
+PixelData<SrcPixel> make_source()
+{
+  return PixelData<SrcPixel>(SIZE, make_pixel<SrcPixel>(12, 34, 56, 78));
+}
+
+/** The plain template path, convert<>() per pixel */
+template<typename SrcPixel, typename DstPixel>
+void BM_convert__scalar(benchmark::State& state)
+{
+  PixelData<SrcPixel> const src = make_source<SrcPixel>();
+  PixelData<DstPixel> dst(SIZE, no_init);
+
+  while (state.KeepRunning()) {
+    for (int y = 0; y < SIZE.height(); ++y) {
+      std::transform(src.get_row(y), src.get_row(y) + SIZE.width(),
+                     dst.get_row(y), convert<SrcPixel, DstPixel>);
+    }
+    benchmark::DoNotOptimize(dst.get_data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * SIZE.width() * SIZE.height());
+}
+
+/** The kernel the KernelRegistry picked for this CPU */
+template<typename SrcPixel, typename DstPixel>
+void BM_convert__kernel(benchmark::State& state)
+{
+  PixelData<SrcPixel> const src = make_source<SrcPixel>();
+  PixelData<DstPixel> dst(SIZE, no_init);
+  SpanKernel const kernel = KernelRegistry::instance().get(PPixelFormat<SrcPixel>::format,
+                                                           PPixelFormat<DstPixel>::format,
+                                                           BlendFunc::COPY);
+
+  while (state.KeepRunning()) {
+    for (int y = 0; y < SIZE.height(); ++y) {
+      kernel(src.get_row(y), dst.get_row(y), SIZE.width());
+    }
+    benchmark::DoNotOptimize(dst.get_data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * SIZE.width() * SIZE.height());
+}
+
+/** PixelView::convert_to(), the registry kernel plus the allocation */
+template<typename SrcPixel, typename DstPixel>
+void BM_convert__convert_to(benchmark::State& state)
+{
+  PixelData<SrcPixel> const src = make_source<SrcPixel>();
+
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(src.template convert_to<DstPixel>());
+  }
+
+  state.SetItemsProcessed(state.iterations() * SIZE.width() * SIZE.height());
+}
+
+} // namespace
+
+#define BENCHMARK_CONVERT(src, dst)                     \
+  BENCHMARK_TEMPLATE(BM_convert__scalar, src, dst);     \
+  BENCHMARK_TEMPLATE(BM_convert__kernel, src, dst);     \
+  BENCHMARK_TEMPLATE(BM_convert__convert_to, src, dst)
+
+BENCHMARK_CONVERT(RGB8Pixel, RGBA8Pixel);
+BENCHMARK_CONVERT(RGBA8Pixel, RGB8Pixel);
+BENCHMARK_CONVERT(RGB8Pixel, L8Pixel);
+BENCHMARK_CONVERT(RGBA8Pixel, L8Pixel);
+BENCHMARK_CONVERT(LA8Pixel, RGBA8Pixel);
+BENCHMARK_CONVERT(RGBA8Pixel, LA8Pixel);
+BENCHMARK_CONVERT(RGBA8Pixel, RGBA16Pixel);
+BENCHMARK_CONVERT(RGBA8Pixel, RGBA32fPixel);
+BENCHMARK_CONVERT(RGBA16Pixel, RGBA32fPixel);
+BENCHMARK_CONVERT(RGBA16Pixel, RGBA8Pixel);
+BENCHMARK_CONVERT(RGBA32fPixel, RGBA8Pixel);
+BENCHMARK_CONVERT(RGBA32fPixel, RGBA16Pixel);
+
+/* EOF */
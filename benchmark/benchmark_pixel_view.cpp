@@ -0,0 +1,95 @@
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include <surf/pixel_data.hpp>
+
+using namespace surf;
+
+namespace {
+
+const geom::isize DSTSIZE(1024, 1024);
+
+void BM_get_row(::benchmark::State& state)
+{
+  PixelData<RGBA8Pixel> src(DSTSIZE, RGBA8Pixel{255, 255, 255, 255});
+
+  while (state.KeepRunning()) {
+    for (int y = 0; y < src.get_height(); ++y) {
+      benchmark::DoNotOptimize(src.get_row(y));
+    }
+  }
+}
+
+void BM_get_row__sum(::benchmark::State& state)
+{
+  PixelData<RGBA8Pixel> src(DSTSIZE, RGBA8Pixel{1, 2, 3, 4});
+
+  while (state.KeepRunning()) {
+    unsigned int sum = 0;
+    for (int y = 0; y < src.get_height(); ++y) {
+      RGBA8Pixel const* row = src.get_row(y);
+      for (int x = 0; x < src.get_width(); ++x) {
+        sum += row[x].r;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+
+void BM_get_pixel(::benchmark::State& state)
+{
+  PixelData<RGBA8Pixel> src(DSTSIZE, RGBA8Pixel{1, 2, 3, 4});
+
+  while (state.KeepRunning()) {
+    unsigned int sum = 0;
+    for (int y = 0; y < src.get_height(); ++y) {
+      for (int x = 0; x < src.get_width(); ++x) {
+        sum += src.get_pixel(geom::ipoint(x, y)).r;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+
+void BM_put_pixel(::benchmark::State& state)
+{
+  PixelData<RGBA8Pixel> dst(DSTSIZE, RGBA8Pixel{1, 2, 3, 4});
+
+  while (state.KeepRunning()) {
+    for (int y = 0; y < dst.get_height(); ++y) {
+      for (int x = 0; x < dst.get_width(); ++x) {
+        dst.put_pixel(geom::ipoint(x, y), RGBA8Pixel{5, 6, 7, 8});
+      }
+    }
+    benchmark::ClobberMemory();
+  }
+}
+
+void BM_allocate(::benchmark::State& state)
+{
+  while (state.KeepRunning()) {
+    PixelData<RGBA8Pixel> dst(geom::isize(6000, 4000));
+    benchmark::DoNotOptimize(dst.get_row(0));
+  }
+}
+
+void BM_allocate__no_init(::benchmark::State& state)
+{
+  while (state.KeepRunning()) {
+    PixelData<RGBA8Pixel> dst(geom::isize(6000, 4000), no_init);
+    benchmark::DoNotOptimize(dst.get_row(0));
+  }
+}
+
+} // namespace
+
+BENCHMARK(BM_allocate);
+BENCHMARK(BM_allocate__no_init);
+BENCHMARK(BM_get_row);
+BENCHMARK(BM_get_row__sum);
+BENCHMARK(BM_get_pixel);
+BENCHMARK(BM_put_pixel);
+
+/* EOF */
@@ -4,6 +4,8 @@
 #include <benchmark/benchmark.h>
 
 #include <surf/pixel_data.hpp>
+#include <surf/surface_pool.hpp>
+#include <surf/tiled_pixel_data.hpp>
 #include <surf/transform.hpp>
 
 using namespace surf;
@@ -22,6 +24,49 @@ void BM_transform(::benchmark::State& state, Transform mod)
   }
 }
 
+void BM_transform_pooled(::benchmark::State& state, Transform mod)
+{
+  SurfacePool pool(64 * 1024 * 1024);
+  SurfacePoolScope scope(pool);
+
+  PixelData<RGBAPixel> src(DSTSIZE, RGBAPixel{255, 255, 255, 255});
+
+  while (state.KeepRunning()) {
+    PixelData<RGBAPixel> dst = transform(src, mod);
+    benchmark::DoNotOptimize(dst);
+  }
+}
+
+void BM_rotate90_tiled(::benchmark::State& state)
+{
+  TiledPixelData<RGBAPixel> src(DSTSIZE, RGBAPixel{255, 255, 255, 255});
+
+  while (state.KeepRunning()) {
+    TiledPixelData<RGBAPixel> dst = rotate90(src);
+    benchmark::DoNotOptimize(dst);
+  }
+}
+
+void BM_halve(::benchmark::State& state, Gamma gamma)
+{
+  PixelData<RGBAPixel> src(DSTSIZE, RGBAPixel{255, 128, 64, 255});
+
+  while (state.KeepRunning()) {
+    PixelData<RGBAPixel> dst = halve(src, gamma);
+    benchmark::DoNotOptimize(dst);
+  }
+}
+
+void BM_scale(::benchmark::State& state, Gamma gamma)
+{
+  PixelData<RGBAPixel> src(DSTSIZE, RGBAPixel{255, 128, 64, 255});
+
+  while (state.KeepRunning()) {
+    PixelData<RGBAPixel> dst = scale(src, DSTSIZE / 3, gamma);
+    benchmark::DoNotOptimize(dst);
+  }
+}
+
 } // namespace
 
 BENCHMARK_CAPTURE(BM_transform, rotate0, Transform::ROTATE_0);
@@ -34,4 +79,14 @@ BENCHMARK_CAPTURE(BM_transform, rotate90flip, Transform::ROTATE_90_FLIP);
 BENCHMARK_CAPTURE(BM_transform, rotate180flip, Transform::ROTATE_180_FLIP);
 BENCHMARK_CAPTURE(BM_transform, rotate270flip, Transform::ROTATE_270_FLIP);
 
+BENCHMARK_CAPTURE(BM_transform_pooled, rotate90, Transform::ROTATE_90);
+BENCHMARK_CAPTURE(BM_transform_pooled, rotate180, Transform::ROTATE_180);
+
+BENCHMARK(BM_rotate90_tiled);
+
+BENCHMARK_CAPTURE(BM_halve, encoded, Gamma::ENCODED);
+BENCHMARK_CAPTURE(BM_halve, linear, Gamma::LINEAR);
+BENCHMARK_CAPTURE(BM_scale, encoded, Gamma::ENCODED);
+BENCHMARK_CAPTURE(BM_scale, linear, Gamma::LINEAR);
+
 /* EOF */
@@ -51,11 +51,13 @@ public:
     m_verbose(false),
     m_file_info(),
     m_blendfunc(surf::BlendFunc::COPY),
+    m_scale_filter(surf::ScaleFilter::NEAREST),
     m_stack()
   {}
 
   void clear() {
     m_blendfunc = surf::BlendFunc::COPY;
+    m_scale_filter = surf::ScaleFilter::NEAREST;
     m_stack.clear();
   }
 
@@ -103,7 +105,7 @@ public:
     if (m_stack.back().use_count() == 1) {
       sur = std::move(*m_stack.back());
     } else {
-      // FIXME: potentially useless copy
+      // cheap, the pixel data is shared until one side writes to it
       sur = *m_stack.back();
     }
     m_stack.pop_back();
@@ -126,7 +128,7 @@ public:
 
   void set_blendfunc(surf::BlendFunc func) {
     if (m_verbose) {
-      std::cout << "set_blendfunc: " << int(func) << "\n";
+      std::cout << "set_blendfunc: " << surf::to_string(func) << "\n";
     }
 
     m_blendfunc = func;
@@ -136,6 +138,18 @@ public:
     return m_blendfunc;
   }
 
+  void set_scale_filter(surf::ScaleFilter filter) {
+    if (m_verbose) {
+      std::cout << "set_scale_filter: " << surf::to_string(filter) << "\n";
+    }
+
+    m_scale_filter = filter;
+  }
+
+  surf::ScaleFilter scale_filter() const {
+    return m_scale_filter;
+  }
+
   FileInfo const& file_info() const {
     return m_file_info;
   }
@@ -158,6 +172,7 @@ private:
   bool m_verbose;
   FileInfo m_file_info;
   surf::BlendFunc m_blendfunc;
+  surf::ScaleFilter m_scale_filter;
   std::vector<std::shared_ptr<SoftwareSurface>> m_stack;
 };
 
@@ -201,9 +216,13 @@ void print_usage(int argc, char** argv)
     << "  --hsv H:S:V          Apply hue/saturation/value\n"
     << "  --convert FORMAT     Convert internal format to FORMAT\n"
     << "  --blit POS           Blit image\n"
-    << "  --blendfunc FUNC     Switch blendfunc to FUNC\n"
+    << "  --blendfunc FUNC     Switch blendfunc to FUNC: COPY, BLEND, ADD, MULTIPLY,\n"
+    << "                       SCREEN, OVERLAY, DARKEN, LIGHTEN, DIFFERENCE,\n"
+    << "                       SUBTRACT, SOFT_LIGHT, SRC_IN, SRC_OUT, SRC_ATOP, XOR\n"
     << "  --blend POS          Blend image\n"
     << "  --blend-scaled RECT  Blit image scaled\n"
+    << "  --scale-filter FILTER\n"
+    << "                       Sample --blend-scaled with NEAREST, BILINEAR or BOX\n"
     << "  --multiply VALUE     Multiply the image by value\n"
     << "  --add VALUE          Add value to pixels\n"
     << "  --split              Split image into channels\n"
@@ -381,7 +400,13 @@ Options parse_args(int argc, char** argv)
 
         opts.commands.emplace_back([rect](Context& ctx) {
           auto img = ctx.pop();
-          blend_scaled(ctx.blendfunc(), img, ctx.top(), rect);
+          blend_scaled(ctx.blendfunc(), img, ctx.top(), rect, ctx.scale_filter());
+        });
+      } else if (opt == "--scale-filter") {
+        std::string_view arg = next_arg();
+        surf::ScaleFilter filter = surf::ScaleFilter_from_string(arg);
+        opts.commands.emplace_back([filter](Context& ctx) {
+          ctx.set_scale_filter(filter);
         });
       } else if (opt == "--blend") {
         std::string_view pos_str = next_arg();
@@ -17,14 +17,71 @@
 #ifndef HEADER_SURF_BLEND_HPP
 #define HEADER_SURF_BLEND_HPP
 
+#include <algorithm>
+
 #include <logmich/log.hpp>
 
+#include "blendmode.hpp"
 #include "color.hpp"
 #include "convert.hpp"
+#include "fixed_point.hpp"
 #include "pixel.hpp"
+#include "promote.hpp"
 
 namespace surf {
 
+namespace detail {
+
+/** Porter-Duff "over" for premultiplied pixels, a single multiply-add
+    per channel and no division by the resulting alpha */
+template<typename T> inline
+constexpr tPRGBAPixel<T> premultiplied_over(tPRGBAPixel<T> src, tPRGBAPixel<T> dst)
+{
+  using Pixel = tPRGBAPixel<T>;
+
+  if constexpr (std::is_floating_point<T>::value) {
+    T const inv = Pixel::max() - src.a;
+    return {src.r + dst.r * inv, src.g + dst.g * inv, src.b + dst.b * inv, src.a + dst.a * inv};
+  } else {
+    using promotype = fixed::product_t<T>;
+    constexpr promotype max = Pixel::max();
+    auto const over = [inv = max - src.a](T s, T d) {
+      return fixed::add_sat(s, fixed::div_max<T>(static_cast<promotype>(d) * inv + max / 2));
+    };
+    return {over(src.r, dst.r), over(src.g, dst.g), over(src.b, dst.b), over(src.a, dst.a)};
+  }
+}
+
+/** Straight alpha "over" in float for pixels with a floating point
+    side. Nothing is clamped for float destinations, so HDR values
+    above 1.0 survive. */
+template<typename SrcPixel, typename DstPixel> inline
+DstPixel float_over(SrcPixel src, DstPixel dst)
+{
+  float const sa = alpha_f(src);
+  if (sa == 0.0f) {
+    return dst;
+  }
+
+  float const inv = 1.0f - sa;
+  if constexpr (DstPixel::has_alpha()) {
+    float const dw = alpha_f(dst) * inv;
+    float const out_a = sa + dw;
+    auto const mix = [&](float s, float d) { return f2value<DstPixel>((s * sa + d * dw) / out_a); };
+    return make_pixel<DstPixel>(mix(red_f(src), red_f(dst)),
+                                mix(green_f(src), green_f(dst)),
+                                mix(blue_f(src), blue_f(dst)),
+                                f2value<DstPixel>(out_a));
+  } else {
+    auto const mix = [&](float s, float d) { return f2value<DstPixel>(s * sa + d * inv); };
+    return make_pixel<DstPixel>(mix(red_f(src), red_f(dst)),
+                                mix(green_f(src), green_f(dst)),
+                                mix(blue_f(src), blue_f(dst)));
+  }
+}
+
+} // namespace detail
+
 template<typename SrcPixel, typename DstPixel>
 struct pixel_copy
 {
@@ -44,26 +101,72 @@ struct pixel_blend
 
     if constexpr (!SrcPixel::has_alpha()) {
       return convert<SrcPixel, DstPixel>(src);
+    } else if constexpr (is_premultiplied<SrcPixel>::value || is_premultiplied<DstPixel>::value) {
+      // blend in premultiplied space at the destination depth
+      using PremultipliedPixel = tPRGBAPixel<dsttype>;
+      return convert<PremultipliedPixel, DstPixel>(
+        detail::premultiplied_over(convert<SrcPixel, PremultipliedPixel>(src),
+                                   convert<DstPixel, PremultipliedPixel>(dst)));
     } else if constexpr (std::is_floating_point<srctype>::value || std::is_floating_point<dsttype>::value) {
-      log_not_implemented();
-      return convert<SrcPixel, DstPixel>(src);
+      return detail::float_over(src, dst);
+    } else if constexpr (SrcPixel::has_alpha() && !DstPixel::has_alpha() &&
+                         std::is_same<srctype, dsttype>::value && sizeof(srctype) < 4) {
+      using calctype = fixed::product_t<srctype>;
+      calctype const sa = alpha(src);
+      calctype const inv = SrcPixel::max() - sa;
+      return make_pixel<DstPixel>(
+        static_cast<dsttype>(fixed::div_max<srctype>(red(src) * sa + red(dst) * inv)),
+        static_cast<dsttype>(fixed::div_max<srctype>(green(src) * sa + green(dst) * inv)),
+        static_cast<dsttype>(fixed::div_max<srctype>(blue(src) * sa + blue(dst) * inv))
+        );
     } else if constexpr (SrcPixel::has_alpha() && !DstPixel::has_alpha()) {
+      // 64-bit for the 16-bit formats, the triple products overflow int
+      using calctype = typename std::conditional<(sizeof(srctype) < 2 && sizeof(dsttype) < 2), int, uint64_t>::type;
+      calctype const sa = alpha(src);
+      calctype const smax = SrcPixel::max();
       return make_pixel<DstPixel>(
-        static_cast<dsttype>((red(src) * alpha(src) + red(dst) * (SrcPixel::max() - alpha(src))) / SrcPixel::max()),
-        static_cast<dsttype>((green(src) * alpha(src) + green(dst) * (SrcPixel::max() - alpha(src))) / SrcPixel::max()),
-        static_cast<dsttype>((blue(src) * alpha(src) + blue(dst) * (SrcPixel::max() - alpha(src))) / SrcPixel::max())
+        static_cast<dsttype>((red(src) * sa + red(dst) * (smax - sa)) / smax),
+        static_cast<dsttype>((green(src) * sa + green(dst) * (smax - sa)) / smax),
+        static_cast<dsttype>((blue(src) * sa + blue(dst) * (smax - sa)) / smax)
         );
+    } else if constexpr (SrcPixel::has_alpha() && DstPixel::has_alpha() &&
+                         std::is_same<srctype, dsttype>::value && sizeof(srctype) == 1) {
+      // the division by out_a goes through a reciprocal table, the
+      // triple products stay divisions by a constant
+      uint32_t const sa = alpha(src);
+      uint32_t const da = alpha(dst);
+      uint32_t const inv = 255 - sa;
+      uint32_t const out_a = sa + fixed::div255(da * inv);
+      if (sa == 0) {
+        return dst;
+      } else {
+        // the truncated out_a can make the quotient overshoot 255
+        auto const mix = [&](uint32_t s, uint32_t d) {
+          return static_cast<dsttype>(std::min<uint32_t>(
+            fixed::div_u8(s * sa + d * da * inv / 255, static_cast<uint8_t>(out_a)), 255));
+        };
+        return make_pixel<DstPixel>(mix(red(src), red(dst)),
+                                    mix(green(src), green(dst)),
+                                    mix(blue(src), blue(dst)),
+                                    static_cast<dsttype>(out_a));
+      }
     } else if constexpr (SrcPixel::has_alpha() && DstPixel::has_alpha()) {
-      dsttype const out_a = static_cast<dsttype>(alpha(src) + alpha(dst) * (SrcPixel::max() - alpha(src)) / SrcPixel::max());
-      if (out_a == 0) {
-        return make_pixel<DstPixel>(0, 0, 0, 0);
+      using calctype = typename std::conditional<(sizeof(srctype) < 2 && sizeof(dsttype) < 2), int, uint64_t>::type;
+      calctype const sa = alpha(src);
+      calctype const da = alpha(dst);
+      calctype const smax = SrcPixel::max();
+      calctype const dmax = DstPixel::max();
+      dsttype const out_a = static_cast<dsttype>(sa + da * (smax - sa) / smax);
+      if (sa == 0) {
+        return dst;
       } else {
-        return make_pixel<DstPixel>(
-          static_cast<dsttype>((red(src) * alpha(src) * DstPixel::max() / SrcPixel::max() + red(dst) * alpha(dst) * (SrcPixel::max() - alpha(src)) / SrcPixel::max()) / out_a),
-          static_cast<dsttype>((green(src) * alpha(src) * DstPixel::max() / SrcPixel::max() + green(dst) * alpha(dst) * (SrcPixel::max() - alpha(src)) / SrcPixel::max()) / out_a),
-          static_cast<dsttype>((blue(src) * alpha(src) * DstPixel::max() / SrcPixel::max() + blue(dst) * alpha(dst) * (SrcPixel::max() - alpha(src)) / SrcPixel::max()) / out_a),
-          out_a
-          );
+        auto const mix = [&](calctype s, calctype d) {
+          return static_cast<dsttype>(std::min<calctype>((s * sa * dmax / smax + d * da * (smax - sa) / smax) / out_a, dmax));
+        };
+        return make_pixel<DstPixel>(mix(red(src), red(dst)),
+                                    mix(green(src), green(dst)),
+                                    mix(blue(src), blue(dst)),
+                                    out_a);
       }
     } else {
       static_assert(!std::is_same<SrcPixel, SrcPixel>::value,
@@ -78,33 +181,57 @@ struct pixel_add
 {
   inline constexpr DstPixel operator()(SrcPixel const src, DstPixel const dst)
   {
-    // using srctype = typename SrcPixel::value_type;
+    using srctype = typename SrcPixel::value_type;
     using dsttype = typename DstPixel::value_type;
 
-    if constexpr (SrcPixel::has_alpha()) {
-      if (alpha(src) == 0) {
-        return dst;
+    if constexpr (is_premultiplied<SrcPixel>::value) {
+      using StraightPixel = tRGBAPixel<srctype>;
+      return pixel_add<StraightPixel, DstPixel>()(convert<SrcPixel, StraightPixel>(src), dst);
+    } else if constexpr (is_premultiplied<DstPixel>::value) {
+      using StraightPixel = tRGBAPixel<dsttype>;
+      return convert<StraightPixel, DstPixel>(
+        pixel_add<SrcPixel, StraightPixel>()(src, convert<DstPixel, StraightPixel>(dst)));
+    } else {
+      if constexpr (SrcPixel::has_alpha()) {
+        if (alpha(src) == 0) {
+          return dst;
+        }
       }
-    }
 
-    if constexpr (std::is_floating_point<dsttype>::value) {
-      return make_pixel<DstPixel>(
-        static_cast<dsttype>(red_f(dst) + red_f(src) * alpha_f(src)),
-        static_cast<dsttype>(green_f(dst) + green_f(src) * alpha_f(src)),
-        static_cast<dsttype>(blue_f(dst) + blue_f(src) * alpha_f(src)),
-        static_cast<dsttype>(alpha_f(dst))
-        );
-    } else {
-      dsttype const r = convert_value<SrcPixel, DstPixel>(red(src));
-      dsttype const g = convert_value<SrcPixel, DstPixel>(green(src));
-      dsttype const b = convert_value<SrcPixel, DstPixel>(blue(src));
-      dsttype const a = convert_value<SrcPixel, DstPixel>(alpha(src));
+      if constexpr (std::is_floating_point<dsttype>::value) {
+        return make_pixel<DstPixel>(
+          static_cast<dsttype>(red_f(dst) + red_f(src) * alpha_f(src)),
+          static_cast<dsttype>(green_f(dst) + green_f(src) * alpha_f(src)),
+          static_cast<dsttype>(blue_f(dst) + blue_f(src) * alpha_f(src)),
+          static_cast<dsttype>(alpha_f(dst))
+          );
+      } else if constexpr (sizeof(dsttype) < 4) {
+        dsttype const r = convert_value<SrcPixel, DstPixel>(red(src));
+        dsttype const g = convert_value<SrcPixel, DstPixel>(green(src));
+        dsttype const b = convert_value<SrcPixel, DstPixel>(blue(src));
+        dsttype const a = convert_value<SrcPixel, DstPixel>(alpha(src));
+        auto const add = [a](dsttype d, dsttype s) {
+          if constexpr (SrcPixel::has_alpha()) {
+            return fixed::add_sat(d, fixed::mul_max(s, a));
+          } else {
+            // a is max, the product drops out
+            return fixed::add_sat(d, s);
+          }
+        };
 
-      return make_pixel<DstPixel>(
-        clamp_pixel_max<DstPixel>(red(dst) + r * a / DstPixel::max()),
-        clamp_pixel_max<DstPixel>(green(dst) + g * a / DstPixel::max()),
-        clamp_pixel_max<DstPixel>(blue(dst) + b * a / DstPixel::max()),
-        alpha(dst));
+        return make_pixel<DstPixel>(add(red(dst), r), add(green(dst), g), add(blue(dst), b), alpha(dst));
+      } else {
+        dsttype const r = convert_value<SrcPixel, DstPixel>(red(src));
+        dsttype const g = convert_value<SrcPixel, DstPixel>(green(src));
+        dsttype const b = convert_value<SrcPixel, DstPixel>(blue(src));
+        dsttype const a = convert_value<SrcPixel, DstPixel>(alpha(src));
+
+        return make_pixel<DstPixel>(
+          clamp_pixel_max<DstPixel>(red(dst) + r * a / DstPixel::max()),
+          clamp_pixel_max<DstPixel>(green(dst) + g * a / DstPixel::max()),
+          clamp_pixel_max<DstPixel>(blue(dst) + b * a / DstPixel::max()),
+          alpha(dst));
+      }
     }
   }
 };
@@ -114,38 +241,99 @@ struct pixel_multiply
 {
   inline constexpr DstPixel operator()(SrcPixel const src, DstPixel const dst)
   {
-    // using srctype = typename SrcPixel::value_type;
+    using srctype = typename SrcPixel::value_type;
     using dsttype = typename DstPixel::value_type;
 
-    if constexpr (SrcPixel::has_alpha()) {
-      if (alpha(src) == 0) {
-        return dst;
+    if constexpr (is_premultiplied<SrcPixel>::value) {
+      using StraightPixel = tRGBAPixel<srctype>;
+      return pixel_multiply<StraightPixel, DstPixel>()(convert<SrcPixel, StraightPixel>(src), dst);
+    } else if constexpr (is_premultiplied<DstPixel>::value) {
+      using StraightPixel = tRGBAPixel<dsttype>;
+      return convert<StraightPixel, DstPixel>(
+        pixel_multiply<SrcPixel, StraightPixel>()(src, convert<DstPixel, StraightPixel>(dst)));
+    } else {
+      if constexpr (SrcPixel::has_alpha()) {
+        if (alpha(src) == 0) {
+          return dst;
+        }
       }
-    }
 
-    // FIXME: ignoring src alpha for now
-    if constexpr (std::is_floating_point<dsttype>::value) {
-      return make_pixel<DstPixel>(
-        static_cast<dsttype>(red_f(dst) * red_f(src)),
-        static_cast<dsttype>(green_f(dst) * green_f(src)),
-        static_cast<dsttype>(blue_f(dst) * blue_f(src)),
-        static_cast<dsttype>(alpha_f(dst))
-        );
-    } else {
-      dsttype const r = convert_value<SrcPixel, DstPixel>(red(src));
-      dsttype const g = convert_value<SrcPixel, DstPixel>(green(src));
-      dsttype const b = convert_value<SrcPixel, DstPixel>(blue(src));
-      //dsttype const a = convert_value<SrcPixel, DstPixel>(alpha(src));
+      // the source is faded towards white by its alpha, so translucent
+      // sources darken less, the destination alpha is kept
+      if constexpr (std::is_floating_point<dsttype>::value) {
+        float const sa = alpha_f(src);
+        auto const mul = [sa](float d, float s) { return static_cast<dsttype>(d * ((1.0f - sa) + s * sa)); };
+        return make_pixel<DstPixel>(mul(red_f(dst), red_f(src)),
+                                    mul(green_f(dst), green_f(src)),
+                                    mul(blue_f(dst), blue_f(src)),
+                                    static_cast<dsttype>(alpha_f(dst)));
+      } else {
+        using calctype = fixed::product_t<dsttype>;
+        dsttype const a = convert_value<SrcPixel, DstPixel>(alpha(src));
+        auto const mul = [a](dsttype d, dsttype s) {
+          calctype f = s;
+          if constexpr (SrcPixel::has_alpha()) {
+            f = (DstPixel::max() - a) + fixed::mul_max(s, a);
+          }
+          return static_cast<dsttype>(fixed::div_max<dsttype>(static_cast<calctype>(d) * f));
+        };
 
-      return make_pixel<DstPixel>(
-        clamp_pixel_max<DstPixel>(red(dst) * r / DstPixel::max()),
-        clamp_pixel_max<DstPixel>(green(dst) * g / DstPixel::max()),
-        clamp_pixel_max<DstPixel>(blue(dst) * b / DstPixel::max()),
-        alpha(dst));
+        return make_pixel<DstPixel>(mul(red(dst), convert_value<SrcPixel, DstPixel>(red(src))),
+                                    mul(green(dst), convert_value<SrcPixel, DstPixel>(green(src))),
+                                    mul(blue(dst), convert_value<SrcPixel, DstPixel>(blue(src))),
+                                    alpha(dst));
+      }
     }
   }
 };
 
+/** Straight alpha compositing with one of the blendmode:: modes. Both
+    pixels go through RGBA32f, so every format pair gives the same
+    result as blending the RGBA32f conversions. */
+template<typename Mode, typename SrcPixel, typename DstPixel>
+struct pixel_composite
+{
+  inline DstPixel operator()(SrcPixel src, DstPixel dst)
+  {
+    return convert<RGBA32fPixel, DstPixel>(
+      blendmode::composite<Mode>(convert<SrcPixel, RGBA32fPixel>(src),
+                                 convert<DstPixel, RGBA32fPixel>(dst)));
+  }
+};
+
+template<typename SrcPixel, typename DstPixel>
+using pixel_screen = pixel_composite<blendmode::Screen, SrcPixel, DstPixel>;
+
+template<typename SrcPixel, typename DstPixel>
+using pixel_overlay = pixel_composite<blendmode::Overlay, SrcPixel, DstPixel>;
+
+template<typename SrcPixel, typename DstPixel>
+using pixel_darken = pixel_composite<blendmode::Darken, SrcPixel, DstPixel>;
+
+template<typename SrcPixel, typename DstPixel>
+using pixel_lighten = pixel_composite<blendmode::Lighten, SrcPixel, DstPixel>;
+
+template<typename SrcPixel, typename DstPixel>
+using pixel_difference = pixel_composite<blendmode::Difference, SrcPixel, DstPixel>;
+
+template<typename SrcPixel, typename DstPixel>
+using pixel_subtract = pixel_composite<blendmode::Subtract, SrcPixel, DstPixel>;
+
+template<typename SrcPixel, typename DstPixel>
+using pixel_soft_light = pixel_composite<blendmode::SoftLight, SrcPixel, DstPixel>;
+
+template<typename SrcPixel, typename DstPixel>
+using pixel_src_in = pixel_composite<blendmode::SrcIn, SrcPixel, DstPixel>;
+
+template<typename SrcPixel, typename DstPixel>
+using pixel_src_out = pixel_composite<blendmode::SrcOut, SrcPixel, DstPixel>;
+
+template<typename SrcPixel, typename DstPixel>
+using pixel_src_atop = pixel_composite<blendmode::SrcAtop, SrcPixel, DstPixel>;
+
+template<typename SrcPixel, typename DstPixel>
+using pixel_xor = pixel_composite<blendmode::Xor, SrcPixel, DstPixel>;
+
 } // namespace surf
 
 #endif
@@ -17,6 +17,8 @@
 #ifndef HEADER_SURF_BLENDFUNC_HPP
 #define HEADER_SURF_BLENDFUNC_HPP
 
+#include <stddef.h>
+
 #include <string_view>
 
 #include "blend.hpp"
@@ -29,9 +31,34 @@ enum class BlendFunc
   BLEND,
   ADD,
   MULTIPLY,
+
+  // separable modes composited "over" the destination, see blendmode.hpp
+  SCREEN,
+  OVERLAY,
+  DARKEN,
+  LIGHTEN,
+  DIFFERENCE,
+  SUBTRACT,
+  SOFT_LIGHT,
+
+  // Porter-Duff operators
+  SRC_IN,
+  SRC_OUT,
+  SRC_ATOP,
+  XOR,
 };
 
+constexpr size_t BLEND_FUNC_COUNT = static_cast<size_t>(BlendFunc::XOR) + 1;
+
 BlendFunc BlendFunc_from_string(std::string_view blendfunc_str);
+std::string_view to_string(BlendFunc blendfunc);
+
+#define BLENDFUNC_TO_TYPE__CASE(value, functor, blendfunc_t, expr)      \
+  case BlendFunc::value: {                                              \
+    using blendfunc_t = functor<srctype, dsttype>; /* NOLINT */         \
+    expr;                                                               \
+    break;                                                              \
+  }
 
 #define BLENDFUNC_TO_TYPE(blendfunc, blendfunc_t, expr)                 \
   do {                                                                  \
@@ -56,6 +83,17 @@ BlendFunc BlendFunc_from_string(std::string_view blendfunc_str);
         expr;                                                           \
         break;                                                          \
       }                                                                 \
+      BLENDFUNC_TO_TYPE__CASE(SCREEN, pixel_screen, blendfunc_t, expr)  \
+      BLENDFUNC_TO_TYPE__CASE(OVERLAY, pixel_overlay, blendfunc_t, expr) \
+      BLENDFUNC_TO_TYPE__CASE(DARKEN, pixel_darken, blendfunc_t, expr)  \
+      BLENDFUNC_TO_TYPE__CASE(LIGHTEN, pixel_lighten, blendfunc_t, expr) \
+      BLENDFUNC_TO_TYPE__CASE(DIFFERENCE, pixel_difference, blendfunc_t, expr) \
+      BLENDFUNC_TO_TYPE__CASE(SUBTRACT, pixel_subtract, blendfunc_t, expr) \
+      BLENDFUNC_TO_TYPE__CASE(SOFT_LIGHT, pixel_soft_light, blendfunc_t, expr) \
+      BLENDFUNC_TO_TYPE__CASE(SRC_IN, pixel_src_in, blendfunc_t, expr)  \
+      BLENDFUNC_TO_TYPE__CASE(SRC_OUT, pixel_src_out, blendfunc_t, expr) \
+      BLENDFUNC_TO_TYPE__CASE(SRC_ATOP, pixel_src_atop, blendfunc_t, expr) \
+      BLENDFUNC_TO_TYPE__CASE(XOR, pixel_xor, blendfunc_t, expr)        \
       default:                                                          \
         throw std::invalid_argument("unknown blendfunc");               \
     }                                                                   \
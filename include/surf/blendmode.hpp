@@ -0,0 +1,202 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_BLENDMODE_HPP
+#define HEADER_SURF_BLENDMODE_HPP
+
+#include <cmath>
+
+#include "pixel.hpp"
+
+namespace surf {
+namespace blendmode {
+
+/** Operations the blend mode templates are written in. The SIMD
+    kernels provide the same set for their vector types, so scalar and
+    vector code run the identical sequence of float operations.
+    Arithmetic uses the plain operators. */
+struct ScalarOps
+{
+  using value_type = float;
+  using mask_type = bool;
+
+  static constexpr float k(float v) { return v; }
+  static constexpr float min(float a, float b) { return a < b ? a : b; }
+  static constexpr float max(float a, float b) { return a > b ? a : b; }
+  static float abs(float v) { return std::fabs(v); }
+  static float sqrt(float v) { return std::sqrt(v); }
+  static constexpr bool le(float a, float b) { return a <= b; }
+  static constexpr float select(bool m, float a, float b) { return m ? a : b; }
+};
+
+/** A blend mode composites with the Porter-Duff coverage factors
+    fa() and fb(): the source contributes fa * sa, the destination
+    fb * da. Separable modes additionally replace the source color
+    where it overlaps the destination with mix(cb, cs), as in the W3C
+    compositing spec, and composite the result "over" the
+    destination. */
+struct Separable
+{
+  static constexpr bool separable = true;
+
+  template<typename Ops, typename T>
+  static constexpr T fa(T /*sa*/, T /*da*/) { return Ops::k(1.0f); }
+
+  template<typename Ops, typename T>
+  static constexpr T fb(T sa, T /*da*/) { return Ops::k(1.0f) - sa; }
+};
+
+struct PorterDuff
+{
+  static constexpr bool separable = false;
+};
+
+struct Screen : Separable
+{
+  template<typename Ops, typename T>
+  static T mix(T cb, T cs) { return cb + cs - cb * cs; }
+};
+
+struct Overlay : Separable
+{
+  template<typename Ops, typename T>
+  static T mix(T cb, T cs) {
+    return Ops::select(Ops::le(cb, Ops::k(0.5f)),
+                       Ops::k(2.0f) * cb * cs,
+                       Screen::mix<Ops>(Ops::k(2.0f) * cb - Ops::k(1.0f), cs));
+  }
+};
+
+struct Darken : Separable
+{
+  template<typename Ops, typename T>
+  static T mix(T cb, T cs) { return Ops::min(cb, cs); }
+};
+
+struct Lighten : Separable
+{
+  template<typename Ops, typename T>
+  static T mix(T cb, T cs) { return Ops::max(cb, cs); }
+};
+
+struct Difference : Separable
+{
+  template<typename Ops, typename T>
+  static T mix(T cb, T cs) { return Ops::abs(cb - cs); }
+};
+
+/** Destination minus source, clamped at zero */
+struct Subtract : Separable
+{
+  template<typename Ops, typename T>
+  static T mix(T cb, T cs) { return Ops::max(cb - cs, Ops::k(0.0f)); }
+};
+
+struct SoftLight : Separable
+{
+  template<typename Ops, typename T>
+  static T mix(T cb, T cs) {
+    T const d = Ops::select(Ops::le(cb, Ops::k(0.25f)),
+                            ((Ops::k(16.0f) * cb - Ops::k(12.0f)) * cb + Ops::k(4.0f)) * cb,
+                            Ops::sqrt(cb));
+    return Ops::select(Ops::le(cs, Ops::k(0.5f)),
+                       cb - (Ops::k(1.0f) - Ops::k(2.0f) * cs) * cb * (Ops::k(1.0f) - cb),
+                       cb + (Ops::k(2.0f) * cs - Ops::k(1.0f)) * (d - cb));
+  }
+};
+
+/** Source where the destination is, the destination is cleared */
+struct SrcIn : PorterDuff
+{
+  template<typename Ops, typename T>
+  static constexpr T fa(T /*sa*/, T da) { return da; }
+
+  template<typename Ops, typename T>
+  static constexpr T fb(T /*sa*/, T /*da*/) { return Ops::k(0.0f); }
+};
+
+/** Source where the destination is not, the destination is cleared */
+struct SrcOut : PorterDuff
+{
+  template<typename Ops, typename T>
+  static constexpr T fa(T /*sa*/, T da) { return Ops::k(1.0f) - da; }
+
+  template<typename Ops, typename T>
+  static constexpr T fb(T /*sa*/, T /*da*/) { return Ops::k(0.0f); }
+};
+
+/** Source over the destination, but only where the destination is */
+struct SrcAtop : PorterDuff
+{
+  template<typename Ops, typename T>
+  static constexpr T fa(T /*sa*/, T da) { return da; }
+
+  template<typename Ops, typename T>
+  static constexpr T fb(T sa, T /*da*/) { return Ops::k(1.0f) - sa; }
+};
+
+struct Xor : PorterDuff
+{
+  template<typename Ops, typename T>
+  static constexpr T fa(T /*sa*/, T da) { return Ops::k(1.0f) - da; }
+
+  template<typename Ops, typename T>
+  static constexpr T fb(T sa, T /*da*/) { return Ops::k(1.0f) - sa; }
+};
+
+/** The straight color of one channel, \a cs and \a cb are the source
+    and destination colors, \a wa and \a wb the weights fa * sa and
+    fb * da and \a out_a their sum */
+template<typename Mode, typename Ops, typename T> inline
+T composite_channel(T cs, T cb, T da, T wa, T wb, T out_a)
+{
+  if constexpr (Mode::separable) {
+    cs = (Ops::k(1.0f) - da) * cs + da * Mode::template mix<Ops>(cb, cs);
+  }
+  return (wa * cs + wb * cb) / out_a;
+}
+
+/** Composite \a src onto \a dst with \a Mode. The destination is
+    returned unchanged when the source contributes nothing, pixels
+    without coverage become transparent black. */
+template<typename Mode> inline
+RGBA32fPixel composite(RGBA32fPixel src, RGBA32fPixel dst)
+{
+  using Ops = ScalarOps;
+
+  float const wa = Mode::template fa<Ops>(src.a, dst.a) * src.a;
+  float const fb = Mode::template fb<Ops>(src.a, dst.a);
+  float const wb = fb * dst.a;
+  float const out_a = wa + wb;
+
+  if (wa == 0.0f && fb == 1.0f) {
+    return dst;
+  } else if (out_a == 0.0f) {
+    return {0.0f, 0.0f, 0.0f, 0.0f};
+  } else {
+    auto const channel = [&](float cs, float cb) {
+      return composite_channel<Mode, Ops>(cs, cb, dst.a, wa, wb, out_a);
+    };
+    return {channel(src.r, dst.r), channel(src.g, dst.g), channel(src.b, dst.b), out_a};
+  }
+}
+
+} // namespace blendmode
+} // namespace surf
+
+#endif
+
+/* EOF */
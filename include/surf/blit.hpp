@@ -19,10 +19,12 @@
 
 #include <cassert>
 #include <cstring>
+#include <vector>
 
 #include "blend.hpp"
 #include "blendfunc.hpp"
 #include "pixel_data.hpp"
+#include "scale_filter.hpp"
 
 namespace surf {
 
@@ -40,6 +42,29 @@ geom::irect equivalence_clip(geom::irect const& srcrect_unclipped, geom::irect c
                      dstrect_unclipped.bottom() + (srcrect.bottom() - srcrect_unclipped.bottom()) * dstrect_unclipped.height() / srcrect_unclipped.height());
 }
 
+/** Clip the \a srcrect to \a dstrect mapping of a scaled blit to
+    \a srcsize and \a dstsize, keeping both in proportion. Returns
+    false when nothing is left to draw. */
+inline
+bool clip_scaled(geom::isize const& srcsize, geom::irect& srcrect,
+                 geom::isize const& dstsize, geom::irect& dstrect)
+{
+  geom::irect const dstrect1 = geom::intersection(geom::irect(dstsize), dstrect);
+  if (dstrect1.width() <= 0 || dstrect1.height() <= 0) {
+    return false;
+  }
+
+  geom::irect const srcrect1 = equivalence_clip(dstrect, dstrect1, srcrect);
+  geom::irect const srcrect2 = geom::intersection(geom::irect(srcsize), srcrect1);
+  if (srcrect2.width() <= 0 || srcrect2.height() <= 0) {
+    return false;
+  }
+
+  srcrect = srcrect2;
+  dstrect = equivalence_clip(srcrect1, srcrect2, dstrect1);
+  return dstrect.width() > 0 && dstrect.height() > 0;
+}
+
 template<typename SrcPixel, typename DstPixel, typename BlendFunc> inline
 void blend_n(BlendFunc blend_func,
              SrcPixel const* srcpixels, DstPixel* dstpixels,
@@ -135,31 +160,40 @@ void blit(PixelView<SrcPixel> const& src, PixelView<DstPixel>& dst, geom::ipoint
   blit(src, geom::irect(src.get_size()), dst, pos);
 }
 
+/** Blend \a srcrect_unclipped of \a src scaled to \a dstrect_unclipped,
+    the source sampled with \a filter, clipped to both surfaces */
 template<typename BlendFuncType, typename SrcPixel, typename DstPixel>
 void blend_scaled(BlendFuncType blendfunc,
                   PixelView<SrcPixel> const& src, geom::irect const& srcrect_unclipped,
-                  PixelView<DstPixel>& dst, geom::irect const& dstrect_unclipped)
+                  PixelView<DstPixel>& dst, geom::irect const& dstrect_unclipped,
+                  ScaleFilter filter)
 {
-  geom::irect const dstrect1 = geom::intersection(geom::irect(dst.get_size()), dstrect_unclipped);
-  geom::irect const srcrect1 = detail::equivalence_clip(dstrect_unclipped, dstrect1, srcrect_unclipped);
-
-  geom::irect const srcrect = geom::intersection(geom::irect(src.get_size()), srcrect1);
-  geom::irect const dstrect = detail::equivalence_clip(srcrect1, srcrect, dstrect1);
+  geom::irect srcrect = srcrect_unclipped;
+  geom::irect dstrect = dstrect_unclipped;
+  if (!detail::clip_scaled(src.get_size(), srcrect, dst.get_size(), dstrect)) {
+    return;
+  }
 
   assert(contains(geom::irect(src.get_size()), srcrect));
   assert(contains(geom::irect(dst.get_size()), dstrect));
 
-  for (int y = 0; y < dstrect.height(); ++y) {
-    SrcPixel const* const srcrow = src.get_row((y + srcrect.top()) * srcrect.height() / dstrect.height()) + srcrect.left();
-    DstPixel* const dstrow = dst.get_row(y + dstrect.top()) + dstrect.left();
+  ScaledRowSampler<SrcPixel> sampler(src, srcrect, dstrect.size(), filter);
+  std::vector<SrcPixel> samples(static_cast<size_t>(dstrect.width()));
 
-    for (int x = 0; x < dstrect.width(); ++x) {
-      // LUT this?
-      dstrow[x] = blendfunc(srcrow[x * srcrect.width() / dstrect.width()], dstrow[x]);
-    }
+  for (int y = 0; y < dstrect.height(); ++y) {
+    sampler.sample_row(y, samples.data());
+    detail::blend_n(blendfunc, samples.data(), dst.get_row(y + dstrect.top()) + dstrect.left(), samples.size());
   }
 }
 
+template<typename BlendFuncType, typename SrcPixel, typename DstPixel>
+void blend_scaled(BlendFuncType blendfunc,
+                  PixelView<SrcPixel> const& src, geom::irect const& srcrect_unclipped,
+                  PixelView<DstPixel>& dst, geom::irect const& dstrect_unclipped)
+{
+  blend_scaled(blendfunc, src, srcrect_unclipped, dst, dstrect_unclipped, ScaleFilter::NEAREST);
+}
+
 template<typename BlendFunc, typename SrcPixel, typename DstPixel>
 void blend_scaled(BlendFunc blendfunc,
                   PixelView<SrcPixel> const& src,
@@ -135,7 +135,7 @@ split_channel(PixelView<tRGBAPixel<T>> const& src)
     }
   }
 
-  return {red_c, green_c, blue_c};
+  return {red_c, green_c, blue_c, alpha_c};
 }
 
 std::vector<SoftwareSurface> split_channel(SoftwareSurface const& src);
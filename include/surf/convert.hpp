@@ -18,6 +18,7 @@
 #define HEADER_SURF_CONVERT_HPP
 
 #include "color.hpp"
+#include "fixed_point.hpp"
 #include "pixel.hpp"
 #include "promote.hpp"
 
@@ -39,12 +40,18 @@ constexpr typename DstPixel::value_type convert_value(typename SrcPixel::value_t
       } else {
         // float -> int
         if constexpr (sizeof(dsttype) == sizeof(srctype)) {
-          // special case, as uint32 -> float32 will overflow
-          return static_cast<dsttype>(
-            std::clamp(static_cast<uint64_t>(v * static_cast<srctype>(DstPixel::max())),
-                       static_cast<uint64_t>(0), static_cast<uint64_t>(DstPixel::max())));
+          // special case, as uint32 -> float32 will overflow, so scale
+          // in double, NaN and negative values must become zero before
+          // the cast, as converting them to unsigned is undefined
+          double const clamped = v > static_cast<srctype>(0) ? std::min(static_cast<double>(v), 1.0) : 0.0;
+          return static_cast<dsttype>(clamped * static_cast<double>(DstPixel::max()) + 0.5);
         } else {
-          return static_cast<dsttype>(std::clamp<srctype>(v, 0.0, 1.0) * static_cast<srctype>(DstPixel::max()));
+          // round to nearest, not truncate, so 8- and 16-bit values
+          // survive a trip through float or half and the scalar path
+          // matches the SIMD kernels, NaN becomes zero like with the
+          // SIMD max(v, 0)
+          srctype const clamped = v > static_cast<srctype>(0) ? std::min(v, static_cast<srctype>(1)) : static_cast<srctype>(0);
+          return static_cast<dsttype>(clamped * static_cast<srctype>(DstPixel::max()) + static_cast<srctype>(0.5));
         }
       }
     } else {
@@ -53,18 +60,63 @@ constexpr typename DstPixel::value_type convert_value(typename SrcPixel::value_t
         return static_cast<dsttype>(v) / static_cast<dsttype>(SrcPixel::max());
       } else {
         // int -> int
-        using promotype = typename promote_t<typename SrcPixel::value_type, typename DstPixel::value_type>::type;
-        return static_cast<dsttype>(static_cast<promotype>(v) * DstPixel::max() / SrcPixel::max());
+        return fixed::rescale<srctype, dsttype>(v);
       }
     }
   }
 }
 
+/** Multiply the color channels by alpha, rounding to nearest */
+template<typename T> inline
+constexpr tPRGBAPixel<T> premultiply(tRGBAPixel<T> src)
+{
+  if constexpr (std::is_floating_point<T>::value) {
+    return {src.r * src.a, src.g * src.a, src.b * src.a, src.a};
+  } else {
+    using promotype = fixed::product_t<T>;
+    constexpr promotype max = tRGBAPixel<T>::max();
+    auto const mul = [a = static_cast<promotype>(src.a)](T v) {
+      return static_cast<T>(fixed::div_max<T>(static_cast<promotype>(v) * a + max / 2));
+    };
+    return {mul(src.r), mul(src.g), mul(src.b), src.a};
+  }
+}
+
+/** Divide the color channels by alpha, rounding to nearest, fully
+    transparent pixels become black */
+template<typename T> inline
+constexpr tRGBAPixel<T> unpremultiply(tPRGBAPixel<T> src)
+{
+  if (src.a == 0) {
+    return {0, 0, 0, 0};
+  }
+
+  if constexpr (std::is_floating_point<T>::value) {
+    return {src.r / src.a, src.g / src.a, src.b / src.a, src.a};
+  } else if constexpr (sizeof(T) == 1) {
+    auto const div = [a = src.a](T v) {
+      return static_cast<T>(std::min<uint32_t>(fixed::div_u8(v * 255u + a / 2u, a), 255));
+    };
+    return {div(src.r), div(src.g), div(src.b), src.a};
+  } else {
+    using promotype = typename promote_t<T, T>::type;
+    constexpr promotype max = tPRGBAPixel<T>::max();
+    auto const div = [a = static_cast<promotype>(src.a)](T v) {
+      return static_cast<T>(std::min<promotype>((static_cast<promotype>(v) * max + a / 2) / a, tPRGBAPixel<T>::max()));
+    };
+    return {div(src.r), div(src.g), div(src.b), src.a};
+  }
+}
+
 template<typename SrcPixel, typename DstPixel>
 DstPixel convert(SrcPixel src)
 {
   if constexpr (std::is_same<SrcPixel, DstPixel>::value) {
     return src;
+  } else if constexpr (is_premultiplied<SrcPixel>::value && !is_premultiplied<DstPixel>::value) {
+    return convert<tRGBAPixel<typename SrcPixel::value_type>, DstPixel>(unpremultiply(src));
+  } else if constexpr (!is_premultiplied<SrcPixel>::value && is_premultiplied<DstPixel>::value) {
+    return premultiply(convert<SrcPixel, tRGBAPixel<typename DstPixel::value_type>>(src));
   } else if constexpr (SrcPixel::has_alpha()) {
     return make_pixel<DstPixel>(
       convert_value<SrcPixel, DstPixel>(red(src)),
@@ -0,0 +1,67 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SURF_CONVERT_SPAN_HPP
+#define HEADER_SURF_CONVERT_SPAN_HPP
+
+#include <stddef.h>
+
+#include <type_traits>
+
+#include "color.hpp"
+#include "pixel.hpp"
+#include "pixel_format.hpp"
+
+namespace surf {
+namespace detail {
+
+/** True when PPixelFormat has a specialization for \a Pixel */
+template<typename Pixel, typename = void>
+struct has_pixel_format : std::false_type {};
+
+template<typename Pixel>
+struct has_pixel_format<Pixel, std::void_t<decltype(PPixelFormat<Pixel>::format)>> : std::true_type {};
+
+/** Convert \a count pixels from \a srcformat to \a dstformat with the
+    KernelRegistry conversion kernel, so the SIMD kernels get picked
+    up. Returns false without touching \a dst when the registry
+    doesn't know one of the formats. Defined in src/convert.cpp to
+    keep the registry out of the PixelView header. */
+bool convert_span(PixelFormat srcformat, PixelFormat dstformat, void const* src, void* dst, size_t count);
+
+/** The formats whose Color rows go through the KernelRegistry span
+    kernels instead of convert() per pixel */
+template<typename Pixel>
+constexpr bool has_color_span_kernel()
+{
+  return std::is_same<Pixel, RGB8Pixel>::value ||
+    std::is_same<Pixel, RGBA8Pixel>::value ||
+    std::is_same<Pixel, RGBA16Pixel>::value ||
+    std::is_same<Pixel, RGBA32fPixel>::value;
+}
+
+/** Convert \a count pixels of \a format to or from Color with the
+    KernelRegistry span kernels */
+void colors_from_span(PixelFormat format, void const* src, Color* dst, size_t count);
+void colors_to_span(PixelFormat format, Color const* src, void* dst, size_t count);
+
+} // namespace detail
+} // namespace surf
+
+#endif
+
+/* EOF */
@@ -0,0 +1,111 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_EXTERNAL_PIXEL_DATA_HPP
+#define HEADER_SURF_EXTERNAL_PIXEL_DATA_HPP
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+
+#include "pixel_view.hpp"
+
+namespace surf {
+
+/** Called with the original pointer once the pixels are no longer
+    needed, e.g. free(), SDL_FreeSurface() wrapped in a lambda, or a
+    custom allocator's release function */
+using PixelDeleter = std::function<void (void*)>;
+
+/** Owning PixelData for a buffer that was allocated elsewhere, the
+    buffer is released with the given deleter */
+template<typename Pixel>
+class ExternalPixelData : public PixelView<Pixel>
+{
+public:
+  ExternalPixelData() :
+    PixelView<Pixel>(),
+    m_ownership(nullptr, [](void*){})
+  {}
+
+  /** Adopt \a pixels, \a pitch is in bytes and must be a multiple of
+      the pixel size. \a deleter receives \a pixels, not the row
+      pointer, and is also called when the constructor throws. An
+      empty \a deleter throws std::invalid_argument and leaves
+      \a pixels with the caller. */
+  ExternalPixelData(geom::isize const& size, Pixel* pixels, ptrdiff_t pitch, PixelDeleter deleter) :
+    PixelView<Pixel>(size, pixels, pitch / static_cast<ptrdiff_t>(sizeof(Pixel))),
+    m_ownership(pixels, check_deleter(std::move(deleter)))
+  {
+    if (pitch % static_cast<ptrdiff_t>(sizeof(Pixel)) != 0) {
+      throw std::invalid_argument("ExternalPixelData: pitch must be a multiple of the pixel size");
+    }
+
+    if (this->m_row_length < size.width()) {
+      throw std::invalid_argument("ExternalPixelData: pitch smaller than width");
+    }
+  }
+
+  ExternalPixelData(ExternalPixelData<Pixel>&& other) noexcept :
+    PixelView<Pixel>(other),
+    m_ownership(std::move(other.m_ownership))
+  {
+    static_cast<PixelView<Pixel>&>(other) = PixelView<Pixel>();
+  }
+
+  ExternalPixelData<Pixel>& operator=(ExternalPixelData<Pixel>&& other) noexcept
+  {
+    if (this != &other) {
+      PixelView<Pixel>::operator=(other);
+      m_ownership = std::move(other.m_ownership);
+      static_cast<PixelView<Pixel>&>(other) = PixelView<Pixel>();
+    }
+    return *this;
+  }
+
+  bool owns_data() const override { return true; }
+
+  /** Give up ownership, the caller becomes responsible for freeing
+      the returned pointer */
+  void* release() {
+    static_cast<PixelView<Pixel>&>(*this) = PixelView<Pixel>();
+    return m_ownership.release();
+  }
+
+private:
+  /** The unique_ptr would call an empty deleter from its noexcept
+      destructor */
+  static PixelDeleter check_deleter(PixelDeleter deleter)
+  {
+    if (!deleter) {
+      throw std::invalid_argument("ExternalPixelData: empty deleter");
+    }
+    return deleter;
+  }
+
+private:
+  std::unique_ptr<void, PixelDeleter> m_ownership;
+
+private:
+  ExternalPixelData(const ExternalPixelData<Pixel>&) = delete;
+  ExternalPixelData<Pixel>& operator=(const ExternalPixelData<Pixel>&) = delete;
+};
+
+} // namespace surf
+
+#endif
+
+/* EOF */
@@ -19,6 +19,7 @@
 
 #include <cmath>
 #include <numbers>
+#include <vector>
 
 #include "algorithm.hpp"
 #include "color.hpp"
@@ -39,34 +40,40 @@ void pixel_filter(PixelView<Pixel>& src, PixelFunc func)
   }
 }
 
-template<typename Pixel>
-void apply_gamma(PixelView<Pixel>& src, float gamma)
+/** Applies \a func(Color&) to each pixel, converting one row at a
+    time to and from Color */
+template<typename Pixel, typename ColorFunc>
+void color_filter(PixelView<Pixel>& src, ColorFunc func)
 {
-  // FIXME: Slow
+  std::vector<Color> row(static_cast<size_t>(src.get_width()));
   for(int y = 0; y < src.get_height(); ++y) {
-    for(int x = 0; x < src.get_width(); ++x) {
-      Color rgba = src.get_pixel_color({x, y});
-      rgba.r = powf(rgba.r, 1.0f / gamma);
-      rgba.g = powf(rgba.g, 1.0f / gamma);
-      rgba.b = powf(rgba.b, 1.0f / gamma);
-      src.put_pixel_color({x, y}, rgba);
+    // qualified, the pixel type is known, so skip the virtual call
+    src.PixelView<Pixel>::read_row_colors(y, 0, src.get_width(), row.data());
+    for (Color& rgba : row) {
+      func(rgba);
     }
+    src.PixelView<Pixel>::write_row_colors(y, 0, src.get_width(), row.data());
   }
 }
 
+template<typename Pixel>
+void apply_gamma(PixelView<Pixel>& src, float gamma)
+{
+  color_filter(src, [gamma](Color& rgba) {
+    rgba.r = powf(rgba.r, 1.0f / gamma);
+    rgba.g = powf(rgba.g, 1.0f / gamma);
+    rgba.b = powf(rgba.b, 1.0f / gamma);
+  });
+}
+
 template<typename Pixel>
 void apply_multiply(PixelView<Pixel>& src, float factor)
 {
-  // FIXME: Slow
-  for(int y = 0; y < src.get_height(); ++y) {
-    for(int x = 0; x < src.get_width(); ++x) {
-      Color rgba = src.get_pixel_color({x, y});
-      rgba.r *= factor;
-      rgba.g *= factor;
-      rgba.b *= factor;
-      src.put_pixel_color({x, y}, rgba);
-    }
-  }
+  color_filter(src, [factor](Color& rgba) {
+    rgba.r *= factor;
+    rgba.g *= factor;
+    rgba.b *= factor;
+  });
 }
 
 template<typename Pixel>
@@ -97,48 +104,35 @@ void apply_add(PixelView<Pixel>& src, float addend)
 template<typename Pixel>
 void apply_brightness(PixelView<Pixel>& src, float brightness)
 {
-  // FIXME: Slow
-  for(int y = 0; y < src.get_height(); ++y) {
-    for(int x = 0; x < src.get_width(); ++x) {
-      Color rgba = src.get_pixel_color({x, y});
-      rgba.r += brightness;
-      rgba.g += brightness;
-      rgba.b += brightness;
-      src.put_pixel_color({x, y}, rgba);
-    }
-  }
+  color_filter(src, [brightness](Color& rgba) {
+    rgba.r += brightness;
+    rgba.g += brightness;
+    rgba.b += brightness;
+  });
 }
 
 template<typename Pixel>
 void apply_contrast(PixelView<Pixel>& src, float contrast /* [-1.0, 1.0f] */)
 {
-  // FIXME: Slow
   contrast = std::clamp(((contrast + 1.0f) / 2.0f), 0.0f, 1.0f);
   float const factor = static_cast<float>(tan(contrast * std::numbers::pi_v<float> / 2.0f));
-  for(int y = 0; y < src.get_height(); ++y) {
-    for(int x = 0; x < src.get_width(); ++x) {
-      Color rgba = src.get_pixel_color({x, y});
-      rgba.r = (rgba.r - 0.5f) * factor + 0.5f;
-      rgba.g = (rgba.g - 0.5f) * factor + 0.5f;
-      rgba.b = (rgba.b - 0.5f) * factor + 0.5f;
-      src.put_pixel_color({x, y}, clamp(rgba));
-    }
-  }
+  color_filter(src, [factor](Color& rgba) {
+    rgba.r = (rgba.r - 0.5f) * factor + 0.5f;
+    rgba.g = (rgba.g - 0.5f) * factor + 0.5f;
+    rgba.b = (rgba.b - 0.5f) * factor + 0.5f;
+    rgba = clamp(rgba);
+  });
 }
 
 template<typename Pixel>
 void apply_invert(PixelView<Pixel>& src)
 {
-  // FIXME: Slow
-  for(int y = 0; y < src.get_height(); ++y) {
-    for(int x = 0; x < src.get_width(); ++x) {
-      Color rgba = src.get_pixel_color({x, y});
-      rgba.r = 1.0f - rgba.r;
-      rgba.g = 1.0f - rgba.g;
-      rgba.b = 1.0f - rgba.b;
-      src.put_pixel_color({x, y}, clamp(rgba));
-    }
-  }
+  color_filter(src, [](Color& rgba) {
+    rgba.r = 1.0f - rgba.r;
+    rgba.g = 1.0f - rgba.g;
+    rgba.b = 1.0f - rgba.b;
+    rgba = clamp(rgba);
+  });
 }
 
 template<typename Pixel>
@@ -190,23 +184,19 @@ void apply_grayscale(PixelView<Pixel>& src)
 template<typename Pixel>
 void apply_hsv(PixelView<Pixel>& src, float hue, float saturation, float value)
 {
-  // FIXME: Slow
-  for(int y = 0; y < src.get_height(); ++y) {
-    for(int x = 0; x < src.get_width(); ++x) {
-      Color color = src.get_pixel_color({x, y});
-      HSVColor hsv = hsv_from_color(color);
+  color_filter(src, [hue, saturation, value](Color& color) {
+    HSVColor hsv = hsv_from_color(color);
 
-      hsv.hue += hue;
-      hsv.saturation += saturation;
-      hsv.value += value;
+    hsv.hue += hue;
+    hsv.saturation += saturation;
+    hsv.value += value;
 
-      hsv.hue = std::fmod(hsv.hue + 1.0f, 1.0f);
-      hsv.saturation = std::clamp(hsv.saturation, 0.0f, 1.0f);
-      hsv.value = std::clamp(hsv.value, 0.0f, 1.0f);
+    hsv.hue = std::fmod(hsv.hue + 1.0f, 1.0f);
+    hsv.saturation = std::clamp(hsv.saturation, 0.0f, 1.0f);
+    hsv.value = std::clamp(hsv.value, 0.0f, 1.0f);
 
-      src.put_pixel_color({x, y}, color_from_hsv(hsv));
-    }
-  }
+    color = color_from_hsv(hsv);
+  });
 }
 
 namespace {
@@ -0,0 +1,145 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SURF_FIXED_POINT_HPP
+#define HEADER_SURF_FIXED_POINT_HPP
+
+#include <stdint.h>
+
+#include <array>
+#include <limits>
+#include <type_traits>
+
+namespace surf {
+namespace fixed {
+
+/** floor(x / (2^Bits - 1)) with two shifts and adds, exact for
+    x < (2^Bits - 1) * (2^Bits + 2), which covers the product of two
+    channel values plus a rounding term */
+template<unsigned Bits, typename U> inline
+constexpr U div_pow2m1(U x)
+{
+  return ((x + 1) + ((x + 1) >> Bits)) >> Bits;
+}
+
+/** floor(x / 255), exact for x < 65790 */
+inline constexpr uint32_t div255(uint32_t x)
+{
+  return div_pow2m1<8>(x);
+}
+
+/** floor(x / 65535), exact for x < 4295032830, 64-bit as that is
+    just past 2^32 */
+inline constexpr uint64_t div65535(uint64_t x)
+{
+  return div_pow2m1<16>(x);
+}
+
+/** Wide enough to hold the product of two values of \a T, plus a
+    rounding term */
+template<typename T>
+using product_t = typename std::conditional<(sizeof(T) < 2), uint32_t, uint64_t>::type;
+
+/** floor(x / max) for the integer channel type \a T, where x is at
+    most max * max + max. 32-bit channels fall back to a division by
+    a constant, which the compiler turns into a multiply. */
+template<typename T> inline
+constexpr product_t<T> div_max(product_t<T> x)
+{
+  static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value);
+
+  if constexpr (sizeof(T) == 1) {
+    return div255(x);
+  } else if constexpr (sizeof(T) == 2) {
+    return div65535(x);
+  } else {
+    return x / std::numeric_limits<T>::max();
+  }
+}
+
+/** floor(a * b / max), a product of two normalized channel values */
+template<typename T> inline
+constexpr T mul_max(T a, T b)
+{
+  return static_cast<T>(div_max<T>(static_cast<product_t<T>>(a) * b));
+}
+
+/** floor(v * Dst::max / Src::max) as a single multiply or division
+    by a constant and without a 64-bit intermediate, the maximums are
+    all 2^n - 1 and divide each other */
+template<typename Src, typename Dst> inline
+constexpr Dst rescale(Src v)
+{
+  constexpr uint64_t srcmax = std::numeric_limits<Src>::max();
+  constexpr uint64_t dstmax = std::numeric_limits<Dst>::max();
+
+  if constexpr (srcmax == dstmax) {
+    return static_cast<Dst>(v);
+  } else if constexpr (dstmax > srcmax) {
+    static_assert(dstmax % srcmax == 0);
+    return static_cast<Dst>(static_cast<Dst>(v) * static_cast<Dst>(dstmax / srcmax));
+  } else {
+    static_assert(srcmax % dstmax == 0);
+    return static_cast<Dst>(v / static_cast<Src>(srcmax / dstmax));
+  }
+}
+
+/** min(a + b, max) */
+template<typename T, typename U> inline
+constexpr T add_sat(T a, U b)
+{
+  using sumtype = typename std::conditional<(sizeof(T) < 4 && sizeof(U) < 4), uint32_t, uint64_t>::type;
+  sumtype const sum = static_cast<sumtype>(a) + static_cast<sumtype>(b);
+  return static_cast<T>(sum < std::numeric_limits<T>::max() ? sum : std::numeric_limits<T>::max());
+}
+
+/** max(a - b, 0) */
+template<typename T> inline
+constexpr T sub_sat(T a, T b)
+{
+  return a > b ? static_cast<T>(a - b) : T(0);
+}
+
+namespace detail {
+
+constexpr std::array<uint64_t, 256> make_reciprocal8()
+{
+  std::array<uint64_t, 256> table{};
+  for (uint64_t a = 1; a < 256; ++a) {
+    table[a] = ((uint64_t(1) << 32) + a - 1) / a;
+  }
+  return table;
+}
+
+/** ceil(2^32 / a), entry 0 is unused */
+inline constexpr std::array<uint64_t, 256> reciprocal8 = make_reciprocal8();
+
+} // namespace detail
+
+/** floor(x / a) for a variable 8-bit divisor like alpha via a
+    reciprocal table, exact for x < 2^24 and a != 0 */
+inline constexpr uint32_t div_u8(uint32_t x, uint8_t a)
+{
+  return static_cast<uint32_t>((static_cast<uint64_t>(x) * detail::reciprocal8[a]) >> 32);
+}
+
+} // namespace fixed
+} // namespace surf
+
+#endif
+
+/* EOF */
@@ -23,6 +23,8 @@ namespace surf {
 
 enum class Transform;
 
+class half;
+
 template<typename T> struct tRGBPixel;
 template<typename T> struct tRGBAPixel;
 template<typename T> struct tGreyscalePixel;
@@ -36,6 +38,9 @@ using RGBA16Pixel = tRGBAPixel<uint16_t>;
 using RGB32Pixel = tRGBPixel<uint32_t>;
 using RGBA32Pixel = tRGBAPixel<uint32_t>;
 
+using RGB16fPixel = tRGBPixel<half>;
+using RGBA16fPixel = tRGBAPixel<half>;
+
 using RGB32fPixel = tRGBPixel<float>;
 using RGBA32fPixel = tRGBAPixel<float>;
 
@@ -49,15 +54,23 @@ using GreyscalePixel = tGreyscalePixel<uint8_t>;
 
 class Color;
 class IPixelData;
+class RowConverter;
 class SoftwareSurface;
 class SoftwareSurfaceFactory;
 class SoftwareSurfaceLoader;
 
 enum class BlendFunc;
+enum class Gamma;
 enum class PixelFormat;
+enum class ScaleFilter;
 
+template<typename Pixel> class ExternalPixelData;
+template<typename Pixel> class MappedPixelData;
+template<typename Pixel> class OutOfCorePixelData;
 template<typename Pixel> class PixelData;
 template<typename Pixel> class PixelView;
+template<typename Pixel> class PlanarPixelData;
+template<typename Pixel> class TiledPixelData;
 
 } // namespace surf
 
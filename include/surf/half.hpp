@@ -0,0 +1,98 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_HALF_HPP
+#define HEADER_SURF_HALF_HPP
+
+#include <stdint.h>
+
+#include <bit>
+
+namespace surf {
+
+/** IEEE 754 binary16 floating point value. It is a storage type only,
+    arithmetic happens in float through the implicit conversions.
+    Conversions give the same bits as F16C: float to half rounds to
+    nearest even, NaNs are quieted and keep the top of their payload. */
+class half
+{
+public:
+  static constexpr half from_bits(uint16_t bits) {
+    half result;
+    result.m_bits = bits;
+    return result;
+  }
+
+public:
+  half() = default;
+  constexpr half(float value) : m_bits(float_to_bits(value)) {}
+
+  constexpr operator float() const { return bits_to_float(m_bits); }
+
+  constexpr uint16_t bits() const { return m_bits; }
+
+private:
+  static constexpr uint16_t float_to_bits(float value)
+  {
+    uint32_t const f = std::bit_cast<uint32_t>(value);
+    uint32_t const sign = (f >> 16) & 0x8000;
+    uint32_t const absf = f & 0x7fffffff;
+
+    if (absf >= 0x47800000) {
+      // too large or Inf/NaN, NaN stays a quiet NaN
+      return static_cast<uint16_t>(sign | (absf > 0x7f800000 ? 0x7e00 | ((absf >> 13) & 0x3ff) : 0x7c00));
+    } else if (absf < 0x38800000) {
+      // subnormal or zero, let the float adder do the rounding
+      float const shifted = std::bit_cast<float>(absf) + 0.5f;
+      return static_cast<uint16_t>(sign | (std::bit_cast<uint32_t>(shifted) - 0x3f000000));
+    } else {
+      // rebias the exponent and round the mantissa to nearest even
+      uint32_t const mant_odd = (absf >> 13) & 1;
+      return static_cast<uint16_t>(sign | ((absf + 0xc8000fff + mant_odd) >> 13));
+    }
+  }
+
+  static constexpr float bits_to_float(uint16_t bits)
+  {
+    uint32_t const sign = static_cast<uint32_t>(bits & 0x8000) << 16;
+    uint32_t const exp = bits & 0x7c00;
+    uint32_t f = static_cast<uint32_t>(bits & 0x7fff) << 13;
+
+    if (exp == 0x7c00) {
+      // Inf/NaN, NaN is quieted
+      f += (255 - 31) << 23;
+      if (bits & 0x3ff) {
+        f |= 0x00400000;
+      }
+    } else if (exp == 0) {
+      // zero or subnormal, renormalize through a float subtraction
+      f = std::bit_cast<uint32_t>(std::bit_cast<float>(f + (113u << 23)) - std::bit_cast<float>(113u << 23));
+    } else {
+      f += (127 - 15) << 23;
+    }
+
+    return std::bit_cast<float>(f | sign);
+  }
+
+private:
+  uint16_t m_bits;
+};
+
+} // namespace surf
+
+#endif
+
+/* EOF */
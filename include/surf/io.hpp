@@ -121,6 +121,104 @@ std::ostream& operator<<(std::ostream& os, RGBA64fPixel const& pixel)
                            pixel.a);
 }
 
+inline
+std::ostream& operator<<(std::ostream& os, BGR8Pixel const& pixel)
+{
+  return os << fmt::format("(b:{:02x} g:{:02x} r:{:02x})",
+                           static_cast<int>(pixel.b),
+                           static_cast<int>(pixel.g),
+                           static_cast<int>(pixel.r));
+}
+
+inline
+std::ostream& operator<<(std::ostream& os, BGRA8Pixel const& pixel)
+{
+  return os << fmt::format("(b:{:02x} g:{:02x} r:{:02x} a:{:02x})",
+                           static_cast<int>(pixel.b),
+                           static_cast<int>(pixel.g),
+                           static_cast<int>(pixel.r),
+                           static_cast<int>(pixel.a));
+}
+
+inline
+std::ostream& operator<<(std::ostream& os, ARGB8Pixel const& pixel)
+{
+  return os << fmt::format("(a:{:02x} r:{:02x} g:{:02x} b:{:02x})",
+                           static_cast<int>(pixel.a),
+                           static_cast<int>(pixel.r),
+                           static_cast<int>(pixel.g),
+                           static_cast<int>(pixel.b));
+}
+
+inline
+std::ostream& operator<<(std::ostream& os, RGB565Pixel const& pixel)
+{
+  return os << fmt::format("({:04x})", static_cast<int>(pixel.value));
+}
+
+inline
+std::ostream& operator<<(std::ostream& os, RGB16fPixel const& pixel)
+{
+  return os << fmt::format("({:.3f} {:.3f} {:.3f})",
+                           static_cast<float>(pixel.r),
+                           static_cast<float>(pixel.g),
+                           static_cast<float>(pixel.b));
+}
+
+inline
+std::ostream& operator<<(std::ostream& os, RGBA16fPixel const& pixel)
+{
+  return os << fmt::format("({:.3f} {:.3f} {:.3f} {:.3f})",
+                           static_cast<float>(pixel.r),
+                           static_cast<float>(pixel.g),
+                           static_cast<float>(pixel.b),
+                           static_cast<float>(pixel.a));
+}
+
+inline
+std::ostream& operator<<(std::ostream& os, L16fPixel const& pixel)
+{
+  return os << fmt::format("({:.3f})", static_cast<float>(pixel.l));
+}
+
+inline
+std::ostream& operator<<(std::ostream& os, LA16fPixel const& pixel)
+{
+  return os << fmt::format("({:.3f} {:.3f})",
+                           static_cast<float>(pixel.l),
+                           static_cast<float>(pixel.a));
+}
+
+inline
+std::ostream& operator<<(std::ostream& os, PRGBA8Pixel const& pixel)
+{
+  return os << fmt::format("(pr:{:02x} pg:{:02x} pb:{:02x} a:{:02x})",
+                           static_cast<int>(pixel.r),
+                           static_cast<int>(pixel.g),
+                           static_cast<int>(pixel.b),
+                           static_cast<int>(pixel.a));
+}
+
+inline
+std::ostream& operator<<(std::ostream& os, PRGBA16Pixel const& pixel)
+{
+  return os << fmt::format("(pr:{:04x} pg:{:04x} pb:{:04x} a:{:04x})",
+                           static_cast<int>(pixel.r),
+                           static_cast<int>(pixel.g),
+                           static_cast<int>(pixel.b),
+                           static_cast<int>(pixel.a));
+}
+
+inline
+std::ostream& operator<<(std::ostream& os, PRGBA32fPixel const& pixel)
+{
+  return os << fmt::format("(pr:{:.2f} pg:{:.2f} pb:{:.2f} a:{:.2f})",
+                           pixel.r,
+                           pixel.g,
+                           pixel.b,
+                           pixel.a);
+}
+
 inline
 std::ostream& operator<<(std::ostream& os, L8Pixel const& pixel)
 {
@@ -17,12 +17,18 @@
 #ifndef HEADER_SURF_IPIXEL_DATA_HPP
 #define HEADER_SURF_IPIXEL_DATA_HPP
 
+#include <stddef.h>
+
 #include <memory>
 
 #include <geom/fwd.hpp>
 
 namespace surf {
 
+/** Format-agnostic interface to pixel data. Every implementation is a
+    PixelView<Pixel> whose Pixel matches get_format(), visit() relies
+    on that to skip the dynamic_cast. SoftwareSurface checks it once
+    when it takes the pixel data. */
 class IPixelData
 {
 public:
@@ -31,13 +37,26 @@ public:
   virtual geom::isize get_size() const = 0;
   virtual int get_width() const = 0;
   virtual int get_height() const = 0;
-  virtual int get_row_length() const = 0;
-  virtual int get_pitch() const = 0;
+  virtual ptrdiff_t get_row_length() const = 0;
+  virtual ptrdiff_t get_pitch() const = 0;
   virtual void* get_row_data(int y) = 0;
   virtual void const* get_row_data(int y) const = 0;
   virtual void put_pixel_color(geom::ipoint const& pos, Color const& color) = 0;
   virtual Color get_pixel_color(geom::ipoint const& pos) const = 0;
+
+  /** Convert \a count pixels of row \a y, starting at \a x, from or
+      to Color, for format-agnostic code that would otherwise pay a
+      virtual call per pixel */
+  virtual void read_row_colors(int y, int x, int count, Color* out) const = 0;
+  virtual void write_row_colors(int y, int x, int count, Color const* in) = 0;
+
   virtual bool empty() const = 0;
+
+  /** Returns true when the pixel memory is owned by this object and
+      not borrowed from somebody else, only owned memory can be shared
+      between SoftwareSurface copies */
+  virtual bool owns_data() const = 0;
+
   virtual std::unique_ptr<IPixelData> copy() const = 0;
   virtual std::unique_ptr<IPixelData> create_view(geom::irect const& rect) = 0;
   virtual std::unique_ptr<IPixelData const> create_view(geom::irect const& rect) const = 0;
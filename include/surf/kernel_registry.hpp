@@ -0,0 +1,108 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_KERNEL_REGISTRY_HPP
+#define HEADER_SURF_KERNEL_REGISTRY_HPP
+
+#include <stddef.h>
+
+#include <array>
+#include <atomic>
+
+#include <geom/fwd.hpp>
+
+#include "blendfunc.hpp"
+#include "fwd.hpp"
+#include "pixel_format.hpp"
+
+namespace surf {
+
+/** Processes \a count pixels, reading from \a src and writing, or for
+    blending read-modify-writing, \a dst. The pixel types are the
+    formats the kernel was registered for. */
+using SpanKernel = void (*)(void const* src, void* dst, size_t count);
+
+/** A table of SpanKernels indexed by source format, destination
+    format and BlendFunc, BlendFunc::COPY doubles as the conversion
+    kernel. It starts out filled with the generic template kernels,
+    with SIMD versions for some hot pairs picked by CPU detection
+    replacing them. Any entry can be replaced at runtime. Lookups and
+    replacements are thread-safe. */
+class KernelRegistry
+{
+public:
+  static KernelRegistry& instance();
+
+  /** Size in bytes of a pixel of \a format, zero for unsupported formats */
+  static size_t pixel_size(PixelFormat format);
+
+public:
+  /** Throws std::invalid_argument when there is no kernel for the
+      combination */
+  SpanKernel get(PixelFormat src, PixelFormat dst, BlendFunc op) const;
+
+  void set(PixelFormat src, PixelFormat dst, BlendFunc op, SpanKernel kernel);
+
+  /** Restore the kernel the registry started out with */
+  void reset(PixelFormat src, PixelFormat dst, BlendFunc op);
+
+  /** The kernel the registry started out with, the SIMD kernel where
+      one was picked for this CPU */
+  SpanKernel get_default(PixelFormat src, PixelFormat dst, BlendFunc op) const;
+
+  /** The generic template kernel, regardless of the CPU, e.g. as the
+      reference to check a SIMD kernel against */
+  SpanKernel get_generic(PixelFormat src, PixelFormat dst, BlendFunc op) const;
+
+private:
+  KernelRegistry();
+
+  static constexpr size_t OP_COUNT = BLEND_FUNC_COUNT;
+  static constexpr size_t TABLE_SIZE = PIXEL_FORMAT_COUNT * PIXEL_FORMAT_COUNT * OP_COUNT;
+
+private:
+  std::array<std::atomic<SpanKernel>, TABLE_SIZE> m_kernels;
+  std::array<SpanKernel, TABLE_SIZE> m_generic;
+  std::array<SpanKernel, TABLE_SIZE> m_default;
+
+private:
+  KernelRegistry(const KernelRegistry&) = delete;
+  KernelRegistry& operator=(const KernelRegistry&) = delete;
+};
+
+/** Run \a kernel over the part of \a srcrect that lands in \a dst when
+    placed at \a pos, clipped like blit() */
+void apply_kernel(SpanKernel kernel,
+                  SoftwareSurface const& src, geom::irect const& srcrect,
+                  SoftwareSurface& dst, geom::ipoint const& pos);
+
+/** Scaled version of apply_kernel(), the kernel gets rows of source
+    pixels sampled with \a filter, clipped like blend_scaled() */
+void apply_kernel_scaled(SpanKernel kernel,
+                         SoftwareSurface const& src, geom::irect const& srcrect,
+                         SoftwareSurface& dst, geom::irect const& dstrect,
+                         ScaleFilter filter);
+
+/** apply_kernel_scaled() with ScaleFilter::NEAREST */
+void apply_kernel_scaled(SpanKernel kernel,
+                         SoftwareSurface const& src, geom::irect const& srcrect,
+                         SoftwareSurface& dst, geom::irect const& dstrect);
+
+} // namespace surf
+
+#endif
+
+/* EOF */
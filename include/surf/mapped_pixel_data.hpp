@@ -0,0 +1,151 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_MAPPED_PIXEL_DATA_HPP
+#define HEADER_SURF_MAPPED_PIXEL_DATA_HPP
+
+#include <stdexcept>
+
+#include "memory_mapping.hpp"
+#include "pixel_view.hpp"
+#include "software_surface.hpp"
+
+namespace surf {
+
+/** PixelData whose storage is a MemoryMapping, writes go straight to
+    the mapped file or shared memory segment. Rows are laid out with
+    a fixed row length, starting at the beginning of the mapping. */
+template<typename Pixel>
+class MappedPixelData : public PixelView<Pixel>
+{
+public:
+  /** Map an existing raw pixel file */
+  static MappedPixelData<Pixel> open(std::filesystem::path const& filename,
+                                     geom::isize const& size,
+                                     size_t offset = 0, bool writable = true) {
+    return MappedPixelData<Pixel>(MemoryMapping::open_file(filename, offset, byte_size(size), writable), size);
+  }
+
+  /** Create a new raw pixel file of the given size */
+  static MappedPixelData<Pixel> create(std::filesystem::path const& filename, geom::isize const& size) {
+    return MappedPixelData<Pixel>(MemoryMapping::create_file(filename, byte_size(size)), size);
+  }
+
+  static MappedPixelData<Pixel> create_memfd(geom::isize const& size) {
+    return MappedPixelData<Pixel>(MemoryMapping::create_memfd("surf", byte_size(size)), size);
+  }
+
+  static MappedPixelData<Pixel> create_shm(std::string const& name, geom::isize const& size) {
+    return MappedPixelData<Pixel>(MemoryMapping::create_shm(name, byte_size(size)), size);
+  }
+
+  static MappedPixelData<Pixel> open_shm(std::string const& name, geom::isize const& size, bool writable = true) {
+    return MappedPixelData<Pixel>(MemoryMapping::open_shm(name, writable), size);
+  }
+
+public:
+  MappedPixelData() :
+    PixelView<Pixel>(),
+    m_mapping()
+  {}
+
+  MappedPixelData(MemoryMapping mapping, geom::isize const& size) :
+    MappedPixelData(std::move(mapping), size, size.width())
+  {}
+
+  MappedPixelData(MemoryMapping mapping, geom::isize const& size, ptrdiff_t row_length) :
+    PixelView<Pixel>(size, static_cast<Pixel*>(mapping.get_data()), row_length),
+    m_mapping(std::move(mapping))
+  {
+    if (row_length < size.width()) {
+      throw std::invalid_argument("MappedPixelData: row_length smaller than width");
+    }
+
+    size_t const required = size.height() == 0 ? 0 :
+      (static_cast<size_t>(row_length) * static_cast<size_t>(size.height() - 1) + static_cast<size_t>(size.width())) * sizeof(Pixel);
+    if (m_mapping.get_length() < required) {
+      throw std::invalid_argument("MappedPixelData: mapping too small for the given size");
+    }
+  }
+
+  MappedPixelData(MappedPixelData<Pixel>&& other) noexcept :
+    PixelView<Pixel>(other),
+    m_mapping(std::move(other.m_mapping))
+  {
+    static_cast<PixelView<Pixel>&>(other) = PixelView<Pixel>();
+  }
+
+  MappedPixelData<Pixel>& operator=(MappedPixelData<Pixel>&& other) noexcept
+  {
+    if (this != &other) {
+      PixelView<Pixel>::operator=(other);
+      m_mapping = std::move(other.m_mapping);
+      static_cast<PixelView<Pixel>&>(other) = PixelView<Pixel>();
+    }
+    return *this;
+  }
+
+  /** Mapped data is never shared copy-on-write, as a detached copy
+      would silently stop writing to the mapping */
+  bool owns_data() const override { return false; }
+
+  /** File descriptor of the mapping, to pass it to another process */
+  int get_fd() const { return m_mapping.get_fd(); }
+
+  MemoryMapping const& get_mapping() const { return m_mapping; }
+
+  void sync() { m_mapping.sync(); }
+
+private:
+  static size_t byte_size(geom::isize const& size) {
+    return static_cast<size_t>(size.width()) * static_cast<size_t>(size.height()) * sizeof(Pixel);
+  }
+
+private:
+  MemoryMapping m_mapping;
+
+private:
+  MappedPixelData(const MappedPixelData<Pixel>&) = delete;
+  MappedPixelData<Pixel>& operator=(const MappedPixelData<Pixel>&) = delete;
+};
+
+/** Wrap \a mapping in a SoftwareSurface of the given \a format, the
+    surface takes ownership of the mapping. A \a pitch of zero means
+    tightly packed rows, any other must be a multiple of the pixel
+    size. */
+inline
+SoftwareSurface create_mapped_surface(PixelFormat format, geom::isize const& size,
+                                      MemoryMapping mapping, ptrdiff_t pitch = 0)
+{
+  PIXELFORMAT_TO_TYPE(
+    format,
+    pixeltype,
+    {
+      ptrdiff_t const pixel_size = static_cast<ptrdiff_t>(sizeof(pixeltype));
+      if (pitch % pixel_size != 0) {
+        throw std::invalid_argument("create_mapped_surface: pitch is not a multiple of the pixel size");
+      }
+      return SoftwareSurface(MappedPixelData<pixeltype>(
+                               std::move(mapping), size,
+                               pitch == 0 ? size.width() : pitch / pixel_size));
+    });
+}
+
+} // namespace surf
+
+#endif
+
+/* EOF */
@@ -0,0 +1,98 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_MEMORY_MAPPING_HPP
+#define HEADER_SURF_MEMORY_MAPPING_HPP
+
+#include <stddef.h>
+
+#include <filesystem>
+#include <string>
+
+namespace surf {
+
+/** An owning, shared mmap() of a file, a memfd or a POSIX shared
+    memory segment. The mapping and the file descriptor are released
+    on destruction, the memory stays valid when the object is moved.
+    Mappings that are not \a writable are private copy-on-write
+    mappings, the memory can still be written to, but the changes stay
+    in this process and never reach the file. */
+class MemoryMapping
+{
+public:
+  /** Map \a length bytes of an existing file starting at \a offset,
+      a \a length of zero maps everything from \a offset to the end,
+      a range past the end of the file throws std::runtime_error */
+  static MemoryMapping open_file(std::filesystem::path const& filename,
+                                 size_t offset = 0, size_t length = 0,
+                                 bool writable = true);
+
+  /** Create or truncate \a filename to \a length bytes and map it */
+  static MemoryMapping create_file(std::filesystem::path const& filename, size_t length);
+
+  /** Create an anonymous memfd of \a length bytes, the fd can be
+      passed to other processes, Linux only */
+  static MemoryMapping create_memfd(std::string const& name, size_t length);
+
+  /** Create a POSIX shared memory segment, \a name must start with '/' */
+  static MemoryMapping create_shm(std::string const& name, size_t length);
+  static MemoryMapping open_shm(std::string const& name, bool writable = true);
+  static void unlink_shm(std::string const& name);
+
+  /** Map an already open \a fd, the MemoryMapping takes ownership of
+      it, a \a length of zero maps everything from \a offset to the
+      end, a range past the end of the file throws std::runtime_error */
+  static MemoryMapping from_fd(int fd, size_t offset = 0, size_t length = 0,
+                               bool writable = true);
+
+public:
+  MemoryMapping();
+  MemoryMapping(MemoryMapping&& other) noexcept;
+  MemoryMapping& operator=(MemoryMapping&& other) noexcept;
+  ~MemoryMapping();
+
+  void* get_data() const { return static_cast<char*>(m_addr) + m_page_offset; }
+  size_t get_length() const { return m_length; }
+  int get_fd() const { return m_fd; }
+  /** Whether writes reach the underlying file */
+  bool is_writable() const { return m_writable; }
+  bool empty() const { return m_addr == nullptr; }
+
+  /** Flush changes to the underlying file, blocking until done */
+  void sync();
+
+  void reset();
+
+private:
+  MemoryMapping(int fd, void* addr, size_t page_offset, size_t length, bool writable);
+
+private:
+  int m_fd;
+  void* m_addr;
+  size_t m_page_offset;
+  size_t m_length;
+  bool m_writable;
+
+private:
+  MemoryMapping(const MemoryMapping&) = delete;
+  MemoryMapping& operator=(const MemoryMapping&) = delete;
+};
+
+} // namespace surf
+
+#endif
+
+/* EOF */
@@ -0,0 +1,337 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_OUT_OF_CORE_PIXEL_DATA_HPP
+#define HEADER_SURF_OUT_OF_CORE_PIXEL_DATA_HPP
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <geom/rect.hpp>
+
+#include "blit.hpp"
+#include "fill.hpp"
+#include "pixel_view.hpp"
+#include "tile_store.hpp"
+
+namespace surf {
+
+/** Pixel storage for images larger than memory. The image is split
+    into TILE_SIZE x TILE_SIZE tiles that live in a TileStore scratch
+    file, only \a cache_budget bytes worth of tiles are kept in
+    memory at any time.
+
+    There is no pointer based row access, as rows don't exist in
+    memory, row-oriented code goes through read_row() and write_row(),
+    which copy a single row in or out. */
+template<typename Pixel>
+class OutOfCorePixelData
+{
+public:
+  using value_type = Pixel;
+
+  static constexpr int TILE_SHIFT = 8;
+  static constexpr int TILE_SIZE = 1 << TILE_SHIFT;
+  static constexpr int TILE_MASK = TILE_SIZE - 1;
+
+  /** Keeps a tile paged in for its lifetime, the view is clipped to
+      the image */
+  class TileLock
+  {
+  public:
+    TileLock(TileStore& store, size_t index, bool write, geom::isize const& size) :
+      m_store(&store),
+      m_index(index),
+      m_view(size, static_cast<Pixel*>(store.lock(index, write)), TILE_SIZE)
+    {}
+
+    TileLock(TileLock&& other) noexcept :
+      m_store(std::exchange(other.m_store, nullptr)),
+      m_index(other.m_index),
+      m_view(other.m_view)
+    {}
+
+    ~TileLock() {
+      if (m_store != nullptr) {
+        m_store->unlock(m_index);
+      }
+    }
+
+    PixelView<Pixel>& get_view() { return m_view; }
+    PixelView<Pixel> const& get_view() const { return m_view; }
+
+  private:
+    TileStore* m_store;
+    size_t m_index;
+    PixelView<Pixel> m_view;
+
+  private:
+    TileLock(const TileLock&) = delete;
+    TileLock& operator=(const TileLock&) = delete;
+    TileLock& operator=(TileLock&&) = delete;
+  };
+
+public:
+  OutOfCorePixelData(geom::isize const& size, size_t cache_budget, Pixel const& pixel = {},
+                     std::filesystem::path const& scratch_dir = std::filesystem::temp_directory_path()) :
+    m_size(size),
+    m_tiles_x((size.width() + TILE_MASK) >> TILE_SHIFT),
+    m_tiles_y((size.height() + TILE_MASK) >> TILE_SHIFT),
+    m_scratch_dir(scratch_dir),
+    m_store()
+  {
+    std::vector<Pixel> const initial_tile(TILE_SIZE * TILE_SIZE, pixel);
+    m_store = std::make_unique<TileStore>(TILE_SIZE * TILE_SIZE * sizeof(Pixel),
+                                          static_cast<size_t>(m_tiles_x) * static_cast<size_t>(m_tiles_y),
+                                          initial_tile.data(), cache_budget, scratch_dir);
+  }
+
+  OutOfCorePixelData(OutOfCorePixelData<Pixel>&& other) noexcept = default;
+  OutOfCorePixelData<Pixel>& operator=(OutOfCorePixelData<Pixel>&& other) noexcept = default;
+
+  geom::isize get_size() const { return m_size; }
+  int get_width() const { return m_size.width(); }
+  int get_height() const { return m_size.height(); }
+
+  int get_tiles_x() const { return m_tiles_x; }
+  int get_tiles_y() const { return m_tiles_y; }
+
+  std::filesystem::path const& get_scratch_dir() const { return m_scratch_dir; }
+
+  /** The area covered by the given tile in image coordinates,
+      clipped to the image */
+  geom::irect get_tile_rect(int tx, int ty) const {
+    return geom::irect(tx * TILE_SIZE, ty * TILE_SIZE,
+                       std::min((tx + 1) * TILE_SIZE, m_size.width()),
+                       std::min((ty + 1) * TILE_SIZE, m_size.height()));
+  }
+
+  /** Page in a tile for writing */
+  TileLock lock_tile(int tx, int ty) {
+    return TileLock(*m_store, tile_index(tx, ty), true, get_tile_rect(tx, ty).size());
+  }
+
+  /** Page in a tile for reading, the view must not be written to */
+  TileLock lock_tile(int tx, int ty) const {
+    return TileLock(*m_store, tile_index(tx, ty), false, get_tile_rect(tx, ty).size());
+  }
+
+  Pixel get_pixel(geom::ipoint const& pos) const {
+    assert(geom::contains(m_size, pos));
+    TileLock const lock = lock_tile(pos.x() >> TILE_SHIFT, pos.y() >> TILE_SHIFT);
+    return lock.get_view().get_pixel(geom::ipoint(pos.x() & TILE_MASK, pos.y() & TILE_MASK));
+  }
+
+  void put_pixel(geom::ipoint const& pos, Pixel const& pixel) {
+    assert(geom::contains(m_size, pos));
+    TileLock lock = lock_tile(pos.x() >> TILE_SHIFT, pos.y() >> TILE_SHIFT);
+    lock.get_view().put_pixel(geom::ipoint(pos.x() & TILE_MASK, pos.y() & TILE_MASK), pixel);
+  }
+
+  /** Copy row \a y into \a out, which must hold get_width() pixels */
+  void read_row(int y, Pixel* out) const {
+    for (int tx = 0; tx < m_tiles_x; ++tx) {
+      TileLock const lock = lock_tile(tx, y >> TILE_SHIFT);
+      PixelView<Pixel> const& view = lock.get_view();
+      std::copy_n(view.get_row(y & TILE_MASK), view.get_width(), out + tx * TILE_SIZE);
+    }
+  }
+
+  void write_row(int y, Pixel const* in) {
+    for (int tx = 0; tx < m_tiles_x; ++tx) {
+      TileLock lock = lock_tile(tx, y >> TILE_SHIFT);
+      PixelView<Pixel>& view = lock.get_view();
+      std::copy_n(in + tx * TILE_SIZE, view.get_width(), view.get_row(y & TILE_MASK));
+    }
+  }
+
+  /** Write all modified tiles back to the scratch file */
+  void flush() { m_store->flush(); }
+
+  void set_cache_budget(size_t budget) { m_store->set_cache_budget(budget); }
+  size_t get_cache_budget() const { return m_store->get_cache_budget(); }
+
+  TileStore::Stats get_stats() const { return m_store->get_stats(); }
+
+private:
+  size_t tile_index(int tx, int ty) const {
+    assert(tx >= 0 && tx < m_tiles_x && ty >= 0 && ty < m_tiles_y);
+    return static_cast<size_t>(ty) * static_cast<size_t>(m_tiles_x) + static_cast<size_t>(tx);
+  }
+
+private:
+  geom::isize m_size;
+  int m_tiles_x;
+  int m_tiles_y;
+  std::filesystem::path m_scratch_dir;
+  std::unique_ptr<TileStore> m_store;
+
+private:
+  OutOfCorePixelData(const OutOfCorePixelData<Pixel>&) = delete;
+  OutOfCorePixelData<Pixel>& operator=(const OutOfCorePixelData<Pixel>&) = delete;
+};
+
+namespace detail {
+
+/** Calls \a f(tx, ty, tile_rect, region) for each tile that overlaps
+    \a rect, \a region is the overlap in image coordinates */
+template<typename Pixel, typename Function>
+void for_each_tile_in(OutOfCorePixelData<Pixel> const& data, geom::irect const& rect, Function f)
+{
+  using Tiled = OutOfCorePixelData<Pixel>;
+
+  geom::irect const region = geom::intersection(geom::irect(data.get_size()), rect);
+  if (region.width() <= 0 || region.height() <= 0) {
+    return;
+  }
+
+  for (int ty = region.top() >> Tiled::TILE_SHIFT; ty <= (region.bottom() - 1) >> Tiled::TILE_SHIFT; ++ty) {
+    for (int tx = region.left() >> Tiled::TILE_SHIFT; tx <= (region.right() - 1) >> Tiled::TILE_SHIFT; ++tx) {
+      geom::irect const tile_rect = data.get_tile_rect(tx, ty);
+      f(tx, ty, tile_rect, geom::intersection(tile_rect, region));
+    }
+  }
+}
+
+/** Applies \a op(src_view, srcrect, dst_view, pos) tile by tile, at
+    most one source and one destination tile are paged in at a time */
+template<typename SrcPixel, typename DstPixel, typename Operation>
+void apply_tiles(OutOfCorePixelData<SrcPixel> const& src, OutOfCorePixelData<DstPixel>& dst,
+                 geom::ipoint const& pos, Operation op)
+{
+  for_each_tile_in(dst, geom::irect(pos, src.get_size()),
+                   [&](int dst_tx, int dst_ty, geom::irect const& dst_tile_rect, geom::irect const& dst_region) {
+    auto dst_lock = dst.lock_tile(dst_tx, dst_ty);
+
+    geom::irect const src_region = dst_region + geom::ioffset(-pos.x(), -pos.y());
+    for_each_tile_in(src, src_region,
+                     [&](int src_tx, int src_ty, geom::irect const& src_tile_rect, geom::irect const& region) {
+      auto const src_lock = src.lock_tile(src_tx, src_ty);
+      op(src_lock.get_view(), region + geom::ioffset(-src_tile_rect.left(), -src_tile_rect.top()),
+         dst_lock.get_view(),
+         geom::ipoint(region.left() + pos.x() - dst_tile_rect.left(),
+                      region.top() + pos.y() - dst_tile_rect.top()));
+    });
+  });
+}
+
+/** Applies \a op(src, srcrect, dst_view, pos) for each destination
+    tile overlapped by \a src placed at \a pos */
+template<typename SrcPixel, typename DstPixel, typename Operation>
+void apply_tiles(PixelView<SrcPixel> const& src, OutOfCorePixelData<DstPixel>& dst,
+                 geom::ipoint const& pos, Operation op)
+{
+  for_each_tile_in(dst, geom::irect(pos, src.get_size()),
+                   [&](int tx, int ty, geom::irect const& tile_rect, geom::irect const& region) {
+    auto lock = dst.lock_tile(tx, ty);
+    op(src, region + geom::ioffset(-pos.x(), -pos.y()),
+       lock.get_view(),
+       geom::ipoint(region.left() - tile_rect.left(), region.top() - tile_rect.top()));
+  });
+}
+
+} // namespace detail
+
+template<typename Pixel>
+void fill_rect(OutOfCorePixelData<Pixel>& dst, geom::irect const& rect, Pixel const& pixel)
+{
+  detail::for_each_tile_in(dst, rect, [&](int tx, int ty, geom::irect const& tile_rect, geom::irect const& region) {
+    auto lock = dst.lock_tile(tx, ty);
+    fill_rect(lock.get_view(), region + geom::ioffset(-tile_rect.left(), -tile_rect.top()), pixel);
+  });
+}
+
+template<typename Pixel>
+void fill(OutOfCorePixelData<Pixel>& dst, Pixel const& pixel)
+{
+  fill_rect(dst, geom::irect(dst.get_size()), pixel);
+}
+
+template<typename SrcPixel, typename DstPixel>
+void blit(PixelView<SrcPixel> const& src, OutOfCorePixelData<DstPixel>& dst, geom::ipoint const& pos)
+{
+  detail::apply_tiles(src, dst, pos,
+                      [](PixelView<SrcPixel> const& s, geom::irect const& srcrect,
+                         PixelView<DstPixel>& d, geom::ipoint const& p) {
+                        blit(s, srcrect, d, p);
+                      });
+}
+
+template<typename SrcPixel, typename DstPixel>
+void blit(OutOfCorePixelData<SrcPixel> const& src, PixelView<DstPixel>& dst, geom::ipoint const& pos)
+{
+  detail::for_each_tile_in(src, geom::irect(geom::ipoint(-pos.x(), -pos.y()), dst.get_size()),
+                           [&](int tx, int ty, geom::irect const& tile_rect, geom::irect const& region) {
+    auto const lock = src.lock_tile(tx, ty);
+    blit(lock.get_view(), region + geom::ioffset(-tile_rect.left(), -tile_rect.top()),
+         dst, geom::ipoint(region.left() + pos.x(), region.top() + pos.y()));
+  });
+}
+
+template<typename SrcPixel, typename DstPixel>
+void blit(OutOfCorePixelData<SrcPixel> const& src, OutOfCorePixelData<DstPixel>& dst, geom::ipoint const& pos)
+{
+  detail::apply_tiles(src, dst, pos,
+                      [](PixelView<SrcPixel> const& s, geom::irect const& srcrect,
+                         PixelView<DstPixel>& d, geom::ipoint const& p) {
+                        blit(s, srcrect, d, p);
+                      });
+}
+
+template<typename BlendFunc, typename SrcPixel, typename DstPixel>
+void blend(BlendFunc blend_func,
+           PixelView<SrcPixel> const& src, OutOfCorePixelData<DstPixel>& dst, geom::ipoint const& pos)
+{
+  detail::apply_tiles(src, dst, pos,
+                      [&blend_func](PixelView<SrcPixel> const& s, geom::irect const& srcrect,
+                                    PixelView<DstPixel>& d, geom::ipoint const& p) {
+                        blend(blend_func, s, srcrect, d, p);
+                      });
+}
+
+template<typename BlendFunc, typename SrcPixel, typename DstPixel>
+void blend(BlendFunc blend_func,
+           OutOfCorePixelData<SrcPixel> const& src, OutOfCorePixelData<DstPixel>& dst, geom::ipoint const& pos)
+{
+  detail::apply_tiles(src, dst, pos,
+                      [&blend_func](PixelView<SrcPixel> const& s, geom::irect const& srcrect,
+                                    PixelView<DstPixel>& d, geom::ipoint const& p) {
+                        blend(blend_func, s, srcrect, d, p);
+                      });
+}
+
+/** The result gets its own scratch file with the same cache budget */
+template<typename Pixel>
+OutOfCorePixelData<Pixel> crop(OutOfCorePixelData<Pixel> const& src, geom::irect const& rect)
+{
+  geom::irect const clipped(std::clamp(rect.left(), 0, src.get_width()),
+                            std::clamp(rect.top(), 0, src.get_height()),
+                            std::clamp(rect.right(), 0, src.get_width()),
+                            std::clamp(rect.bottom(), 0, src.get_height()));
+
+  OutOfCorePixelData<Pixel> dst(clipped.size(), src.get_cache_budget(), Pixel{}, src.get_scratch_dir());
+  blit(src, dst, geom::ipoint(-clipped.left(), -clipped.top()));
+  return dst;
+}
+
+} // namespace surf
+
+#endif
+
+/* EOF */
@@ -22,25 +22,41 @@
 #include <algorithm>
 #include <bit>
 #include <limits>
+#include <type_traits>
 
+#include "half.hpp"
 #include "pixel_format.hpp"
 
 namespace surf {
 
+/** The type a channel stored as T is read and computed in, half
+    channels are handled as float */
+template<typename T>
+struct channel_value
+{
+  using type = T;
+};
+
+template<>
+struct channel_value<half>
+{
+  using type = float;
+};
+
 template<typename T>
 struct tRGBPixel
 {
-  using value_type = T;
+  using value_type = typename channel_value<T>::type;
   static constexpr bool has_alpha() { return false; }
   static constexpr bool has_rgb() { return true; }
-  static constexpr T max() {
-    if constexpr (std::is_floating_point<T>::value) {
+  static constexpr value_type max() {
+    if constexpr (std::is_floating_point<value_type>::value) {
       return 1.0;
     } else {
       return std::numeric_limits<T>::max();
     }
   }
-  static constexpr bool is_floating_point() { return std::is_floating_point<T>::value; }
+  static constexpr bool is_floating_point() { return std::is_floating_point<value_type>::value; }
 
   T r;
   T g;
@@ -52,17 +68,17 @@ struct tRGBPixel
 template<typename T>
 struct tRGBAPixel
 {
-  using value_type = T;
+  using value_type = typename channel_value<T>::type;
   static constexpr bool has_alpha() { return true; }
   static constexpr bool has_rgb() { return true; }
-  static constexpr T max() {
-    if constexpr (std::is_floating_point<T>::value) {
+  static constexpr value_type max() {
+    if constexpr (std::is_floating_point<value_type>::value) {
       return 1.0;
     } else {
       return std::numeric_limits<T>::max();
     }
   }
-  static constexpr bool is_floating_point() { return std::is_floating_point<T>::value; }
+  static constexpr bool is_floating_point() { return std::is_floating_point<value_type>::value; }
 
   T r;
   T g;
@@ -75,17 +91,17 @@ struct tRGBAPixel
 template<typename T>
 struct tLPixel
 {
-  using value_type = T;
+  using value_type = typename channel_value<T>::type;
   static constexpr bool has_alpha() { return false; }
   static constexpr bool has_rgb() { return false; }
-  static constexpr T max() {
-    if constexpr (std::is_floating_point<T>::value) {
+  static constexpr value_type max() {
+    if constexpr (std::is_floating_point<value_type>::value) {
       return 1.0;
     } else {
       return std::numeric_limits<T>::max();
     }
   }
-  static constexpr bool is_floating_point() { return std::is_floating_point<T>::value; }
+  static constexpr bool is_floating_point() { return std::is_floating_point<value_type>::value; }
 
   T l;
 
@@ -95,17 +111,17 @@ struct tLPixel
 template<typename T>
 struct tLAPixel
 {
-  using value_type = T;
+  using value_type = typename channel_value<T>::type;
   static constexpr bool has_alpha() { return true; }
   static constexpr bool has_rgb() { return false; }
-  static constexpr T max() {
-    if constexpr (std::is_floating_point<T>::value) {
+  static constexpr value_type max() {
+    if constexpr (std::is_floating_point<value_type>::value) {
       return 1.0;
     } else {
       return std::numeric_limits<T>::max();
     }
   }
-  static constexpr bool is_floating_point() { return std::is_floating_point<T>::value; }
+  static constexpr bool is_floating_point() { return std::is_floating_point<value_type>::value; }
 
   T l;
   T a;
@@ -113,6 +129,128 @@ struct tLAPixel
   inline bool operator==(tLAPixel<T> const& rhs) const = default;
 };
 
+/** RGB with the channels stored in reverse order, the members keep
+    their names so red(), green(), blue() and make_pixel() work
+    unchanged */
+template<typename T>
+struct tBGRPixel
+{
+  using value_type = typename channel_value<T>::type;
+  static constexpr bool has_alpha() { return false; }
+  static constexpr bool has_rgb() { return true; }
+  static constexpr value_type max() {
+    if constexpr (std::is_floating_point<value_type>::value) {
+      return 1.0;
+    } else {
+      return std::numeric_limits<T>::max();
+    }
+  }
+  static constexpr bool is_floating_point() { return std::is_floating_point<value_type>::value; }
+
+  T b;
+  T g;
+  T r;
+
+  inline bool operator==(tBGRPixel<T> const& rhs) const = default;
+};
+
+template<typename T>
+struct tBGRAPixel
+{
+  using value_type = typename channel_value<T>::type;
+  static constexpr bool has_alpha() { return true; }
+  static constexpr bool has_rgb() { return true; }
+  static constexpr value_type max() {
+    if constexpr (std::is_floating_point<value_type>::value) {
+      return 1.0;
+    } else {
+      return std::numeric_limits<T>::max();
+    }
+  }
+  static constexpr bool is_floating_point() { return std::is_floating_point<value_type>::value; }
+
+  T b;
+  T g;
+  T r;
+  T a;
+
+  inline bool operator==(tBGRAPixel<T> const& rhs) const = default;
+};
+
+template<typename T>
+struct tARGBPixel
+{
+  using value_type = typename channel_value<T>::type;
+  static constexpr bool has_alpha() { return true; }
+  static constexpr bool has_rgb() { return true; }
+  static constexpr value_type max() {
+    if constexpr (std::is_floating_point<value_type>::value) {
+      return 1.0;
+    } else {
+      return std::numeric_limits<T>::max();
+    }
+  }
+  static constexpr bool is_floating_point() { return std::is_floating_point<value_type>::value; }
+
+  T a;
+  T r;
+  T g;
+  T b;
+
+  inline bool operator==(tARGBPixel<T> const& rhs) const = default;
+};
+
+/** RGBA with the color channels premultiplied by alpha, r, g and b
+    are never larger than a. red(), green() and blue() return the
+    stored premultiplied values, convert() premultiplies and
+    unpremultiplies when going from or to a straight alpha type. */
+template<typename T>
+struct tPRGBAPixel
+{
+  using value_type = typename channel_value<T>::type;
+  static constexpr bool has_alpha() { return true; }
+  static constexpr bool has_rgb() { return true; }
+  static constexpr value_type max() {
+    if constexpr (std::is_floating_point<value_type>::value) {
+      return 1.0;
+    } else {
+      return std::numeric_limits<T>::max();
+    }
+  }
+  static constexpr bool is_floating_point() { return std::is_floating_point<value_type>::value; }
+
+  T r;
+  T g;
+  T b;
+  T a;
+
+  inline bool operator==(tPRGBAPixel<T> const& rhs) const = default;
+};
+
+/** True for pixel types that store premultiplied alpha */
+template<typename Pixel>
+struct is_premultiplied : std::false_type {};
+
+template<typename T>
+struct is_premultiplied<tPRGBAPixel<T>> : std::true_type {};
+
+/** 16-bit packed RGB, red in the top five bits, green in the middle
+    six and blue in the low five, stored in native byte order. The
+    channels are exposed as 8-bit values through red(), green(),
+    blue() and make_pixel(). */
+struct RGB565Pixel
+{
+  using value_type = uint8_t;
+  static constexpr bool has_alpha() { return false; }
+  static constexpr bool has_rgb() { return true; }
+  static constexpr uint8_t max() { return 255; }
+  static constexpr bool is_floating_point() { return false; }
+
+  uint16_t value;
+
+  inline bool operator==(RGB565Pixel const& rhs) const = default;
+};
+
 using RGB8Pixel = tRGBPixel<uint8_t>;
 using RGBA8Pixel = tRGBAPixel<uint8_t>;
 
@@ -122,6 +260,9 @@ using RGBA16Pixel = tRGBAPixel<uint16_t>;
 using RGB32Pixel = tRGBPixel<uint32_t>;
 using RGBA32Pixel = tRGBAPixel<uint32_t>;
 
+using RGB16fPixel = tRGBPixel<half>;
+using RGBA16fPixel = tRGBAPixel<half>;
+
 using RGB32fPixel = tRGBPixel<float>;
 using RGBA32fPixel = tRGBAPixel<float>;
 
@@ -137,12 +278,23 @@ using LA16Pixel = tLAPixel<uint16_t>;
 using L32Pixel = tLPixel<uint32_t>;
 using LA32Pixel = tLAPixel<uint32_t>;
 
+using L16fPixel = tLPixel<half>;
+using LA16fPixel = tLAPixel<half>;
+
 using L32fPixel = tLPixel<float>;
 using LA32fPixel = tLAPixel<float>;
 
 using L64fPixel = tLPixel<double>;
 using LA64fPixel = tLAPixel<double>;
 
+using BGR8Pixel = tBGRPixel<uint8_t>;
+using BGRA8Pixel = tBGRAPixel<uint8_t>;
+using ARGB8Pixel = tARGBPixel<uint8_t>;
+
+using PRGBA8Pixel = tPRGBAPixel<uint8_t>;
+using PRGBA16Pixel = tPRGBAPixel<uint16_t>;
+using PRGBA32fPixel = tPRGBAPixel<float>;
+
 template<typename Pixel> inline
 constexpr Pixel make_pixel(typename Pixel::value_type r,
                            typename Pixel::value_type g,
@@ -150,11 +302,15 @@ constexpr Pixel make_pixel(typename Pixel::value_type r,
                            typename Pixel::value_type a = Pixel::max())
 {
   if constexpr (Pixel::has_rgb()) {
+    // assign by name, the member order differs between formats
+    Pixel pixel{};
+    pixel.r = r;
+    pixel.g = g;
+    pixel.b = b;
     if constexpr (Pixel::has_alpha()) {
-      return Pixel{r, g, b, a};
-    } else {
-      return Pixel{r, g, b};
+      pixel.a = a;
     }
+    return pixel;
   } else {
     if constexpr (Pixel::has_alpha()) {
       return Pixel{static_cast<typename Pixel::value_type>((r + g + b) / 3), a};
@@ -199,6 +355,31 @@ template<typename Pixel> constexpr inline typename Pixel::value_type alpha(Pixel
   }
 }
 
+template<> inline
+constexpr RGB565Pixel make_pixel<RGB565Pixel>(uint8_t r, uint8_t g, uint8_t b, uint8_t /*a*/)
+{
+  return RGB565Pixel{static_cast<uint16_t>(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3))};
+}
+
+// expand to 8 bits by replicating the high bits into the low ones
+constexpr inline uint8_t red(RGB565Pixel pixel)
+{
+  uint32_t const v = (pixel.value >> 11) & 0x1f;
+  return static_cast<uint8_t>((v << 3) | (v >> 2));
+}
+
+constexpr inline uint8_t green(RGB565Pixel pixel)
+{
+  uint32_t const v = (pixel.value >> 5) & 0x3f;
+  return static_cast<uint8_t>((v << 2) | (v >> 4));
+}
+
+constexpr inline uint8_t blue(RGB565Pixel pixel)
+{
+  uint32_t const v = pixel.value & 0x1f;
+  return static_cast<uint8_t>((v << 3) | (v >> 2));
+}
+
 template<typename Pixel> constexpr inline float red_f(Pixel pixel) { return static_cast<float>(red(pixel)) / static_cast<float>(Pixel::max()); }
 template<typename Pixel> constexpr inline float green_f(Pixel pixel) { return static_cast<float>(green(pixel)) / static_cast<float>(Pixel::max()); }
 template<typename Pixel> constexpr inline float blue_f(Pixel pixel) { return static_cast<float>(blue(pixel)) / static_cast<float>(Pixel::max()); }
@@ -256,7 +437,7 @@ struct PPixelFormat<RGB8Pixel>
   static constexpr int bits_per_pixel = 24;
   static constexpr int bytes_per_pixel = 3;
   static constexpr uint32_t rmask = std::endian::native == std::endian::big ? 0x00ff0000 : 0x000000ff;
-  static constexpr uint32_t gmask = std::endian::native == std::endian::big ? 0x0000ff00 : 0x0000ff00; // NOLINT
+  static constexpr uint32_t gmask = 0x0000ff00;
   static constexpr uint32_t bmask = std::endian::native == std::endian::big ? 0x000000ff : 0x00ff0000;
   static constexpr uint32_t amask = 0x00000000;
 };
@@ -410,6 +591,114 @@ struct PPixelFormat<LA64fPixel>
   static constexpr PixelFormat format = PixelFormat::LA64f;
 };
 
+template<>
+struct PPixelFormat<BGR8Pixel>
+{
+  static constexpr PixelFormat format = PixelFormat::BGR8;
+  static constexpr int bits_per_pixel = 24;
+  static constexpr int bytes_per_pixel = 3;
+  static constexpr uint32_t rmask = std::endian::native == std::endian::big ? 0x000000ff : 0x00ff0000;
+  static constexpr uint32_t gmask = 0x0000ff00;
+  static constexpr uint32_t bmask = std::endian::native == std::endian::big ? 0x00ff0000 : 0x000000ff;
+  static constexpr uint32_t amask = 0x00000000;
+};
+
+template<>
+struct PPixelFormat<BGRA8Pixel>
+{
+  static constexpr PixelFormat format = PixelFormat::BGRA8;
+  static constexpr int bits_per_pixel = 32;
+  static constexpr int bytes_per_pixel = 4;
+  static constexpr uint32_t rmask = std::endian::native == std::endian::big ? 0x0000ff00 : 0x00ff0000;
+  static constexpr uint32_t gmask = std::endian::native == std::endian::big ? 0x00ff0000 : 0x0000ff00;
+  static constexpr uint32_t bmask = std::endian::native == std::endian::big ? 0xff000000 : 0x000000ff;
+  static constexpr uint32_t amask = std::endian::native == std::endian::big ? 0x000000ff : 0xff000000;
+};
+
+template<>
+struct PPixelFormat<ARGB8Pixel>
+{
+  static constexpr PixelFormat format = PixelFormat::ARGB8;
+  static constexpr int bits_per_pixel = 32;
+  static constexpr int bytes_per_pixel = 4;
+  static constexpr uint32_t rmask = std::endian::native == std::endian::big ? 0x00ff0000 : 0x0000ff00;
+  static constexpr uint32_t gmask = std::endian::native == std::endian::big ? 0x0000ff00 : 0x00ff0000;
+  static constexpr uint32_t bmask = std::endian::native == std::endian::big ? 0x000000ff : 0xff000000;
+  static constexpr uint32_t amask = std::endian::native == std::endian::big ? 0xff000000 : 0x000000ff;
+};
+
+template<>
+struct PPixelFormat<RGB565Pixel>
+{
+  static constexpr PixelFormat format = PixelFormat::RGB565;
+  static constexpr int bits_per_pixel = 16;
+  static constexpr int bytes_per_pixel = 2;
+  static constexpr uint32_t rmask = 0xf800;
+  static constexpr uint32_t gmask = 0x07e0;
+  static constexpr uint32_t bmask = 0x001f;
+  static constexpr uint32_t amask = 0x0000;
+};
+
+template<>
+struct PPixelFormat<PRGBA8Pixel>
+{
+  static constexpr PixelFormat format = PixelFormat::PRGBA8;
+  static constexpr int bits_per_pixel = 32;
+  static constexpr int bytes_per_pixel = 4;
+  static constexpr uint32_t rmask = std::endian::native == std::endian::big ? 0xff000000 : 0x000000ff;
+  static constexpr uint32_t gmask = std::endian::native == std::endian::big ? 0x00ff0000 : 0x0000ff00;
+  static constexpr uint32_t bmask = std::endian::native == std::endian::big ? 0x0000ff00 : 0x00ff0000;
+  static constexpr uint32_t amask = std::endian::native == std::endian::big ? 0x000000ff : 0xff000000;
+};
+
+template<>
+struct PPixelFormat<PRGBA16Pixel>
+{
+  static constexpr PixelFormat format = PixelFormat::PRGBA16;
+  static constexpr int bits_per_pixel = 64;
+  static constexpr int bytes_per_pixel = 8;
+};
+
+template<>
+struct PPixelFormat<PRGBA32fPixel>
+{
+  static constexpr PixelFormat format = PixelFormat::PRGBA32f;
+  static constexpr int bits_per_pixel = 128;
+  static constexpr int bytes_per_pixel = 16;
+};
+
+template<>
+struct PPixelFormat<RGB16fPixel>
+{
+  static constexpr PixelFormat format = PixelFormat::RGB16f;
+  static constexpr int bits_per_pixel = 48;
+  static constexpr int bytes_per_pixel = 6;
+};
+
+template<>
+struct PPixelFormat<RGBA16fPixel>
+{
+  static constexpr PixelFormat format = PixelFormat::RGBA16f;
+  static constexpr int bits_per_pixel = 64;
+  static constexpr int bytes_per_pixel = 8;
+};
+
+template<>
+struct PPixelFormat<L16fPixel>
+{
+  static constexpr PixelFormat format = PixelFormat::L16f;
+  static constexpr int bits_per_pixel = 16;
+  static constexpr int bytes_per_pixel = 2;
+};
+
+template<>
+struct PPixelFormat<LA16fPixel>
+{
+  static constexpr PixelFormat format = PixelFormat::LA16f;
+  static constexpr int bits_per_pixel = 32;
+  static constexpr int bytes_per_pixel = 4;
+};
+
 } // namespace surf
 
 #endif
@@ -0,0 +1,132 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_PIXEL_ALLOCATOR_HPP
+#define HEADER_SURF_PIXEL_ALLOCATOR_HPP
+
+#include <stddef.h>
+
+#include <new>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace surf {
+
+/** Tag for constructors that leave the pixels uninitialized, for
+    producers that overwrite every pixel anyway */
+struct NoInit {};
+inline constexpr NoInit no_init{};
+
+/** Alignment of pixel buffers and of padded rows, one cache line */
+inline constexpr size_t PIXEL_ALIGNMENT = 64;
+
+/** Allocate a PIXEL_ALIGNMENT aligned buffer, throws std::bad_alloc
+    on failure. Buffers at or above the huge page threshold are
+    advised to use transparent huge pages. */
+void* allocate_pixels(size_t bytes);
+void deallocate_pixels(void* ptr, size_t bytes) noexcept;
+
+/** Buffers of at least \a bytes size get madvise(MADV_HUGEPAGE),
+    zero disables the advice. Only has an effect on Linux. */
+void set_hugepage_threshold(size_t bytes);
+size_t get_hugepage_threshold();
+
+/** Returns the number of pixels per row needed so that each row of
+    \a width pixels starts on an \a alignment byte boundary */
+template<typename Pixel> inline
+constexpr ptrdiff_t aligned_row_length(int width, size_t alignment = PIXEL_ALIGNMENT)
+{
+  ptrdiff_t const step = static_cast<ptrdiff_t>(alignment / std::gcd(alignment, sizeof(Pixel)));
+  return (width + step - 1) / step * step;
+}
+
+class SurfacePool;
+
+/** Returns the pool set by the innermost SurfacePoolScope on the
+    current thread, or nullptr */
+SurfacePool* current_surface_pool();
+
+/** Allocate from \a pool, or from the system when \a pool is nullptr */
+void* allocate_pixels(SurfacePool* pool, size_t bytes);
+void deallocate_pixels(SurfacePool* pool, void* ptr, size_t bytes) noexcept;
+
+/** Allocator for pixel buffers, it binds to the current SurfacePool
+    on construction and keeps using that pool for its lifetime. Copies
+    of a container bind to the pool current at the time of the copy
+    and copy assignment keeps the pool of the target, so copies made
+    after the scope ended don't depend on the pool staying alive. */
+template<typename T>
+class PixelAllocator
+{
+  template<typename U> friend class PixelAllocator;
+
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+public:
+  PixelAllocator() noexcept :
+    m_pool(current_surface_pool())
+  {}
+
+  PixelAllocator(SurfacePool* pool) noexcept :
+    m_pool(pool)
+  {}
+
+  template<typename U>
+  PixelAllocator(PixelAllocator<U> const& other) noexcept :
+    m_pool(other.m_pool)
+  {}
+
+  PixelAllocator select_on_container_copy_construction() const noexcept {
+    return PixelAllocator(current_surface_pool());
+  }
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(allocate_pixels(m_pool, n * sizeof(T)));
+  }
+
+  void deallocate(T* ptr, size_t n) noexcept {
+    deallocate_pixels(m_pool, ptr, n * sizeof(T));
+  }
+
+  /** Default-initialize instead of value-initialize, so that
+      PixelBuffer(n) does not zero the pixels */
+  template<typename U>
+  void construct(U* ptr) noexcept(std::is_nothrow_default_constructible<U>::value) {
+    ::new(static_cast<void*>(ptr)) U;
+  }
+
+  SurfacePool* get_pool() const { return m_pool; }
+
+  template<typename U>
+  bool operator==(PixelAllocator<U> const& rhs) const noexcept { return m_pool == rhs.m_pool; }
+
+private:
+  SurfacePool* m_pool;
+};
+
+template<typename Pixel>
+using PixelBuffer = std::vector<Pixel, PixelAllocator<Pixel>>;
+
+} // namespace surf
+
+#endif
+
+/* EOF */
@@ -17,6 +17,10 @@
 #ifndef HEADER_SURF_PIXEL_DATA_HPP
 #define HEADER_SURF_PIXEL_DATA_HPP
 
+#include <utility>
+#include <vector>
+
+#include "pixel_allocator.hpp"
 #include "pixel_view.hpp"
 
 namespace surf {
@@ -65,8 +69,8 @@ public:
   }
 
   PixelData(PixelView<Pixel> const& view) :
-    PixelView<Pixel>(view),
-    m_pixels_ownership(geom::area(this->m_size))
+    PixelView<Pixel>(view.get_size(), static_cast<Pixel*>(nullptr), aligned_row_length<Pixel>(view.get_width())),
+    m_pixels_ownership(static_cast<size_t>(this->m_row_length) * static_cast<size_t>(this->m_size.height()))
   {
     this->m_pixels = m_pixels_ownership.data();
     for (int y = 0; y < this->m_size.height(); ++y) {
@@ -74,29 +78,58 @@ public:
     }
   }
 
-  PixelData(geom::isize const& size, Pixel const& pixel = {}) :
-    PixelView<Pixel>(size, nullptr),
-    m_pixels_ownership(geom::area(size), pixel)
+  /** Create PixelData with each row starting on a \a row_alignment
+      byte boundary, an alignment of 1 gives tightly packed rows */
+  PixelData(geom::isize const& size, Pixel const& pixel = {}, size_t row_alignment = PIXEL_ALIGNMENT) :
+    PixelView<Pixel>(size, static_cast<Pixel*>(nullptr), aligned_row_length<Pixel>(size.width(), row_alignment)),
+    m_pixels_ownership(static_cast<size_t>(this->m_row_length) * static_cast<size_t>(size.height()), pixel)
   {
     this->m_pixels = m_pixels_ownership.data();
   }
 
-  PixelData(geom::isize const& size, std::vector<Pixel> pixels) :
+  /** Create PixelData with uninitialized pixels */
+  PixelData(geom::isize const& size, NoInit, size_t row_alignment = PIXEL_ALIGNMENT) :
+    PixelView<Pixel>(size, static_cast<Pixel*>(nullptr), aligned_row_length<Pixel>(size.width(), row_alignment)),
+    m_pixels_ownership(static_cast<size_t>(this->m_row_length) * static_cast<size_t>(size.height()))
+  {
+    this->m_pixels = m_pixels_ownership.data();
+  }
+
+  /** Create PixelData from tightly packed pixels, the pixels are
+      copied into aligned storage */
+  PixelData(geom::isize const& size, std::vector<Pixel> const& pixels) :
     PixelView<Pixel>(size, nullptr),
-    m_pixels_ownership(std::move(pixels))
+    m_pixels_ownership(pixels.begin(), pixels.end())
   {
     this->m_pixels = m_pixels_ownership.data();
   }
 
-  PixelData(geom::isize const& size, std::vector<Pixel> pixels, int row_length) :
-    PixelView<Pixel>(size, nullptr, row_length),
-    m_pixels_ownership(std::move(pixels))
+  PixelData(geom::isize const& size, std::vector<Pixel> const& pixels, ptrdiff_t row_length) :
+    PixelView<Pixel>(size, static_cast<Pixel*>(nullptr), row_length),
+    m_pixels_ownership(pixels.begin(), pixels.end())
   {
     this->m_pixels = m_pixels_ownership.data();
   }
 
+  /** The aligned storage uses its own allocator and can't take over
+      the vector's memory, the pixels are copied once and the vector
+      is released right away instead of when the caller is done */
+  PixelData(geom::isize const& size, std::vector<Pixel>&& pixels) :
+    PixelData(size, std::as_const(pixels))
+  {
+    std::vector<Pixel>().swap(pixels);
+  }
+
+  PixelData(geom::isize const& size, std::vector<Pixel>&& pixels, ptrdiff_t row_length) :
+    PixelData(size, std::as_const(pixels), row_length)
+  {
+    std::vector<Pixel>().swap(pixels);
+  }
+
+  bool owns_data() const override { return true; }
+
 private:
-  std::vector<Pixel> m_pixels_ownership;
+  PixelBuffer<Pixel> m_pixels_ownership;
 };
 
 } // namespace surf
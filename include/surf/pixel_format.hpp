@@ -17,6 +17,8 @@
 #ifndef HEADER_SURF_PIXEL_FORMAT_HPP
 #define HEADER_SURF_PIXEL_FORMAT_HPP
 
+#include <stddef.h>
+
 #include <string>
 
 namespace surf {
@@ -48,8 +50,29 @@ enum class PixelFormat
   LA32f,
   L64f,
   LA64f,
+
+  // named by byte order in memory, except RGB565, which is a native
+  // endian 16-bit value
+  BGR8,
+  BGRA8,
+  ARGB8,
+  RGB565,
+
+  // color channels premultiplied by alpha
+  PRGBA8,
+  PRGBA16,
+  PRGBA32f,
+
+  // IEEE 754 half floats
+  RGB16f,
+  RGBA16f,
+  L16f,
+  LA16f,
 };
 
+/** Number of PixelFormat values, for tables indexed by format */
+inline constexpr size_t PIXEL_FORMAT_COUNT = static_cast<size_t>(PixelFormat::LA16f) + 1;
+
 std::string to_string(PixelFormat format);
 
 PixelFormat pixelformat_from_string(std::string_view text);
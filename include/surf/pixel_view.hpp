@@ -17,6 +17,10 @@
 #ifndef HEADER_SURF_PIXEL_VIEW_HPP
 #define HEADER_SURF_PIXEL_VIEW_HPP
 
+#include <stddef.h>
+
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 #include <geom/point.hpp>
@@ -25,8 +29,10 @@
 
 #include "color.hpp"
 #include "convert.hpp"
+#include "convert_span.hpp"
 #include "ipixel_data.hpp"
 #include "pixel.hpp"
+#include "pixel_allocator.hpp"
 #include "pixel_format.hpp"
 
 namespace surf {
@@ -62,13 +68,13 @@ public:
     m_pixels(pixels)
   {}
 
-  PixelView(geom::isize const& size, Pixel* pixels, int row_length) :
+  PixelView(geom::isize const& size, Pixel* pixels, ptrdiff_t row_length) :
     m_size(size),
     m_row_length(row_length),
     m_pixels(pixels)
   {}
 
-  PixelView(geom::isize const& size, Pixel const* pixels, int row_length) :
+  PixelView(geom::isize const& size, Pixel const* pixels, ptrdiff_t row_length) :
     m_size(size),
     m_row_length(row_length),
     // FIXME: this is ugly and dangerous, but less troublesome than
@@ -81,10 +87,11 @@ public:
   geom::isize get_size() const override { return m_size; }
   int get_width() const override { return m_size.width(); }
   int get_height() const override { return m_size.height(); }
-  int get_row_length() const override { return m_row_length; }
-  int get_pitch() const override { return m_row_length * sizeof(Pixel); }
+  ptrdiff_t get_row_length() const override { return m_row_length; }
+  ptrdiff_t get_pitch() const override { return m_row_length * static_cast<ptrdiff_t>(sizeof(Pixel)); }
 
   bool empty() const override { return m_pixels == nullptr; }
+  bool owns_data() const override { return false; }
 
   void put_pixel(geom::ipoint const& pos, Pixel const& pixel)
   {
@@ -102,6 +109,32 @@ public:
     return convert<Pixel, Color>(get_pixel(pos));
   }
 
+  void read_row_colors(int y, int x, int count, Color* out) const override
+  {
+    assert(y >= 0 && y < m_size.height() && x >= 0 && x + count <= m_size.width());
+    Pixel const* const row = get_row(y) + x;
+    if constexpr (detail::has_color_span_kernel<Pixel>()) {
+      detail::colors_from_span(PPixelFormat<Pixel>::format, row, out, static_cast<size_t>(count));
+    } else {
+      for (int i = 0; i < count; ++i) {
+        out[i] = convert<Pixel, Color>(row[i]);
+      }
+    }
+  }
+
+  void write_row_colors(int y, int x, int count, Color const* in) override
+  {
+    assert(y >= 0 && y < m_size.height() && x >= 0 && x + count <= m_size.width());
+    Pixel* const row = get_row(y) + x;
+    if constexpr (detail::has_color_span_kernel<Pixel>()) {
+      detail::colors_to_span(PPixelFormat<Pixel>::format, in, row, static_cast<size_t>(count));
+    } else {
+      for (int i = 0; i < count; ++i) {
+        row[i] = convert<Color, Pixel>(in[i]);
+      }
+    }
+  }
+
   Pixel get_pixel(geom::ipoint const& pos) const
   {
     assert(geom::contains(m_size, pos));
@@ -138,17 +171,34 @@ public:
     if constexpr (std::is_same<DstPixel, Pixel>::value) {
       return *this;
     } else {
-      std::vector<DstPixel> dstpixels;
-      dstpixels.reserve(geom::area(this->m_size));
+      PixelData<DstPixel> result(m_size, no_init);
+      convert_into(result);
+      return result;
+    }
+  }
 
-      for (int y = 0; y < m_size.height(); ++y) {
-        std::transform(get_row(y), get_row(y) + m_size.width(),
-                       std::back_inserter(dstpixels),
-                       convert<Pixel, DstPixel>);
+  /** Convert into the caller provided \a dst, the sizes have to match */
+  template<typename DstPixel>
+  void convert_into(PixelView<DstPixel>& dst) const
+  {
+    if (dst.get_size() != m_size) {
+      throw std::invalid_argument("PixelView::convert_into: size mismatch");
+    }
+
+    size_t const width = static_cast<size_t>(m_size.width());
+    for (int y = 0; y < m_size.height(); ++y) {
+      // the registry kernels, SIMD where available, give the same
+      // results as convert()
+      if constexpr (detail::has_pixel_format<Pixel>::value && detail::has_pixel_format<DstPixel>::value) {
+        if (detail::convert_span(PPixelFormat<Pixel>::format, PPixelFormat<DstPixel>::format,
+                                 get_row(y), dst.get_row(y), width)) {
+          continue;
+        }
       }
 
-      PixelData<DstPixel> result(m_size, std::move(dstpixels));
-      return result;
+      std::transform(get_row(y), get_row(y) + m_size.width(),
+                     dst.get_row(y),
+                     convert<Pixel, DstPixel>);
     }
   }
 
@@ -200,7 +250,8 @@ protected:
 
 protected:
   geom::isize m_size;
-  int m_row_length;
+  /** ptrdiff_t so that y * m_row_length is computed in 64-bit */
+  ptrdiff_t m_row_length;
   Pixel* m_pixels;
 };
 
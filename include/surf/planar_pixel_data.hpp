@@ -0,0 +1,401 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_PLANAR_PIXEL_DATA_HPP
+#define HEADER_SURF_PLANAR_PIXEL_DATA_HPP
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+
+#include "color.hpp"
+#include "convert.hpp"
+#include "pixel.hpp"
+#include "pixel_data.hpp"
+#include "promote.hpp"
+
+namespace surf {
+
+/** Structure-of-arrays storage for tRGBPixel and tRGBAPixel, each
+    channel lives in its own plane. Planes are ordinary L PixelData,
+    so they can be handed to anything that takes a PixelView or be
+    wrapped with SoftwareSurface::create_view() without a copy.
+
+    This is deliberately not an IPixelData and has no PixelFormat of
+    its own. Every IPixelData is a PixelView with interleaved rows,
+    get_row_data(), visit() and all KernelRegistry kernels depend on
+    that. A planar implementation would have to fail those or
+    interleave on every row access, which is what this class avoids.
+    get_format() names the interleaved equivalent, to_pixeldata()
+    gives a PixelData for SoftwareSurface, and read_row_colors() and
+    write_row_colors() match the IPixelData ones for code that works
+    on Color. */
+template<typename Pixel>
+class PlanarPixelData
+{
+  static_assert(Pixel::has_rgb(), "PlanarPixelData needs an RGB or RGBA pixel type");
+
+public:
+  using value_type = Pixel;
+  using channel_type = typename Pixel::value_type;
+  using PlanePixel = tLPixel<channel_type>;
+
+  static constexpr int channels = Pixel::has_alpha() ? 4 : 3;
+
+public:
+  PlanarPixelData() :
+    m_size(0, 0),
+    m_planes()
+  {}
+
+  PlanarPixelData(geom::isize const& size, Pixel const& pixel = {}) :
+    m_size(size),
+    m_planes()
+  {
+    for (int c = 0; c < channels; ++c) {
+      m_planes[c] = PixelData<PlanePixel>(size, PlanePixel{channel(pixel, c)});
+    }
+  }
+
+  /** Deinterleave \a src */
+  explicit PlanarPixelData(PixelView<Pixel> const& src) :
+    PlanarPixelData(src.get_size())
+  {
+    for (int y = 0; y < m_size.height(); ++y) {
+      Pixel const* const src_row = src.get_row(y);
+      for (int c = 0; c < channels; ++c) {
+        PlanePixel* const dst_row = m_planes[c].get_row(y);
+        for (int x = 0; x < m_size.width(); ++x) {
+          dst_row[x].l = channel(src_row[x], c);
+        }
+      }
+    }
+  }
+
+  /** Take over \a planes without copying, one plane per channel in
+      RGB(A) order, all of the same size */
+  explicit PlanarPixelData(std::vector<PixelData<PlanePixel>> planes) :
+    m_size(planes.empty() ? geom::isize(0, 0) : planes[0].get_size()),
+    m_planes()
+  {
+    if (planes.size() != channels) {
+      throw std::invalid_argument("PlanarPixelData: wrong number of planes");
+    }
+
+    for (int c = 0; c < channels; ++c) {
+      if (planes[c].get_size() != m_size) {
+        throw std::invalid_argument("PlanarPixelData: planes must be the same size");
+      }
+      m_planes[c] = std::move(planes[c]);
+    }
+  }
+
+  /** Interleave the planes back into a single PixelData */
+  PixelData<Pixel> to_pixeldata() const
+  {
+    PixelData<Pixel> dst(m_size, no_init);
+    for (int y = 0; y < m_size.height(); ++y) {
+      Pixel* const dst_row = dst.get_row(y);
+      if constexpr (channels == 4) {
+        PlanePixel const* const r = m_planes[0].get_row(y);
+        PlanePixel const* const g = m_planes[1].get_row(y);
+        PlanePixel const* const b = m_planes[2].get_row(y);
+        PlanePixel const* const a = m_planes[3].get_row(y);
+        for (int x = 0; x < m_size.width(); ++x) {
+          dst_row[x] = make_pixel<Pixel>(r[x].l, g[x].l, b[x].l, a[x].l);
+        }
+      } else {
+        PlanePixel const* const r = m_planes[0].get_row(y);
+        PlanePixel const* const g = m_planes[1].get_row(y);
+        PlanePixel const* const b = m_planes[2].get_row(y);
+        for (int x = 0; x < m_size.width(); ++x) {
+          dst_row[x] = make_pixel<Pixel>(r[x].l, g[x].l, b[x].l);
+        }
+      }
+    }
+    return dst;
+  }
+
+  /** The PixelFormat of the interleaved equivalent */
+  PixelFormat get_format() const { return PPixelFormat<Pixel>::format; }
+  PixelFormat get_plane_format() const { return PPixelFormat<PlanePixel>::format; }
+
+  geom::isize get_size() const { return m_size; }
+  int get_width() const { return m_size.width(); }
+  int get_height() const { return m_size.height(); }
+  bool empty() const { return m_planes[0].empty(); }
+
+  PixelData<PlanePixel>& get_plane(int c) { return m_planes[c]; }
+  PixelData<PlanePixel> const& get_plane(int c) const { return m_planes[c]; }
+
+  Pixel get_pixel(geom::ipoint const& pos) const {
+    if constexpr (channels == 4) {
+      return make_pixel<Pixel>(m_planes[0].get_pixel(pos).l, m_planes[1].get_pixel(pos).l,
+                               m_planes[2].get_pixel(pos).l, m_planes[3].get_pixel(pos).l);
+    } else {
+      return make_pixel<Pixel>(m_planes[0].get_pixel(pos).l, m_planes[1].get_pixel(pos).l,
+                               m_planes[2].get_pixel(pos).l);
+    }
+  }
+
+  void put_pixel(geom::ipoint const& pos, Pixel const& pixel) {
+    for (int c = 0; c < channels; ++c) {
+      m_planes[c].put_pixel(pos, PlanePixel{channel(pixel, c)});
+    }
+  }
+
+  /** Same as IPixelData::read_row_colors(), interleaving on access */
+  void read_row_colors(int y, int x, int count, Color* out) const
+  {
+    assert(y >= 0 && y < m_size.height() && x >= 0 && x + count <= m_size.width());
+    PlanePixel const* rows[channels];
+    for (int c = 0; c < channels; ++c) {
+      rows[c] = m_planes[c].get_row(y) + x;
+    }
+    for (int i = 0; i < count; ++i) {
+      if constexpr (channels == 4) {
+        out[i] = convert<Pixel, Color>(make_pixel<Pixel>(rows[0][i].l, rows[1][i].l, rows[2][i].l, rows[3][i].l));
+      } else {
+        out[i] = convert<Pixel, Color>(make_pixel<Pixel>(rows[0][i].l, rows[1][i].l, rows[2][i].l));
+      }
+    }
+  }
+
+  /** Same as IPixelData::write_row_colors(), deinterleaving on access */
+  void write_row_colors(int y, int x, int count, Color const* in)
+  {
+    assert(y >= 0 && y < m_size.height() && x >= 0 && x + count <= m_size.width());
+    PlanePixel* rows[channels];
+    for (int c = 0; c < channels; ++c) {
+      rows[c] = m_planes[c].get_row(y) + x;
+    }
+    for (int i = 0; i < count; ++i) {
+      Pixel const pixel = convert<Color, Pixel>(in[i]);
+      for (int c = 0; c < channels; ++c) {
+        rows[c][i].l = channel(pixel, c);
+      }
+    }
+  }
+
+  bool operator==(PlanarPixelData<Pixel> const& rhs) const {
+    if (m_size != rhs.m_size) {
+      return false;
+    }
+
+    for (int c = 0; c < channels; ++c) {
+      if (m_planes[c] != rhs.m_planes[c]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool operator!=(PlanarPixelData<Pixel> const& rhs) const {
+    return !(*this == rhs);
+  }
+
+private:
+  static channel_type channel(Pixel const& pixel, int c) {
+    switch (c) {
+      case 0: return red(pixel);
+      case 1: return green(pixel);
+      case 2: return blue(pixel);
+      default: return alpha(pixel);
+    }
+  }
+
+private:
+  geom::isize m_size;
+  std::array<PixelData<PlanePixel>, channels> m_planes;
+};
+
+namespace detail {
+
+/** Calls \a f(int channel, channel_type* values, int count) for each
+    row of the red, green and blue planes, alpha is left untouched */
+template<typename Pixel, typename RowFunc>
+void for_each_color_plane_row(PlanarPixelData<Pixel>& src, RowFunc f)
+{
+  using channel_type = typename Pixel::value_type;
+  static_assert(sizeof(typename PlanarPixelData<Pixel>::PlanePixel) == sizeof(channel_type));
+
+  for (int c = 0; c < 3; ++c) {
+    auto& plane = src.get_plane(c);
+    for (int y = 0; y < plane.get_height(); ++y) {
+      f(c, reinterpret_cast<channel_type*>(plane.get_row(y)), plane.get_width());
+    }
+  }
+}
+
+} // namespace detail
+
+/** Zero-copy views of the planes, in RGB(A) order */
+template<typename Pixel>
+std::vector<PixelView<typename PlanarPixelData<Pixel>::PlanePixel>>
+split_channel(PlanarPixelData<Pixel>& src)
+{
+  std::vector<PixelView<typename PlanarPixelData<Pixel>::PlanePixel>> planes;
+  for (int c = 0; c < PlanarPixelData<Pixel>::channels; ++c) {
+    planes.emplace_back(src.get_plane(c));
+  }
+  return planes;
+}
+
+/** Copy the given channels into planar storage, the result has an
+    alpha plane when four channels are given */
+template<typename T>
+PlanarPixelData<tRGBPixel<T>> join_channel_planar(PixelView<tLPixel<T>> const& red,
+                                                  PixelView<tLPixel<T>> const& green,
+                                                  PixelView<tLPixel<T>> const& blue)
+{
+  std::vector<PixelData<tLPixel<T>>> planes;
+  planes.reserve(3);
+  planes.emplace_back(red);
+  planes.emplace_back(green);
+  planes.emplace_back(blue);
+  return PlanarPixelData<tRGBPixel<T>>(std::move(planes));
+}
+
+template<typename T>
+PlanarPixelData<tRGBAPixel<T>> join_channel_planar(PixelView<tLPixel<T>> const& red,
+                                                   PixelView<tLPixel<T>> const& green,
+                                                   PixelView<tLPixel<T>> const& blue,
+                                                   PixelView<tLPixel<T>> const& alpha)
+{
+  std::vector<PixelData<tLPixel<T>>> planes;
+  planes.reserve(4);
+  planes.emplace_back(red);
+  planes.emplace_back(green);
+  planes.emplace_back(blue);
+  planes.emplace_back(alpha);
+  return PlanarPixelData<tRGBAPixel<T>>(std::move(planes));
+}
+
+template<typename Pixel>
+void apply_add(PlanarPixelData<Pixel>& src, float addend)
+{
+  using type = typename Pixel::value_type;
+  type const addend_v = f2value<Pixel>(addend);
+
+  detail::for_each_color_plane_row(src, [addend_v](int /*c*/, type* values, int count) {
+    for (int i = 0; i < count; ++i) {
+      if constexpr (Pixel::is_floating_point()) {
+        values[i] = values[i] + addend_v;
+      } else {
+        values[i] = clamp_pixel<Pixel>(promote<type, type>(values[i]) + addend_v);
+      }
+    }
+  });
+}
+
+template<typename Pixel>
+void apply_multiply(PlanarPixelData<Pixel>& src, float factor)
+{
+  using type = typename Pixel::value_type;
+  using PlanePixel = typename PlanarPixelData<Pixel>::PlanePixel;
+
+  detail::for_each_color_plane_row(src, [factor](int /*c*/, type* values, int count) {
+    for (int i = 0; i < count; ++i) {
+      float const v = convert_value<PlanePixel, L32fPixel>(values[i]) * factor;
+      values[i] = convert_value<L32fPixel, PlanePixel>(v);
+    }
+  });
+}
+
+template<typename Pixel>
+void apply_brightness(PlanarPixelData<Pixel>& src, float brightness)
+{
+  using type = typename Pixel::value_type;
+  using PlanePixel = typename PlanarPixelData<Pixel>::PlanePixel;
+
+  detail::for_each_color_plane_row(src, [brightness](int /*c*/, type* values, int count) {
+    for (int i = 0; i < count; ++i) {
+      float const v = convert_value<PlanePixel, L32fPixel>(values[i]) + brightness;
+      values[i] = convert_value<L32fPixel, PlanePixel>(v);
+    }
+  });
+}
+
+template<typename Pixel>
+void apply_contrast(PlanarPixelData<Pixel>& src, float contrast /* [-1.0, 1.0f] */)
+{
+  using type = typename Pixel::value_type;
+  using PlanePixel = typename PlanarPixelData<Pixel>::PlanePixel;
+
+  contrast = std::clamp(((contrast + 1.0f) / 2.0f), 0.0f, 1.0f);
+  float const factor = static_cast<float>(tan(contrast * std::numbers::pi_v<float> / 2.0f));
+
+  detail::for_each_color_plane_row(src, [factor](int /*c*/, type* values, int count) {
+    for (int i = 0; i < count; ++i) {
+      float const v = (convert_value<PlanePixel, L32fPixel>(values[i]) - 0.5f) * factor + 0.5f;
+      values[i] = convert_value<L32fPixel, PlanePixel>(std::clamp(v, 0.0f, 1.0f));
+    }
+  });
+}
+
+template<typename Pixel>
+void apply_invert(PlanarPixelData<Pixel>& src)
+{
+  using type = typename Pixel::value_type;
+
+  detail::for_each_color_plane_row(src, [](int /*c*/, type* values, int count) {
+    for (int i = 0; i < count; ++i) {
+      values[i] = static_cast<type>(Pixel::max() - values[i]);
+    }
+  });
+}
+
+/** Like the interleaved version, which rebuilds each pixel with
+    make_pixel(), the alpha plane becomes fully opaque */
+template<typename Pixel>
+void apply_threshold(PlanarPixelData<Pixel>& src, Color threshold)
+{
+  using type = typename Pixel::value_type;
+
+  constexpr type min_val = std::numeric_limits<type>::min();
+  constexpr type max_val = std::numeric_limits<type>::max();
+
+  std::array<type, 3> const thresholds = {
+    static_cast<type>(std::clamp(threshold.r, 0.0f, 1.0f) * static_cast<float>(max_val)),
+    static_cast<type>(std::clamp(threshold.g, 0.0f, 1.0f) * static_cast<float>(max_val)),
+    static_cast<type>(std::clamp(threshold.b, 0.0f, 1.0f) * static_cast<float>(max_val)),
+  };
+
+  detail::for_each_color_plane_row(src, [&thresholds](int c, type* values, int count) {
+    type const t = thresholds[c];
+    for (int i = 0; i < count; ++i) {
+      values[i] = values[i] > t ? max_val : min_val;
+    }
+  });
+
+  if constexpr (Pixel::has_alpha()) {
+    auto& alpha = src.get_plane(3);
+    for (int y = 0; y < alpha.get_height(); ++y) {
+      std::fill_n(alpha.get_row(y), alpha.get_width(), typename PlanarPixelData<Pixel>::PlanePixel{max_val});
+    }
+  }
+}
+
+} // namespace surf
+
+#endif
+
+/* EOF */
@@ -21,6 +21,7 @@
 #include <jpeglib.h>
 
 #include <surf/pixel_data.hpp>
+#include <surf/software_surface.hpp>
 
 namespace surf {
 
@@ -38,6 +39,13 @@ public:
 
   void save(PixelView<RGB8Pixel> const& pixel_data, int quality);
 
+  /** Surfaces that aren't RGB8 get converted in strips of scanlines
+      while compressing, no full RGB8 copy is made */
+  void save(SoftwareSurface const& surface, int quality);
+
+private:
+  void start_compress(geom::isize const& size, int quality);
+
 private:
   JPEGCompressor(const JPEGCompressor&);
   JPEGCompressor& operator=(const JPEGCompressor&);
@@ -0,0 +1,88 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_ROW_CONVERTER_HPP
+#define HEADER_SURF_ROW_CONVERTER_HPP
+
+#include <stddef.h>
+
+#include "kernel_registry.hpp"
+#include "pixel.hpp"
+#include "pixel_format.hpp"
+#include "pixel_view.hpp"
+#include "software_surface.hpp"
+
+namespace surf {
+
+/** Converts pixel rows from one format to another a scanline or a
+    strip at a time, so that conversion can be fused into decode and
+    encode loops instead of going through a full temporary surface.
+    The conversion kernel is looked up once, in the constructor. */
+class RowConverter
+{
+public:
+  /** Throws std::invalid_argument when there is no kernel for the
+      pair of formats */
+  RowConverter(PixelFormat src, PixelFormat dst);
+
+  PixelFormat get_src_format() const { return m_src; }
+  PixelFormat get_dst_format() const { return m_dst; }
+
+  /** Convert \a width pixels from \a src into \a dst */
+  void convert_row(void const* src, void* dst, int width) const {
+    m_kernel(src, dst, static_cast<size_t>(width));
+  }
+
+  /** Convert the rows of \a src starting at row \a y into all rows of
+      \a dst, both have to have the same width */
+  void convert_rows(SoftwareSurface const& src, int y, SoftwareSurface& dst) const;
+
+  template<typename DstPixel>
+  void convert_rows(SoftwareSurface const& src, int y, PixelView<DstPixel>& dst) const
+  {
+    check_rows(src, y, PPixelFormat<DstPixel>::format, dst.get_size());
+
+    for (int i = 0; i < dst.get_height(); ++i) {
+      convert_row(src.get_row_data(y + i), dst.get_row(i), dst.get_width());
+    }
+  }
+
+private:
+  void check_rows(SoftwareSurface const& src, int y, PixelFormat dst_format, geom::isize const& dst_size) const;
+
+private:
+  PixelFormat m_src;
+  PixelFormat m_dst;
+  SpanKernel m_kernel;
+};
+
+/** Convert \a src into the caller provided \a dst, the sizes have to
+    match */
+template<typename DstPixel>
+void convert_into(SoftwareSurface const& src, PixelView<DstPixel>& dst)
+{
+  if (src.get_size() != dst.get_size()) {
+    throw std::invalid_argument("convert_into: size mismatch");
+  }
+
+  RowConverter(src.get_format(), PPixelFormat<DstPixel>::format).convert_rows(src, 0, dst);
+}
+
+} // namespace surf
+
+#endif
+
+/* EOF */
@@ -0,0 +1,303 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_SCALE_FILTER_HPP
+#define HEADER_SURF_SCALE_FILTER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <geom/rect.hpp>
+#include <geom/size.hpp>
+
+#include "pixel.hpp"
+#include "pixel_view.hpp"
+
+namespace surf {
+
+/** How blend_scaled() samples the source */
+enum class ScaleFilter
+{
+  /** The source pixel the destination pixel center falls into */
+  NEAREST,
+
+  /** Interpolate between the four source pixels around the center,
+      for upscaling and mild downscaling */
+  BILINEAR,
+
+  /** Average all source pixels the destination pixel covers, for
+      downscaling, upscales like NEAREST */
+  BOX,
+};
+
+ScaleFilter ScaleFilter_from_string(std::string_view text);
+std::string_view to_string(ScaleFilter filter);
+
+namespace detail {
+
+/** Where a destination pixel samples along one axis. NEAREST uses
+    index, BILINEAR blends index and next with frac / 256 of next and
+    BOX averages [index, next). */
+struct ScaleTap
+{
+  int index;
+  int next;
+  uint32_t frac;
+};
+
+/** The taps for \a dstlen destination pixels covering \a srclen
+    source pixels, computed by stepping instead of dividing per
+    pixel. NEAREST and BOX give the same indices as x * srclen /
+    dstlen, BILINEAR samples at the pixel centers in 16.16 fixed point
+    and clamps to the edge. */
+std::vector<ScaleTap> make_scale_taps(ScaleFilter filter, int srclen, int dstlen);
+
+/** Per byte lerp of \a count bytes with the weights of
+    lerp_channel(), SIMD when the CPU has it. Works for every pixel
+    format made of 8-bit channels. */
+void lerp_bytes(uint8_t const* a, uint8_t const* b, uint8_t* out, size_t count, uint32_t frac);
+
+/** Horizontal BILINEAR pass over a row of four 8-bit channel pixels */
+void bilinear_row_4x8(void const* srcrow, ScaleTap const* taps, void* out, size_t count);
+
+/** a * (1 - frac / 256) + b * frac / 256, rounded for integers */
+template<typename T> inline
+T lerp_channel(T a, T b, uint32_t frac)
+{
+  if constexpr (std::is_floating_point<T>::value) {
+    return (a * static_cast<T>(256 - frac) + b * static_cast<T>(frac)) / static_cast<T>(256);
+  } else {
+    using calctype = std::conditional_t<(sizeof(T) < 4), uint32_t, uint64_t>;
+    return static_cast<T>((static_cast<calctype>(a) * (256 - frac) + static_cast<calctype>(b) * frac + 128) >> 8);
+  }
+}
+
+/** make_pixel() for filtered channels, L formats take the luminance
+    as is, averaging three copies of it would overflow 32-bit channels */
+template<typename Pixel> inline
+Pixel make_filtered_pixel(typename Pixel::value_type r, typename Pixel::value_type g,
+                          typename Pixel::value_type b, typename Pixel::value_type a)
+{
+  if constexpr (Pixel::has_rgb()) {
+    return make_pixel<Pixel>(r, g, b, a);
+  } else if constexpr (Pixel::has_alpha()) {
+    return Pixel{r, a};
+  } else {
+    return Pixel{r};
+  }
+}
+
+template<typename Pixel> inline
+Pixel lerp_pixel(Pixel a, Pixel b, uint32_t frac)
+{
+  return make_filtered_pixel<Pixel>(lerp_channel(red(a), red(b), frac),
+                           lerp_channel(green(a), green(b), frac),
+                           lerp_channel(blue(a), blue(b), frac),
+                           lerp_channel(alpha(a), alpha(b), frac));
+}
+
+/** Pixel formats whose bytes are all independent 8-bit channels */
+template<typename Pixel>
+struct is_unorm8_pixel : std::integral_constant<bool, std::is_same<typename Pixel::value_type, uint8_t>::value &&
+                                                      !std::is_same<Pixel, RGB565Pixel>::value> {};
+
+} // namespace detail
+
+/** Produces the rows of \a srcrect scaled to \a dstsize one at a
+    time, in the source pixel format. Channels are filtered
+    independently, so with straight alpha the color of transparent
+    pixels bleeds into the edges, premultiplied formats don't have
+    that problem. Samples never reach outside of \a srcrect. */
+template<typename Pixel>
+class ScaledRowSampler
+{
+private:
+  using value_type = typename Pixel::value_type;
+  using sumtype = std::conditional_t<std::is_floating_point<value_type>::value, double, uint64_t>;
+
+public:
+  ScaledRowSampler(PixelView<Pixel> const& src, geom::irect const& srcrect,
+                   geom::isize const& dstsize, ScaleFilter filter) :
+    m_src(src),
+    m_srcrect(srcrect),
+    m_filter(filter),
+    m_xtaps(detail::make_scale_taps(filter, srcrect.width(), dstsize.width())),
+    m_ytaps(detail::make_scale_taps(filter, srcrect.height(), dstsize.height())),
+    m_rows(),
+    m_row_y{-1, -1},
+    m_sums(),
+    m_box_scale()
+  {
+    if (m_filter == ScaleFilter::BILINEAR) {
+      m_rows[0].resize(m_xtaps.size());
+      m_rows[1].resize(m_xtaps.size());
+    } else if (m_filter == ScaleFilter::BOX) {
+      m_sums.resize(m_xtaps.size() * 4);
+      m_box_scale.reserve(m_xtaps.size());
+      for (detail::ScaleTap const& tap : m_xtaps) {
+        m_box_scale.push_back(1.0 / (tap.next - tap.index));
+      }
+    }
+  }
+
+  /** Write destination row \a y, dstsize.width() pixels, to \a out */
+  void sample_row(int y, Pixel* out)
+  {
+    detail::ScaleTap const& tap = m_ytaps[static_cast<size_t>(y)];
+
+    switch (m_filter) {
+      case ScaleFilter::BILINEAR: {
+        Pixel const* const row0 = horizontal(tap.index, tap.next);
+        if (tap.frac == 0) {
+          std::copy_n(row0, m_xtaps.size(), out);
+        } else {
+          Pixel const* const row1 = horizontal(tap.next, tap.index);
+          if constexpr (detail::is_unorm8_pixel<Pixel>::value) {
+            detail::lerp_bytes(reinterpret_cast<uint8_t const*>(row0), reinterpret_cast<uint8_t const*>(row1),
+                               reinterpret_cast<uint8_t*>(out), m_xtaps.size() * sizeof(Pixel), tap.frac);
+          } else {
+            for (size_t x = 0; x < m_xtaps.size(); ++x) {
+              out[x] = detail::lerp_pixel(row0[x], row1[x], tap.frac);
+            }
+          }
+        }
+        break;
+      }
+
+      case ScaleFilter::BOX:
+        box(tap, out);
+        break;
+
+      default: {
+        Pixel const* const srcrow = source_row(tap.index);
+        for (size_t x = 0; x < m_xtaps.size(); ++x) {
+          out[x] = srcrow[m_xtaps[x].index];
+        }
+        break;
+      }
+    }
+  }
+
+private:
+  Pixel const* source_row(int y) const
+  {
+    return m_src.get_row(m_srcrect.top() + y) + m_srcrect.left();
+  }
+
+  /** Source row \a y filtered horizontally, cached, as consecutive
+      destination rows mostly share their source rows. \a keep is the
+      row the caller still needs. */
+  Pixel const* horizontal(int y, int keep)
+  {
+    for (size_t i = 0; i < 2; ++i) {
+      if (m_row_y[i] == y) {
+        return m_rows[i].data();
+      }
+    }
+
+    size_t const slot = m_row_y[0] == keep ? 1 : 0;
+    Pixel* const row = m_rows[slot].data();
+    Pixel const* const srcrow = source_row(y);
+
+    if constexpr (sizeof(Pixel) == 4 && detail::is_unorm8_pixel<Pixel>::value) {
+      detail::bilinear_row_4x8(srcrow, m_xtaps.data(), row, m_xtaps.size());
+    } else {
+      for (size_t x = 0; x < m_xtaps.size(); ++x) {
+        detail::ScaleTap const& t = m_xtaps[x];
+        row[x] = detail::lerp_pixel(srcrow[t.index], srcrow[t.next], t.frac);
+      }
+    }
+
+    m_row_y[slot] = y;
+    return row;
+  }
+
+  void box(detail::ScaleTap const& ytap, Pixel* out)
+  {
+    std::fill(m_sums.begin(), m_sums.end(), sumtype(0));
+
+    for (int y = ytap.index; y < ytap.next; ++y) {
+      Pixel const* const srcrow = source_row(y);
+      for (size_t x = 0; x < m_xtaps.size(); ++x) {
+        sumtype* const sum = &m_sums[x * 4];
+        for (int sx = m_xtaps[x].index; sx < m_xtaps[x].next; ++sx) {
+          sum[0] += red(srcrow[sx]);
+          sum[1] += green(srcrow[sx]);
+          sum[2] += blue(srcrow[sx]);
+          sum[3] += alpha(srcrow[sx]);
+        }
+      }
+    }
+
+    // multiply with the reciprocal of the box area instead of dividing
+    // each channel. For integers, (v + n/2 + 0.5) / n keeps the rounded
+    // result at least 1/2n away from the next integer. That only
+    // absorbs the floating point error while it stays below 1/2n,
+    // which holds for channels of up to 16 bits and boxes of up to
+    // 2^32 pixels. 32-bit channels and larger boxes divide exactly.
+    int64_t const height = ytap.next - ytap.index;
+    double const yscale = 1.0 / static_cast<double>(height);
+    for (size_t x = 0; x < m_xtaps.size(); ++x) {
+      int64_t const area = height * (m_xtaps[x].next - m_xtaps[x].index);
+      double const scale = yscale * m_box_scale[x];
+      bool const exact = !std::is_floating_point<sumtype>::value &&
+        (sizeof(value_type) > 2 || area > (int64_t{1} << 32));
+      double const offset = std::is_floating_point<sumtype>::value ? 0.0 :
+        static_cast<double>(area / 2) + 0.5;
+      sumtype const* const sum = &m_sums[x * 4];
+      auto const average = [scale, offset, exact, area](sumtype v) {
+        if constexpr (!std::is_floating_point<sumtype>::value) {
+          if (exact) {
+            uint64_t const n = static_cast<uint64_t>(area);
+            return static_cast<value_type>((v + n / 2) / n);
+          }
+        }
+        return static_cast<value_type>((static_cast<double>(v) + offset) * scale);
+      };
+      out[x] = detail::make_filtered_pixel<Pixel>(average(sum[0]), average(sum[1]), average(sum[2]), average(sum[3]));
+    }
+  }
+
+private:
+  PixelView<Pixel> const& m_src;
+  geom::irect const m_srcrect;
+  ScaleFilter const m_filter;
+  std::vector<detail::ScaleTap> const m_xtaps;
+  std::vector<detail::ScaleTap> const m_ytaps;
+
+  // BILINEAR, two horizontally filtered source rows and their y
+  std::vector<Pixel> m_rows[2];
+  int m_row_y[2];
+
+  // BOX, per destination pixel channel sums
+  std::vector<sumtype> m_sums;
+  std::vector<double> m_box_scale;
+
+private:
+  ScaledRowSampler(const ScaledRowSampler&) = delete;
+  ScaledRowSampler& operator=(const ScaledRowSampler&) = delete;
+};
+
+} // namespace surf
+
+#endif
+
+/* EOF */
@@ -21,9 +21,11 @@
 #include <assert.h>
 #include <string.h>
 #include <memory>
+#include <type_traits>
 
 #include <fmt/format.h>
 
+#include "external_pixel_data.hpp"
 #include "fwd.hpp"
 #include "software_surface.hpp"
 
@@ -47,6 +49,7 @@ public:
   }
 
   void reset(SDL_Surface* surf) { destroy(); m_surf = surf; }
+  SDL_Surface* release() { return std::exchange(m_surf, nullptr); }
   SDL_Surface& operator*() const { return *m_surf; }
   SDL_Surface* get() const { return m_surf; }
   SDL_Surface* operator->() const { return m_surf; }
@@ -63,19 +66,51 @@ private:
   SDL_Surface* m_surf;
 };
 
+/** The SDL_PixelFormatEnum with the same memory layout as \a Pixel,
+    SDL_PIXELFORMAT_UNKNOWN when there is none */
+template<typename Pixel> constexpr
+uint32_t sdl_pixelformat()
+{
+  if constexpr (std::is_same<Pixel, RGB8Pixel>::value) {
+    return SDL_PIXELFORMAT_RGB24;
+  } else if constexpr (std::is_same<Pixel, RGBA8Pixel>::value) {
+    return SDL_PIXELFORMAT_RGBA32;
+  } else if constexpr (std::is_same<Pixel, BGR8Pixel>::value) {
+    return SDL_PIXELFORMAT_BGR24;
+  } else if constexpr (std::is_same<Pixel, BGRA8Pixel>::value) {
+    return SDL_PIXELFORMAT_BGRA32;
+  } else if constexpr (std::is_same<Pixel, ARGB8Pixel>::value) {
+    return SDL_PIXELFORMAT_ARGB32;
+  } else if constexpr (std::is_same<Pixel, RGB565Pixel>::value) {
+    return SDL_PIXELFORMAT_RGB565;
+  } else {
+    return SDL_PIXELFORMAT_UNKNOWN;
+  }
+}
+
 /** Create an SDL_Surface from PixelData without copying it */
 template<typename Pixel>
 SDLSurfacePtr create_sdl_surface_view(PixelData<Pixel>& pixeldata)
 {
-  SDL_Surface* surface = SDL_CreateRGBSurfaceFrom(pixeldata.get_data(),
-                                                  pixeldata.get_width(),
-                                                  pixeldata.get_height(),
-                                                  PPixelFormat<Pixel>::bits_per_pixel,
-                                                  pixeldata.get_row_length() * sizeof(Pixel),
-                                                  PPixelFormat<Pixel>::rmask,
-                                                  PPixelFormat<Pixel>::gmask,
-                                                  PPixelFormat<Pixel>::bmask,
-                                                  PPixelFormat<Pixel>::amask);
+  SDL_Surface* surface;
+  if constexpr (sdl_pixelformat<Pixel>() != SDL_PIXELFORMAT_UNKNOWN) {
+    surface = SDL_CreateRGBSurfaceWithFormatFrom(pixeldata.get_data(),
+                                                 pixeldata.get_width(),
+                                                 pixeldata.get_height(),
+                                                 PPixelFormat<Pixel>::bits_per_pixel,
+                                                 static_cast<int>(pixeldata.get_pitch()),
+                                                 sdl_pixelformat<Pixel>());
+  } else {
+    surface = SDL_CreateRGBSurfaceFrom(pixeldata.get_data(),
+                                       pixeldata.get_width(),
+                                       pixeldata.get_height(),
+                                       PPixelFormat<Pixel>::bits_per_pixel,
+                                       static_cast<int>(pixeldata.get_pitch()),
+                                       PPixelFormat<Pixel>::rmask,
+                                       PPixelFormat<Pixel>::gmask,
+                                       PPixelFormat<Pixel>::bmask,
+                                       PPixelFormat<Pixel>::amask);
+  }
   if (surface == nullptr) {
     std::ostringstream oss;
     oss << "SDL_Surface creation failed: " << SDL_GetError();
@@ -124,6 +159,19 @@ SDLSurfacePtr create_sdl_surface(PixelData<Pixel> const& pixeldata)
 template<typename Pixel>
 PixelData<Pixel> pixeldata_from_sdl_surface(SDL_Surface& surface)
 {
+  if (surface.format->format == sdl_pixelformat<Pixel>()) {
+    // same layout, a plain row copy is enough
+    PixelData<Pixel> pixeldata({surface.w, surface.h}, no_init);
+    SDL_LockSurface(&surface);
+    for (int y = 0; y < surface.h; ++y) {
+      memcpy(pixeldata.get_row(y),
+             static_cast<uint8_t const*>(surface.pixels) + static_cast<ptrdiff_t>(y) * surface.pitch,
+             static_cast<size_t>(surface.w) * sizeof(Pixel));
+    }
+    SDL_UnlockSurface(&surface);
+    return pixeldata;
+  }
+
   PixelData<Pixel> pixeldata({surface.w, surface.h});
   SDLSurfacePtr dst(create_sdl_surface_view(pixeldata));
   if (SDL_BlitSurface(&surface, nullptr, dst.get(), nullptr) != 0) {
@@ -134,20 +182,40 @@ PixelData<Pixel> pixeldata_from_sdl_surface(SDL_Surface& surface)
   return pixeldata;
 }
 
+namespace detail {
+
+template<typename Pixel>
+std::unique_ptr<IPixelData> pixelview_from_sdl_surface(SDL_Surface& surface)
+{
+  return std::make_unique<PixelView<Pixel>>(geom::isize(surface.w, surface.h),
+                                            static_cast<Pixel*>(surface.pixels),
+                                            surface.pitch / sizeof(Pixel));
+}
+
+} // namespace detail
+
 inline
 std::unique_ptr<IPixelData> pixelview_from_sdl_surface(SDL_Surface& surface)
 {
   switch (surface.format->format)
   {
     case SDL_PIXELFORMAT_RGB24:
-      return std::make_unique<PixelView<RGBPixel>>(geom::isize(surface.w, surface.h),
-                                                   static_cast<RGBPixel*>(surface.pixels),
-                                                   surface.pitch / sizeof(RGBPixel));
+      return detail::pixelview_from_sdl_surface<RGBPixel>(surface);
 
     case SDL_PIXELFORMAT_RGBA32:
-      return std::make_unique<PixelView<RGBAPixel>>(geom::isize(surface.w, surface.h),
-                                                    static_cast<RGBAPixel*>(surface.pixels),
-                                                    surface.pitch / sizeof(RGBAPixel));
+      return detail::pixelview_from_sdl_surface<RGBAPixel>(surface);
+
+    case SDL_PIXELFORMAT_BGR24:
+      return detail::pixelview_from_sdl_surface<BGR8Pixel>(surface);
+
+    case SDL_PIXELFORMAT_BGRA32:
+      return detail::pixelview_from_sdl_surface<BGRA8Pixel>(surface);
+
+    case SDL_PIXELFORMAT_ARGB32:
+      return detail::pixelview_from_sdl_surface<ARGB8Pixel>(surface);
+
+    case SDL_PIXELFORMAT_RGB565:
+      return detail::pixelview_from_sdl_surface<RGB565Pixel>(surface);
 
     default:
       throw std::runtime_error(fmt::format("unsupported SDL_PixelFormatEnum: {}", surface.format->format));
@@ -165,6 +233,18 @@ SoftwareSurface softwaresurface_from_sdl_surface(SDL_Surface& surface)
     case SDL_PIXELFORMAT_RGBA32:
       return SoftwareSurface(pixeldata_from_sdl_surface<RGBAPixel>(surface));
 
+    case SDL_PIXELFORMAT_BGR24:
+      return SoftwareSurface(pixeldata_from_sdl_surface<BGR8Pixel>(surface));
+
+    case SDL_PIXELFORMAT_BGRA32:
+      return SoftwareSurface(pixeldata_from_sdl_surface<BGRA8Pixel>(surface));
+
+    case SDL_PIXELFORMAT_ARGB32:
+      return SoftwareSurface(pixeldata_from_sdl_surface<ARGB8Pixel>(surface));
+
+    case SDL_PIXELFORMAT_RGB565:
+      return SoftwareSurface(pixeldata_from_sdl_surface<RGB565Pixel>(surface));
+
     default:
       throw std::runtime_error(fmt::format("unsupported SDL_PixelFormatEnum: {}", surface.format->format));
   }
@@ -176,6 +256,56 @@ SoftwareSurface softwaresurface_view_from_sdl_surface(SDL_Surface& surface)
   return SoftwareSurface(pixelview_from_sdl_surface(surface));
 }
 
+namespace detail {
+
+template<typename Pixel>
+SoftwareSurface adopt_sdl_surface(SDLSurfacePtr surface)
+{
+  if (SDL_MUSTLOCK(surface.get()) || surface->pitch % sizeof(Pixel) != 0) {
+    return SoftwareSurface(pixeldata_from_sdl_surface<Pixel>(*surface));
+  }
+
+  SDL_Surface* const sdl_surface = surface.release();
+  return SoftwareSurface(ExternalPixelData<Pixel>(geom::isize(sdl_surface->w, sdl_surface->h),
+                                                  static_cast<Pixel*>(sdl_surface->pixels),
+                                                  sdl_surface->pitch,
+                                                  [sdl_surface](void*) { SDL_FreeSurface(sdl_surface); }));
+}
+
+} // namespace detail
+
+/** Take ownership of \a surface without copying its pixels, it is
+    freed with SDL_FreeSurface() once the last SoftwareSurface
+    referencing it is gone. Surfaces that need locking or whose pitch
+    isn't a multiple of the pixel size are copied instead. */
+inline
+SoftwareSurface softwaresurface_adopt_sdl_surface(SDLSurfacePtr surface)
+{
+  switch (surface->format->format)
+  {
+    case SDL_PIXELFORMAT_RGB24:
+      return detail::adopt_sdl_surface<RGBPixel>(std::move(surface));
+
+    case SDL_PIXELFORMAT_RGBA32:
+      return detail::adopt_sdl_surface<RGBAPixel>(std::move(surface));
+
+    case SDL_PIXELFORMAT_BGR24:
+      return detail::adopt_sdl_surface<BGR8Pixel>(std::move(surface));
+
+    case SDL_PIXELFORMAT_BGRA32:
+      return detail::adopt_sdl_surface<BGRA8Pixel>(std::move(surface));
+
+    case SDL_PIXELFORMAT_ARGB32:
+      return detail::adopt_sdl_surface<ARGB8Pixel>(std::move(surface));
+
+    case SDL_PIXELFORMAT_RGB565:
+      return detail::adopt_sdl_surface<RGB565Pixel>(std::move(surface));
+
+    default:
+      throw std::runtime_error(fmt::format("unsupported SDL_PixelFormatEnum: {}", surface->format->format));
+  }
+}
+
 } // namespace surf
 
 #endif
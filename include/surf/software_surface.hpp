@@ -19,7 +19,9 @@
 
 #include <stdint.h>
 
+#include <cassert>
 #include <filesystem>
+#include <functional>
 #include <memory>
 
 #include <geom/fwd.hpp>
@@ -31,6 +33,14 @@
 
 namespace surf {
 
+/** SoftwareSurface shares owned pixel data between copies and only
+    duplicates it on the first mutable access (copy-on-write). Surfaces
+    that handed out a mutable pointer or reference, through get_data(),
+    get_row_data(), as_pixelview() or get_view(), are never shared
+    again, as later writes through it must not show up in copies.
+    Library code that writes through a pointer which does not outlive
+    the call uses get_row_data_detached() and as_pixelview_unchecked()
+    instead, which leave the surface shareable. */
 class SoftwareSurface
 {
 public:
@@ -38,6 +48,10 @@ public:
   static SoftwareSurface from_file(std::filesystem::path const& filename, std::string_view loader);
   static SoftwareSurface create(PixelFormat format, geom::isize const& size, Color const& color = {});
 
+  /** Create a surface with uninitialized pixels, for producers that
+      overwrite all of them */
+  static SoftwareSurface create(PixelFormat format, geom::isize const& size, NoInit);
+
   template<typename Pixel>
   static SoftwareSurface create_view(PixelView<Pixel>& data) {
     return SoftwareSurface(std::make_unique<PixelView<Pixel>>(data));
@@ -48,26 +62,49 @@ public:
     return SoftwareSurface(std::make_unique<PixelView<Pixel>>(data));
   }
 
-  static SoftwareSurface create_view(PixelFormat format, geom::isize const& size, void* ptr, int pitch);
-  static SoftwareSurface create_view(PixelFormat format, geom::isize const& size, void const* ptr, int pitch);
+  static SoftwareSurface create_view(PixelFormat format, geom::isize const& size, void* ptr, ptrdiff_t pitch);
+  static SoftwareSurface create_view(PixelFormat format, geom::isize const& size, void const* ptr, ptrdiff_t pitch);
+
+  /** Take ownership of \a ptr, \a deleter is called with \a ptr
+      once the last SoftwareSurface referencing it is gone, an empty
+      \a deleter throws std::invalid_argument */
+  static SoftwareSurface adopt(PixelFormat format, geom::isize const& size, void* ptr, ptrdiff_t pitch,
+                               std::function<void (void*)> deleter);
 
 public:
   SoftwareSurface();
   SoftwareSurface(SoftwareSurface const& other);
   SoftwareSurface(SoftwareSurface&& other) = default;
 
-  SoftwareSurface(std::unique_ptr<IPixelData> pixel_data) :
-    m_pixel_data(std::move(pixel_data))
-  {}
+  /** Throws std::invalid_argument unless \a pixel_data is a
+      PixelView<Pixel> matching its get_format(), which the unchecked
+      casts in as_pixelview_unchecked() and visit() rely on */
+  SoftwareSurface(std::unique_ptr<IPixelData> pixel_data);
 
   template<typename Pixel>
   explicit SoftwareSurface(PixelData<Pixel> data) :
-    m_pixel_data(std::make_unique<PixelData<Pixel>>(std::move(data)))
+    m_pixel_data(std::make_shared<PixelData<Pixel>>(std::move(data))),
+    m_shareable(true)
+  {}
+
+  /** Takes ownership of the external buffer, see external_pixel_data.hpp */
+  template<typename Pixel>
+  explicit SoftwareSurface(ExternalPixelData<Pixel>&& data) :
+    m_pixel_data(std::make_shared<ExternalPixelData<Pixel>>(std::move(data))),
+    m_shareable(true)
+  {}
+
+  /** Takes ownership of the mapping, see mapped_pixel_data.hpp */
+  template<typename Pixel>
+  explicit SoftwareSurface(MappedPixelData<Pixel>&& data) :
+    m_pixel_data(std::make_shared<MappedPixelData<Pixel>>(std::move(data))),
+    m_shareable(true)
   {}
 
   template<typename Pixel>
   explicit SoftwareSurface(PixelView<Pixel> const& data) :
-    m_pixel_data(std::make_unique<PixelData<Pixel>>(data))
+    m_pixel_data(std::make_shared<PixelData<Pixel>>(data)),
+    m_shareable(true)
   {}
 
   SoftwareSurface& operator=(SoftwareSurface const& other);
@@ -76,15 +113,23 @@ public:
   geom::isize get_size() const;
   int get_width() const;
   int get_height() const;
-  int get_pitch() const;
+  ptrdiff_t get_pitch() const;
   PixelFormat get_format() const;
 
   Color get_pixel(geom::ipoint const& position) const;
   void put_pixel(geom::ipoint const& position, Color const& color);
 
+  void read_row_colors(int y, int x, int count, Color* out) const;
+  void write_row_colors(int y, int x, int count, Color const* in);
+
   void* get_data();
   void* get_row_data(int y);
 
+  /** Like get_row_data(), but the surface stays shareable, the
+      pointer must not be used after the call that requested it
+      returns or after the surface is copied */
+  void* get_row_data_detached(int y);
+
   void const* get_data() const;
   void const* get_row_data(int y) const;
 
@@ -102,17 +147,57 @@ public:
 
   template<typename Pixel>
   PixelView<Pixel>& as_pixelview() {
+    detach();
+    m_shareable = false;
     return dynamic_cast<PixelView<Pixel>&>(*m_pixel_data);
   }
 
+  /** Like as_pixelview(), but without the RTTI check, \a Pixel must
+      match get_format(). The mutable overload leaves the surface
+      shareable, like get_row_data_detached(), so the reference must
+      not outlive the call that requested it. */
+  template<typename Pixel>
+  PixelView<Pixel> const& as_pixelview_unchecked() const {
+    assert(get_format() == PPixelFormat<Pixel>::format);
+    return static_cast<PixelView<Pixel> const&>(*m_pixel_data);
+  }
+
+  template<typename Pixel>
+  PixelView<Pixel>& as_pixelview_unchecked() {
+    assert(get_format() == PPixelFormat<Pixel>::format);
+    detach();
+    return static_cast<PixelView<Pixel>&>(*m_pixel_data);
+  }
+
   bool operator==(SoftwareSurface const& rhs) const {
     return *m_pixel_data == *rhs.m_pixel_data;
   }
 
-  SoftwareSurface get_view(geom::irect const& rect) const;
+  /** Returns a view into \a rect of the pixel data, writes through it
+      show up in this surface, but not in its copies */
+  SoftwareSurface get_view(geom::irect const& rect);
+
+  /** Returns a read-only view into \a rect, the surface itself is left
+      untouched, so it can be called from multiple threads. The view
+      keeps the pixels alive and shows them as they were when it was
+      taken, later writes to this surface or its copies go to a copy.
+      Copying the view copies the pixels. */
+  SoftwareSurface const get_view(geom::irect const& rect) const;
+
+  /** Returns true if the pixel data is currently shared with another
+      SoftwareSurface */
+  bool is_shared() const { return m_pixel_data.use_count() > 1; }
 
 private:
-  std::unique_ptr<IPixelData> m_pixel_data;
+  /** Give this surface its own copy of the pixel data if it is shared */
+  void detach();
+
+private:
+  std::shared_ptr<IPixelData> m_pixel_data;
+
+  /** false once a view, mutable pointer or reference into the pixel
+      data was handed out */
+  bool m_shareable;
 };
 
 void blit(SoftwareSurface const& src, SoftwareSurface& dst, geom::ipoint const& pos);
@@ -121,14 +206,28 @@ void blit(SoftwareSurface const& src, geom::irect const& srcrect, SoftwareSurfac
 void blend_scaled(BlendFunc blendfunc, SoftwareSurface const& src, SoftwareSurface& dst, geom::irect const& dstrect);
 void blend_scaled(BlendFunc blendfunc, SoftwareSurface const& src, geom::irect const& srcrect, SoftwareSurface& dst, geom::irect const& dstrect);
 
+/** Scaled blend with the source sampled by \a filter instead of
+    ScaleFilter::NEAREST */
+void blend_scaled(BlendFunc blendfunc, SoftwareSurface const& src, SoftwareSurface& dst, geom::irect const& dstrect, ScaleFilter filter);
+void blend_scaled(BlendFunc blendfunc, SoftwareSurface const& src, geom::irect const& srcrect, SoftwareSurface& dst, geom::irect const& dstrect, ScaleFilter filter);
+
 void blend(BlendFunc blendfunc, SoftwareSurface const& src, SoftwareSurface& dst, geom::ipoint const& pos);
 void blend(BlendFunc blendfunc, SoftwareSurface const& src, geom::irect const& srcrect, SoftwareSurface& dst, geom::ipoint const& pos);
 
+/** With Gamma::LINEAR both surfaces are decoded from sRGB to linear
+    light RGBA16 a row at a time, blended and encoded back */
+void blend(BlendFunc blendfunc, SoftwareSurface const& src, SoftwareSurface& dst, geom::ipoint const& pos, Gamma gamma);
+void blend(BlendFunc blendfunc, SoftwareSurface const& src, geom::irect const& srcrect, SoftwareSurface& dst, geom::ipoint const& pos, Gamma gamma);
+
 void fill(SoftwareSurface& dst, Color const& color);
 void fill_rect(SoftwareSurface& dst, geom::irect const& rect, Color const& color);
 
 SoftwareSurface convert(SoftwareSurface const& src, PixelFormat format);
 
+/** Convert \a src into the caller provided \a dst, which keeps its
+    format, the sizes have to match */
+void convert_into(SoftwareSurface const& src, SoftwareSurface& dst);
+
 } // namespace surf
 
 #endif
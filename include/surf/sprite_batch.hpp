@@ -0,0 +1,92 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SURF_SPRITE_BATCH_HPP
+#define HEADER_SURF_SPRITE_BATCH_HPP
+
+#include <stddef.h>
+
+#include <vector>
+
+#include <geom/rect.hpp>
+
+#include "blendfunc.hpp"
+#include "fwd.hpp"
+#include "scale_filter.hpp"
+
+namespace surf {
+
+/** A list of draws onto one destination, rendered together with
+    render(). Each draw gets its kernel looked up and is clipped once,
+    the destination is then processed in bands of rows, each band
+    running the draws that touch it in the order they were added. The
+    result is the same as issuing the draws one by one with blit(),
+    blend() and blend_scaled(), but the rows of a band stay in cache
+    while thousands of small sprites land on them, and the bands can
+    be rendered on multiple threads.
+
+    Only pointers to the source surfaces are stored, they must stay
+    alive and unchanged until render() returns. */
+class SpriteBatch
+{
+public:
+  static constexpr int DEFAULT_BAND_HEIGHT = 64;
+
+  struct Draw
+  {
+    SoftwareSurface const* src;
+    geom::irect srcrect;
+    geom::irect dstrect;
+    BlendFunc blendfunc;
+    ScaleFilter filter;
+    bool scaled;
+  };
+
+public:
+  explicit SpriteBatch(int band_height = DEFAULT_BAND_HEIGHT);
+
+  void blit(SoftwareSurface const& src, geom::ipoint const& pos);
+  void blit(SoftwareSurface const& src, geom::irect const& srcrect, geom::ipoint const& pos);
+
+  void blend(BlendFunc blendfunc, SoftwareSurface const& src, geom::ipoint const& pos);
+  void blend(BlendFunc blendfunc, SoftwareSurface const& src, geom::irect const& srcrect, geom::ipoint const& pos);
+
+  void blend_scaled(BlendFunc blendfunc, SoftwareSurface const& src, geom::irect const& dstrect,
+                    ScaleFilter filter = ScaleFilter::NEAREST);
+  void blend_scaled(BlendFunc blendfunc, SoftwareSurface const& src, geom::irect const& srcrect,
+                    geom::irect const& dstrect, ScaleFilter filter = ScaleFilter::NEAREST);
+
+  /** Run all draws on \a dst, on up to \a threads threads, zero picks
+      one per hardware thread. Throws std::invalid_argument before
+      touching \a dst if a draw has no kernel for its formats. */
+  void render(SoftwareSurface& dst, unsigned int threads = 1) const;
+
+  std::vector<Draw> const& get_draws() const { return m_draws; }
+  size_t size() const { return m_draws.size(); }
+  bool empty() const { return m_draws.empty(); }
+  void clear() { m_draws.clear(); }
+
+private:
+  int m_band_height;
+  std::vector<Draw> m_draws;
+};
+
+} // namespace surf
+
+#endif
+
+/* EOF */
@@ -0,0 +1,232 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SURF_SRGB_HPP
+#define HEADER_SURF_SRGB_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <type_traits>
+
+#include "convert.hpp"
+#include "kernel_registry.hpp"
+#include "pixel.hpp"
+
+namespace surf {
+
+/** Whether operations that mix pixels, like halve(), scale() and
+    blend(), work on the stored gamma encoded values or decode them
+    from sRGB to linear light first */
+enum class Gamma
+{
+  ENCODED,
+  LINEAR
+};
+
+/** The exact sRGB transfer functions for values in [0, 1], slow, the
+    SRGBLut is used for the bulk work */
+inline float srgb_to_linear(float v)
+{
+  return v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+}
+
+inline float linear_to_srgb(float v)
+{
+  return v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.0f / 2.4f) - 0.055f;
+}
+
+/** Table driven sRGB <-> linear light conversion with 16-bit linear
+    values. 8-bit input is a direct 256 entry lookup, 16-bit input and
+    the encoding direction use 4096 entry tables with linear
+    interpolation. 8-bit values survive the round trip unchanged. */
+class SRGBLut
+{
+public:
+  using Kernel = void (*)(SRGBLut const& lut, void const* src, void* dst, size_t count);
+
+  static SRGBLut const& instance();
+
+public:
+  uint16_t decode(uint8_t v) const { return static_cast<uint16_t>(m_decode8[v]); }
+  uint16_t decode(uint16_t v) const { return interpolate(m_decode16, v); }
+
+  uint16_t encode(uint16_t v) const { return interpolate(m_encode, v); }
+  uint8_t encode8(uint16_t v) const { return static_cast<uint8_t>((encode(v) + 128) / 257); }
+
+  /** Whole RGBA8 spans, using SIMD kernels when the CPU has them */
+  void decode_n(RGBA8Pixel const* src, RGBA16Pixel* dst, size_t count) const;
+  void encode_n(RGBA16Pixel const* src, RGBA8Pixel* dst, size_t count) const;
+
+  /** Raw tables for the SIMD kernels, the encode table is indexed by
+      the linear value >> 4 and has one extra entry at the end */
+  uint32_t const* get_decode8_table() const { return m_decode8.data(); }
+  uint32_t const* get_encode_table() const { return m_encode.data(); }
+
+private:
+  SRGBLut();
+
+  static uint16_t interpolate(std::array<uint32_t, 4097> const& table, uint16_t v) {
+    uint32_t const lo = table[v >> 4];
+    uint32_t const hi = table[(v >> 4) + 1];
+    return static_cast<uint16_t>(std::min<uint32_t>(lo + (((hi - lo) * (v & 15u) + 8) >> 4), 65535));
+  }
+
+private:
+  // uint32_t entries so SIMD gathers can read them directly
+  std::array<uint32_t, 256> m_decode8;
+  std::array<uint32_t, 4097> m_decode16;
+  std::array<uint32_t, 4097> m_encode;
+
+  Kernel m_decode_rgba8;
+  Kernel m_encode_rgba8;
+
+private:
+  SRGBLut(const SRGBLut&) = delete;
+  SRGBLut& operator=(const SRGBLut&) = delete;
+};
+
+namespace detail {
+
+template<typename T> inline
+uint16_t srgb_decode(SRGBLut const& lut, T v)
+{
+  if constexpr (std::is_floating_point<T>::value) {
+    return static_cast<uint16_t>(srgb_to_linear(std::clamp<float>(v, 0.0f, 1.0f)) * 65535.0f + 0.5f);
+  } else if constexpr (sizeof(T) == 4) {
+    return lut.decode(static_cast<uint16_t>(v >> 16));
+  } else {
+    return lut.decode(v);
+  }
+}
+
+template<typename T> inline
+T srgb_encode(SRGBLut const& lut, uint16_t v)
+{
+  if constexpr (std::is_floating_point<T>::value) {
+    return static_cast<T>(linear_to_srgb(static_cast<float>(v) / 65535.0f));
+  } else if constexpr (sizeof(T) == 1) {
+    return lut.encode8(v);
+  } else if constexpr (sizeof(T) == 2) {
+    return lut.encode(v);
+  } else {
+    return lut.encode(v) * 65537u;
+  }
+}
+
+/** Alpha isn't gamma encoded, only the depth changes */
+template<typename T> inline
+uint16_t to_unorm16(T v)
+{
+  if constexpr (std::is_floating_point<T>::value) {
+    return static_cast<uint16_t>(std::clamp<float>(v, 0.0f, 1.0f) * 65535.0f + 0.5f);
+  } else if constexpr (sizeof(T) == 1) {
+    return static_cast<uint16_t>(v * 257);
+  } else if constexpr (sizeof(T) == 2) {
+    return v;
+  } else {
+    return static_cast<uint16_t>(v >> 16);
+  }
+}
+
+template<typename T> inline
+T from_unorm16(uint16_t v)
+{
+  if constexpr (std::is_floating_point<T>::value) {
+    return static_cast<T>(v) / static_cast<T>(65535);
+  } else if constexpr (sizeof(T) == 1) {
+    return static_cast<T>((v + 128) / 257);
+  } else if constexpr (sizeof(T) == 2) {
+    return v;
+  } else {
+    return v * 65537u;
+  }
+}
+
+} // namespace detail
+
+/** Decode a sRGB pixel to straight alpha linear light RGBA16, float
+    values outside of [0, 1] are clamped */
+template<typename Pixel> inline
+RGBA16Pixel srgb_decode(SRGBLut const& lut, Pixel pixel)
+{
+  if constexpr (is_premultiplied<Pixel>::value) {
+    return srgb_decode(lut, convert<Pixel, tRGBAPixel<typename Pixel::value_type>>(pixel));
+  } else {
+    return {detail::srgb_decode(lut, red(pixel)),
+            detail::srgb_decode(lut, green(pixel)),
+            detail::srgb_decode(lut, blue(pixel)),
+            detail::to_unorm16(alpha(pixel))};
+  }
+}
+
+template<typename Pixel> inline
+Pixel srgb_encode(SRGBLut const& lut, RGBA16Pixel pixel)
+{
+  using type = typename Pixel::value_type;
+
+  if constexpr (is_premultiplied<Pixel>::value) {
+    return convert<tRGBAPixel<type>, Pixel>(srgb_encode<tRGBAPixel<type>>(lut, pixel));
+  } else {
+    return make_pixel<Pixel>(detail::srgb_encode<type>(lut, pixel.r),
+                             detail::srgb_encode<type>(lut, pixel.g),
+                             detail::srgb_encode<type>(lut, pixel.b),
+                             detail::from_unorm16<type>(pixel.a));
+  }
+}
+
+template<typename Pixel>
+void srgb_decode_n(Pixel const* src, RGBA16Pixel* dst, size_t count)
+{
+  SRGBLut const& lut = SRGBLut::instance();
+
+  if constexpr (std::is_same<Pixel, RGBA8Pixel>::value) {
+    lut.decode_n(src, dst, count);
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      dst[i] = srgb_decode(lut, src[i]);
+    }
+  }
+}
+
+template<typename Pixel>
+void srgb_encode_n(RGBA16Pixel const* src, Pixel* dst, size_t count)
+{
+  SRGBLut const& lut = SRGBLut::instance();
+
+  if constexpr (std::is_same<Pixel, RGBA8Pixel>::value) {
+    lut.encode_n(src, dst, count);
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      dst[i] = srgb_encode<Pixel>(lut, src[i]);
+    }
+  }
+}
+
+/** Type erased srgb_decode_n() and srgb_encode_n() for \a format,
+    the linear side is always RGBA16 */
+SpanKernel srgb_decode_kernel(PixelFormat format);
+SpanKernel srgb_encode_kernel(PixelFormat format);
+
+} // namespace surf
+
+#endif
+
+/* EOF */
@@ -18,26 +18,49 @@
 #define HEADER_SURF_SURF_HPP
 
 #include "blend.hpp"
+#include "blendmode.hpp"
 #include "blit.hpp"
 #include "color.hpp"
 #include "convert.hpp"
+#include "convert_span.hpp"
+#include "external_pixel_data.hpp"
 #include "fill.hpp"
 #include "filter.hpp"
+#include "fixed_point.hpp"
 #include "fwd.hpp"
+#include "half.hpp"
 #include "io.hpp"
 #include "ipixel_data.hpp"
+#include "kernel_registry.hpp"
 #include "palette.hpp"
+#include "pixel_allocator.hpp"
 #include "pixel_data.hpp"
 #include "pixel_format.hpp"
 #include "pixel.hpp"
 #include "pixel_view.hpp"
+#include "planar_pixel_data.hpp"
+#include "row_converter.hpp"
 #include "save.hpp"
+#include "scale_filter.hpp"
 #include "software_surface_factory.hpp"
 #include "software_surface.hpp"
 #include "software_surface_loader.hpp"
+#include "sprite_batch.hpp"
+#include "srgb.hpp"
 #include "surf.hpp"
+#include "surface_pool.hpp"
+#include "tiled_pixel_data.hpp"
 #include "transform.hpp"
 #include "unwrap.hpp"
+#include "visit.hpp"
+
+// only built on UNIX, see CMakeLists.txt
+#ifndef _WIN32
+#  include "mapped_pixel_data.hpp"
+#  include "memory_mapping.hpp"
+#  include "out_of_core_pixel_data.hpp"
+#  include "tile_store.hpp"
+#endif
 
 #endif
 
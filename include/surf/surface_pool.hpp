@@ -0,0 +1,105 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_SURFACE_POOL_HPP
+#define HEADER_SURF_SURFACE_POOL_HPP
+
+#include <stddef.h>
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "pixel_allocator.hpp"
+
+namespace surf {
+
+/** A thread-safe cache of pixel buffers. Freed buffers are kept in
+    per size-class free lists and handed out again to later
+    allocations of a similar size, up to a budget of idle bytes.
+
+    PixelData draws from the pool that is active on the current thread
+    at construction time, see SurfacePoolScope, and returns its buffer
+    to that same pool when destroyed, regardless of the thread. The
+    pool must outlive all PixelData allocated from it. */
+class SurfacePool
+{
+public:
+  struct Stats
+  {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t recycled = 0;
+    size_t released = 0;
+    size_t cached_bytes = 0;
+    size_t cached_buffers = 0;
+  };
+
+public:
+  /** Buffers are only cached as long as the total size of idle
+      buffers stays below \a budget bytes */
+  SurfacePool(size_t budget);
+  ~SurfacePool();
+
+  void* allocate(size_t bytes);
+  void deallocate(void* ptr, size_t bytes) noexcept;
+
+  /** Free all idle buffers */
+  void trim();
+
+  void set_budget(size_t budget);
+  size_t get_budget() const;
+
+  Stats get_stats() const;
+
+  /** The number of bytes actually allocated for a request of \a bytes */
+  static size_t size_class(size_t bytes);
+
+private:
+  void trim_to(size_t budget);
+
+private:
+  mutable std::mutex m_mutex;
+  size_t m_budget;
+  std::unordered_map<size_t, std::vector<void*>> m_free_lists;
+  Stats m_stats;
+
+private:
+  SurfacePool(const SurfacePool&) = delete;
+  SurfacePool& operator=(const SurfacePool&) = delete;
+};
+
+/** Makes \a pool the pool used by PixelData allocations on the
+    current thread for the lifetime of the scope, scopes nest */
+class SurfacePoolScope
+{
+public:
+  SurfacePoolScope(SurfacePool& pool);
+  ~SurfacePoolScope();
+
+private:
+  SurfacePool* m_previous;
+
+private:
+  SurfacePoolScope(const SurfacePoolScope&) = delete;
+  SurfacePoolScope& operator=(const SurfacePoolScope&) = delete;
+};
+
+} // namespace surf
+
+#endif
+
+/* EOF */
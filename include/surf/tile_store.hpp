@@ -0,0 +1,118 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_TILE_STORE_HPP
+#define HEADER_SURF_TILE_STORE_HPP
+
+#include <stddef.h>
+
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <vector>
+
+namespace surf {
+
+/** A fixed number of equally sized tiles kept in an unlinked scratch
+    file, paged in through a bounded LRU cache. Modified tiles are
+    written back when they get evicted or on flush(). Tiles that were
+    never written out read back as a copy of the initial tile.
+
+    Tiles are pinned while locked and never evicted while pinned, so
+    the cache can exceed its budget by the number of tiles locked at
+    the same time, until the next lock() evicts them. All functions
+    are thread-safe. */
+class TileStore
+{
+public:
+  struct Stats
+  {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t writebacks = 0;
+    size_t resident_bytes = 0;
+    size_t resident_tiles = 0;
+  };
+
+public:
+  /** Create a store of \a tile_count tiles of \a tile_bytes each,
+      every tile starts out as a copy of \a initial_tile. At most
+      \a cache_budget bytes of tiles are kept in memory. The scratch
+      file is created in \a scratch_dir and removed on destruction. */
+  TileStore(size_t tile_bytes, size_t tile_count,
+            void const* initial_tile, size_t cache_budget,
+            std::filesystem::path const& scratch_dir = std::filesystem::temp_directory_path());
+  ~TileStore();
+
+  /** Page the tile in and pin it, with \a write the tile is marked
+      dirty. The returned memory stays valid until unlock(). Errors
+      writing back evicted tiles are thrown from here, the tiles stay
+      resident and dirty. */
+  void* lock(size_t index, bool write);
+
+  /** Unpin the tile, never evicts or throws, so it is safe to call
+      from destructors */
+  void unlock(size_t index) noexcept;
+
+  /** Write all dirty tiles back to the scratch file */
+  void flush();
+
+  /** Evict unpinned tiles until the cache fits into \a budget bytes */
+  void set_cache_budget(size_t budget);
+  size_t get_cache_budget() const;
+
+  size_t get_tile_bytes() const { return m_tile_bytes; }
+  size_t get_tile_count() const { return m_tile_count; }
+
+  Stats get_stats() const;
+
+private:
+  struct Entry
+  {
+    std::byte* data = nullptr;
+    bool dirty = false;
+    bool on_disk = false;
+    int pins = 0;
+    std::list<size_t>::iterator lru;
+  };
+
+  void evict_to(size_t budget);
+  void write_back(size_t index, Entry& entry);
+  void read_in(size_t index, Entry& entry);
+
+private:
+  mutable std::mutex m_mutex;
+  size_t m_tile_bytes;
+  size_t m_tile_count;
+  size_t m_cache_budget;
+  int m_fd;
+  std::vector<std::byte> m_initial_tile;
+  std::vector<Entry> m_entries;
+
+  /** Resident tiles, most recently used first */
+  std::list<size_t> m_lru;
+  Stats m_stats;
+
+private:
+  TileStore(const TileStore&) = delete;
+  TileStore& operator=(const TileStore&) = delete;
+};
+
+} // namespace surf
+
+#endif
+
+/* EOF */
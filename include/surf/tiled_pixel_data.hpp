@@ -0,0 +1,408 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_TILED_PIXEL_DATA_HPP
+#define HEADER_SURF_TILED_PIXEL_DATA_HPP
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <geom/rect.hpp>
+
+#include "algorithm.hpp"
+#include "blit.hpp"
+#include "fill.hpp"
+#include "pixel_data.hpp"
+
+namespace surf {
+
+/** Pixel storage split into square tiles of TILE_SIZE x TILE_SIZE
+    pixels, kept in a row-major tile directory. Tiles are reference
+    counted and shared between copies, a tile is only duplicated when
+    it is written to. Edge tiles are allocated at full size, the part
+    outside of the image is padding and never read. */
+template<typename Pixel>
+class TiledPixelData
+{
+public:
+  using value_type = Pixel;
+  using Tile = PixelData<Pixel>;
+
+  static constexpr int TILE_SHIFT = 6;
+  static constexpr int TILE_SIZE = 1 << TILE_SHIFT;
+  static constexpr int TILE_MASK = TILE_SIZE - 1;
+
+public:
+  TiledPixelData() :
+    m_size(0, 0),
+    m_tiles_x(0),
+    m_tiles_y(0),
+    m_tiles()
+  {}
+
+  /** All tiles start out sharing a single filled tile */
+  TiledPixelData(geom::isize const& size, Pixel const& pixel = {}) :
+    m_size(size),
+    m_tiles_x((size.width() + TILE_MASK) >> TILE_SHIFT),
+    m_tiles_y((size.height() + TILE_MASK) >> TILE_SHIFT),
+    m_tiles()
+  {
+    if (m_tiles_x * m_tiles_y > 0) {
+      m_tiles.assign(static_cast<size_t>(m_tiles_x) * m_tiles_y, make_tile(pixel));
+    }
+  }
+
+  explicit TiledPixelData(PixelView<Pixel> const& src) :
+    m_size(src.get_size()),
+    m_tiles_x((m_size.width() + TILE_MASK) >> TILE_SHIFT),
+    m_tiles_y((m_size.height() + TILE_MASK) >> TILE_SHIFT),
+    m_tiles(static_cast<size_t>(m_tiles_x) * m_tiles_y)
+  {
+    for (int ty = 0; ty < m_tiles_y; ++ty) {
+      for (int tx = 0; tx < m_tiles_x; ++tx) {
+        geom::irect const rect = get_tile_rect(tx, ty);
+        std::shared_ptr<Tile> tile = make_tile(Pixel{});
+        blit(src, rect, *tile, geom::ipoint(0, 0));
+        m_tiles[static_cast<size_t>(ty) * m_tiles_x + tx] = std::move(tile);
+      }
+    }
+  }
+
+  PixelData<Pixel> to_pixeldata() const
+  {
+    PixelData<Pixel> dst(m_size, no_init);
+    for (int ty = 0; ty < m_tiles_y; ++ty) {
+      for (int tx = 0; tx < m_tiles_x; ++tx) {
+        geom::irect const rect = get_tile_rect(tx, ty);
+        blit(get_tile(tx, ty), geom::irect(rect.size()), dst, rect.topleft());
+      }
+    }
+    return dst;
+  }
+
+  geom::isize get_size() const { return m_size; }
+  int get_width() const { return m_size.width(); }
+  int get_height() const { return m_size.height(); }
+  bool empty() const { return m_tiles.empty(); }
+
+  int get_tiles_x() const { return m_tiles_x; }
+  int get_tiles_y() const { return m_tiles_y; }
+
+  /** The area covered by the given tile in image coordinates,
+      clipped to the image */
+  geom::irect get_tile_rect(int tx, int ty) const {
+    return geom::irect(tx * TILE_SIZE, ty * TILE_SIZE,
+                       std::min((tx + 1) * TILE_SIZE, m_size.width()),
+                       std::min((ty + 1) * TILE_SIZE, m_size.height()));
+  }
+
+  PixelView<Pixel> const& get_tile(int tx, int ty) const {
+    return *m_tiles[static_cast<size_t>(ty) * m_tiles_x + tx];
+  }
+
+  /** Mutable access, detaches the tile if it is shared */
+  PixelView<Pixel>& get_tile(int tx, int ty) {
+    std::shared_ptr<Tile>& tile = m_tiles[static_cast<size_t>(ty) * m_tiles_x + tx];
+    if (tile.use_count() > 1) {
+      tile = std::make_shared<Tile>(*tile);
+    }
+    return *tile;
+  }
+
+  bool is_tile_shared(int tx, int ty) const {
+    return m_tiles[static_cast<size_t>(ty) * m_tiles_x + tx].use_count() > 1;
+  }
+
+  /** Make the tile at \a tx, \a ty share its pixels with \a other */
+  void share_tile(int tx, int ty, TiledPixelData<Pixel> const& other, int other_tx, int other_ty) {
+    m_tiles[static_cast<size_t>(ty) * m_tiles_x + tx] =
+      other.m_tiles[static_cast<size_t>(other_ty) * other.m_tiles_x + other_tx];
+  }
+
+  /** Replace the tile at \a tx, \a ty with a tile filled with \a pixel */
+  void fill_tile(int tx, int ty, Pixel const& pixel) {
+    m_tiles[static_cast<size_t>(ty) * m_tiles_x + tx] = make_tile(pixel);
+  }
+
+  Pixel get_pixel(geom::ipoint const& pos) const {
+    assert(geom::contains(m_size, pos));
+    return get_tile(pos.x() >> TILE_SHIFT, pos.y() >> TILE_SHIFT)
+      .get_pixel(geom::ipoint(pos.x() & TILE_MASK, pos.y() & TILE_MASK));
+  }
+
+  void put_pixel(geom::ipoint const& pos, Pixel const& pixel) {
+    assert(geom::contains(m_size, pos));
+    get_tile(pos.x() >> TILE_SHIFT, pos.y() >> TILE_SHIFT)
+      .put_pixel(geom::ipoint(pos.x() & TILE_MASK, pos.y() & TILE_MASK), pixel);
+  }
+
+  bool operator==(TiledPixelData<Pixel> const& rhs) const {
+    if (m_size != rhs.m_size) {
+      return false;
+    }
+
+    for (int ty = 0; ty < m_tiles_y; ++ty) {
+      for (int tx = 0; tx < m_tiles_x; ++tx) {
+        PixelView<Pixel> const& lhs_tile = get_tile(tx, ty);
+        PixelView<Pixel> const& rhs_tile = rhs.get_tile(tx, ty);
+        if (&lhs_tile == &rhs_tile) {
+          continue;
+        }
+
+        geom::irect const rect = get_tile_rect(tx, ty);
+        for (int y = 0; y < rect.height(); ++y) {
+          if (!std::equal(lhs_tile.get_row(y), lhs_tile.get_row(y) + rect.width(), rhs_tile.get_row(y))) {
+            return false;
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+  bool operator!=(TiledPixelData<Pixel> const& rhs) const {
+    return !(*this == rhs);
+  }
+
+private:
+  static std::shared_ptr<Tile> make_tile(Pixel const& pixel) {
+    return std::make_shared<Tile>(geom::isize(TILE_SIZE, TILE_SIZE), pixel);
+  }
+
+private:
+  geom::isize m_size;
+  int m_tiles_x;
+  int m_tiles_y;
+  std::vector<std::shared_ptr<Tile>> m_tiles;
+};
+
+/** Calls \a f(PixelView<Pixel>& view, geom::ipoint const& origin) for
+    each tile, \a view is clipped to the image and \a origin is its
+    position in the image. Tiles don't overlap, so \a f can safely be
+    dispatched to multiple threads. */
+template<typename Pixel, typename TileFunction>
+void for_each_tile(TiledPixelData<Pixel>& dst, TileFunction f)
+{
+  for (int ty = 0; ty < dst.get_tiles_y(); ++ty) {
+    for (int tx = 0; tx < dst.get_tiles_x(); ++tx) {
+      geom::irect const rect = dst.get_tile_rect(tx, ty);
+      PixelView<Pixel> view = dst.get_tile(tx, ty).get_view(geom::irect(rect.size()));
+      f(view, rect.topleft());
+    }
+  }
+}
+
+template<typename Pixel, typename TileFunction>
+void for_each_tile(TiledPixelData<Pixel> const& src, TileFunction f)
+{
+  for (int ty = 0; ty < src.get_tiles_y(); ++ty) {
+    for (int tx = 0; tx < src.get_tiles_x(); ++tx) {
+      geom::irect const rect = src.get_tile_rect(tx, ty);
+      PixelView<Pixel> const& tile = src.get_tile(tx, ty);
+      PixelView<Pixel> const view(rect.size(), tile.get_row(0), tile.get_row_length());
+      f(view, rect.topleft());
+    }
+  }
+}
+
+template<typename Pixel, typename UnaryFunction>
+void for_each_pixel(TiledPixelData<Pixel>& dst, UnaryFunction f)
+{
+  for_each_tile(dst, [&f](PixelView<Pixel>& view, geom::ipoint const& /*origin*/) {
+    for_each_pixel(view, f);
+  });
+}
+
+template<typename Pixel>
+void fill_rect(TiledPixelData<Pixel>& dst, geom::irect const& rect, Pixel const& pixel)
+{
+  geom::irect const region = geom::intersection(geom::irect(dst.get_size()), rect);
+  if (region.width() <= 0 || region.height() <= 0) {
+    return;
+  }
+
+  for (int ty = region.top() >> TiledPixelData<Pixel>::TILE_SHIFT;
+       ty <= (region.bottom() - 1) >> TiledPixelData<Pixel>::TILE_SHIFT; ++ty) {
+    for (int tx = region.left() >> TiledPixelData<Pixel>::TILE_SHIFT;
+         tx <= (region.right() - 1) >> TiledPixelData<Pixel>::TILE_SHIFT; ++tx) {
+      geom::irect const tile_rect = dst.get_tile_rect(tx, ty);
+      geom::irect const tile_region = geom::intersection(tile_rect, region);
+
+      if (tile_region == tile_rect) {
+        // covers the whole tile, no need to copy or touch the old one
+        dst.fill_tile(tx, ty, pixel);
+      } else {
+        fill_rect(dst.get_tile(tx, ty),
+                  tile_region + geom::ioffset(-tile_rect.left(), -tile_rect.top()),
+                  pixel);
+      }
+    }
+  }
+}
+
+template<typename Pixel>
+void fill(TiledPixelData<Pixel>& dst, Pixel const& pixel)
+{
+  fill_rect(dst, geom::irect(dst.get_size()), pixel);
+}
+
+template<typename SrcPixel, typename DstPixel>
+void blit(PixelView<SrcPixel> const& src, TiledPixelData<DstPixel>& dst, geom::ipoint const& pos)
+{
+  using Tiled = TiledPixelData<DstPixel>;
+
+  geom::irect const region = geom::intersection(geom::irect(pos, src.get_size()),
+                                                geom::irect(dst.get_size()));
+  if (region.width() <= 0 || region.height() <= 0) {
+    return;
+  }
+
+  for (int ty = region.top() >> Tiled::TILE_SHIFT; ty <= (region.bottom() - 1) >> Tiled::TILE_SHIFT; ++ty) {
+    for (int tx = region.left() >> Tiled::TILE_SHIFT; tx <= (region.right() - 1) >> Tiled::TILE_SHIFT; ++tx) {
+      geom::irect const tile_rect = dst.get_tile_rect(tx, ty);
+      geom::irect const tile_region = geom::intersection(tile_rect, region);
+
+      blit(src, tile_region + geom::ioffset(-pos.x(), -pos.y()),
+           dst.get_tile(tx, ty),
+           geom::ipoint(tile_region.left() - tile_rect.left(), tile_region.top() - tile_rect.top()));
+    }
+  }
+}
+
+template<typename SrcPixel, typename DstPixel>
+void blit(TiledPixelData<SrcPixel> const& src, PixelView<DstPixel>& dst, geom::ipoint const& pos)
+{
+  for (int ty = 0; ty < src.get_tiles_y(); ++ty) {
+    for (int tx = 0; tx < src.get_tiles_x(); ++tx) {
+      geom::irect const rect = src.get_tile_rect(tx, ty);
+      blit(src.get_tile(tx, ty), geom::irect(rect.size()), dst,
+           geom::ipoint(pos.x() + rect.left(), pos.y() + rect.top()));
+    }
+  }
+}
+
+/** Tiles that land exactly on a destination tile are shared instead
+    of copied */
+template<typename SrcPixel, typename DstPixel>
+void blit(TiledPixelData<SrcPixel> const& src, TiledPixelData<DstPixel>& dst, geom::ipoint const& pos)
+{
+  using Tiled = TiledPixelData<DstPixel>;
+
+  bool const aligned = std::is_same<SrcPixel, DstPixel>::value &&
+    (pos.x() & Tiled::TILE_MASK) == 0 && (pos.y() & Tiled::TILE_MASK) == 0;
+
+  for_each_tile(src, [&](PixelView<SrcPixel> const& view, geom::ipoint const& origin) {
+    geom::ipoint const dstpos(pos.x() + origin.x(), pos.y() + origin.y());
+
+    if constexpr (std::is_same<SrcPixel, DstPixel>::value) {
+      if (aligned && dstpos.x() >= 0 && dstpos.y() >= 0 &&
+          dstpos.x() < dst.get_width() && dstpos.y() < dst.get_height())
+      {
+        int const dst_tx = dstpos.x() >> Tiled::TILE_SHIFT;
+        int const dst_ty = dstpos.y() >> Tiled::TILE_SHIFT;
+        geom::irect const dst_rect = dst.get_tile_rect(dst_tx, dst_ty);
+        if (dst_rect.size() == view.get_size()) {
+          dst.share_tile(dst_tx, dst_ty, src,
+                         origin.x() >> Tiled::TILE_SHIFT, origin.y() >> Tiled::TILE_SHIFT);
+          return;
+        }
+      }
+    }
+
+    blit(view, dst, dstpos);
+  });
+}
+
+template<typename Pixel>
+TiledPixelData<Pixel> crop(TiledPixelData<Pixel> const& src, geom::irect const& rect)
+{
+  geom::irect const clipped(std::clamp(rect.left(), 0, src.get_width()),
+                            std::clamp(rect.top(), 0, src.get_height()),
+                            std::clamp(rect.right(), 0, src.get_width()),
+                            std::clamp(rect.bottom(), 0, src.get_height()));
+
+  TiledPixelData<Pixel> dst(clipped.size());
+  blit(src, dst, geom::ipoint(-clipped.left(), -clipped.top()));
+  return dst;
+}
+
+/** Rotates clockwise, each destination tile is assembled from at most
+    four source tiles, so all reads and writes stay in cache */
+template<typename Pixel>
+TiledPixelData<Pixel> rotate90(TiledPixelData<Pixel> const& src)
+{
+  using Tiled = TiledPixelData<Pixel>;
+
+  TiledPixelData<Pixel> dst(geom::isize(src.get_height(), src.get_width()));
+  int const h = src.get_height();
+
+  for_each_tile(dst, [&src, h](PixelView<Pixel>& view, geom::ipoint const& origin) {
+    for (int y = 0; y < view.get_height(); ++y) {
+      Pixel* const row = view.get_row(y);
+      int const sx = origin.y() + y;
+
+      // walk up the source column one source tile at a time
+      for (int x = 0; x < view.get_width(); ) {
+        int const sy = h - 1 - (origin.x() + x);
+        int const n = std::min(view.get_width() - x, (sy & Tiled::TILE_MASK) + 1);
+        PixelView<Pixel> const& tile = src.get_tile(sx >> Tiled::TILE_SHIFT, sy >> Tiled::TILE_SHIFT);
+        for (int i = 0; i < n; ++i) {
+          row[x + i] = tile.get_row((sy & Tiled::TILE_MASK) - i)[sx & Tiled::TILE_MASK];
+        }
+        x += n;
+      }
+    }
+  });
+
+  return dst;
+}
+
+template<typename Pixel>
+TiledPixelData<Pixel> rotate270(TiledPixelData<Pixel> const& src)
+{
+  using Tiled = TiledPixelData<Pixel>;
+
+  TiledPixelData<Pixel> dst(geom::isize(src.get_height(), src.get_width()));
+  int const w = src.get_width();
+
+  for_each_tile(dst, [&src, w](PixelView<Pixel>& view, geom::ipoint const& origin) {
+    for (int y = 0; y < view.get_height(); ++y) {
+      Pixel* const row = view.get_row(y);
+      int const sx = w - 1 - (origin.y() + y);
+
+      // walk down the source column one source tile at a time
+      for (int x = 0; x < view.get_width(); ) {
+        int const sy = origin.x() + x;
+        int const n = std::min(view.get_width() - x, Tiled::TILE_SIZE - (sy & Tiled::TILE_MASK));
+        PixelView<Pixel> const& tile = src.get_tile(sx >> Tiled::TILE_SHIFT, sy >> Tiled::TILE_SHIFT);
+        for (int i = 0; i < n; ++i) {
+          row[x + i] = tile.get_row((sy & Tiled::TILE_MASK) + i)[sx & Tiled::TILE_MASK];
+        }
+        x += n;
+      }
+    }
+  });
+
+  return dst;
+}
+
+} // namespace surf
+
+#endif
+
+/* EOF */
@@ -17,10 +17,15 @@
 #ifndef HEADER_SURF_TRANSFORM_HPP
 #define HEADER_SURF_TRANSFORM_HPP
 
+#include <algorithm>
+#include <vector>
+
 #include <geom/size.hpp>
 
 #include "pixel_data.hpp"
+#include "scale_filter.hpp"
 #include "software_surface.hpp"
+#include "srgb.hpp"
 
 namespace surf {
 
@@ -80,15 +85,32 @@ PixelData<Pixel> transform(PixelView<Pixel> const& src, Transform mod)
   }
 }
 
+namespace detail {
+
+/** Block size for the rotations, small enough that the source rows
+    and destination columns of a block stay in L1 cache */
+constexpr int ROTATE_BLOCK_SIZE = 64;
+
+} // namespace detail
+
 template<typename Pixel>
 PixelData<Pixel> rotate90(PixelView<Pixel> const& src)
 {
-  PixelData<Pixel> dst(geom::isize(src.get_size().height(), src.get_size().width()));
-
-  for(int y = 0; y < src.get_size().height(); ++y) {
-    for(int x = 0; x < src.get_size().width(); ++x) {
-      dst.put_pixel(geom::ipoint(src.get_size().height() - y - 1, x),
-                    src.get_pixel(geom::ipoint(x, y)));
+  PixelData<Pixel> dst(geom::isize(src.get_size().height(), src.get_size().width()), no_init);
+
+  int const w = src.get_width();
+  int const h = src.get_height();
+
+  for(int by = 0; by < h; by += detail::ROTATE_BLOCK_SIZE) {
+    int const ey = std::min(by + detail::ROTATE_BLOCK_SIZE, h);
+    for(int bx = 0; bx < w; bx += detail::ROTATE_BLOCK_SIZE) {
+      int const ex = std::min(bx + detail::ROTATE_BLOCK_SIZE, w);
+      for(int x = bx; x < ex; ++x) {
+        Pixel* const dstrow = dst.get_row(x);
+        for(int y = by; y < ey; ++y) {
+          dstrow[h - y - 1] = src.get_row(y)[x];
+        }
+      }
     }
   }
 
@@ -98,7 +120,7 @@ PixelData<Pixel> rotate90(PixelView<Pixel> const& src)
 template<typename Pixel>
 PixelData<Pixel> rotate180(PixelView<Pixel> const& src)
 {
-  PixelData<Pixel> dst(src.get_size());
+  PixelData<Pixel> dst(src.get_size(), no_init);
 
   for(int y = 0; y < src.get_size().height(); ++y) {
     for(int x = 0; x < src.get_size().width(); ++x) {
@@ -113,12 +135,21 @@ PixelData<Pixel> rotate180(PixelView<Pixel> const& src)
 template<typename Pixel>
 PixelData<Pixel> rotate270(PixelView<Pixel> const& src)
 {
-  PixelData<Pixel> dst(src.get_size());
-
-  for(int y = 0; y < src.get_size().height(); ++y) {
-    for(int x = 0; x < src.get_size().width(); ++x) {
-      dst.put_pixel(geom::ipoint(y, src.get_size().width() - 1 - x),
-                    src.get_pixel(geom::ipoint(x, y)));
+  PixelData<Pixel> dst(geom::isize(src.get_size().height(), src.get_size().width()), no_init);
+
+  int const w = src.get_width();
+  int const h = src.get_height();
+
+  for(int by = 0; by < h; by += detail::ROTATE_BLOCK_SIZE) {
+    int const ey = std::min(by + detail::ROTATE_BLOCK_SIZE, h);
+    for(int bx = 0; bx < w; bx += detail::ROTATE_BLOCK_SIZE) {
+      int const ex = std::min(bx + detail::ROTATE_BLOCK_SIZE, w);
+      for(int x = bx; x < ex; ++x) {
+        Pixel* const dstrow = dst.get_row(w - 1 - x);
+        for(int y = by; y < ey; ++y) {
+          dstrow[y] = src.get_row(y)[x];
+        }
+      }
     }
   }
 
@@ -128,7 +159,7 @@ PixelData<Pixel> rotate270(PixelView<Pixel> const& src)
 template<typename Pixel>
 PixelData<Pixel> flip_vertical(PixelView<Pixel> const& src)
 {
-  PixelData<Pixel> dst(src.get_size());
+  PixelData<Pixel> dst(src.get_size(), no_init);
 
   for(int y = 0; y < src.get_size().height(); ++y) {
     std::copy_n(src.get_row(y),
@@ -142,7 +173,7 @@ PixelData<Pixel> flip_vertical(PixelView<Pixel> const& src)
 template<typename Pixel>
 PixelData<Pixel> flip_horizontal(PixelView<Pixel> const& src)
 {
-  PixelData<Pixel> dst(src.get_size());
+  PixelData<Pixel> dst(src.get_size(), no_init);
 
   for(int y = 0; y < src.get_size().height(); ++y) {
     for(int x = 0; x < src.get_size().width(); ++x) {
@@ -159,7 +190,7 @@ PixelData<Pixel> halve(PixelView<Pixel> const& src)
 {
   using type = typename Pixel::value_type;
 
-  PixelData<Pixel> dst(src.get_size() / 2);
+  PixelData<Pixel> dst(src.get_size() / 2, no_init);
 
   for(int y = 0; y < dst.get_height(); ++y) {
     for(int x = 0; x < dst.get_width(); ++x) {
@@ -179,13 +210,86 @@ PixelData<Pixel> halve(PixelView<Pixel> const& src)
   return dst;
 }
 
+namespace detail {
+
+/** Sum of linear light pixels. With \a premultiplied the colors are
+    weighted by alpha, so the average is that of the premultiplied
+    values and transparent pixels don't bleed into the edges. */
+template<bool premultiplied>
+struct LinearSum
+{
+  uint64_t r = 0;
+  uint64_t g = 0;
+  uint64_t b = 0;
+  uint64_t a = 0;
+
+  void add(RGBA16Pixel const& pixel)
+  {
+    uint64_t const weight = premultiplied ? pixel.a : 1;
+    r += pixel.r * weight;
+    g += pixel.g * weight;
+    b += pixel.b * weight;
+    a += pixel.a;
+  }
+
+  /** The average of \a count pixels, straight alpha as
+      srgb_encode() expects it */
+  RGBA16Pixel average(uint64_t count) const
+  {
+    uint64_t const weight = premultiplied ? a : count;
+    auto const divide = [weight](uint64_t sum) {
+      return weight == 0 ? uint16_t{0} : static_cast<uint16_t>((sum + weight / 2) / weight);
+    };
+    return RGBA16Pixel{divide(r), divide(g), divide(b),
+                       static_cast<uint16_t>((a + count / 2) / count)};
+  }
+};
+
+} // namespace detail
+
+/** With Gamma::LINEAR the four source pixels are averaged in linear
+    light, decoding and encoding a row at a time through the SRGBLut.
+    Premultiplied formats average the premultiplied values. */
+template<typename Pixel>
+PixelData<Pixel> halve(PixelView<Pixel> const& src, Gamma gamma)
+{
+  if (gamma == Gamma::ENCODED) {
+    return halve(src);
+  }
+
+  PixelData<Pixel> dst(src.get_size() / 2, no_init);
+
+  size_t const width = static_cast<size_t>(dst.get_width());
+  std::vector<RGBA16Pixel> row0(width * 2);
+  std::vector<RGBA16Pixel> row1(width * 2);
+  std::vector<RGBA16Pixel> out(width);
+
+  for(int y = 0; y < dst.get_height(); ++y) {
+    srgb_decode_n(src.get_row(y * 2 + 0), row0.data(), width * 2);
+    srgb_decode_n(src.get_row(y * 2 + 1), row1.data(), width * 2);
+
+    for(size_t x = 0; x < width; ++x) {
+      detail::LinearSum<is_premultiplied<Pixel>::value> sum;
+      sum.add(row0[x * 2 + 0]);
+      sum.add(row0[x * 2 + 1]);
+      sum.add(row1[x * 2 + 0]);
+      sum.add(row1[x * 2 + 1]);
+      out[x] = sum.average(4);
+    }
+
+    srgb_encode_n(out.data(), dst.get_row(y), width);
+  }
+
+  return dst;
+}
+
 template<typename Pixel>
 PixelData<Pixel> scale(PixelView<Pixel> const& src, geom::isize const& size)
 {
   if (src.get_size() == size) { return src; }
   if (src.get_size() == geom::isize(0, 0)) { return PixelData<Pixel>(size); }
 
-  PixelData<Pixel> dst(size);
+  PixelData<Pixel> dst(size, no_init);
 
   for(int y = 0; y < dst.get_height(); ++y) {
     for(int x = 0; x < dst.get_width(); ++x) {
@@ -197,6 +301,61 @@ PixelData<Pixel> scale(PixelView<Pixel> const& src, geom::isize const& size)
   return dst;
 }
 
+/** With Gamma::LINEAR every destination pixel is the linear light
+    average of the source pixels it covers, so downscales don't darken
+    and alias like the nearest neighbour sampling of Gamma::ENCODED.
+    Premultiplied formats average the premultiplied values. An axis
+    that grows is sampled nearest neighbour, when neither axis shrinks
+    the pixels are copied as they are in both modes. */
+template<typename Pixel>
+PixelData<Pixel> scale(PixelView<Pixel> const& src, geom::isize const& size, Gamma gamma)
+{
+  if (gamma == Gamma::ENCODED || src.get_size() == geom::isize(0, 0) ||
+      (size.width() >= src.get_width() && size.height() >= src.get_height())) {
+    return scale(src, size);
+  }
+
+  PixelData<Pixel> dst(size, no_init);
+
+  int const srcw = src.get_width();
+  int const srch = src.get_height();
+  int const dstw = dst.get_width();
+  int const dsth = dst.get_height();
+
+  // the source span of each destination pixel, at least one pixel
+  // wide, the same as for ScaleFilter::BOX
+  std::vector<detail::ScaleTap> const xtaps = detail::make_scale_taps(ScaleFilter::BOX, srcw, dstw);
+  std::vector<detail::ScaleTap> const ytaps = detail::make_scale_taps(ScaleFilter::BOX, srch, dsth);
+
+  std::vector<RGBA16Pixel> row(static_cast<size_t>(srcw));
+  std::vector<detail::LinearSum<is_premultiplied<Pixel>::value>> sums(static_cast<size_t>(dstw));
+  std::vector<RGBA16Pixel> out(static_cast<size_t>(dstw));
+
+  for (int y = 0; y < dsth; ++y) {
+    detail::ScaleTap const& ytap = ytaps[static_cast<size_t>(y)];
+
+    std::fill(sums.begin(), sums.end(), typename decltype(sums)::value_type());
+    for (int sy = ytap.index; sy < ytap.next; ++sy) {
+      srgb_decode_n(src.get_row(sy), row.data(), row.size());
+      for (int x = 0; x < dstw; ++x) {
+        for (int sx = xtaps[x].index; sx < xtaps[x].next; ++sx) {
+          sums[static_cast<size_t>(x)].add(row[sx]);
+        }
+      }
+    }
+
+    for (int x = 0; x < dstw; ++x) {
+      uint64_t const count = static_cast<uint64_t>(xtaps[x].next - xtaps[x].index) *
+                             static_cast<uint64_t>(ytap.next - ytap.index);
+      out[x] = sums[static_cast<size_t>(x)].average(count);
+    }
+
+    srgb_encode_n(out.data(), dst.get_row(y), out.size());
+  }
+
+  return dst;
+}
+
 template<typename Pixel>
 PixelData<Pixel> crop(PixelView<Pixel> const& src, geom::irect const& rect)
 {
@@ -206,7 +365,7 @@ PixelData<Pixel> crop(PixelView<Pixel> const& src, geom::irect const& rect)
                       std::clamp(rect.right(), 0, src.get_width()),
                       std::clamp(rect.bottom(), 0, src.get_height()));
 
-  PixelData<Pixel> dst(clipped.size());
+  PixelData<Pixel> dst(clipped.size(), no_init);
 
   for(int y = clipped.top(); y < clipped.bottom(); ++y) {
     std::copy_n(src.get_row(y) + clipped.left(),
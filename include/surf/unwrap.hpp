@@ -54,6 +54,17 @@
     PIXELFORMAT_TO_TYPE__CASE(type, expr, PixelFormat::LA32, LA32Pixel)              \
     PIXELFORMAT_TO_TYPE__CASE(type, expr, PixelFormat::L32f, L32fPixel)              \
     PIXELFORMAT_TO_TYPE__CASE(type, expr, PixelFormat::LA32f, LA32fPixel)            \
+    PIXELFORMAT_TO_TYPE__CASE(type, expr, PixelFormat::BGR8, BGR8Pixel)              \
+    PIXELFORMAT_TO_TYPE__CASE(type, expr, PixelFormat::BGRA8, BGRA8Pixel)            \
+    PIXELFORMAT_TO_TYPE__CASE(type, expr, PixelFormat::ARGB8, ARGB8Pixel)            \
+    PIXELFORMAT_TO_TYPE__CASE(type, expr, PixelFormat::RGB565, RGB565Pixel)          \
+    PIXELFORMAT_TO_TYPE__CASE(type, expr, PixelFormat::PRGBA8, PRGBA8Pixel)          \
+    PIXELFORMAT_TO_TYPE__CASE(type, expr, PixelFormat::PRGBA16, PRGBA16Pixel)        \
+    PIXELFORMAT_TO_TYPE__CASE(type, expr, PixelFormat::PRGBA32f, PRGBA32fPixel)      \
+    PIXELFORMAT_TO_TYPE__CASE(type, expr, PixelFormat::RGB16f, RGB16fPixel)          \
+    PIXELFORMAT_TO_TYPE__CASE(type, expr, PixelFormat::RGBA16f, RGBA16fPixel)        \
+    PIXELFORMAT_TO_TYPE__CASE(type, expr, PixelFormat::L16f, L16fPixel)              \
+    PIXELFORMAT_TO_TYPE__CASE(type, expr, PixelFormat::LA16f, LA16fPixel)            \
     }                                                                                \
   } while (false)
 
@@ -67,15 +78,6 @@
     PIXELFORMAT_TO_TYPE__CASE(type, expr, PixelFormat::LA64f, LA64fPixel)
 #endif
 
-#define PIXELFORMAT2_TO_TYPE(srcformat, srctype, dstformat, dsttype, expr) \
-  PIXELFORMAT_TO_TYPE(                                                  \
-    (srcformat),                                                        \
-    srctype,                                                            \
-    PIXELFORMAT_TO_TYPE(                                                \
-      (dstformat),                                                      \
-      dsttype,                                                          \
-      expr))
-
 #define SOFTWARE_SURFACE_LIFT_VOID(function)                        \
   template<typename ...Args>                                        \
   void function(SoftwareSurface& src,                               \
@@ -83,7 +85,7 @@
   {                                                                 \
     PIXELFORMAT_TO_TYPE(                                            \
       src.get_format(), srctype,                                    \
-      function(src.as_pixelview<srctype>(),                         \
+      function(src.as_pixelview_unchecked<srctype>(),               \
                std::forward<Args>(args)...));                       \
   }
 
@@ -95,25 +97,10 @@
     PIXELFORMAT_TO_TYPE(                                       \
       src.get_format(), srctype,                               \
       return SoftwareSurface(                                  \
-        function(src.as_pixelview<srctype>(),                  \
+        function(src.as_pixelview_unchecked<srctype>(),        \
                  std::forward<Args>(args)...)));               \
   }
 
-#define SOFTWARE_SURFACE_LIFT2(function)                                \
-  template<typename ...Args>                                            \
-  SoftwareSurface function(SoftwareSurface const& src,                  \
-                           SoftwareSurface const& dst,                  \
-                           Args&&... args)                              \
-  {                                                                     \
-    PIXELFORMAT2_TO_TYPE(                                               \
-      src.get_format(), srctype,                                        \
-      dst.get_format(), dsttype,                                        \
-      function(src.as_pixelview<srctype>(),                             \
-               dst.as_pixelview<dsttype>(),                             \
-               std::forward<Args>(args)...))                            \
-      );                                                                \
-  }
-
 #endif
 
 /* EOF */
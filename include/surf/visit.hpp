@@ -0,0 +1,113 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_VISIT_HPP
+#define HEADER_SURF_VISIT_HPP
+
+#include <stdexcept>
+#include <utility>
+
+#include "pixel.hpp"
+#include "pixel_view.hpp"
+#include "software_surface.hpp"
+
+namespace surf {
+
+namespace detail {
+
+#define SURF_VISIT__CASE(format, type)                                  \
+  case format:                                                          \
+    return std::forward<Func>(func)(surface.template as_pixelview_unchecked<type>())
+
+template<typename Surface, typename Func>
+decltype(auto) visit_surface(Surface& surface, Func&& func)
+{
+  // same set of formats as PIXELFORMAT_TO_TYPE
+  switch (surface.get_format())
+  {
+    SURF_VISIT__CASE(PixelFormat::RGB8, RGB8Pixel);
+    SURF_VISIT__CASE(PixelFormat::RGBA8, RGBA8Pixel);
+    SURF_VISIT__CASE(PixelFormat::RGB16, RGB16Pixel);
+    SURF_VISIT__CASE(PixelFormat::RGBA16, RGBA16Pixel);
+    SURF_VISIT__CASE(PixelFormat::RGB32, RGB32Pixel);
+    SURF_VISIT__CASE(PixelFormat::RGBA32, RGBA32Pixel);
+    SURF_VISIT__CASE(PixelFormat::RGB32f, RGB32fPixel);
+    SURF_VISIT__CASE(PixelFormat::RGBA32f, RGBA32fPixel);
+    SURF_VISIT__CASE(PixelFormat::L8, L8Pixel);
+    SURF_VISIT__CASE(PixelFormat::LA8, LA8Pixel);
+    SURF_VISIT__CASE(PixelFormat::L16, L16Pixel);
+    SURF_VISIT__CASE(PixelFormat::LA16, LA16Pixel);
+    SURF_VISIT__CASE(PixelFormat::L32, L32Pixel);
+    SURF_VISIT__CASE(PixelFormat::LA32, LA32Pixel);
+    SURF_VISIT__CASE(PixelFormat::L32f, L32fPixel);
+    SURF_VISIT__CASE(PixelFormat::LA32f, LA32fPixel);
+    SURF_VISIT__CASE(PixelFormat::BGR8, BGR8Pixel);
+    SURF_VISIT__CASE(PixelFormat::BGRA8, BGRA8Pixel);
+    SURF_VISIT__CASE(PixelFormat::ARGB8, ARGB8Pixel);
+    SURF_VISIT__CASE(PixelFormat::RGB565, RGB565Pixel);
+    SURF_VISIT__CASE(PixelFormat::PRGBA8, PRGBA8Pixel);
+    SURF_VISIT__CASE(PixelFormat::PRGBA16, PRGBA16Pixel);
+    SURF_VISIT__CASE(PixelFormat::PRGBA32f, PRGBA32fPixel);
+    SURF_VISIT__CASE(PixelFormat::RGB16f, RGB16fPixel);
+    SURF_VISIT__CASE(PixelFormat::RGBA16f, RGBA16fPixel);
+    SURF_VISIT__CASE(PixelFormat::L16f, L16fPixel);
+    SURF_VISIT__CASE(PixelFormat::LA16f, LA16fPixel);
+
+    default:
+      throw std::invalid_argument("visit: unknown PixelFormat");
+  }
+}
+
+#undef SURF_VISIT__CASE
+
+} // namespace detail
+
+/** Call \a func with the surface's pixel data as a concrete
+    PixelView<Pixel>&, e.g. visit(surface, [](auto& view){ ... }).
+    The format is dispatched once per call, so \a func can run typed
+    inner loops without RTTI or virtual calls. \a func has to return
+    the same type for every pixel format. The view must not be kept
+    past the call, the surface stays shareable with copies. */
+template<typename Func>
+decltype(auto) visit(SoftwareSurface& surface, Func&& func)
+{
+  return detail::visit_surface(surface, std::forward<Func>(func));
+}
+
+/** Read-only visit(), \a func receives a PixelView<Pixel> const& */
+template<typename Func>
+decltype(auto) visit(SoftwareSurface const& surface, Func&& func)
+{
+  return detail::visit_surface(surface, std::forward<Func>(func));
+}
+
+/** Call \a func with the concrete views of both surfaces,
+    instantiating \a func for every pair of formats */
+template<typename Src, typename Dst, typename Func>
+decltype(auto) visit2(Src& src, Dst& dst, Func&& func)
+{
+  return visit(src, [&dst, &func](auto& srcview) -> decltype(auto) {
+    return visit(dst, [&srcview, &func](auto& dstview) -> decltype(auto) {
+      return func(srcview, dstview);
+    });
+  });
+}
+
+} // namespace surf
+
+#endif
+
+/* EOF */
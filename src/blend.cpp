@@ -14,10 +14,12 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
+#include <vector>
+
 #include "blit.hpp"
-#include "pixel_view.hpp"
+#include "kernel_registry.hpp"
 #include "software_surface.hpp"
-#include "unwrap.hpp"
+#include "srgb.hpp"
 
 namespace surf {
 
@@ -25,10 +27,8 @@ void blend(BlendFunc blendfunc,
            SoftwareSurface const& src, geom::irect const& srcrect,
            SoftwareSurface& dst, geom::ipoint const& pos)
 {
-  PIXELFORMAT2_TO_TYPE(
-    src.get_format(), srctype,
-    dst.get_format(), dsttype,
-    blend_wrap(blendfunc, src.as_pixelview<srctype>(), srcrect, dst.as_pixelview<dsttype>(), pos));
+  apply_kernel(KernelRegistry::instance().get(src.get_format(), dst.get_format(), blendfunc),
+               src, srcrect, dst, pos);
 }
 
 void blend(BlendFunc blendfunc, SoftwareSurface const& src, SoftwareSurface& dst, geom::ipoint const& pos)
@@ -36,6 +36,54 @@ void blend(BlendFunc blendfunc, SoftwareSurface const& src, SoftwareSurface& dst
   blend(blendfunc, src, geom::irect(src.get_size()), dst, pos);
 }
 
+void blend(BlendFunc blendfunc,
+           SoftwareSurface const& src, geom::irect const& srcrect,
+           SoftwareSurface& dst, geom::ipoint const& pos,
+           Gamma gamma)
+{
+  if (gamma == Gamma::ENCODED) {
+    blend(blendfunc, src, srcrect, dst, pos);
+    return;
+  }
+
+  assert(contains(geom::irect(src.get_size()), srcrect));
+
+  SpanKernel const kernel = KernelRegistry::instance().get(PixelFormat::RGBA16, PixelFormat::RGBA16, blendfunc);
+  SpanKernel const decode_src = srgb_decode_kernel(src.get_format());
+  SpanKernel const decode_dst = srgb_decode_kernel(dst.get_format());
+  SpanKernel const encode_dst = srgb_encode_kernel(dst.get_format());
+
+  size_t const src_pixel_size = KernelRegistry::pixel_size(src.get_format());
+  size_t const dst_pixel_size = KernelRegistry::pixel_size(dst.get_format());
+
+  geom::irect const cliprect(dst.get_size());
+  geom::irect const region = intersection(geom::irect(srcrect.size()) + geom::ioffset(pos), cliprect);
+  geom::ioffset const dst2src(-pos.x() + srcrect.left(), -pos.y() + srcrect.top());
+
+  if (region.width() <= 0) {
+    return;
+  }
+
+  std::vector<RGBA16Pixel> srcrow(static_cast<size_t>(region.width()));
+  std::vector<RGBA16Pixel> dstrow(static_cast<size_t>(region.width()));
+
+  for (int y = region.top(); y < region.bottom(); ++y) {
+    uint8_t const* const srcdata = static_cast<uint8_t const*>(src.get_row_data(y + dst2src.y())) +
+      (region.left() + dst2src.x()) * src_pixel_size;
+    uint8_t* const dstdata = static_cast<uint8_t*>(dst.get_row_data_detached(y)) + region.left() * dst_pixel_size;
+
+    decode_src(srcdata, srcrow.data(), srcrow.size());
+    decode_dst(dstdata, dstrow.data(), dstrow.size());
+    kernel(srcrow.data(), dstrow.data(), dstrow.size());
+    encode_dst(dstrow.data(), dstdata, dstrow.size());
+  }
+}
+
+void blend(BlendFunc blendfunc, SoftwareSurface const& src, SoftwareSurface& dst, geom::ipoint const& pos, Gamma gamma)
+{
+  blend(blendfunc, src, geom::irect(src.get_size()), dst, pos, gamma);
+}
+
 } // namespace surf
 
 /* EOF */
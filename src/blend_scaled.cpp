@@ -15,20 +15,15 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "blit.hpp"
-#include "pixel_view.hpp"
+#include "kernel_registry.hpp"
 #include "software_surface.hpp"
-#include "unwrap.hpp"
 
 namespace surf {
 
 void blend_scaled(BlendFunc blendfunc, SoftwareSurface const& src, geom::irect const& srcrect, SoftwareSurface& dst, geom::irect const& dstrect)
 {
-  PIXELFORMAT2_TO_TYPE(
-    src.get_format(), srctype,
-    dst.get_format(), dsttype,
-    blend_scaled_wrap(blendfunc,
-                      src.as_pixelview<srctype>(), srcrect,
-                      dst.as_pixelview<dsttype>(), dstrect));
+  apply_kernel_scaled(KernelRegistry::instance().get(src.get_format(), dst.get_format(), blendfunc),
+                      src, srcrect, dst, dstrect);
 }
 
 void blend_scaled(BlendFunc blendfunc, SoftwareSurface const& src, SoftwareSurface& dst, geom::irect const& dstrect)
@@ -36,6 +31,17 @@ void blend_scaled(BlendFunc blendfunc, SoftwareSurface const& src, SoftwareSurfa
   blend_scaled(blendfunc, src, geom::irect(src.get_size()), dst, dstrect);
 }
 
+void blend_scaled(BlendFunc blendfunc, SoftwareSurface const& src, geom::irect const& srcrect, SoftwareSurface& dst, geom::irect const& dstrect, ScaleFilter filter)
+{
+  apply_kernel_scaled(KernelRegistry::instance().get(src.get_format(), dst.get_format(), blendfunc),
+                      src, srcrect, dst, dstrect, filter);
+}
+
+void blend_scaled(BlendFunc blendfunc, SoftwareSurface const& src, SoftwareSurface& dst, geom::irect const& dstrect, ScaleFilter filter)
+{
+  blend_scaled(blendfunc, src, geom::irect(src.get_size()), dst, dstrect, filter);
+}
+
 } // namespace surf
 
 /* EOF */
@@ -16,21 +16,58 @@
 
 #include "blendfunc.hpp"
 
+#include <iterator>
+#include <stdexcept>
+
 namespace surf {
 
+namespace {
+
+struct BlendFuncName
+{
+  BlendFunc blendfunc;
+  std::string_view name;
+};
+
+constexpr BlendFuncName blendfunc_names[] = {
+  { BlendFunc::COPY, "COPY" },
+  { BlendFunc::BLEND, "BLEND" },
+  { BlendFunc::ADD, "ADD" },
+  { BlendFunc::MULTIPLY, "MULTIPLY" },
+  { BlendFunc::SCREEN, "SCREEN" },
+  { BlendFunc::OVERLAY, "OVERLAY" },
+  { BlendFunc::DARKEN, "DARKEN" },
+  { BlendFunc::LIGHTEN, "LIGHTEN" },
+  { BlendFunc::DIFFERENCE, "DIFFERENCE" },
+  { BlendFunc::SUBTRACT, "SUBTRACT" },
+  { BlendFunc::SOFT_LIGHT, "SOFT_LIGHT" },
+  { BlendFunc::SRC_IN, "SRC_IN" },
+  { BlendFunc::SRC_OUT, "SRC_OUT" },
+  { BlendFunc::SRC_ATOP, "SRC_ATOP" },
+  { BlendFunc::XOR, "XOR" },
+};
+
+static_assert(std::size(blendfunc_names) == BLEND_FUNC_COUNT);
+
+} // namespace
+
 BlendFunc BlendFunc_from_string(std::string_view blendfunc_str)
 {
-  if (blendfunc_str == "COPY") {
-    return BlendFunc::COPY;
-  } else if (blendfunc_str == "BLEND") {
-    return BlendFunc::BLEND;
-  } else if (blendfunc_str == "ADD") {
-    return BlendFunc::ADD;
-  } else if (blendfunc_str == "MULTIPLY") {
-    return BlendFunc::MULTIPLY;
-  } else {
+  for (auto const& entry : blendfunc_names) {
+    if (entry.name == blendfunc_str) {
+      return entry.blendfunc;
+    }
+  }
+  throw std::invalid_argument("invalid BlendFunc");
+}
+
+std::string_view to_string(BlendFunc blendfunc)
+{
+  size_t const idx = static_cast<size_t>(blendfunc);
+  if (idx >= BLEND_FUNC_COUNT) {
     throw std::invalid_argument("invalid BlendFunc");
   }
+  return blendfunc_names[idx].name;
 }
 
 } // namespace surf
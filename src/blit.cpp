@@ -16,26 +16,21 @@
 
 #include "blit.hpp"
 
+#include "kernel_registry.hpp"
 #include "software_surface.hpp"
-#include "unwrap.hpp"
 
 namespace surf {
 
 void blit(SoftwareSurface const& src, SoftwareSurface& dst, geom::ipoint const& pos)
 {
-  PIXELFORMAT2_TO_TYPE(
-    src.get_format(), srctype,
-    dst.get_format(), dsttype,
-    blit(src.as_pixelview<srctype>(), dst.as_pixelview<dsttype>(), pos));
+  blit(src, geom::irect(src.get_size()), dst, pos);
 }
 
 void blit(SoftwareSurface const& src, geom::irect const& srcrect,
           SoftwareSurface& dst, geom::ipoint const& pos)
 {
-  PIXELFORMAT2_TO_TYPE(
-    src.get_format(), srctype,
-    dst.get_format(), dsttype,
-    blit(src.as_pixelview<srctype>(), srcrect, dst.as_pixelview<dsttype>(), pos));
+  apply_kernel(KernelRegistry::instance().get(src.get_format(), dst.get_format(), BlendFunc::COPY),
+               src, srcrect, dst, pos);
 }
 
 } // namespace surf
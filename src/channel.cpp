@@ -16,6 +16,8 @@
 
 #include "channel.hpp"
 
+#include <utility>
+
 #include "software_surface.hpp"
 #include "unwrap.hpp"
 
@@ -62,6 +64,20 @@ split_channel_to_software_surface(PixelView<tRGBAPixel<T>> const& src)
   };
 }
 
+/** Swizzled and packed formats split like their RGB(A) equivalent */
+template<typename Pixel>
+std::vector<SoftwareSurface>
+split_channel_to_software_surface(PixelView<Pixel> const& src)
+{
+  using T = typename Pixel::value_type;
+
+  if constexpr (Pixel::has_alpha()) {
+    return split_channel_to_software_surface(src.template convert_to<tRGBAPixel<T>>());
+  } else {
+    return split_channel_to_software_surface(src.template convert_to<tRGBPixel<T>>());
+  }
+}
+
 template<typename T>
 SoftwareSurface join_channel_to_software_surface(PixelView<tLPixel<T>> red_c,
                                                  PixelView<tLPixel<T>> green_c,
@@ -97,16 +113,16 @@ join_channel(std::vector<SoftwareSurface> channels)
   } else if (channels.size() == 3) {
       PIXELFORMAT_TO_TYPE(
         channels[0].get_format(), srctype,
-        return join_channel_to_software_surface(channels[0].as_pixelview<tLPixel<typename srctype::value_type>>(),
-                                                channels[1].as_pixelview<tLPixel<typename srctype::value_type>>(),
-                                                channels[2].as_pixelview<tLPixel<typename srctype::value_type>>()));
+        return join_channel_to_software_surface(std::as_const(channels[0]).as_pixelview<tLPixel<typename srctype::value_type>>(),
+                                                std::as_const(channels[1]).as_pixelview<tLPixel<typename srctype::value_type>>(),
+                                                std::as_const(channels[2]).as_pixelview<tLPixel<typename srctype::value_type>>()));
   } else if (channels.size() == 4) {
       PIXELFORMAT_TO_TYPE(
         channels[0].get_format(), srctype,
-        return join_channel_to_software_surface(channels[0].as_pixelview<tLPixel<typename srctype::value_type>>(),
-                                                channels[1].as_pixelview<tLPixel<typename srctype::value_type>>(),
-                                                channels[2].as_pixelview<tLPixel<typename srctype::value_type>>(),
-                                                channels[3].as_pixelview<tLPixel<typename srctype::value_type>>()));
+        return join_channel_to_software_surface(std::as_const(channels[0]).as_pixelview<tLPixel<typename srctype::value_type>>(),
+                                                std::as_const(channels[1]).as_pixelview<tLPixel<typename srctype::value_type>>(),
+                                                std::as_const(channels[2]).as_pixelview<tLPixel<typename srctype::value_type>>(),
+                                                std::as_const(channels[3]).as_pixelview<tLPixel<typename srctype::value_type>>()));
   } else {
     throw std::invalid_argument("invalid number of channels");
   }
@@ -14,18 +14,59 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
+#include <stdexcept>
+
+#include "color.hpp"
+#include "convert_span.hpp"
+#include "kernel_registry.hpp"
 #include "pixel_view.hpp"
+#include "row_converter.hpp"
 #include "software_surface.hpp"
-#include "unwrap.hpp"
 
 namespace surf {
 
+namespace detail {
+
+// Color is used as a RGBA32f pixel by the kernels
+static_assert(sizeof(Color) == sizeof(RGBA32fPixel));
+
+bool convert_span(PixelFormat srcformat, PixelFormat dstformat, void const* src, void* dst, size_t count)
+{
+  if (KernelRegistry::pixel_size(srcformat) == 0 || KernelRegistry::pixel_size(dstformat) == 0) {
+    return false;
+  }
+
+  KernelRegistry::instance().get(srcformat, dstformat, BlendFunc::COPY)(src, dst, count);
+  return true;
+}
+
+void colors_from_span(PixelFormat format, void const* src, Color* dst, size_t count)
+{
+  KernelRegistry::instance().get(format, PixelFormat::RGBA32f, BlendFunc::COPY)(src, dst, count);
+}
+
+void colors_to_span(PixelFormat format, Color const* src, void* dst, size_t count)
+{
+  KernelRegistry::instance().get(PixelFormat::RGBA32f, format, BlendFunc::COPY)(src, dst, count);
+}
+
+} // namespace detail
+
 SoftwareSurface convert(SoftwareSurface const& src, PixelFormat format)
 {
-  PIXELFORMAT2_TO_TYPE(
-    src.get_format(), srctype,
-    format, dsttype,
-    return SoftwareSurface(src.as_pixelview<srctype>().template convert_to<dsttype>()));
+  RowConverter const converter(src.get_format(), format);
+  SoftwareSurface dst = SoftwareSurface::create(format, src.get_size(), no_init);
+  converter.convert_rows(src, 0, dst);
+  return dst;
+}
+
+void convert_into(SoftwareSurface const& src, SoftwareSurface& dst)
+{
+  if (src.get_size() != dst.get_size()) {
+    throw std::invalid_argument("convert_into: size mismatch");
+  }
+
+  RowConverter(src.get_format(), dst.get_format()).convert_rows(src, 0, dst);
 }
 
 } // namespace surf
@@ -26,7 +26,7 @@ void fill_rect(SoftwareSurface& dst, geom::irect const& rect, Color const& color
 {
   PIXELFORMAT_TO_TYPE(
     dst.get_format(), dsttype,
-    fill_rect(dst.as_pixelview<dsttype>(), rect, convert<Color, dsttype>(color)));
+    fill_rect(dst.as_pixelview_unchecked<dsttype>(), rect, convert<Color, dsttype>(color)));
 }
 
 void fill(SoftwareSurface& dst, Color const& color)
@@ -39,7 +39,7 @@ void fill_checkerboard(SoftwareSurface& dst, geom::isize const& size,
 {
   PIXELFORMAT_TO_TYPE(
     dst.get_format(), dsttype,
-    fill_checkerboard(dst.as_pixelview<dsttype>(), size,
+    fill_checkerboard(dst.as_pixelview_unchecked<dsttype>(), size,
                       convert<Color, dsttype>(color)));
 }
 
@@ -0,0 +1,322 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "kernel_registry.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "blit.hpp"
+#include "kernels/blend_kernels.hpp"
+#include "kernels/convert_kernels.hpp"
+#include "kernels/half_kernels.hpp"
+#include "kernels/premultiply_kernels.hpp"
+#include "kernels/swizzle_kernels.hpp"
+#include "pixel.hpp"
+#include "scale_filter.hpp"
+#include "software_surface.hpp"
+#include "visit.hpp"
+
+namespace surf {
+
+namespace {
+
+// Same set of formats as PIXELFORMAT_TO_TYPE
+using GenericFormats = std::tuple<RGB8Pixel, RGBA8Pixel,
+                                  RGB16Pixel, RGBA16Pixel,
+                                  RGB32Pixel, RGBA32Pixel,
+                                  RGB32fPixel, RGBA32fPixel,
+                                  L8Pixel, LA8Pixel,
+                                  L16Pixel, LA16Pixel,
+                                  L32Pixel, LA32Pixel,
+                                  L32fPixel, LA32fPixel,
+                                  BGR8Pixel, BGRA8Pixel,
+                                  ARGB8Pixel, RGB565Pixel,
+                                  PRGBA8Pixel, PRGBA16Pixel, PRGBA32fPixel,
+                                  RGB16fPixel, RGBA16fPixel,
+                                  L16fPixel, LA16fPixel>;
+
+constexpr size_t OP_COUNT = BLEND_FUNC_COUNT;
+
+size_t kernel_index(PixelFormat src, PixelFormat dst, BlendFunc op)
+{
+  size_t const src_idx = static_cast<size_t>(src);
+  size_t const dst_idx = static_cast<size_t>(dst);
+  size_t const op_idx = static_cast<size_t>(op);
+
+  if (src_idx >= PIXEL_FORMAT_COUNT || dst_idx >= PIXEL_FORMAT_COUNT || op_idx >= OP_COUNT) {
+    throw std::invalid_argument("KernelRegistry: index out of range");
+  }
+
+  return (src_idx * PIXEL_FORMAT_COUNT + dst_idx) * OP_COUNT + op_idx;
+}
+
+template<typename SrcPixel, typename DstPixel, typename BlendFuncType>
+void generic_kernel(void const* src, void* dst, size_t count)
+{
+  if constexpr (std::is_same<SrcPixel, DstPixel>::value &&
+                std::is_same<BlendFuncType, pixel_copy<SrcPixel, DstPixel>>::value) {
+    std::memcpy(dst, src, count * sizeof(SrcPixel));
+  } else {
+    detail::blend_n(BlendFuncType(),
+                    static_cast<SrcPixel const*>(src),
+                    static_cast<DstPixel*>(dst),
+                    count);
+  }
+}
+
+/** Run the RGBA32f kernel for \a op on RGBA32f conversions of the
+    spans, as pixel_composite is defined through RGBA32f this gives the
+    same result as a native kernel */
+void composite_span(PixelFormat srcformat, PixelFormat dstformat, BlendFunc op,
+                    void const* src, void* dst, size_t count)
+{
+  KernelRegistry const& registry = KernelRegistry::instance();
+  SpanKernel const src_to_float = registry.get(srcformat, PixelFormat::RGBA32f, BlendFunc::COPY);
+  SpanKernel const dst_to_float = registry.get(dstformat, PixelFormat::RGBA32f, BlendFunc::COPY);
+  SpanKernel const float_to_dst = registry.get(PixelFormat::RGBA32f, dstformat, BlendFunc::COPY);
+  SpanKernel const kernel = registry.get(PixelFormat::RGBA32f, PixelFormat::RGBA32f, op);
+
+  size_t const src_pixel_size = KernelRegistry::pixel_size(srcformat);
+  size_t const dst_pixel_size = KernelRegistry::pixel_size(dstformat);
+
+  constexpr size_t CHUNK_SIZE = 256;
+  std::array<RGBA32fPixel, CHUNK_SIZE> srcbuf;
+  std::array<RGBA32fPixel, CHUNK_SIZE> dstbuf;
+
+  for (size_t i = 0; i < count; i += CHUNK_SIZE) {
+    size_t const n = std::min(CHUNK_SIZE, count - i);
+    void* const dstspan = static_cast<uint8_t*>(dst) + i * dst_pixel_size;
+    src_to_float(static_cast<uint8_t const*>(src) + i * src_pixel_size, srcbuf.data(), n);
+    dst_to_float(dstspan, dstbuf.data(), n);
+    kernel(srcbuf.data(), dstbuf.data(), n);
+    float_to_dst(dstbuf.data(), dstspan, n);
+  }
+}
+
+template<typename SrcPixel, typename DstPixel, BlendFunc op>
+void composite_kernel(void const* src, void* dst, size_t count)
+{
+  if constexpr (std::is_same<SrcPixel, RGBA32fPixel>::value && std::is_same<DstPixel, RGBA32fPixel>::value) {
+    // the native kernel all other pairs go through
+    using srctype = SrcPixel;
+    using dsttype = DstPixel;
+    BLENDFUNC_TO_TYPE(op, blendfunc_t, (generic_kernel<SrcPixel, DstPixel, blendfunc_t>(src, dst, count)));
+  } else {
+    composite_span(PPixelFormat<SrcPixel>::format, PPixelFormat<DstPixel>::format, op, src, dst, count);
+  }
+}
+
+template<typename SrcPixel, typename DstPixel, size_t... Is>
+void add_composite_kernels(SpanKernel* table, std::index_sequence<Is...>)
+{
+  constexpr PixelFormat src = PPixelFormat<SrcPixel>::format;
+  constexpr PixelFormat dst = PPixelFormat<DstPixel>::format;
+  constexpr size_t first = static_cast<size_t>(BlendFunc::SCREEN);
+
+  ((table[kernel_index(src, dst, static_cast<BlendFunc>(first + Is))] =
+    &composite_kernel<SrcPixel, DstPixel, static_cast<BlendFunc>(first + Is)>), ...);
+}
+
+template<typename SrcPixel, typename DstPixel>
+void add_generic_kernels(SpanKernel* table)
+{
+  constexpr PixelFormat src = PPixelFormat<SrcPixel>::format;
+  constexpr PixelFormat dst = PPixelFormat<DstPixel>::format;
+
+  table[kernel_index(src, dst, BlendFunc::COPY)] = &generic_kernel<SrcPixel, DstPixel, pixel_copy<SrcPixel, DstPixel>>;
+  table[kernel_index(src, dst, BlendFunc::BLEND)] = &generic_kernel<SrcPixel, DstPixel, pixel_blend<SrcPixel, DstPixel>>;
+  table[kernel_index(src, dst, BlendFunc::ADD)] = &generic_kernel<SrcPixel, DstPixel, pixel_add<SrcPixel, DstPixel>>;
+  table[kernel_index(src, dst, BlendFunc::MULTIPLY)] = &generic_kernel<SrcPixel, DstPixel, pixel_multiply<SrcPixel, DstPixel>>;
+
+  // the blend modes past MULTIPLY
+  add_composite_kernels<SrcPixel, DstPixel>(
+    table, std::make_index_sequence<OP_COUNT - static_cast<size_t>(BlendFunc::SCREEN)>());
+}
+
+template<typename SrcPixel, typename... DstPixels>
+void add_generic_kernels_from(SpanKernel* table, std::tuple<DstPixels...> const*)
+{
+  (add_generic_kernels<SrcPixel, DstPixels>(table), ...);
+}
+
+template<typename... SrcPixels>
+void add_all_generic_kernels(SpanKernel* table, std::tuple<SrcPixels...> const* formats)
+{
+  (add_generic_kernels_from<SrcPixels>(table, formats), ...);
+}
+
+template<typename... Pixels>
+std::array<size_t, PIXEL_FORMAT_COUNT> make_pixel_sizes(std::tuple<Pixels...> const*)
+{
+  std::array<size_t, PIXEL_FORMAT_COUNT> sizes{};
+  ((sizes[static_cast<size_t>(PPixelFormat<Pixels>::format)] = sizeof(Pixels)), ...);
+  return sizes;
+}
+
+} // namespace
+
+KernelRegistry&
+KernelRegistry::instance()
+{
+  static KernelRegistry registry;
+  return registry;
+}
+
+size_t
+KernelRegistry::pixel_size(PixelFormat format)
+{
+  static std::array<size_t, PIXEL_FORMAT_COUNT> const sizes =
+    make_pixel_sizes(static_cast<GenericFormats const*>(nullptr));
+
+  size_t const idx = static_cast<size_t>(format);
+  return idx < sizes.size() ? sizes[idx] : 0;
+}
+
+KernelRegistry::KernelRegistry() :
+  m_kernels(),
+  m_generic(),
+  m_default()
+{
+  static_assert(OP_COUNT == KernelRegistry::OP_COUNT);
+
+  m_generic.fill(nullptr);
+  add_all_generic_kernels(m_generic.data(), static_cast<GenericFormats const*>(nullptr));
+
+  for (size_t i = 0; i < TABLE_SIZE; ++i) {
+    m_kernels[i].store(m_generic[i], std::memory_order_relaxed);
+  }
+
+  kernels::register_convert_kernels(*this);
+  kernels::register_swizzle_kernels(*this);
+  kernels::register_premultiply_kernels(*this);
+  kernels::register_half_kernels(*this);
+  kernels::register_blend_kernels(*this);
+
+  // reset() returns to the kernels picked for this CPU, m_generic
+  // keeps the template kernels as a reference
+  for (size_t i = 0; i < TABLE_SIZE; ++i) {
+    m_default[i] = m_kernels[i].load(std::memory_order_relaxed);
+  }
+}
+
+SpanKernel
+KernelRegistry::get(PixelFormat src, PixelFormat dst, BlendFunc op) const
+{
+  SpanKernel const kernel = m_kernels[kernel_index(src, dst, op)].load(std::memory_order_acquire);
+  if (kernel == nullptr) {
+    throw std::invalid_argument("KernelRegistry: no kernel for " +
+                                to_string(src) + " -> " + to_string(dst));
+  }
+  return kernel;
+}
+
+void
+KernelRegistry::set(PixelFormat src, PixelFormat dst, BlendFunc op, SpanKernel kernel)
+{
+  m_kernels[kernel_index(src, dst, op)].store(kernel, std::memory_order_release);
+}
+
+void
+KernelRegistry::reset(PixelFormat src, PixelFormat dst, BlendFunc op)
+{
+  size_t const idx = kernel_index(src, dst, op);
+  m_kernels[idx].store(m_default[idx], std::memory_order_release);
+}
+
+SpanKernel
+KernelRegistry::get_default(PixelFormat src, PixelFormat dst, BlendFunc op) const
+{
+  return m_default[kernel_index(src, dst, op)];
+}
+
+SpanKernel
+KernelRegistry::get_generic(PixelFormat src, PixelFormat dst, BlendFunc op) const
+{
+  return m_generic[kernel_index(src, dst, op)];
+}
+
+void apply_kernel(SpanKernel kernel,
+                  SoftwareSurface const& src, geom::irect const& srcrect,
+                  SoftwareSurface& dst, geom::ipoint const& pos)
+{
+  assert(contains(geom::irect(src.get_size()), srcrect));
+
+  size_t const src_pixel_size = KernelRegistry::pixel_size(src.get_format());
+  size_t const dst_pixel_size = KernelRegistry::pixel_size(dst.get_format());
+
+  geom::irect const cliprect(dst.get_size());
+  geom::irect const region = intersection(geom::irect(srcrect.size()) + geom::ioffset(pos), cliprect);
+  geom::ioffset const dst2src(-pos.x() + srcrect.left(), -pos.y() + srcrect.top());
+
+  if (region.width() <= 0) {
+    return;
+  }
+
+  for (int y = region.top(); y < region.bottom(); ++y) {
+    kernel(static_cast<uint8_t const*>(src.get_row_data(y + dst2src.y())) + (region.left() + dst2src.x()) * src_pixel_size,
+           static_cast<uint8_t*>(dst.get_row_data_detached(y)) + region.left() * dst_pixel_size,
+           region.width());
+  }
+}
+
+void apply_kernel_scaled(SpanKernel kernel,
+                         SoftwareSurface const& src, geom::irect const& srcrect_unclipped,
+                         SoftwareSurface& dst, geom::irect const& dstrect_unclipped,
+                         ScaleFilter filter)
+{
+  geom::irect srcrect = srcrect_unclipped;
+  geom::irect dstrect = dstrect_unclipped;
+  if (!detail::clip_scaled(src.get_size(), srcrect, dst.get_size(), dstrect)) {
+    return;
+  }
+
+  assert(contains(geom::irect(src.get_size()), srcrect));
+  assert(contains(geom::irect(dst.get_size()), dstrect));
+
+  size_t const dst_pixel_size = KernelRegistry::pixel_size(dst.get_format());
+
+  visit(src, [&](auto const& srcview) {
+    using SrcPixel = typename std::decay_t<decltype(srcview)>::value_type;
+
+    // the sampled source pixels, so the kernel sees a plain span
+    ScaledRowSampler<SrcPixel> sampler(srcview, srcrect, dstrect.size(), filter);
+    std::vector<SrcPixel> samples(static_cast<size_t>(dstrect.width()));
+
+    for (int y = 0; y < dstrect.height(); ++y) {
+      sampler.sample_row(y, samples.data());
+      kernel(samples.data(),
+             static_cast<uint8_t*>(dst.get_row_data_detached(y + dstrect.top())) + dstrect.left() * dst_pixel_size,
+             samples.size());
+    }
+  });
+}
+
+void apply_kernel_scaled(SpanKernel kernel,
+                         SoftwareSurface const& src, geom::irect const& srcrect,
+                         SoftwareSurface& dst, geom::irect const& dstrect)
+{
+  apply_kernel_scaled(kernel, src, srcrect, dst, dstrect, ScaleFilter::NEAREST);
+}
+
+} // namespace surf
+
+/* EOF */
@@ -0,0 +1,339 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "kernels/blend_kernels.hpp"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define SURF_HAVE_BLEND_KERNELS
+#  include <immintrin.h>
+#endif
+
+#include "blend.hpp"
+#include "kernel_registry.hpp"
+#include "pixel.hpp"
+
+namespace surf {
+namespace kernels {
+
+namespace {
+
+#ifdef SURF_HAVE_BLEND_KERNELS
+
+/** Load and store the twelve bytes of four RGB8 or two RGB16 pixels
+    without touching the memory behind them */
+__attribute__((target("sse4.1"))) inline
+__m128i load12(void const* p)
+{
+  int32_t tail;
+  memcpy(&tail, static_cast<uint8_t const*>(p) + 8, sizeof(tail));
+  return _mm_insert_epi32(_mm_loadl_epi64(static_cast<__m128i const*>(p)), tail, 2);
+}
+
+__attribute__((target("sse4.1"))) inline
+void store12(void* p, __m128i v)
+{
+  int32_t const tail = _mm_extract_epi32(v, 2);
+  _mm_storel_epi64(static_cast<__m128i*>(p), v);
+  memcpy(static_cast<uint8_t*>(p) + 8, &tail, sizeof(tail));
+}
+
+/** floor(x / d) for 0 <= x < 2^24 and d > 0. The float quotient is
+    off by at most one, the remainder corrects it. */
+__attribute__((target("sse4.1"))) inline
+__m128i div_exact(__m128i x, __m128i d)
+{
+  __m128i q = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(x), _mm_cvtepi32_ps(d)));
+  __m128i const r = _mm_sub_epi32(x, _mm_mullo_epi32(q, d));
+  q = _mm_sub_epi32(q, _mm_cmpgt_epi32(r, _mm_sub_epi32(d, _mm_set1_epi32(1))));
+  return _mm_add_epi32(q, _mm_cmpgt_epi32(_mm_setzero_si128(), r));
+}
+
+__attribute__((target("avx2"))) inline
+__m256i div_exact(__m256i x, __m256i d)
+{
+  __m256i q = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(x), _mm256_cvtepi32_ps(d)));
+  __m256i const r = _mm256_sub_epi32(x, _mm256_mullo_epi32(q, d));
+  q = _mm256_sub_epi32(q, _mm256_cmpgt_epi32(r, _mm256_sub_epi32(d, _mm256_set1_epi32(1))));
+  return _mm256_add_epi32(q, _mm256_cmpgt_epi32(_mm256_setzero_si256(), r));
+}
+
+/** pixel_blend<RGBA8Pixel, RGBA8Pixel> for one pixel with 32 bits per
+    channel. Colors above 255 are left for packus to clamp, pixels with
+    a transparent source keep the destination. */
+__attribute__((target("sse4.1"))) inline
+__m128i over_rgba8_1(__m128i s, __m128i d)
+{
+  __m128i const max = _mm_set1_epi32(255);
+  __m128i const sa = _mm_shuffle_epi32(s, _MM_SHUFFLE(3, 3, 3, 3));
+  __m128i const da = _mm_shuffle_epi32(d, _MM_SHUFFLE(3, 3, 3, 3));
+  __m128i const t = _mm_mullo_epi32(da, _mm_sub_epi32(max, sa));
+  __m128i const t1 = _mm_add_epi32(t, _mm_set1_epi32(1));
+  __m128i const out_a = _mm_add_epi32(sa, _mm_srli_epi32(_mm_add_epi32(t1, _mm_srli_epi32(t1, 8)), 8));
+  __m128i const n = _mm_add_epi32(_mm_mullo_epi32(s, sa), div_exact(_mm_mullo_epi32(d, t), max));
+  __m128i const q = div_exact(n, _mm_max_epi32(out_a, _mm_set1_epi32(1)));
+  __m128i const p = _mm_blend_epi16(q, out_a, 0xc0);
+  return _mm_blendv_epi8(p, d, _mm_cmpeq_epi32(sa, _mm_setzero_si128()));
+}
+
+/** Two pixel version of over_rgba8_1() */
+__attribute__((target("avx2"))) inline
+__m256i over_rgba8_2(__m256i s, __m256i d)
+{
+  __m256i const max = _mm256_set1_epi32(255);
+  __m256i const sa = _mm256_shuffle_epi32(s, _MM_SHUFFLE(3, 3, 3, 3));
+  __m256i const da = _mm256_shuffle_epi32(d, _MM_SHUFFLE(3, 3, 3, 3));
+  __m256i const t = _mm256_mullo_epi32(da, _mm256_sub_epi32(max, sa));
+  __m256i const t1 = _mm256_add_epi32(t, _mm256_set1_epi32(1));
+  __m256i const out_a = _mm256_add_epi32(sa, _mm256_srli_epi32(_mm256_add_epi32(t1, _mm256_srli_epi32(t1, 8)), 8));
+  __m256i const n = _mm256_add_epi32(_mm256_mullo_epi32(s, sa), div_exact(_mm256_mullo_epi32(d, t), max));
+  __m256i const q = div_exact(n, _mm256_max_epi32(out_a, _mm256_set1_epi32(1)));
+  __m256i const p = _mm256_blend_epi16(q, out_a, 0xc0);
+  return _mm256_blendv_epi8(p, d, _mm256_cmpeq_epi32(sa, _mm256_setzero_si256()));
+}
+
+/** Four pixels of RGBA8 over RGBA8, 16 bytes each */
+__attribute__((target("avx2"))) inline
+__m128i over_rgba8_4(__m128i s, __m128i d)
+{
+  __m256i const lo = over_rgba8_2(_mm256_cvtepu8_epi32(s), _mm256_cvtepu8_epi32(d));
+  __m256i const hi = over_rgba8_2(_mm256_cvtepu8_epi32(_mm_srli_si128(s, 8)),
+                                  _mm256_cvtepu8_epi32(_mm_srli_si128(d, 8)));
+  // packus interleaves the 128 bit lanes, the permute restores pixel order
+  __m256i const p = _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+  return _mm_packus_epi16(_mm256_castsi256_si128(p), _mm256_extracti128_si256(p, 1));
+}
+
+__attribute__((target("sse4.1")))
+void over_rgba8_rgba8_sse41(void const* src, void* dst, size_t count)
+{
+  RGBA8Pixel const* s = static_cast<RGBA8Pixel const*>(src);
+  RGBA8Pixel* d = static_cast<RGBA8Pixel*>(dst);
+  __m128i const alpha = _mm_set1_epi32(static_cast<int>(0xff000000));
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i const sv = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+    if (_mm_testz_si128(sv, alpha)) {
+      continue;
+    } else if (_mm_testc_si128(sv, alpha)) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), sv);
+    } else {
+      __m128i const dv = _mm_loadu_si128(reinterpret_cast<__m128i const*>(d + i));
+      __m128i const p0 = over_rgba8_1(_mm_cvtepu8_epi32(sv), _mm_cvtepu8_epi32(dv));
+      __m128i const p1 = over_rgba8_1(_mm_cvtepu8_epi32(_mm_srli_si128(sv, 4)), _mm_cvtepu8_epi32(_mm_srli_si128(dv, 4)));
+      __m128i const p2 = over_rgba8_1(_mm_cvtepu8_epi32(_mm_srli_si128(sv, 8)), _mm_cvtepu8_epi32(_mm_srli_si128(dv, 8)));
+      __m128i const p3 = over_rgba8_1(_mm_cvtepu8_epi32(_mm_srli_si128(sv, 12)), _mm_cvtepu8_epi32(_mm_srli_si128(dv, 12)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i),
+                       _mm_packus_epi16(_mm_packus_epi32(p0, p1), _mm_packus_epi32(p2, p3)));
+    }
+  }
+
+  for (; i < count; ++i) {
+    d[i] = pixel_blend<RGBA8Pixel, RGBA8Pixel>()(s[i], d[i]);
+  }
+}
+
+__attribute__((target("avx2")))
+void over_rgba8_rgba8_avx2(void const* src, void* dst, size_t count)
+{
+  RGBA8Pixel const* s = static_cast<RGBA8Pixel const*>(src);
+  RGBA8Pixel* d = static_cast<RGBA8Pixel*>(dst);
+  __m256i const alpha = _mm256_set1_epi32(static_cast<int>(0xff000000));
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i const sv = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s + i));
+    if (_mm256_testz_si256(sv, alpha)) {
+      continue;
+    } else if (_mm256_testc_si256(sv, alpha)) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), sv);
+    } else {
+      __m256i const dv = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(d + i));
+      __m128i const lo = over_rgba8_4(_mm256_castsi256_si128(sv), _mm256_castsi256_si128(dv));
+      __m128i const hi = over_rgba8_4(_mm256_extracti128_si256(sv, 1), _mm256_extracti128_si256(dv, 1));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), _mm256_set_m128i(hi, lo));
+    }
+  }
+
+  for (; i < count; ++i) {
+    d[i] = pixel_blend<RGBA8Pixel, RGBA8Pixel>()(s[i], d[i]);
+  }
+}
+
+/** (s * a + d * (255 - a)) / 255 with 16 bits per channel, exact as
+    the sum never exceeds 255 * 255 */
+__attribute__((target("sse4.1"))) inline
+__m128i mix_rgb8(__m128i s, __m128i d, __m128i a)
+{
+  __m128i const x = _mm_add_epi16(_mm_mullo_epi16(s, a),
+                                  _mm_mullo_epi16(d, _mm_sub_epi16(_mm_set1_epi16(255), a)));
+  __m128i const x1 = _mm_add_epi16(x, _mm_set1_epi16(1));
+  return _mm_srli_epi16(_mm_add_epi16(x1, _mm_srli_epi16(x1, 8)), 8);
+}
+
+__attribute__((target("sse4.1")))
+void over_rgba8_rgb8_sse41(void const* src, void* dst, size_t count)
+{
+  RGBA8Pixel const* s = static_cast<RGBA8Pixel const*>(src);
+  RGB8Pixel* d = static_cast<RGB8Pixel*>(dst);
+  __m128i const alpha = _mm_set1_epi32(static_cast<int>(0xff000000));
+  __m128i const zero = _mm_setzero_si128();
+  __m128i const to_rgb = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+  __m128i const to_rgbx = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+  __m128i const bcast_alpha = _mm_setr_epi8(3, 3, 3, 3, 7, 7, 7, 7, 11, 11, 11, 11, 15, 15, 15, 15);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i const sv = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+    if (_mm_testz_si128(sv, alpha)) {
+      continue;
+    } else if (_mm_testc_si128(sv, alpha)) {
+      store12(d + i, _mm_shuffle_epi8(sv, to_rgb));
+    } else {
+      __m128i const dv = _mm_shuffle_epi8(load12(d + i), to_rgbx);
+      __m128i const av = _mm_shuffle_epi8(sv, bcast_alpha);
+      __m128i const lo = mix_rgb8(_mm_unpacklo_epi8(sv, zero), _mm_unpacklo_epi8(dv, zero), _mm_unpacklo_epi8(av, zero));
+      __m128i const hi = mix_rgb8(_mm_unpackhi_epi8(sv, zero), _mm_unpackhi_epi8(dv, zero), _mm_unpackhi_epi8(av, zero));
+      store12(d + i, _mm_shuffle_epi8(_mm_packus_epi16(lo, hi), to_rgb));
+    }
+  }
+
+  for (; i < count; ++i) {
+    d[i] = pixel_blend<RGBA8Pixel, RGB8Pixel>()(s[i], d[i]);
+  }
+}
+
+__attribute__((target("avx2")))
+void over_rgba16_rgb16_avx2(void const* src, void* dst, size_t count)
+{
+  RGBA16Pixel const* s = static_cast<RGBA16Pixel const*>(src);
+  RGB16Pixel* d = static_cast<RGB16Pixel*>(dst);
+  __m128i const alpha = _mm_set1_epi64x(static_cast<int64_t>(0xffff000000000000));
+  __m128i const to_rgb = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13, -1, -1, -1, -1);
+  __m128i const to_rgbx = _mm_setr_epi8(0, 1, 2, 3, 4, 5, -1, -1, 6, 7, 8, 9, 10, 11, -1, -1);
+  __m256i const max = _mm256_set1_epi32(65535);
+
+  size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    __m128i const sv = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+    if (_mm_testz_si128(sv, alpha)) {
+      continue;
+    } else if (_mm_testc_si128(sv, alpha)) {
+      store12(d + i, _mm_shuffle_epi8(sv, to_rgb));
+    } else {
+      // the sum stays below 2^32 and so does the division by 65535
+      __m256i const s32 = _mm256_cvtepu16_epi32(sv);
+      __m256i const d32 = _mm256_cvtepu16_epi32(_mm_shuffle_epi8(load12(d + i), to_rgbx));
+      __m256i const sa = _mm256_shuffle_epi32(s32, _MM_SHUFFLE(3, 3, 3, 3));
+      __m256i const x = _mm256_add_epi32(_mm256_mullo_epi32(s32, sa),
+                                         _mm256_mullo_epi32(d32, _mm256_sub_epi32(max, sa)));
+      __m256i const x1 = _mm256_add_epi32(x, _mm256_set1_epi32(1));
+      __m256i const q = _mm256_srli_epi32(_mm256_add_epi32(x1, _mm256_srli_epi32(x1, 16)), 16);
+      __m128i const p = _mm_packus_epi32(_mm256_castsi256_si128(q), _mm256_extracti128_si256(q, 1));
+      store12(d + i, _mm_shuffle_epi8(p, to_rgb));
+    }
+  }
+
+  for (; i < count; ++i) {
+    d[i] = pixel_blend<RGBA16Pixel, RGB16Pixel>()(s[i], d[i]);
+  }
+}
+
+/** pixel_blend<RGBA16Pixel, RGBA16Pixel> for one pixel in double. The
+    products stay below 2^49 and the floored quotients are exact, as no
+    rounding error comes close to the 1/65535 distance between a
+    fraction and the next integer. */
+__attribute__((target("avx2"))) inline
+void over_rgba16_1(RGBA16Pixel const* src, RGBA16Pixel* dst)
+{
+  if (src->a == 0) {
+    return;
+  } else if (src->a == 65535) {
+    *dst = *src;
+  } else {
+    __m256d const max = _mm256_set1_pd(65535.0);
+    __m256d const s = _mm256_cvtepi32_pd(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(src))));
+    __m256d const d = _mm256_cvtepi32_pd(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(dst))));
+    __m256d const sa = _mm256_permute4x64_pd(s, _MM_SHUFFLE(3, 3, 3, 3));
+    __m256d const da = _mm256_permute4x64_pd(d, _MM_SHUFFLE(3, 3, 3, 3));
+    __m256d const t = _mm256_mul_pd(da, _mm256_sub_pd(max, sa));
+    __m256d const out_a = _mm256_add_pd(sa, _mm256_floor_pd(_mm256_div_pd(t, max)));
+    __m256d const n = _mm256_add_pd(_mm256_mul_pd(s, sa), _mm256_floor_pd(_mm256_div_pd(_mm256_mul_pd(d, t), max)));
+    __m256d const q = _mm256_min_pd(_mm256_floor_pd(_mm256_div_pd(n, out_a)), max);
+    __m128i const p = _mm256_cvttpd_epi32(_mm256_blend_pd(q, out_a, 0x8));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi32(p, p));
+  }
+}
+
+__attribute__((target("avx2")))
+void over_rgba16_rgba16_avx2(void const* src, void* dst, size_t count)
+{
+  RGBA16Pixel const* s = static_cast<RGBA16Pixel const*>(src);
+  RGBA16Pixel* d = static_cast<RGBA16Pixel*>(dst);
+  __m256i const alpha = _mm256_set1_epi64x(static_cast<int64_t>(0xffff000000000000));
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256i const sv = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s + i));
+    if (_mm256_testz_si256(sv, alpha)) {
+      continue;
+    } else if (_mm256_testc_si256(sv, alpha)) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), sv);
+    } else {
+      for (size_t j = i; j < i + 4; ++j) {
+        over_rgba16_1(s + j, d + j);
+      }
+    }
+  }
+
+  for (; i < count; ++i) {
+    d[i] = pixel_blend<RGBA16Pixel, RGBA16Pixel>()(s[i], d[i]);
+  }
+}
+
+#endif
+
+} // namespace
+
+void register_blend_kernels(KernelRegistry& registry)
+{
+#ifdef SURF_HAVE_BLEND_KERNELS
+  if (__builtin_cpu_supports("sse4.1")) {
+    registry.set(PixelFormat::RGBA8, PixelFormat::RGBA8, BlendFunc::BLEND, &over_rgba8_rgba8_sse41);
+    registry.set(PixelFormat::RGBA8, PixelFormat::RGB8, BlendFunc::BLEND, &over_rgba8_rgb8_sse41);
+  }
+
+  if (__builtin_cpu_supports("avx2")) {
+    registry.set(PixelFormat::RGBA8, PixelFormat::RGBA8, BlendFunc::BLEND, &over_rgba8_rgba8_avx2);
+    registry.set(PixelFormat::RGBA16, PixelFormat::RGBA16, BlendFunc::BLEND, &over_rgba16_rgba16_avx2);
+    registry.set(PixelFormat::RGBA16, PixelFormat::RGB16, BlendFunc::BLEND, &over_rgba16_rgb16_avx2);
+  }
+
+  if (__builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c")) {
+    register_blend_kernels_avx(registry);
+  }
+#else
+  (void)registry;
+#endif
+}
+
+} // namespace kernels
+} // namespace surf
+
+/* EOF */
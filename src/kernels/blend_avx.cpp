@@ -0,0 +1,373 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "kernels/blend_kernels.hpp"
+
+// built with -mavx -mf16c where the compiler supports it, see
+// CMakeLists.txt, everything in here only runs after the CPU check in
+// register_blend_kernels()
+#if defined(__AVX__) && defined(__F16C__)
+#  define SURF_HAVE_AVX_BLEND_KERNELS
+#  include <immintrin.h>
+#endif
+
+#include <type_traits>
+
+#include "blendmode.hpp"
+#include "kernel_registry.hpp"
+#include "pixel.hpp"
+
+namespace surf {
+namespace kernels {
+
+namespace {
+
+#ifdef SURF_HAVE_AVX_BLEND_KERNELS
+
+/** Two RGBA32f or RGBA16f pixels as eight floats */
+inline
+__m256 load2(RGBA32fPixel const* p)
+{
+  return _mm256_loadu_ps(&p->r);
+}
+
+inline
+__m256 load2(RGBA16fPixel const* p)
+{
+  return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p)));
+}
+
+inline
+__m256 load2(RGBA8Pixel const* p)
+{
+  __m128i const v = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(p));
+  __m256i const i32 = _mm256_setr_m128i(_mm_cvtepu8_epi32(v), _mm_cvtepu8_epi32(_mm_srli_si128(v, 4)));
+  return _mm256_div_ps(_mm256_cvtepi32_ps(i32), _mm256_set1_ps(255.0f));
+}
+
+inline
+void store2(RGBA32fPixel* p, __m256 v)
+{
+  _mm256_storeu_ps(&p->r, v);
+}
+
+inline
+void store2(RGBA16fPixel* p, __m256 v)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+}
+
+/** Two RGB32f, L32f or LA32f pixels spread out like RGBA32f, the
+    gray is copied into red, green and blue, a missing alpha is 1.0 */
+inline
+__m256 load2(RGB32fPixel const* p)
+{
+  __m128i const mask = _mm_setr_epi32(-1, -1, -1, 0);
+  __m256 const v = _mm256_setr_m128(_mm_maskload_ps(&p[0].r, mask), _mm_maskload_ps(&p[1].r, mask));
+  return _mm256_blend_ps(v, _mm256_set1_ps(1.0f), 0x88);
+}
+
+inline
+__m256 load2(L32fPixel const* p)
+{
+  __m128 const v = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<double const*>(p)));
+  __m256 const l = _mm256_setr_m128(_mm_permute_ps(v, _MM_SHUFFLE(0, 0, 0, 0)),
+                                    _mm_permute_ps(v, _MM_SHUFFLE(1, 1, 1, 1)));
+  return _mm256_blend_ps(l, _mm256_set1_ps(1.0f), 0x88);
+}
+
+inline
+__m256 load2(LA32fPixel const* p)
+{
+  __m128 const v = _mm_loadu_ps(&p->l);
+  return _mm256_setr_m128(_mm_permute_ps(v, _MM_SHUFFLE(1, 0, 0, 0)),
+                          _mm_permute_ps(v, _MM_SHUFFLE(3, 2, 2, 2)));
+}
+
+/** The gray stores take red, see to_dst() */
+inline
+void store2(RGB32fPixel* p, __m256 v)
+{
+  __m128i const mask = _mm_setr_epi32(-1, -1, -1, 0);
+  _mm_maskstore_ps(&p[0].r, mask, _mm256_castps256_ps128(v));
+  _mm_maskstore_ps(&p[1].r, mask, _mm256_extractf128_ps(v, 1));
+}
+
+inline
+void store2(L32fPixel* p, __m256 v)
+{
+  _mm_storel_pi(reinterpret_cast<__m64*>(p),
+                _mm_unpacklo_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+inline
+void store2(LA32fPixel* p, __m256 v)
+{
+  _mm_storeu_ps(&p->l, _mm_shuffle_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1),
+                                      _MM_SHUFFLE(3, 0, 3, 0)));
+}
+
+/** Rounds like convert_value() */
+inline
+void store2(RGBA8Pixel* p, __m256 v)
+{
+  v = _mm256_max_ps(_mm256_min_ps(v, _mm256_set1_ps(1.0f)), _mm256_setzero_ps());
+  __m256i const i32 = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(v, _mm256_set1_ps(255.0f)),
+                                                        _mm256_set1_ps(0.5f)));
+  __m128i const i16 = _mm_packus_epi32(_mm256_castsi256_si128(i32), _mm256_extractf128_si256(i32, 1));
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(i16, i16));
+}
+
+// The float operations follow the scalar functors step by step, there
+// is no FMA, so the results only differ where the compiler contracts
+// the scalar code. Pixels with a transparent source keep the
+// destination, for "over" an opaque one replaces it.
+
+struct FloatOver
+{
+  static constexpr bool skip_transparent = true;
+  static constexpr bool copy_opaque = true;
+
+  static inline
+  __m256 apply(__m256 s, __m256 d)
+  {
+    __m256 const sa = _mm256_permute_ps(s, _MM_SHUFFLE(3, 3, 3, 3));
+    __m256 const dw = _mm256_mul_ps(_mm256_permute_ps(d, _MM_SHUFFLE(3, 3, 3, 3)),
+                                    _mm256_sub_ps(_mm256_set1_ps(1.0f), sa));
+    __m256 const out_a = _mm256_add_ps(sa, dw);
+    __m256 const c = _mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(s, sa), _mm256_mul_ps(d, dw)), out_a);
+    return _mm256_blendv_ps(_mm256_blend_ps(c, out_a, 0x88), d,
+                            _mm256_cmp_ps(sa, _mm256_setzero_ps(), _CMP_EQ_OQ));
+  }
+};
+
+/** FloatOver for destinations without alpha, which count as opaque */
+struct FloatOverOpaque
+{
+  static constexpr bool skip_transparent = true;
+  static constexpr bool copy_opaque = true;
+
+  static inline
+  __m256 apply(__m256 s, __m256 d)
+  {
+    __m256 const sa = _mm256_permute_ps(s, _MM_SHUFFLE(3, 3, 3, 3));
+    __m256 const c = _mm256_add_ps(_mm256_mul_ps(s, sa),
+                                   _mm256_mul_ps(d, _mm256_sub_ps(_mm256_set1_ps(1.0f), sa)));
+    return _mm256_blendv_ps(c, d, _mm256_cmp_ps(sa, _mm256_setzero_ps(), _CMP_EQ_OQ));
+  }
+};
+
+struct FloatAdd
+{
+  static constexpr bool skip_transparent = true;
+  static constexpr bool copy_opaque = false;
+
+  static inline
+  __m256 apply(__m256 s, __m256 d)
+  {
+    __m256 const sa = _mm256_permute_ps(s, _MM_SHUFFLE(3, 3, 3, 3));
+    __m256 const c = _mm256_add_ps(d, _mm256_mul_ps(s, sa));
+    return _mm256_blendv_ps(_mm256_blend_ps(c, d, 0x88), d,
+                            _mm256_cmp_ps(sa, _mm256_setzero_ps(), _CMP_EQ_OQ));
+  }
+};
+
+struct FloatMultiply
+{
+  static constexpr bool skip_transparent = true;
+  static constexpr bool copy_opaque = false;
+
+  static inline
+  __m256 apply(__m256 s, __m256 d)
+  {
+    __m256 const sa = _mm256_permute_ps(s, _MM_SHUFFLE(3, 3, 3, 3));
+    __m256 const c = _mm256_mul_ps(d, _mm256_add_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), sa),
+                                                    _mm256_mul_ps(s, sa)));
+    return _mm256_blendv_ps(_mm256_blend_ps(c, d, 0x88), d,
+                            _mm256_cmp_ps(sa, _mm256_setzero_ps(), _CMP_EQ_OQ));
+  }
+};
+
+/** blendmode::ScalarOps for __m256, the arithmetic uses the vector
+    extension operators */
+struct AvxOps
+{
+  static inline __m256 k(float v) { return _mm256_set1_ps(v); }
+  static inline __m256 min(__m256 a, __m256 b) { return _mm256_min_ps(a, b); }
+  static inline __m256 max(__m256 a, __m256 b) { return _mm256_max_ps(a, b); }
+  static inline __m256 abs(__m256 v) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v); }
+  static inline __m256 sqrt(__m256 v) { return _mm256_sqrt_ps(v); }
+  static inline __m256 le(__m256 a, __m256 b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+  // spelled out, GCC lowers a blendv on a compare result lane by lane here
+  static inline __m256 select(__m256 m, __m256 a, __m256 b) {
+    return _mm256_or_ps(_mm256_and_ps(m, a), _mm256_andnot_ps(m, b));
+  }
+};
+
+/** The blendmode:: templates instantiated with AvxOps, the same
+    operations as blendmode::composite() */
+template<typename Mode>
+struct FloatComposite
+{
+  // a transparent source keeps the destination unless fb() clears it
+  static constexpr bool skip_transparent = Mode::template fb<blendmode::ScalarOps>(0.0f, 0.5f) == 1.0f;
+  static constexpr bool copy_opaque = false;
+
+  static inline
+  __m256 apply(__m256 s, __m256 d)
+  {
+    __m256 const sa = _mm256_permute_ps(s, _MM_SHUFFLE(3, 3, 3, 3));
+    __m256 const da = _mm256_permute_ps(d, _MM_SHUFFLE(3, 3, 3, 3));
+    __m256 const wa = Mode::template fa<AvxOps>(sa, da) * sa;
+    __m256 const fb = Mode::template fb<AvxOps>(sa, da);
+    __m256 const wb = fb * da;
+    __m256 const out_a = wa + wb;
+
+    __m256 const c = blendmode::composite_channel<Mode, AvxOps>(s, d, da, wa, wb, out_a);
+    __m256 const cleared = _mm256_andnot_ps(_mm256_cmp_ps(out_a, _mm256_setzero_ps(), _CMP_EQ_OQ),
+                                            _mm256_blend_ps(c, out_a, 0x88));
+    __m256 const keep = _mm256_and_ps(_mm256_cmp_ps(wa, _mm256_setzero_ps(), _CMP_EQ_OQ),
+                                      _mm256_cmp_ps(fb, _mm256_set1_ps(1.0f), _CMP_EQ_OQ));
+    return AvxOps::select(keep, d, cleared);
+  }
+};
+
+/** The result \a v of an operation on \a s and \a d as the
+    destination format sees it, make_pixel() averages red, green and
+    blue for the gray formats. A destination kept for a transparent
+    source stays as it is, the average of three equal values need not
+    give the value back. */
+template<typename DstPixel> inline
+__m256 to_dst(__m256 s, __m256 d, __m256 v)
+{
+  if constexpr (DstPixel::has_rgb()) {
+    return v;
+  } else {
+    __m256 const sum = _mm256_add_ps(_mm256_add_ps(_mm256_permute_ps(v, _MM_SHUFFLE(0, 0, 0, 0)),
+                                                   _mm256_permute_ps(v, _MM_SHUFFLE(1, 1, 1, 1))),
+                                     _mm256_permute_ps(v, _MM_SHUFFLE(2, 2, 2, 2)));
+    __m256 const gray = _mm256_blend_ps(_mm256_div_ps(sum, _mm256_set1_ps(3.0f)), v, 0x88);
+    return _mm256_blendv_ps(gray, d, _mm256_cmp_ps(_mm256_permute_ps(s, _MM_SHUFFLE(3, 3, 3, 3)),
+                                                   _mm256_setzero_ps(), _CMP_EQ_OQ));
+  }
+}
+
+template<typename Op, BlendFunc func, typename SrcPixel, typename DstPixel>
+void float_kernel_avx(void const* src, void* dst, size_t count)
+{
+  SrcPixel const* s = static_cast<SrcPixel const*>(src);
+  DstPixel* d = static_cast<DstPixel*>(dst);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256 const slo = load2(s + i);
+    __m256 const shi = load2(s + i + 2);
+
+    // alpha is lane 3 and 7 of each half
+    int const transparent = _mm256_movemask_ps(_mm256_cmp_ps(slo, _mm256_setzero_ps(), _CMP_EQ_OQ)) &
+                            _mm256_movemask_ps(_mm256_cmp_ps(shi, _mm256_setzero_ps(), _CMP_EQ_OQ));
+    if (Op::skip_transparent && (transparent & 0x88) == 0x88) {
+      continue;
+    }
+
+    if constexpr (Op::copy_opaque) {
+      int const opaque = _mm256_movemask_ps(_mm256_cmp_ps(slo, _mm256_set1_ps(1.0f), _CMP_EQ_OQ)) &
+                         _mm256_movemask_ps(_mm256_cmp_ps(shi, _mm256_set1_ps(1.0f), _CMP_EQ_OQ));
+      if ((opaque & 0x88) == 0x88) {
+        store2(d + i, to_dst<DstPixel>(slo, slo, slo));
+        store2(d + i + 2, to_dst<DstPixel>(shi, shi, shi));
+        continue;
+      }
+    }
+
+    __m256 const dlo = load2(d + i);
+    __m256 const dhi = load2(d + i + 2);
+    store2(d + i, to_dst<DstPixel>(slo, dlo, Op::apply(slo, dlo)));
+    store2(d + i + 2, to_dst<DstPixel>(shi, dhi, Op::apply(shi, dhi)));
+  }
+
+  if (i < count) {
+    // the inline scalar functors are compiled without AVX elsewhere,
+    // so the tail goes to the generic kernel instead of instantiating
+    // them in here
+    KernelRegistry::instance().get_generic(PPixelFormat<SrcPixel>::format, PPixelFormat<DstPixel>::format, func)(
+      s + i, d + i, count - i);
+  }
+}
+
+template<typename SrcPixel, typename DstPixel>
+void register_float_kernels(KernelRegistry& registry)
+{
+  constexpr PixelFormat src = PPixelFormat<SrcPixel>::format;
+  constexpr PixelFormat dst = PPixelFormat<DstPixel>::format;
+
+  using Over = typename std::conditional<DstPixel::has_alpha(), FloatOver, FloatOverOpaque>::type;
+
+  registry.set(src, dst, BlendFunc::BLEND, &float_kernel_avx<Over, BlendFunc::BLEND, SrcPixel, DstPixel>);
+  registry.set(src, dst, BlendFunc::ADD, &float_kernel_avx<FloatAdd, BlendFunc::ADD, SrcPixel, DstPixel>);
+  registry.set(src, dst, BlendFunc::MULTIPLY, &float_kernel_avx<FloatMultiply, BlendFunc::MULTIPLY, SrcPixel, DstPixel>);
+}
+
+template<typename SrcPixel, typename DstPixel>
+void register_composite_kernels(KernelRegistry& registry)
+{
+  constexpr PixelFormat src = PPixelFormat<SrcPixel>::format;
+  constexpr PixelFormat dst = PPixelFormat<DstPixel>::format;
+
+  registry.set(src, dst, BlendFunc::SCREEN, &float_kernel_avx<FloatComposite<blendmode::Screen>, BlendFunc::SCREEN, SrcPixel, DstPixel>);
+  registry.set(src, dst, BlendFunc::OVERLAY, &float_kernel_avx<FloatComposite<blendmode::Overlay>, BlendFunc::OVERLAY, SrcPixel, DstPixel>);
+  registry.set(src, dst, BlendFunc::DARKEN, &float_kernel_avx<FloatComposite<blendmode::Darken>, BlendFunc::DARKEN, SrcPixel, DstPixel>);
+  registry.set(src, dst, BlendFunc::LIGHTEN, &float_kernel_avx<FloatComposite<blendmode::Lighten>, BlendFunc::LIGHTEN, SrcPixel, DstPixel>);
+  registry.set(src, dst, BlendFunc::DIFFERENCE, &float_kernel_avx<FloatComposite<blendmode::Difference>, BlendFunc::DIFFERENCE, SrcPixel, DstPixel>);
+  registry.set(src, dst, BlendFunc::SUBTRACT, &float_kernel_avx<FloatComposite<blendmode::Subtract>, BlendFunc::SUBTRACT, SrcPixel, DstPixel>);
+  registry.set(src, dst, BlendFunc::SOFT_LIGHT, &float_kernel_avx<FloatComposite<blendmode::SoftLight>, BlendFunc::SOFT_LIGHT, SrcPixel, DstPixel>);
+  registry.set(src, dst, BlendFunc::SRC_IN, &float_kernel_avx<FloatComposite<blendmode::SrcIn>, BlendFunc::SRC_IN, SrcPixel, DstPixel>);
+  registry.set(src, dst, BlendFunc::SRC_OUT, &float_kernel_avx<FloatComposite<blendmode::SrcOut>, BlendFunc::SRC_OUT, SrcPixel, DstPixel>);
+  registry.set(src, dst, BlendFunc::SRC_ATOP, &float_kernel_avx<FloatComposite<blendmode::SrcAtop>, BlendFunc::SRC_ATOP, SrcPixel, DstPixel>);
+  registry.set(src, dst, BlendFunc::XOR, &float_kernel_avx<FloatComposite<blendmode::Xor>, BlendFunc::XOR, SrcPixel, DstPixel>);
+}
+
+#endif
+
+} // namespace
+
+void register_blend_kernels_avx(KernelRegistry& registry)
+{
+#ifdef SURF_HAVE_AVX_BLEND_KERNELS
+  register_float_kernels<RGBA32fPixel, RGBA32fPixel>(registry);
+  register_float_kernels<RGBA32fPixel, RGBA16fPixel>(registry);
+  register_float_kernels<RGBA16fPixel, RGBA32fPixel>(registry);
+  register_float_kernels<RGBA16fPixel, RGBA16fPixel>(registry);
+  register_float_kernels<RGBA32fPixel, RGB32fPixel>(registry);
+  register_float_kernels<RGBA32fPixel, L32fPixel>(registry);
+  register_float_kernels<RGBA32fPixel, LA32fPixel>(registry);
+  register_float_kernels<RGBA16fPixel, RGB32fPixel>(registry);
+  register_float_kernels<RGBA16fPixel, L32fPixel>(registry);
+  register_float_kernels<RGBA16fPixel, LA32fPixel>(registry);
+
+  register_composite_kernels<RGBA32fPixel, RGBA32fPixel>(registry);
+  register_composite_kernels<RGBA16fPixel, RGBA16fPixel>(registry);
+  register_composite_kernels<RGBA8Pixel, RGBA8Pixel>(registry);
+  register_composite_kernels<RGBA8Pixel, RGBA32fPixel>(registry);
+#else
+  (void)registry;
+#endif
+}
+
+} // namespace kernels
+} // namespace surf
+
+/* EOF */
@@ -0,0 +1,52 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_KERNELS_BLEND_KERNELS_HPP
+#define HEADER_SURF_KERNELS_BLEND_KERNELS_HPP
+
+namespace surf {
+
+class KernelRegistry;
+
+namespace kernels {
+
+/** Register straight alpha BlendFunc::BLEND kernels for RGBA8 over
+    RGBA8 (SSE4.1, AVX2), RGBA8 over RGB8 (SSE4.1), RGBA16 over RGBA16
+    and RGBA16 over RGB16 (AVX2), picked by CPU detection. Fully
+    transparent source runs are skipped and fully opaque ones copied.
+    The results are identical to the generic kernels.
+
+    BLEND, ADD and MULTIPLY between RGBA32f and RGBA16f, and from
+    those onto RGB32f, L32f and LA32f, get AVX/F16C kernels, four
+    pixels per iteration. The other float destinations, RGB16f, L16f
+    and LA16f, and the integer ones stay with the generic kernels. The blend modes past MULTIPLY
+    get them for RGBA32f, RGBA16f and RGBA8 from the same
+    blendmode.hpp templates as the scalar code. */
+void register_blend_kernels(KernelRegistry& registry);
+
+/** The AVX/F16C float kernels of register_blend_kernels(). They live
+    in blend_avx.cpp, which is compiled with -mavx -mf16c so that the
+    blendmode.hpp templates get the vector ABI too, and must only be
+    registered after checking the CPU. Does nothing when the file was
+    built without AVX. */
+void register_blend_kernels_avx(KernelRegistry& registry);
+
+} // namespace kernels
+} // namespace surf
+
+#endif
+
+/* EOF */
@@ -0,0 +1,509 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "kernels/convert_kernels.hpp"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define SURF_HAVE_X86_KERNELS
+#  include <immintrin.h>
+#endif
+
+#include "convert.hpp"
+#include "kernel_registry.hpp"
+#include "pixel.hpp"
+
+namespace surf {
+namespace kernels {
+
+namespace {
+
+#ifdef SURF_HAVE_X86_KERNELS
+
+/** Turn a per channel function into a SpanKernel for pixels with
+    \a Channels channels */
+template<size_t Channels, typename Src, typename Dst, void (*Func)(Src const*, Dst*, size_t)>
+void per_channel(void const* src, void* dst, size_t count)
+{
+  Func(static_cast<Src const*>(src), static_cast<Dst*>(dst), count * Channels);
+}
+
+// 8 -> 16 bit, v * 65535 / 255 is v * 257
+
+__attribute__((target("sse2")))
+void u8_to_u16_sse2(uint8_t const* s, uint16_t* d, size_t n)
+{
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_unpacklo_epi8(v, v));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i + 8), _mm_unpackhi_epi8(v, v));
+  }
+
+  for (; i < n; ++i) {
+    d[i] = static_cast<uint16_t>(s[i] * 257);
+  }
+}
+
+__attribute__((target("avx2")))
+void u8_to_u16_avx2(uint8_t const* s, uint16_t* d, size_t n)
+{
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256i const v = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), _mm256_or_si256(v, _mm256_slli_epi16(v, 8)));
+  }
+
+  for (; i < n; ++i) {
+    d[i] = static_cast<uint16_t>(s[i] * 257);
+  }
+}
+
+// 8/16 bit -> float, a real division like convert_value()
+
+__attribute__((target("sse2")))
+void u8_to_f32_sse2(uint8_t const* s, float* d, size_t n)
+{
+  __m128i const zero = _mm_setzero_si128();
+  __m128 const max = _mm_set1_ps(255.0f);
+
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+    __m128i const lo = _mm_unpacklo_epi8(v, zero);
+    __m128i const hi = _mm_unpackhi_epi8(v, zero);
+    _mm_storeu_ps(d + i + 0, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), max));
+    _mm_storeu_ps(d + i + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), max));
+    _mm_storeu_ps(d + i + 8, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), max));
+    _mm_storeu_ps(d + i + 12, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), max));
+  }
+
+  for (; i < n; ++i) {
+    d[i] = static_cast<float>(s[i]) / 255.0f;
+  }
+}
+
+__attribute__((target("avx2")))
+void u8_to_f32_avx2(uint8_t const* s, float* d, size_t n)
+{
+  __m256 const max = _mm256_set1_ps(255.0f);
+
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i const v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(s + i)));
+    _mm256_storeu_ps(d + i, _mm256_div_ps(_mm256_cvtepi32_ps(v), max));
+  }
+
+  for (; i < n; ++i) {
+    d[i] = static_cast<float>(s[i]) / 255.0f;
+  }
+}
+
+__attribute__((target("sse2")))
+void u16_to_f32_sse2(uint16_t const* s, float* d, size_t n)
+{
+  __m128i const zero = _mm_setzero_si128();
+  __m128 const max = _mm_set1_ps(65535.0f);
+
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+    _mm_storeu_ps(d + i + 0, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero)), max));
+    _mm_storeu_ps(d + i + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero)), max));
+  }
+
+  for (; i < n; ++i) {
+    d[i] = static_cast<float>(s[i]) / 65535.0f;
+  }
+}
+
+__attribute__((target("avx2")))
+void u16_to_f32_avx2(uint16_t const* s, float* d, size_t n)
+{
+  __m256 const max = _mm256_set1_ps(65535.0f);
+
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i const v = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i)));
+    _mm256_storeu_ps(d + i, _mm256_div_ps(_mm256_cvtepi32_ps(v), max));
+  }
+
+  for (; i < n; ++i) {
+    d[i] = static_cast<float>(s[i]) / 65535.0f;
+  }
+}
+
+// 16 -> 8 bit, v / 257 truncated like fixed::rescale(), the high
+// half of v * 0xff01 shifted by 8 is exact for all 16-bit v
+
+__attribute__((target("sse2")))
+void u16_to_u8_sse2(uint16_t const* s, uint8_t* d, size_t n)
+{
+  __m128i const k = _mm_set1_epi16(static_cast<short>(0xff01));
+
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i const lo = _mm_srli_epi16(_mm_mulhi_epu16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i)), k), 8);
+    __m128i const hi = _mm_srli_epi16(_mm_mulhi_epu16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i + 8)), k), 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_packus_epi16(lo, hi));
+  }
+
+  for (; i < n; ++i) {
+    d[i] = static_cast<uint8_t>(s[i] / 257);
+  }
+}
+
+__attribute__((target("avx2")))
+void u16_to_u8_avx2(uint16_t const* s, uint8_t* d, size_t n)
+{
+  __m256i const k = _mm256_set1_epi16(static_cast<short>(0xff01));
+
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256i const q = _mm256_srli_epi16(_mm256_mulhi_epu16(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(s + i)), k), 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i),
+                     _mm_packus_epi16(_mm256_castsi256_si128(q), _mm256_extracti128_si256(q, 1)));
+  }
+
+  for (; i < n; ++i) {
+    d[i] = static_cast<uint8_t>(s[i] / 257);
+  }
+}
+
+// float -> 8/16 bit, clamped and rounded to nearest like
+// convert_value(), max(v, 0) returns its second operand for NaN, so
+// NaN becomes zero there as well
+
+__attribute__((target("sse2"))) inline
+__m128i f32_to_i32_sse2(__m128 v, __m128 max)
+{
+  v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+  return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, max), _mm_set1_ps(0.5f)));
+}
+
+__attribute__((target("avx2"))) inline
+__m256i f32_to_i32_avx2(__m256 v, __m256 max)
+{
+  v = _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+  return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(v, max), _mm256_set1_ps(0.5f)));
+}
+
+__attribute__((target("sse2")))
+void f32_to_u8_sse2(float const* s, uint8_t* d, size_t n)
+{
+  __m128 const max = _mm_set1_ps(255.0f);
+
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i const lo = _mm_packs_epi32(f32_to_i32_sse2(_mm_loadu_ps(s + i + 0), max),
+                                       f32_to_i32_sse2(_mm_loadu_ps(s + i + 4), max));
+    __m128i const hi = _mm_packs_epi32(f32_to_i32_sse2(_mm_loadu_ps(s + i + 8), max),
+                                       f32_to_i32_sse2(_mm_loadu_ps(s + i + 12), max));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_packus_epi16(lo, hi));
+  }
+
+  for (; i < n; ++i) {
+    d[i] = convert_value<RGBA32fPixel, RGBA8Pixel>(s[i]);
+  }
+}
+
+__attribute__((target("avx2")))
+void f32_to_u8_avx2(float const* s, uint8_t* d, size_t n)
+{
+  __m256 const max = _mm256_set1_ps(255.0f);
+
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i const v = f32_to_i32_avx2(_mm256_loadu_ps(s + i), max);
+    __m128i const w = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(d + i), _mm_packus_epi16(w, w));
+  }
+
+  for (; i < n; ++i) {
+    d[i] = convert_value<RGBA32fPixel, RGBA8Pixel>(s[i]);
+  }
+}
+
+/** SSE2 has no unsigned 32 to 16 bit pack, the values get moved into
+    the signed range and back */
+__attribute__((target("sse2")))
+void f32_to_u16_sse2(float const* s, uint16_t* d, size_t n)
+{
+  __m128 const max = _mm_set1_ps(65535.0f);
+  __m128i const bias32 = _mm_set1_epi32(32768);
+  __m128i const bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i const lo = _mm_sub_epi32(f32_to_i32_sse2(_mm_loadu_ps(s + i + 0), max), bias32);
+    __m128i const hi = _mm_sub_epi32(f32_to_i32_sse2(_mm_loadu_ps(s + i + 4), max), bias32);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_xor_si128(_mm_packs_epi32(lo, hi), bias16));
+  }
+
+  for (; i < n; ++i) {
+    d[i] = convert_value<RGBA32fPixel, RGBA16Pixel>(s[i]);
+  }
+}
+
+__attribute__((target("avx2")))
+void f32_to_u16_avx2(float const* s, uint16_t* d, size_t n)
+{
+  __m256 const max = _mm256_set1_ps(65535.0f);
+
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i const v = f32_to_i32_avx2(_mm256_loadu_ps(s + i), max);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i),
+                     _mm_packus_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+  }
+
+  for (; i < n; ++i) {
+    d[i] = convert_value<RGBA32fPixel, RGBA16Pixel>(s[i]);
+  }
+}
+
+// luminance, (r + g + b) / 3 like make_pixel()
+
+/** r + g + b of four pixels in RGBA or RGBx byte order, as 32-bit lanes */
+__attribute__((target("sse2"))) inline
+__m128i sum_rgb(__m128i v)
+{
+  __m128i const rb = _mm_madd_epi16(_mm_and_si128(v, _mm_set1_epi32(0x00ff00ff)), _mm_set1_epi16(1));
+  __m128i const g = _mm_and_si128(_mm_srli_epi32(v, 8), _mm_set1_epi32(0xff));
+  return _mm_add_epi32(rb, g);
+}
+
+/** x / 3 for 16-bit lanes up to 765 */
+__attribute__((target("sse2"))) inline
+__m128i div3(__m128i x)
+{
+  return _mm_srli_epi16(_mm_mulhi_epu16(x, _mm_set1_epi16(static_cast<short>(0xaaab))), 1);
+}
+
+/** Luminance of 16 pixels given as four vectors of four RGBA or RGBx pixels */
+__attribute__((target("sse2"))) inline
+__m128i luminance16(__m128i p0, __m128i p1, __m128i p2, __m128i p3)
+{
+  return _mm_packus_epi16(div3(_mm_packs_epi32(sum_rgb(p0), sum_rgb(p1))),
+                          div3(_mm_packs_epi32(sum_rgb(p2), sum_rgb(p3))));
+}
+
+__attribute__((target("sse2")))
+void rgba8_to_l8_sse2(void const* src, void* dst, size_t count)
+{
+  uint8_t const* s = static_cast<uint8_t const*>(src);
+  uint8_t* d = static_cast<uint8_t*>(dst);
+
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m128i const* p = reinterpret_cast<__m128i const*>(s + 4 * i);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i),
+                     luminance16(_mm_loadu_si128(p + 0), _mm_loadu_si128(p + 1),
+                                 _mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)));
+  }
+
+  for (; i < count; ++i) {
+    d[i] = static_cast<uint8_t>((s[4 * i + 0] + s[4 * i + 1] + s[4 * i + 2]) / 3);
+  }
+}
+
+__attribute__((target("sse2")))
+void rgba8_to_la8_sse2(void const* src, void* dst, size_t count)
+{
+  uint8_t const* s = static_cast<uint8_t const*>(src);
+  uint8_t* d = static_cast<uint8_t*>(dst);
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m128i const p0 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + 4 * i));
+    __m128i const p1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + 4 * i + 16));
+    __m128i const l = div3(_mm_packs_epi32(sum_rgb(p0), sum_rgb(p1)));
+    __m128i const a = _mm_packs_epi32(_mm_srli_epi32(p0, 24), _mm_srli_epi32(p1, 24));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 2 * i), _mm_or_si128(l, _mm_slli_epi16(a, 8)));
+  }
+
+  for (; i < count; ++i) {
+    d[2 * i + 0] = static_cast<uint8_t>((s[4 * i + 0] + s[4 * i + 1] + s[4 * i + 2]) / 3);
+    d[2 * i + 1] = s[4 * i + 3];
+  }
+}
+
+__attribute__((target("ssse3")))
+void rgb8_to_l8_ssse3(void const* src, void* dst, size_t count)
+{
+  __m128i const mask = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+
+  uint8_t const* s = static_cast<uint8_t const*>(src);
+  uint8_t* d = static_cast<uint8_t*>(dst);
+
+  // the last load reads four bytes past the 16 pixels
+  size_t i = 0;
+  for (; i + 18 <= count; i += 16) {
+    uint8_t const* p = s + 3 * i;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i),
+                     luminance16(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p + 0)), mask),
+                                 _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p + 12)), mask),
+                                 _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p + 24)), mask),
+                                 _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p + 36)), mask)));
+  }
+
+  for (; i < count; ++i) {
+    d[i] = static_cast<uint8_t>((s[3 * i + 0] + s[3 * i + 1] + s[3 * i + 2]) / 3);
+  }
+}
+
+// adding and dropping channels
+
+__attribute__((target("ssse3")))
+void rgb8_to_rgba8_ssse3(void const* src, void* dst, size_t count)
+{
+  __m128i const mask = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+  __m128i const alpha = _mm_set1_epi32(static_cast<int>(0xff000000));
+
+  uint8_t const* s = static_cast<uint8_t const*>(src);
+  uint8_t* d = static_cast<uint8_t*>(dst);
+
+  // the load reads four bytes past the four pixels
+  size_t i = 0;
+  for (; i + 6 <= count; i += 4) {
+    __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + 3 * i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 4 * i), _mm_or_si128(_mm_shuffle_epi8(v, mask), alpha));
+  }
+
+  for (; i < count; ++i) {
+    d[4 * i + 0] = s[3 * i + 0];
+    d[4 * i + 1] = s[3 * i + 1];
+    d[4 * i + 2] = s[3 * i + 2];
+    d[4 * i + 3] = 255;
+  }
+}
+
+__attribute__((target("ssse3")))
+void rgba8_to_rgb8_ssse3(void const* src, void* dst, size_t count)
+{
+  __m128i const mask = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+  uint8_t const* s = static_cast<uint8_t const*>(src);
+  uint8_t* d = static_cast<uint8_t*>(dst);
+
+  // the store writes four bytes past the four pixels, they get
+  // rewritten by the next step or the scalar tail
+  size_t i = 0;
+  for (; i + 6 <= count; i += 4) {
+    __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + 4 * i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 3 * i), _mm_shuffle_epi8(v, mask));
+  }
+
+  for (; i < count; ++i) {
+    d[3 * i + 0] = s[4 * i + 0];
+    d[3 * i + 1] = s[4 * i + 1];
+    d[3 * i + 2] = s[4 * i + 2];
+  }
+}
+
+__attribute__((target("ssse3")))
+void la8_to_rgba8_ssse3(void const* src, void* dst, size_t count)
+{
+  __m128i const mask = _mm_setr_epi8(0, 0, 0, 1, 2, 2, 2, 3, 4, 4, 4, 5, 6, 6, 6, 7);
+
+  uint8_t const* s = static_cast<uint8_t const*>(src);
+  uint8_t* d = static_cast<uint8_t*>(dst);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i const v = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(s + 2 * i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 4 * i), _mm_shuffle_epi8(v, mask));
+  }
+
+  for (; i < count; ++i) {
+    d[4 * i + 0] = s[2 * i + 0];
+    d[4 * i + 1] = s[2 * i + 0];
+    d[4 * i + 2] = s[2 * i + 0];
+    d[4 * i + 3] = s[2 * i + 1];
+  }
+}
+
+#endif
+
+} // namespace
+
+void register_convert_kernels(KernelRegistry& registry)
+{
+#ifdef SURF_HAVE_X86_KERNELS
+  if (__builtin_cpu_supports("sse2")) {
+    registry.set(PixelFormat::RGB8, PixelFormat::RGB16, BlendFunc::COPY, &per_channel<3, uint8_t, uint16_t, u8_to_u16_sse2>);
+    registry.set(PixelFormat::RGBA8, PixelFormat::RGBA16, BlendFunc::COPY, &per_channel<4, uint8_t, uint16_t, u8_to_u16_sse2>);
+    registry.set(PixelFormat::L8, PixelFormat::L16, BlendFunc::COPY, &per_channel<1, uint8_t, uint16_t, u8_to_u16_sse2>);
+    registry.set(PixelFormat::LA8, PixelFormat::LA16, BlendFunc::COPY, &per_channel<2, uint8_t, uint16_t, u8_to_u16_sse2>);
+
+    registry.set(PixelFormat::RGB8, PixelFormat::RGB32f, BlendFunc::COPY, &per_channel<3, uint8_t, float, u8_to_f32_sse2>);
+    registry.set(PixelFormat::RGBA8, PixelFormat::RGBA32f, BlendFunc::COPY, &per_channel<4, uint8_t, float, u8_to_f32_sse2>);
+    registry.set(PixelFormat::RGB16, PixelFormat::RGB32f, BlendFunc::COPY, &per_channel<3, uint16_t, float, u16_to_f32_sse2>);
+    registry.set(PixelFormat::RGBA16, PixelFormat::RGBA32f, BlendFunc::COPY, &per_channel<4, uint16_t, float, u16_to_f32_sse2>);
+
+    registry.set(PixelFormat::RGB16, PixelFormat::RGB8, BlendFunc::COPY, &per_channel<3, uint16_t, uint8_t, u16_to_u8_sse2>);
+    registry.set(PixelFormat::RGBA16, PixelFormat::RGBA8, BlendFunc::COPY, &per_channel<4, uint16_t, uint8_t, u16_to_u8_sse2>);
+    registry.set(PixelFormat::L16, PixelFormat::L8, BlendFunc::COPY, &per_channel<1, uint16_t, uint8_t, u16_to_u8_sse2>);
+    registry.set(PixelFormat::LA16, PixelFormat::LA8, BlendFunc::COPY, &per_channel<2, uint16_t, uint8_t, u16_to_u8_sse2>);
+
+    registry.set(PixelFormat::RGB32f, PixelFormat::RGB8, BlendFunc::COPY, &per_channel<3, float, uint8_t, f32_to_u8_sse2>);
+    registry.set(PixelFormat::RGBA32f, PixelFormat::RGBA8, BlendFunc::COPY, &per_channel<4, float, uint8_t, f32_to_u8_sse2>);
+    registry.set(PixelFormat::RGB32f, PixelFormat::RGB16, BlendFunc::COPY, &per_channel<3, float, uint16_t, f32_to_u16_sse2>);
+    registry.set(PixelFormat::RGBA32f, PixelFormat::RGBA16, BlendFunc::COPY, &per_channel<4, float, uint16_t, f32_to_u16_sse2>);
+
+    registry.set(PixelFormat::RGBA8, PixelFormat::L8, BlendFunc::COPY, &rgba8_to_l8_sse2);
+    registry.set(PixelFormat::RGBA8, PixelFormat::LA8, BlendFunc::COPY, &rgba8_to_la8_sse2);
+  }
+
+  if (__builtin_cpu_supports("ssse3")) {
+    registry.set(PixelFormat::RGB8, PixelFormat::RGBA8, BlendFunc::COPY, &rgb8_to_rgba8_ssse3);
+    registry.set(PixelFormat::RGBA8, PixelFormat::RGB8, BlendFunc::COPY, &rgba8_to_rgb8_ssse3);
+    registry.set(PixelFormat::RGB8, PixelFormat::L8, BlendFunc::COPY, &rgb8_to_l8_ssse3);
+    registry.set(PixelFormat::LA8, PixelFormat::RGBA8, BlendFunc::COPY, &la8_to_rgba8_ssse3);
+  }
+
+  if (__builtin_cpu_supports("avx2")) {
+    registry.set(PixelFormat::RGB8, PixelFormat::RGB16, BlendFunc::COPY, &per_channel<3, uint8_t, uint16_t, u8_to_u16_avx2>);
+    registry.set(PixelFormat::RGBA8, PixelFormat::RGBA16, BlendFunc::COPY, &per_channel<4, uint8_t, uint16_t, u8_to_u16_avx2>);
+    registry.set(PixelFormat::L8, PixelFormat::L16, BlendFunc::COPY, &per_channel<1, uint8_t, uint16_t, u8_to_u16_avx2>);
+    registry.set(PixelFormat::LA8, PixelFormat::LA16, BlendFunc::COPY, &per_channel<2, uint8_t, uint16_t, u8_to_u16_avx2>);
+
+    registry.set(PixelFormat::RGB8, PixelFormat::RGB32f, BlendFunc::COPY, &per_channel<3, uint8_t, float, u8_to_f32_avx2>);
+    registry.set(PixelFormat::RGBA8, PixelFormat::RGBA32f, BlendFunc::COPY, &per_channel<4, uint8_t, float, u8_to_f32_avx2>);
+    registry.set(PixelFormat::RGB16, PixelFormat::RGB32f, BlendFunc::COPY, &per_channel<3, uint16_t, float, u16_to_f32_avx2>);
+    registry.set(PixelFormat::RGBA16, PixelFormat::RGBA32f, BlendFunc::COPY, &per_channel<4, uint16_t, float, u16_to_f32_avx2>);
+
+    registry.set(PixelFormat::RGB16, PixelFormat::RGB8, BlendFunc::COPY, &per_channel<3, uint16_t, uint8_t, u16_to_u8_avx2>);
+    registry.set(PixelFormat::RGBA16, PixelFormat::RGBA8, BlendFunc::COPY, &per_channel<4, uint16_t, uint8_t, u16_to_u8_avx2>);
+    registry.set(PixelFormat::L16, PixelFormat::L8, BlendFunc::COPY, &per_channel<1, uint16_t, uint8_t, u16_to_u8_avx2>);
+    registry.set(PixelFormat::LA16, PixelFormat::LA8, BlendFunc::COPY, &per_channel<2, uint16_t, uint8_t, u16_to_u8_avx2>);
+
+    registry.set(PixelFormat::RGB32f, PixelFormat::RGB8, BlendFunc::COPY, &per_channel<3, float, uint8_t, f32_to_u8_avx2>);
+    registry.set(PixelFormat::RGBA32f, PixelFormat::RGBA8, BlendFunc::COPY, &per_channel<4, float, uint8_t, f32_to_u8_avx2>);
+    registry.set(PixelFormat::RGB32f, PixelFormat::RGB16, BlendFunc::COPY, &per_channel<3, float, uint16_t, f32_to_u16_avx2>);
+    registry.set(PixelFormat::RGBA32f, PixelFormat::RGBA16, BlendFunc::COPY, &per_channel<4, float, uint16_t, f32_to_u16_avx2>);
+  }
+#else
+  (void)registry;
+#endif
+}
+
+} // namespace kernels
+} // namespace surf
+
+/* EOF */
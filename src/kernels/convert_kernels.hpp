@@ -0,0 +1,38 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_KERNELS_CONVERT_KERNELS_HPP
+#define HEADER_SURF_KERNELS_CONVERT_KERNELS_HPP
+
+namespace surf {
+
+class KernelRegistry;
+
+namespace kernels {
+
+/** Register SSE2, SSSE3 and AVX2 COPY kernels for the common
+    conversions: RGB8 <-> RGBA8, RGB8/RGBA8 -> L8, LA8 <-> RGBA8, 8 <->
+    16 bit and 8/16 bit <-> 32-bit float. The best version the CPU
+    supports is picked, the generic kernels stay in place otherwise.
+    The results are identical to the generic kernels. */
+void register_convert_kernels(KernelRegistry& registry);
+
+} // namespace kernels
+} // namespace surf
+
+#endif
+
+/* EOF */
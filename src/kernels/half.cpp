@@ -0,0 +1,155 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "kernels/half_kernels.hpp"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define SURF_HAVE_F16C_KERNELS
+#  include <immintrin.h>
+#endif
+
+#include "convert.hpp"
+#include "half.hpp"
+#include "kernel_registry.hpp"
+#include "pixel.hpp"
+
+namespace surf {
+namespace kernels {
+
+namespace {
+
+#ifdef SURF_HAVE_F16C_KERNELS
+
+// the kernels work on single channels, so one instance serves all
+// formats with the same number of channels
+
+template<size_t Channels>
+__attribute__((target("avx,f16c")))
+void float_to_half_f16c(void const* src, void* dst, size_t count)
+{
+  float const* s = static_cast<float const*>(src);
+  half* d = static_cast<half*>(dst);
+  size_t const n = count * Channels;
+
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i),
+                     _mm256_cvtps_ph(_mm256_loadu_ps(s + i), _MM_FROUND_TO_NEAREST_INT));
+  }
+
+  for (; i < n; ++i) {
+    d[i] = half(s[i]);
+  }
+}
+
+template<size_t Channels>
+__attribute__((target("avx,f16c")))
+void half_to_float_f16c(void const* src, void* dst, size_t count)
+{
+  half const* s = static_cast<half const*>(src);
+  float* d = static_cast<float*>(dst);
+  size_t const n = count * Channels;
+
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(d + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i))));
+  }
+
+  for (; i < n; ++i) {
+    d[i] = s[i];
+  }
+}
+
+/** Same as convert_value(), v / 255 */
+template<size_t Channels>
+__attribute__((target("avx,f16c")))
+void u8_to_half_f16c(void const* src, void* dst, size_t count)
+{
+  uint8_t const* s = static_cast<uint8_t const*>(src);
+  half* d = static_cast<half*>(dst);
+  size_t const n = count * Channels;
+  __m128 const max = _mm_set1_ps(255.0f);
+
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    int32_t v;
+    memcpy(&v, s + i, sizeof(v));
+    __m128 const f = _mm_div_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(v))), max);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(d + i), _mm_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+  }
+
+  for (; i < n; ++i) {
+    d[i] = half(static_cast<float>(s[i]) / 255.0f);
+  }
+}
+
+/** Same as convert_value(), clamp(v, 0, 1) * 255 rounded */
+template<size_t Channels>
+__attribute__((target("avx,f16c")))
+void half_to_u8_f16c(void const* src, void* dst, size_t count)
+{
+  half const* s = static_cast<half const*>(src);
+  uint8_t* d = static_cast<uint8_t*>(dst);
+  size_t const n = count * Channels;
+  __m128 const zero = _mm_setzero_ps();
+  __m128 const one = _mm_set1_ps(1.0f);
+  __m128 const max = _mm_set1_ps(255.0f);
+  __m128 const round = _mm_set1_ps(0.5f);
+
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128 const f = _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(s + i)));
+    __m128i const v = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(f, zero), one), max), round));
+    __m128i const packed = _mm_packus_epi16(_mm_packs_epi32(v, v), v);
+    int32_t const out = _mm_cvtsi128_si32(packed);
+    memcpy(d + i, &out, sizeof(out));
+  }
+
+  for (; i < n; ++i) {
+    d[i] = convert_value<RGBA16fPixel, RGBA8Pixel>(s[i]);
+  }
+}
+
+#endif
+
+} // namespace
+
+void register_half_kernels(KernelRegistry& registry)
+{
+#ifdef SURF_HAVE_F16C_KERNELS
+  if (__builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c")) {
+    registry.set(PixelFormat::RGB32f, PixelFormat::RGB16f, BlendFunc::COPY, &float_to_half_f16c<3>);
+    registry.set(PixelFormat::RGBA32f, PixelFormat::RGBA16f, BlendFunc::COPY, &float_to_half_f16c<4>);
+    registry.set(PixelFormat::RGB16f, PixelFormat::RGB32f, BlendFunc::COPY, &half_to_float_f16c<3>);
+    registry.set(PixelFormat::RGBA16f, PixelFormat::RGBA32f, BlendFunc::COPY, &half_to_float_f16c<4>);
+
+    registry.set(PixelFormat::RGB8, PixelFormat::RGB16f, BlendFunc::COPY, &u8_to_half_f16c<3>);
+    registry.set(PixelFormat::RGBA8, PixelFormat::RGBA16f, BlendFunc::COPY, &u8_to_half_f16c<4>);
+    registry.set(PixelFormat::RGB16f, PixelFormat::RGB8, BlendFunc::COPY, &half_to_u8_f16c<3>);
+    registry.set(PixelFormat::RGBA16f, PixelFormat::RGBA8, BlendFunc::COPY, &half_to_u8_f16c<4>);
+  }
+#else
+  (void)registry;
+#endif
+}
+
+} // namespace kernels
+} // namespace surf
+
+/* EOF */
@@ -0,0 +1,173 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "kernels/premultiply_kernels.hpp"
+
+#include <stdint.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define SURF_HAVE_SSE2_KERNELS
+#  include <immintrin.h>
+#endif
+
+#include "blend.hpp"
+#include "convert.hpp"
+#include "kernel_registry.hpp"
+#include "pixel.hpp"
+
+namespace surf {
+namespace kernels {
+
+namespace {
+
+#ifdef SURF_HAVE_SSE2_KERNELS
+
+/** Broadcast the alpha of the two pixels in \a p, 16 bits per
+    channel, to all four of their channels */
+__attribute__((target("sse2"))) inline
+__m128i broadcast_alpha16(__m128i p)
+{
+  return _mm_shufflehi_epi16(_mm_shufflelo_epi16(p, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+/** v * m / 255 rounded to nearest, exact for v * m <= 255 * 255 */
+__attribute__((target("sse2"))) inline
+__m128i mul_div255(__m128i v, __m128i m)
+{
+  __m128i const x = _mm_add_epi16(_mm_mullo_epi16(v, m), _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+__attribute__((target("sse2"))) inline
+__m128i premultiply2(__m128i p)
+{
+  // alpha gets multiplied by 255, so it passes through unchanged
+  __m128i const alpha_lanes = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+  __m128i const m = _mm_or_si128(_mm_andnot_si128(alpha_lanes, broadcast_alpha16(p)),
+                                 _mm_and_si128(alpha_lanes, _mm_set1_epi16(255)));
+  return mul_div255(p, m);
+}
+
+/** One pixel with 32 bits per channel, computes (v * 255 + a / 2) / a
+    like unpremultiply(), the division is exact in float as the
+    quotient is never above 65152 */
+__attribute__((target("sse2"))) inline
+__m128i unpremultiply1(__m128i p)
+{
+  __m128i const alpha_lane = _mm_setr_epi32(0, 0, 0, -1);
+  __m128i const a = _mm_shuffle_epi32(p, _MM_SHUFFLE(3, 3, 3, 3));
+  __m128i const n = _mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(p, 8), p), _mm_srli_epi32(a, 1));
+  __m128i const q = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(n), _mm_cvtepi32_ps(a)));
+
+  // keep alpha, transparent pixels become black
+  __m128i const discard = _mm_or_si128(alpha_lane, _mm_cmpeq_epi32(a, _mm_setzero_si128()));
+  return _mm_or_si128(_mm_andnot_si128(discard, q), _mm_and_si128(alpha_lane, p));
+}
+
+__attribute__((target("sse2")))
+void premultiply_sse2(void const* src, void* dst, size_t count)
+{
+  RGBA8Pixel const* s = static_cast<RGBA8Pixel const*>(src);
+  PRGBA8Pixel* d = static_cast<PRGBA8Pixel*>(dst);
+  __m128i const zero = _mm_setzero_si128();
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+    __m128i const lo = premultiply2(_mm_unpacklo_epi8(v, zero));
+    __m128i const hi = premultiply2(_mm_unpackhi_epi8(v, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_packus_epi16(lo, hi));
+  }
+
+  for (; i < count; ++i) {
+    d[i] = premultiply(s[i]);
+  }
+}
+
+__attribute__((target("sse2")))
+void unpremultiply_sse2(void const* src, void* dst, size_t count)
+{
+  PRGBA8Pixel const* s = static_cast<PRGBA8Pixel const*>(src);
+  RGBA8Pixel* d = static_cast<RGBA8Pixel*>(dst);
+  __m128i const zero = _mm_setzero_si128();
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+    __m128i const lo = _mm_unpacklo_epi8(v, zero);
+    __m128i const hi = _mm_unpackhi_epi8(v, zero);
+    __m128i const p01 = _mm_packs_epi32(unpremultiply1(_mm_unpacklo_epi16(lo, zero)),
+                                        unpremultiply1(_mm_unpackhi_epi16(lo, zero)));
+    __m128i const p23 = _mm_packs_epi32(unpremultiply1(_mm_unpacklo_epi16(hi, zero)),
+                                        unpremultiply1(_mm_unpackhi_epi16(hi, zero)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_packus_epi16(p01, p23));
+  }
+
+  for (; i < count; ++i) {
+    d[i] = unpremultiply(s[i]);
+  }
+}
+
+__attribute__((target("sse2")))
+void over_sse2(void const* src, void* dst, size_t count)
+{
+  PRGBA8Pixel const* s = static_cast<PRGBA8Pixel const*>(src);
+  PRGBA8Pixel* d = static_cast<PRGBA8Pixel*>(dst);
+  __m128i const zero = _mm_setzero_si128();
+  __m128i const max = _mm_set1_epi16(255);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i const sv = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+    __m128i const dv = _mm_loadu_si128(reinterpret_cast<__m128i const*>(d + i));
+
+    __m128i const slo = _mm_unpacklo_epi8(sv, zero);
+    __m128i const shi = _mm_unpackhi_epi8(sv, zero);
+
+    // src + dst * (255 - src.a) / 255, packus clamps like clamp_pixel_max()
+    __m128i const lo = _mm_add_epi16(slo, mul_div255(_mm_unpacklo_epi8(dv, zero),
+                                                     _mm_sub_epi16(max, broadcast_alpha16(slo))));
+    __m128i const hi = _mm_add_epi16(shi, mul_div255(_mm_unpackhi_epi8(dv, zero),
+                                                     _mm_sub_epi16(max, broadcast_alpha16(shi))));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_packus_epi16(lo, hi));
+  }
+
+  for (; i < count; ++i) {
+    d[i] = detail::premultiplied_over(s[i], d[i]);
+  }
+}
+
+#endif
+
+} // namespace
+
+void register_premultiply_kernels(KernelRegistry& registry)
+{
+#ifdef SURF_HAVE_SSE2_KERNELS
+  if (__builtin_cpu_supports("sse2")) {
+    registry.set(PixelFormat::RGBA8, PixelFormat::PRGBA8, BlendFunc::COPY, &premultiply_sse2);
+    registry.set(PixelFormat::PRGBA8, PixelFormat::RGBA8, BlendFunc::COPY, &unpremultiply_sse2);
+    registry.set(PixelFormat::PRGBA8, PixelFormat::PRGBA8, BlendFunc::BLEND, &over_sse2);
+  }
+#else
+  (void)registry;
+#endif
+}
+
+} // namespace kernels
+} // namespace surf
+
+/* EOF */
@@ -0,0 +1,36 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_KERNELS_PREMULTIPLY_KERNELS_HPP
+#define HEADER_SURF_KERNELS_PREMULTIPLY_KERNELS_HPP
+
+namespace surf {
+
+class KernelRegistry;
+
+namespace kernels {
+
+/** Register SSE2 kernels for RGBA8 -> PRGBA8 and PRGBA8 -> RGBA8
+    conversion and for PRGBA8 over PRGBA8 blending, when the CPU has
+    SSE2. The results are identical to the generic kernels. */
+void register_premultiply_kernels(KernelRegistry& registry);
+
+} // namespace kernels
+} // namespace surf
+
+#endif
+
+/* EOF */
@@ -0,0 +1,135 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "kernels/scale_kernels.hpp"
+
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define SURF_HAVE_SCALE_KERNELS
+#  include <immintrin.h>
+#endif
+
+#include "scale_filter.hpp"
+
+namespace surf {
+namespace kernels {
+
+namespace {
+
+#ifdef SURF_HAVE_SCALE_KERNELS
+
+/** (a * wa + b * wb + 128) >> 8 on 16-bit lanes, wa + wb = 256, the
+    sum stays below 2^16 so unsigned wraparound can't happen */
+__attribute__((target("sse2"))) inline
+__m128i lerp_epi16(__m128i a, __m128i b, __m128i wa, __m128i wb)
+{
+  return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(a, wa), _mm_mullo_epi16(b, wb)),
+                                      _mm_set1_epi16(128)), 8);
+}
+
+__attribute__((target("sse2")))
+void lerp_bytes_sse2(uint8_t const* a, uint8_t const* b, uint8_t* out, size_t count, uint32_t frac)
+{
+  __m128i const zero = _mm_setzero_si128();
+  __m128i const wa = _mm_set1_epi16(static_cast<short>(256 - frac));
+  __m128i const wb = _mm_set1_epi16(static_cast<short>(frac));
+
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m128i const va = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i));
+    __m128i const vb = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b + i));
+    __m128i const lo = lerp_epi16(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, zero), wa, wb);
+    __m128i const hi = lerp_epi16(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, zero), wa, wb);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(lo, hi));
+  }
+
+  for (; i < count; ++i) {
+    out[i] = detail::lerp_channel(a[i], b[i], frac);
+  }
+}
+
+__attribute__((target("sse2"))) inline
+__m128i load_pixel(uint8_t const* row, int index)
+{
+  int32_t v;
+  memcpy(&v, row + static_cast<size_t>(index) * 4, sizeof(v));
+  return _mm_cvtsi32_si128(v);
+}
+
+/** Two destination pixels per iteration, each one from its own pair
+    of source pixels */
+__attribute__((target("sse2")))
+void bilinear_row_4x8_sse2(void const* srcrow, detail::ScaleTap const* taps, void* out, size_t count)
+{
+  uint8_t const* const src = static_cast<uint8_t const*>(srcrow);
+  uint8_t* const dst = static_cast<uint8_t*>(out);
+  __m128i const zero = _mm_setzero_si128();
+
+  size_t x = 0;
+  for (; x + 2 <= count; x += 2) {
+    detail::ScaleTap const& t0 = taps[x];
+    detail::ScaleTap const& t1 = taps[x + 1];
+
+    __m128i const a = _mm_unpacklo_epi32(load_pixel(src, t0.index), load_pixel(src, t1.index));
+    __m128i const b = _mm_unpacklo_epi32(load_pixel(src, t0.next), load_pixel(src, t1.next));
+    __m128i const wb = _mm_set_epi16(static_cast<short>(t1.frac), static_cast<short>(t1.frac),
+                                     static_cast<short>(t1.frac), static_cast<short>(t1.frac),
+                                     static_cast<short>(t0.frac), static_cast<short>(t0.frac),
+                                     static_cast<short>(t0.frac), static_cast<short>(t0.frac));
+    __m128i const wa = _mm_sub_epi16(_mm_set1_epi16(256), wb);
+
+    __m128i const v = lerp_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), wa, wb);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(v, v));
+  }
+
+  for (; x < count; ++x) {
+    for (size_t c = 0; c < 4; ++c) {
+      dst[x * 4 + c] = detail::lerp_channel(src[static_cast<size_t>(taps[x].index) * 4 + c],
+                                            src[static_cast<size_t>(taps[x].next) * 4 + c],
+                                            taps[x].frac);
+    }
+  }
+}
+
+#endif
+
+} // namespace
+
+LerpBytesKernel get_lerp_bytes_kernel()
+{
+#ifdef SURF_HAVE_SCALE_KERNELS
+  if (__builtin_cpu_supports("sse2")) {
+    return &lerp_bytes_sse2;
+  }
+#endif
+  return nullptr;
+}
+
+BilinearRowKernel get_bilinear_row_4x8_kernel()
+{
+#ifdef SURF_HAVE_SCALE_KERNELS
+  if (__builtin_cpu_supports("sse2")) {
+    return &bilinear_row_4x8_sse2;
+  }
+#endif
+  return nullptr;
+}
+
+} // namespace kernels
+} // namespace surf
+
+/* EOF */
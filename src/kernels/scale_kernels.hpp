@@ -0,0 +1,45 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_KERNELS_SCALE_KERNELS_HPP
+#define HEADER_SURF_KERNELS_SCALE_KERNELS_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace surf {
+
+namespace detail {
+struct ScaleTap;
+} // namespace detail
+
+namespace kernels {
+
+using LerpBytesKernel = void (*)(uint8_t const* a, uint8_t const* b, uint8_t* out, size_t count, uint32_t frac);
+using BilinearRowKernel = void (*)(void const* srcrow, detail::ScaleTap const* taps, void* out, size_t count);
+
+/** SSE2 kernels for the 8-bit BILINEAR passes of ScaledRowSampler,
+    nullptr when the CPU doesn't have SSE2. The results are identical
+    to detail::lerp_channel(). */
+LerpBytesKernel get_lerp_bytes_kernel();
+BilinearRowKernel get_bilinear_row_4x8_kernel();
+
+} // namespace kernels
+} // namespace surf
+
+#endif
+
+/* EOF */
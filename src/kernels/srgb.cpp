@@ -0,0 +1,138 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "kernels/srgb_kernels.hpp"
+
+#include <stdint.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define SURF_HAVE_SRGB_KERNELS
+#  include <immintrin.h>
+#endif
+
+#include "srgb.hpp"
+
+namespace surf {
+namespace kernels {
+
+namespace {
+
+#ifdef SURF_HAVE_SRGB_KERNELS
+
+/** Eight channels of two RGBA8 pixels, widened to 32-bit, to linear
+    light, alpha becomes a * 257 */
+__attribute__((target("avx2")))
+inline __m256i decode8_avx2(int const* table, __m256i v)
+{
+  __m256i const linear = _mm256_i32gather_epi32(table, v, 4);
+  __m256i const alpha = _mm256_or_si256(_mm256_slli_epi32(v, 8), v);
+  return _mm256_blend_epi32(linear, alpha, 0x88);
+}
+
+/** Eight 16-bit linear channels, widened to 32-bit, to 8-bit sRGB,
+    alpha is only rounded to 8-bit. (x + 128) * 65281 >> 24 is
+    (x + 128) / 257 for all x that can occur here. */
+__attribute__((target("avx2")))
+inline __m256i encode8_avx2(int const* table, __m256i v)
+{
+  __m256i const idx = _mm256_srli_epi32(v, 4);
+  __m256i const frac = _mm256_and_si256(v, _mm256_set1_epi32(15));
+  __m256i const lo = _mm256_i32gather_epi32(table, idx, 4);
+  __m256i const hi = _mm256_i32gather_epi32(table + 1, idx, 4);
+
+  __m256i srgb = _mm256_add_epi32(lo, _mm256_srli_epi32(
+                                    _mm256_add_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(hi, lo), frac),
+                                                     _mm256_set1_epi32(8)), 4));
+  srgb = _mm256_min_epu32(srgb, _mm256_set1_epi32(65535));
+  srgb = _mm256_blend_epi32(srgb, v, 0x88);
+
+  return _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_add_epi32(srgb, _mm256_set1_epi32(128)),
+                                              _mm256_set1_epi32(65281)), 24);
+}
+
+__attribute__((target("avx2")))
+void decode_rgba8_avx2(SRGBLut const& lut, void const* src, void* dst, size_t count)
+{
+  RGBA8Pixel const* s = static_cast<RGBA8Pixel const*>(src);
+  RGBA16Pixel* d = static_cast<RGBA16Pixel*>(dst);
+  int const* table = reinterpret_cast<int const*>(lut.get_decode8_table());
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256i const v0 = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(s + i)));
+    __m256i const v1 = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(s + i + 2)));
+
+    // packus works per 128-bit lane, giving pixels 0, 2, 1, 3
+    __m256i const packed = _mm256_packus_epi32(decode8_avx2(table, v0), decode8_avx2(table, v1));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), _mm256_permute4x64_epi64(packed, 0xd8));
+  }
+
+  for (; i < count; ++i) {
+    d[i] = srgb_decode(lut, s[i]);
+  }
+}
+
+__attribute__((target("avx2")))
+void encode_rgba8_avx2(SRGBLut const& lut, void const* src, void* dst, size_t count)
+{
+  RGBA16Pixel const* s = static_cast<RGBA16Pixel const*>(src);
+  RGBA8Pixel* d = static_cast<RGBA8Pixel*>(dst);
+  int const* table = reinterpret_cast<int const*>(lut.get_encode_table());
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256i const v0 = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i)));
+    __m256i const v1 = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i + 2)));
+
+    __m256i const words = _mm256_permute4x64_epi64(
+      _mm256_packus_epi32(encode8_avx2(table, v0), encode8_avx2(table, v1)), 0xd8);
+    __m128i const bytes = _mm_packus_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), bytes);
+  }
+
+  for (; i < count; ++i) {
+    d[i] = srgb_encode<RGBA8Pixel>(lut, s[i]);
+  }
+}
+
+#endif
+
+} // namespace
+
+SRGBKernel get_srgb_decode_rgba8_kernel()
+{
+#ifdef SURF_HAVE_SRGB_KERNELS
+  if (__builtin_cpu_supports("avx2")) {
+    return &decode_rgba8_avx2;
+  }
+#endif
+  return nullptr;
+}
+
+SRGBKernel get_srgb_encode_rgba8_kernel()
+{
+#ifdef SURF_HAVE_SRGB_KERNELS
+  if (__builtin_cpu_supports("avx2")) {
+    return &encode_rgba8_avx2;
+  }
+#endif
+  return nullptr;
+}
+
+} // namespace kernels
+} // namespace surf
+
+/* EOF */
@@ -0,0 +1,41 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SURF_KERNELS_SRGB_KERNELS_HPP
+#define HEADER_SURF_KERNELS_SRGB_KERNELS_HPP
+
+#include <stddef.h>
+
+namespace surf {
+
+class SRGBLut;
+
+namespace kernels {
+
+using SRGBKernel = void (*)(SRGBLut const& lut, void const* src, void* dst, size_t count);
+
+/** AVX2 gather kernels for sRGB RGBA8 <-> linear RGBA16, nullptr
+    when the CPU doesn't have AVX2. The results are identical to the
+    scalar SRGBLut lookups. */
+SRGBKernel get_srgb_decode_rgba8_kernel();
+SRGBKernel get_srgb_encode_rgba8_kernel();
+
+} // namespace kernels
+} // namespace surf
+
+#endif
+
+/* EOF */
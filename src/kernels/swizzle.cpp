@@ -0,0 +1,321 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "kernels/swizzle_kernels.hpp"
+
+#include <stdint.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define SURF_HAVE_X86_KERNELS
+#  include <immintrin.h>
+#endif
+
+#include "kernel_registry.hpp"
+#include "pixel.hpp"
+
+namespace surf {
+namespace kernels {
+
+namespace {
+
+/** dst byte n of each pixel comes from src byte I<n> */
+template<int I0, int I1, int I2, int I3>
+void shuffle4(void const* src, void* dst, size_t count)
+{
+  uint8_t const* s = static_cast<uint8_t const*>(src);
+  uint8_t* d = static_cast<uint8_t*>(dst);
+  for (size_t i = 0; i < count; ++i, s += 4, d += 4) {
+    uint8_t const p[4] = { s[0], s[1], s[2], s[3] };
+    d[0] = p[I0];
+    d[1] = p[I1];
+    d[2] = p[I2];
+    d[3] = p[I3];
+  }
+}
+
+void swap_rb3(void const* src, void* dst, size_t count)
+{
+  uint8_t const* s = static_cast<uint8_t const*>(src);
+  uint8_t* d = static_cast<uint8_t*>(dst);
+  for (size_t i = 0; i < count; ++i, s += 3, d += 3) {
+    uint8_t const p0 = s[0];
+    d[0] = s[2];
+    d[1] = s[1];
+    d[2] = p0;
+  }
+}
+
+/** dst byte n of each four byte pixel comes from src byte I<n> of
+    a three byte pixel, an index of 3 is an opaque alpha */
+template<int I0, int I1, int I2, int I3>
+void expand3(void const* src, void* dst, size_t count)
+{
+  uint8_t const* s = static_cast<uint8_t const*>(src);
+  uint8_t* d = static_cast<uint8_t*>(dst);
+  for (size_t i = 0; i < count; ++i, s += 3, d += 4) {
+    uint8_t const p[4] = { s[0], s[1], s[2], 255 };
+    d[0] = p[I0];
+    d[1] = p[I1];
+    d[2] = p[I2];
+    d[3] = p[I3];
+  }
+}
+
+/** dst byte n of each three byte pixel comes from src byte I<n> of a
+    four byte pixel */
+template<int I0, int I1, int I2>
+void drop4(void const* src, void* dst, size_t count)
+{
+  uint8_t const* s = static_cast<uint8_t const*>(src);
+  uint8_t* d = static_cast<uint8_t*>(dst);
+  for (size_t i = 0; i < count; ++i, s += 4, d += 3) {
+    d[0] = s[I0];
+    d[1] = s[I1];
+    d[2] = s[I2];
+  }
+}
+
+#ifdef SURF_HAVE_X86_KERNELS
+
+template<int I0, int I1, int I2, int I3>
+__attribute__((target("ssse3")))
+void shuffle4_ssse3(void const* src, void* dst, size_t count)
+{
+  __m128i const mask = _mm_setr_epi8(I0, I1, I2, I3,
+                                     4 + I0, 4 + I1, 4 + I2, 4 + I3,
+                                     8 + I0, 8 + I1, 8 + I2, 8 + I3,
+                                     12 + I0, 12 + I1, 12 + I2, 12 + I3);
+
+  uint8_t const* s = static_cast<uint8_t const*>(src);
+  uint8_t* d = static_cast<uint8_t*>(dst);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + 4 * i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 4 * i), _mm_shuffle_epi8(v, mask));
+  }
+
+  shuffle4<I0, I1, I2, I3>(s + 4 * i, d + 4 * i, count - i);
+}
+
+__attribute__((target("ssse3")))
+void swap_rb3_ssse3(void const* src, void* dst, size_t count)
+{
+  // five pixels per step, the 16th byte belongs to the next pixel and
+  // gets rewritten by the following step or the scalar tail
+  __m128i const mask = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+
+  uint8_t const* s = static_cast<uint8_t const*>(src);
+  uint8_t* d = static_cast<uint8_t*>(dst);
+
+  size_t i = 0;
+  for (; i + 6 <= count; i += 5) {
+    __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + 3 * i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 3 * i), _mm_shuffle_epi8(v, mask));
+  }
+
+  swap_rb3(s + 3 * i, d + 3 * i, count - i);
+}
+
+/** Source byte \a n of pixel \a k for expand3_ssse3(), -1 for the
+    alpha byte that gets or'ed in */
+constexpr int expand3_index(int k, int n)
+{
+  return n == 3 ? -1 : 3 * k + n;
+}
+
+template<int I0, int I1, int I2, int I3>
+__attribute__((target("ssse3")))
+void expand3_ssse3(void const* src, void* dst, size_t count)
+{
+  __m128i const mask = _mm_setr_epi8(expand3_index(0, I0), expand3_index(0, I1), expand3_index(0, I2), expand3_index(0, I3),
+                                     expand3_index(1, I0), expand3_index(1, I1), expand3_index(1, I2), expand3_index(1, I3),
+                                     expand3_index(2, I0), expand3_index(2, I1), expand3_index(2, I2), expand3_index(2, I3),
+                                     expand3_index(3, I0), expand3_index(3, I1), expand3_index(3, I2), expand3_index(3, I3));
+  __m128i const alpha = _mm_set1_epi32(static_cast<int>(0xffu << (8 * (I0 == 3 ? 0 : I1 == 3 ? 1 : I2 == 3 ? 2 : 3))));
+
+  uint8_t const* s = static_cast<uint8_t const*>(src);
+  uint8_t* d = static_cast<uint8_t*>(dst);
+
+  // the load reads four bytes past the four pixels
+  size_t i = 0;
+  for (; i + 6 <= count; i += 4) {
+    __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + 3 * i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 4 * i), _mm_or_si128(_mm_shuffle_epi8(v, mask), alpha));
+  }
+
+  expand3<I0, I1, I2, I3>(s + 3 * i, d + 4 * i, count - i);
+}
+
+template<int I0, int I1, int I2>
+__attribute__((target("ssse3")))
+void drop4_ssse3(void const* src, void* dst, size_t count)
+{
+  __m128i const mask = _mm_setr_epi8(I0, I1, I2, 4 + I0, 4 + I1, 4 + I2,
+                                     8 + I0, 8 + I1, 8 + I2, 12 + I0, 12 + I1, 12 + I2,
+                                     -1, -1, -1, -1);
+
+  uint8_t const* s = static_cast<uint8_t const*>(src);
+  uint8_t* d = static_cast<uint8_t*>(dst);
+
+  // the store writes four bytes past the four pixels, they get
+  // rewritten by the next step or the scalar tail
+  size_t i = 0;
+  for (; i + 6 <= count; i += 4) {
+    __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + 4 * i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 3 * i), _mm_shuffle_epi8(v, mask));
+  }
+
+  drop4<I0, I1, I2>(s + 4 * i, d + 3 * i, count - i);
+}
+
+// RGB565 <-> RGBA8, the 5 and 6 bit channels are widened by
+// repeating their top bits, like red(), green() and blue() do
+
+__attribute__((target("sse2")))
+void rgb565_to_rgba8_sse2(void const* src, void* dst, size_t count)
+{
+  __m128i const mask_f8 = _mm_set1_epi16(0xf8);
+  __m128i const mask_fc = _mm_set1_epi16(0xfc);
+  __m128i const mask_07 = _mm_set1_epi16(0x07);
+  __m128i const mask_03 = _mm_set1_epi16(0x03);
+  __m128i const alpha = _mm_set1_epi16(static_cast<short>(0xff00));
+
+  RGB565Pixel const* s = static_cast<RGB565Pixel const*>(src);
+  uint8_t* d = static_cast<uint8_t*>(dst);
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i));
+    __m128i const r = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 8), mask_f8), _mm_srli_epi16(v, 13));
+    __m128i const g = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 3), mask_fc), _mm_and_si128(_mm_srli_epi16(v, 9), mask_03));
+    __m128i const b = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(v, 3), mask_f8), _mm_and_si128(_mm_srli_epi16(v, 2), mask_07));
+    __m128i const rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+    __m128i const ba = _mm_or_si128(b, alpha);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 4 * i), _mm_unpacklo_epi16(rg, ba));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 4 * i + 16), _mm_unpackhi_epi16(rg, ba));
+  }
+
+  for (; i < count; ++i) {
+    d[4 * i + 0] = red(s[i]);
+    d[4 * i + 1] = green(s[i]);
+    d[4 * i + 2] = blue(s[i]);
+    d[4 * i + 3] = 255;
+  }
+}
+
+__attribute__((target("sse2")))
+void rgba8_to_rgb565_sse2(void const* src, void* dst, size_t count)
+{
+  __m128i const mask_r = _mm_set1_epi32(0xf8);
+  __m128i const mask_g = _mm_set1_epi32(0xfc00);
+  __m128i const mask_b = _mm_set1_epi32(0x1f);
+
+  uint8_t const* s = static_cast<uint8_t const*>(src);
+  RGB565Pixel* d = static_cast<RGB565Pixel*>(dst);
+
+  // each 32 bit lane becomes one 16 bit value, sign extended so the
+  // signed saturation of packs keeps it unchanged
+  auto const pack = [&](__m128i v) {
+    __m128i const p = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(v, mask_r), 8),
+                                                _mm_srli_epi32(_mm_and_si128(v, mask_g), 5)),
+                                   _mm_and_si128(_mm_srli_epi32(v, 19), mask_b));
+    return _mm_srai_epi32(_mm_slli_epi32(p, 16), 16);
+  };
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m128i const lo = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + 4 * i));
+    __m128i const hi = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + 4 * i + 16));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_packs_epi32(pack(lo), pack(hi)));
+  }
+
+  for (; i < count; ++i) {
+    d[i] = make_pixel<RGB565Pixel>(s[4 * i + 0], s[4 * i + 1], s[4 * i + 2]);
+  }
+}
+
+#endif
+
+} // namespace
+
+void register_swizzle_kernels(KernelRegistry& registry)
+{
+  SpanKernel rgba_bgra = &shuffle4<2, 1, 0, 3>;
+  SpanKernel rgba_argb = &shuffle4<3, 0, 1, 2>;
+  SpanKernel argb_rgba = &shuffle4<1, 2, 3, 0>;
+  SpanKernel bgra_argb = &shuffle4<3, 2, 1, 0>;
+  SpanKernel rgb_bgr = &swap_rb3;
+  SpanKernel rgb_bgra = &expand3<2, 1, 0, 3>;
+  SpanKernel rgb_argb = &expand3<3, 0, 1, 2>;
+  SpanKernel bgr_argb = &expand3<3, 2, 1, 0>;
+  SpanKernel bgr_bgra = &expand3<0, 1, 2, 3>;
+  SpanKernel rgba_bgr = &drop4<2, 1, 0>;
+  SpanKernel argb_rgb = &drop4<1, 2, 3>;
+  SpanKernel argb_bgr = &drop4<3, 2, 1>;
+  SpanKernel bgra_bgr = &drop4<0, 1, 2>;
+
+#ifdef SURF_HAVE_X86_KERNELS
+  if (__builtin_cpu_supports("sse2")) {
+    registry.set(PixelFormat::RGB565, PixelFormat::RGBA8, BlendFunc::COPY, &rgb565_to_rgba8_sse2);
+    registry.set(PixelFormat::RGBA8, PixelFormat::RGB565, BlendFunc::COPY, &rgba8_to_rgb565_sse2);
+  }
+
+  if (__builtin_cpu_supports("ssse3")) {
+    rgba_bgra = &shuffle4_ssse3<2, 1, 0, 3>;
+    rgba_argb = &shuffle4_ssse3<3, 0, 1, 2>;
+    argb_rgba = &shuffle4_ssse3<1, 2, 3, 0>;
+    bgra_argb = &shuffle4_ssse3<3, 2, 1, 0>;
+    rgb_bgr = &swap_rb3_ssse3;
+    rgb_bgra = &expand3_ssse3<2, 1, 0, 3>;
+    rgb_argb = &expand3_ssse3<3, 0, 1, 2>;
+    bgr_argb = &expand3_ssse3<3, 2, 1, 0>;
+    bgr_bgra = &expand3_ssse3<0, 1, 2, 3>;
+    rgba_bgr = &drop4_ssse3<2, 1, 0>;
+    argb_rgb = &drop4_ssse3<1, 2, 3>;
+    argb_bgr = &drop4_ssse3<3, 2, 1>;
+    bgra_bgr = &drop4_ssse3<0, 1, 2>;
+  }
+#endif
+
+  // swapping red and blue and reversing all bytes are their own inverse
+  registry.set(PixelFormat::RGBA8, PixelFormat::BGRA8, BlendFunc::COPY, rgba_bgra);
+  registry.set(PixelFormat::BGRA8, PixelFormat::RGBA8, BlendFunc::COPY, rgba_bgra);
+  registry.set(PixelFormat::RGBA8, PixelFormat::ARGB8, BlendFunc::COPY, rgba_argb);
+  registry.set(PixelFormat::ARGB8, PixelFormat::RGBA8, BlendFunc::COPY, argb_rgba);
+  registry.set(PixelFormat::BGRA8, PixelFormat::ARGB8, BlendFunc::COPY, bgra_argb);
+  registry.set(PixelFormat::ARGB8, PixelFormat::BGRA8, BlendFunc::COPY, bgra_argb);
+  registry.set(PixelFormat::RGB8, PixelFormat::BGR8, BlendFunc::COPY, rgb_bgr);
+  registry.set(PixelFormat::BGR8, PixelFormat::RGB8, BlendFunc::COPY, rgb_bgr);
+
+  // RGB8 <-> RGBA8 lives with the convert kernels, swapping red and
+  // blue while adding or dropping alpha covers the other pairs
+  registry.set(PixelFormat::RGB8, PixelFormat::BGRA8, BlendFunc::COPY, rgb_bgra);
+  registry.set(PixelFormat::BGR8, PixelFormat::RGBA8, BlendFunc::COPY, rgb_bgra);
+  registry.set(PixelFormat::RGB8, PixelFormat::ARGB8, BlendFunc::COPY, rgb_argb);
+  registry.set(PixelFormat::BGR8, PixelFormat::ARGB8, BlendFunc::COPY, bgr_argb);
+  registry.set(PixelFormat::BGR8, PixelFormat::BGRA8, BlendFunc::COPY, bgr_bgra);
+  registry.set(PixelFormat::RGBA8, PixelFormat::BGR8, BlendFunc::COPY, rgba_bgr);
+  registry.set(PixelFormat::BGRA8, PixelFormat::RGB8, BlendFunc::COPY, rgba_bgr);
+  registry.set(PixelFormat::ARGB8, PixelFormat::RGB8, BlendFunc::COPY, argb_rgb);
+  registry.set(PixelFormat::ARGB8, PixelFormat::BGR8, BlendFunc::COPY, argb_bgr);
+  registry.set(PixelFormat::BGRA8, PixelFormat::BGR8, BlendFunc::COPY, bgra_bgr);
+}
+
+} // namespace kernels
+} // namespace surf
+
+/* EOF */
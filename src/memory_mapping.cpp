@@ -0,0 +1,249 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "memory_mapping.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stdexcept>
+#include <utility>
+
+#include <fmt/format.h>
+
+namespace surf {
+
+namespace {
+
+[[noreturn]]
+void throw_errno(std::string_view context, int errnum)
+{
+  throw std::runtime_error(fmt::format("MemoryMapping: {}: {}", context, strerror(errnum)));
+}
+
+void resize_fd(int fd, size_t length, std::string_view context)
+{
+  if (ftruncate(fd, static_cast<off_t>(length)) != 0) {
+    int const errnum = errno;
+    close(fd);
+    throw_errno(context, errnum);
+  }
+}
+
+} // namespace
+
+MemoryMapping
+MemoryMapping::open_file(std::filesystem::path const& filename,
+                         size_t offset, size_t length, bool writable)
+{
+  int const fd = open(filename.c_str(), (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+  if (fd < 0) {
+    throw_errno(filename.string(), errno);
+  }
+  return from_fd(fd, offset, length, writable);
+}
+
+MemoryMapping
+MemoryMapping::create_file(std::filesystem::path const& filename, size_t length)
+{
+  int const fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    throw_errno(filename.string(), errno);
+  }
+  resize_fd(fd, length, filename.string());
+  return from_fd(fd, 0, length, true);
+}
+
+MemoryMapping
+MemoryMapping::create_memfd(std::string const& name, size_t length)
+{
+#ifdef __linux__
+  int const fd = memfd_create(name.c_str(), MFD_CLOEXEC);
+  if (fd < 0) {
+    throw_errno(name, errno);
+  }
+  resize_fd(fd, length, name);
+  return from_fd(fd, 0, length, true);
+#else
+  throw std::runtime_error(fmt::format("MemoryMapping: {}: memfd not supported on this platform", name));
+#endif
+}
+
+MemoryMapping
+MemoryMapping::create_shm(std::string const& name, size_t length)
+{
+  int const fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0) {
+    throw_errno(name, errno);
+  }
+
+  try {
+    resize_fd(fd, length, name);
+    return from_fd(fd, 0, length, true);
+  } catch (...) {
+    // the name was created above, don't leave it behind
+    shm_unlink(name.c_str());
+    throw;
+  }
+}
+
+MemoryMapping
+MemoryMapping::open_shm(std::string const& name, bool writable)
+{
+  int const fd = shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+  if (fd < 0) {
+    throw_errno(name, errno);
+  }
+  return from_fd(fd, 0, 0, writable);
+}
+
+void
+MemoryMapping::unlink_shm(std::string const& name)
+{
+  if (shm_unlink(name.c_str()) != 0) {
+    throw_errno(name, errno);
+  }
+}
+
+MemoryMapping
+MemoryMapping::from_fd(int fd, size_t offset, size_t length, bool writable)
+{
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    int const errnum = errno;
+    close(fd);
+    throw_errno("fstat()", errnum);
+  }
+
+  size_t const file_size = static_cast<size_t>(st.st_size);
+  if (file_size < offset) {
+    close(fd);
+    throw std::runtime_error("MemoryMapping: offset beyond the end of the file");
+  }
+
+  if (length == 0) {
+    length = file_size - offset;
+  } else if (length > file_size - offset) {
+    // pages past the end of the file raise SIGBUS on access
+    close(fd);
+    throw std::runtime_error("MemoryMapping: length beyond the end of the file");
+  }
+
+  if (length == 0) {
+    close(fd);
+    throw std::runtime_error("MemoryMapping: can't map zero bytes");
+  }
+
+  // mmap() wants a page aligned offset
+  size_t const page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t const page_offset = offset % page_size;
+
+  // read-only requests are mapped copy-on-write, so that a surface
+  // wrapping them can still be drawn to without touching the file
+  void* addr = mmap(nullptr, length + page_offset,
+                    PROT_READ | PROT_WRITE,
+                    writable ? MAP_SHARED : MAP_PRIVATE, fd,
+                    static_cast<off_t>(offset - page_offset));
+  if (addr == MAP_FAILED) {
+    int const errnum = errno;
+    close(fd);
+    throw_errno("mmap()", errnum);
+  }
+
+  return MemoryMapping(fd, addr, page_offset, length, writable);
+}
+
+MemoryMapping::MemoryMapping() :
+  m_fd(-1),
+  m_addr(nullptr),
+  m_page_offset(0),
+  m_length(0),
+  m_writable(false)
+{
+}
+
+MemoryMapping::MemoryMapping(int fd, void* addr, size_t page_offset, size_t length, bool writable) :
+  m_fd(fd),
+  m_addr(addr),
+  m_page_offset(page_offset),
+  m_length(length),
+  m_writable(writable)
+{
+}
+
+MemoryMapping::MemoryMapping(MemoryMapping&& other) noexcept :
+  m_fd(std::exchange(other.m_fd, -1)),
+  m_addr(std::exchange(other.m_addr, nullptr)),
+  m_page_offset(std::exchange(other.m_page_offset, 0)),
+  m_length(std::exchange(other.m_length, 0)),
+  m_writable(std::exchange(other.m_writable, false))
+{
+}
+
+MemoryMapping&
+MemoryMapping::operator=(MemoryMapping&& other) noexcept
+{
+  if (this != &other) {
+    reset();
+    m_fd = std::exchange(other.m_fd, -1);
+    m_addr = std::exchange(other.m_addr, nullptr);
+    m_page_offset = std::exchange(other.m_page_offset, 0);
+    m_length = std::exchange(other.m_length, 0);
+    m_writable = std::exchange(other.m_writable, false);
+  }
+  return *this;
+}
+
+MemoryMapping::~MemoryMapping()
+{
+  reset();
+}
+
+void
+MemoryMapping::sync()
+{
+  if (m_addr == nullptr || !m_writable) { return; }
+
+  if (msync(m_addr, m_length + m_page_offset, MS_SYNC) != 0) {
+    throw_errno("msync()", errno);
+  }
+}
+
+void
+MemoryMapping::reset()
+{
+  if (m_addr != nullptr) {
+    munmap(m_addr, m_length + m_page_offset);
+    m_addr = nullptr;
+  }
+
+  if (m_fd >= 0) {
+    close(m_fd);
+    m_fd = -1;
+  }
+
+  m_page_offset = 0;
+  m_length = 0;
+  m_writable = false;
+}
+
+} // namespace surf
+
+/* EOF */
@@ -0,0 +1,105 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "pixel_allocator.hpp"
+
+#include <stdlib.h>
+
+#include <atomic>
+#include <new>
+
+#ifdef __linux__
+#  include <sys/mman.h>
+#endif
+
+namespace surf {
+
+namespace {
+
+constexpr size_t HUGEPAGE_SIZE = 2 * 1024 * 1024;
+
+std::atomic<size_t> g_hugepage_threshold = 8 * 1024 * 1024;
+
+void* aligned_malloc(size_t alignment, size_t bytes)
+{
+#ifdef _WIN32
+  return _aligned_malloc(bytes, alignment);
+#else
+  void* ptr = nullptr;
+  if (posix_memalign(&ptr, alignment, bytes) != 0) {
+    return nullptr;
+  }
+  return ptr;
+#endif
+}
+
+void aligned_free(void* ptr)
+{
+#ifdef _WIN32
+  _aligned_free(ptr);
+#else
+  free(ptr);
+#endif
+}
+
+} // namespace
+
+void* allocate_pixels(size_t bytes)
+{
+  void* ptr = nullptr;
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  size_t const threshold = g_hugepage_threshold.load(std::memory_order_relaxed);
+  if (threshold != 0 && bytes >= threshold) {
+    // align and pad to full huge pages, so the advice covers the whole buffer
+    size_t const length = (bytes + HUGEPAGE_SIZE - 1) / HUGEPAGE_SIZE * HUGEPAGE_SIZE;
+    ptr = aligned_malloc(HUGEPAGE_SIZE, length);
+    if (ptr != nullptr) {
+      // failure is harmless, the buffer just stays on regular pages
+      madvise(ptr, length, MADV_HUGEPAGE);
+    }
+  } else {
+    ptr = aligned_malloc(PIXEL_ALIGNMENT, bytes);
+  }
+#else
+  ptr = aligned_malloc(PIXEL_ALIGNMENT, bytes);
+#endif
+
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+
+  return ptr;
+}
+
+void deallocate_pixels(void* ptr, size_t /*bytes*/) noexcept
+{
+  aligned_free(ptr);
+}
+
+void set_hugepage_threshold(size_t bytes)
+{
+  g_hugepage_threshold.store(bytes, std::memory_order_relaxed);
+}
+
+size_t get_hugepage_threshold()
+{
+  return g_hugepage_threshold.load(std::memory_order_relaxed);
+}
+
+} // namespace surf
+
+/* EOF */
@@ -89,6 +89,39 @@ std::string to_string(PixelFormat format)
     case PixelFormat::LA64f:
       return "LA64f";
 
+    case PixelFormat::BGR8:
+      return "BGR8";
+
+    case PixelFormat::BGRA8:
+      return "BGRA8";
+
+    case PixelFormat::ARGB8:
+      return "ARGB8";
+
+    case PixelFormat::RGB565:
+      return "RGB565";
+
+    case PixelFormat::PRGBA8:
+      return "PRGBA8";
+
+    case PixelFormat::PRGBA16:
+      return "PRGBA16";
+
+    case PixelFormat::PRGBA32f:
+      return "PRGBA32f";
+
+    case PixelFormat::RGB16f:
+      return "RGB16f";
+
+    case PixelFormat::RGBA16f:
+      return "RGBA16f";
+
+    case PixelFormat::L16f:
+      return "L16f";
+
+    case PixelFormat::LA16f:
+      return "LA16f";
+
     default:
       throw std::invalid_argument("unknown PixelFormat");
   }
@@ -136,6 +169,28 @@ PixelFormat pixelformat_from_string(std::string_view text)
     return PixelFormat::L64f;
   } else if (text == "la64f") {
     return PixelFormat::LA64f;
+  } else if (text == "bgr8") {
+    return PixelFormat::BGR8;
+  } else if (text == "bgra8") {
+    return PixelFormat::BGRA8;
+  } else if (text == "argb8") {
+    return PixelFormat::ARGB8;
+  } else if (text == "rgb565") {
+    return PixelFormat::RGB565;
+  } else if (text == "prgba8") {
+    return PixelFormat::PRGBA8;
+  } else if (text == "prgba16") {
+    return PixelFormat::PRGBA16;
+  } else if (text == "prgba32f") {
+    return PixelFormat::PRGBA32f;
+  } else if (text == "rgb16f") {
+    return PixelFormat::RGB16f;
+  } else if (text == "rgba16f") {
+    return PixelFormat::RGBA16f;
+  } else if (text == "l16f") {
+    return PixelFormat::L16f;
+  } else if (text == "la16f") {
+    return PixelFormat::LA16f;
   } else {
     throw std::invalid_argument(fmt::format("unknown PixelFormat: '{}'", text));
   }
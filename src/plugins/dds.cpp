@@ -58,7 +58,7 @@ SoftwareSurface load_from_file(std::filesystem::path const& filename)
   {
     DDSSurface dds(in);
 
-    PixelData<RGBAPixel> dst(geom::isize(dds.get_width(), dds.get_height()));
+    PixelData<RGBAPixel> dst(geom::isize(dds.get_width(), dds.get_height()), no_init);
 
     if (static_cast<int>(dds.get_length()) != dst.get_width() * dst.get_height() * 4)
     {
@@ -68,7 +68,9 @@ SoftwareSurface load_from_file(std::filesystem::path const& filename)
       throw std::runtime_error(out.str());
     }
 
-    memcpy(dst.get_data(), dds.get_data(), dds.get_length());
+    for (int y = 0; y < dst.get_height(); ++y) {
+      memcpy(dst.get_row(y), dds.get_data() + static_cast<size_t>(y) * static_cast<size_t>(dst.get_width()) * 4, static_cast<size_t>(dst.get_width()) * 4);
+    }
 
     return SoftwareSurface(dst);
   }
@@ -45,7 +45,7 @@ MagickImage2PixelData(const Magick::Image& image)
 
   if (image.matte())
   {
-    PixelData<RGBAPixel> dst(geom::isize(width, height));
+    PixelData<RGBAPixel> dst(geom::isize(width, height), no_init);
 
     for(int y = 0; y < height; ++y)
     {
@@ -63,11 +63,11 @@ MagickImage2PixelData(const Magick::Image& image)
       }
     }
 
-    return SoftwareSurface(dst);
+    return SoftwareSurface(std::move(dst));
   }
   else
   {
-    PixelData<RGBPixel> dst(geom::isize(width, height));
+    PixelData<RGBPixel> dst(geom::isize(width, height), no_init);
 
     for(int y = 0; y < height; ++y)
     {
@@ -84,7 +84,7 @@ MagickImage2PixelData(const Magick::Image& image)
       }
     }
 
-    return SoftwareSurface(dst);
+    return SoftwareSurface(std::move(dst));
   }
 }
 
@@ -141,22 +141,14 @@ SoftwareSurface load_from_mem(std::span<uint8_t const> data, int scale, geom::is
 void save(SoftwareSurface const& surface, std::filesystem::path const& filename, int quality)
 {
   FileJPEGCompressor compressor(filename);
-  if (PixelView<RGB8Pixel> const* optional = surface.as_pixelview_ptr<RGB8Pixel>()) {
-    compressor.save(*optional, quality);
-  } else {
-    compressor.save(convert(surface, surf::PixelFormat::RGB8).as_pixelview<RGB8Pixel>(), quality);
-  }
+  compressor.save(surface, quality);
 }
 
 std::vector<uint8_t> save(SoftwareSurface const& surface, int quality)
 {
   std::vector<uint8_t> data;
   MemJPEGCompressor compressor(data);
-  if (PixelView<RGB8Pixel> const* optional = surface.as_pixelview_ptr<RGB8Pixel>()) {
-    compressor.save(*optional, quality);
-  } else {
-    compressor.save(convert(surface, surf::PixelFormat::RGB8).as_pixelview<RGB8Pixel>(), quality);
-  }
+  compressor.save(surface, quality);
   return data;
 }
 
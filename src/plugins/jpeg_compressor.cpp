@@ -16,6 +16,10 @@
 
 #include "plugins/jpeg_compressor.hpp"
 
+#include <algorithm>
+
+#include "row_converter.hpp"
+
 namespace surf {
 
 JPEGCompressor::JPEGCompressor() :
@@ -35,10 +39,10 @@ JPEGCompressor::~JPEGCompressor()
 }
 
 void
-JPEGCompressor::save(PixelView<RGB8Pixel> const& pixel_data, int quality)
+JPEGCompressor::start_compress(geom::isize const& size, int quality)
 {
-  m_cinfo.image_width = static_cast<JDIMENSION>(pixel_data.get_width());
-  m_cinfo.image_height = static_cast<JDIMENSION>(pixel_data.get_height());
+  m_cinfo.image_width = static_cast<JDIMENSION>(size.width());
+  m_cinfo.image_height = static_cast<JDIMENSION>(size.height());
 
   m_cinfo.input_components = 3; // # of color components per pixel
   m_cinfo.in_color_space = JCS_RGB; // colorspace of input image
@@ -47,6 +51,12 @@ JPEGCompressor::save(PixelView<RGB8Pixel> const& pixel_data, int quality)
   jpeg_set_quality(&m_cinfo, quality, TRUE /* limit to baseline-JPEG values */);
 
   jpeg_start_compress(&m_cinfo, TRUE);
+}
+
+void
+JPEGCompressor::save(PixelView<RGB8Pixel> const& pixel_data, int quality)
+{
+  start_compress(pixel_data.get_size(), quality);
 
   std::vector<JSAMPROW> row_pointer(static_cast<size_t>(pixel_data.get_height()));
   for(int y = 0; y < pixel_data.get_height(); ++y)
@@ -63,6 +73,47 @@ JPEGCompressor::save(PixelView<RGB8Pixel> const& pixel_data, int quality)
   jpeg_finish_compress(&m_cinfo);
 }
 
+void
+JPEGCompressor::save(SoftwareSurface const& surface, int quality)
+{
+  if (PixelView<RGB8Pixel> const* optional = surface.as_pixelview_ptr<RGB8Pixel>()) {
+    save(*optional, quality);
+    return;
+  }
+
+  constexpr int strip_height = 16;
+
+  RowConverter const converter(surface.get_format(), PixelFormat::RGB8);
+  PixelData<RGB8Pixel> strip(geom::isize(surface.get_width(),
+                                         std::min(strip_height, surface.get_height())),
+                             no_init);
+
+  std::vector<JSAMPROW> row_pointer(static_cast<size_t>(strip.get_height()));
+  for (int y = 0; y < strip.get_height(); ++y) {
+    row_pointer[y] = static_cast<JSAMPLE*>(strip.get_row_data(y));
+  }
+
+  start_compress(surface.get_size(), quality);
+
+  while (m_cinfo.next_scanline < m_cinfo.image_height)
+  {
+    int const y = static_cast<int>(m_cinfo.next_scanline);
+    int const rows = std::min(strip.get_height(), surface.get_height() - y);
+
+    for (int i = 0; i < rows; ++i) {
+      converter.convert_row(surface.get_row_data(y + i), strip.get_row_data(i), surface.get_width());
+    }
+
+    JDIMENSION written = 0;
+    while (written < static_cast<JDIMENSION>(rows)) {
+      written += jpeg_write_scanlines(&m_cinfo, &row_pointer[written],
+                                      static_cast<JDIMENSION>(rows) - written);
+    }
+  }
+
+  jpeg_finish_compress(&m_cinfo);
+}
+
 } // namespace surf
 
 /* EOF */
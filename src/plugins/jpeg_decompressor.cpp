@@ -103,7 +103,8 @@ JPEGDecompressor::read_image(int scale, geom::isize* image_size)
   jpeg_start_decompress(&m_cinfo);
 
   PixelData<RGB8Pixel> dst(geom::isize(static_cast<int>(m_cinfo.output_width),
-                                      static_cast<int>(m_cinfo.output_height)));
+                                      static_cast<int>(m_cinfo.output_height)),
+                           no_init);
 
   if (m_cinfo.out_color_space == JCS_RGB &&
       m_cinfo.output_components == 3) {
@@ -262,11 +262,11 @@ SoftwareSurface load_from_stream(std::istream& is, std::string const& context)
   geom::isize const size(static_cast<int>(png_get_image_width(png_ptr, info_ptr)),
                          static_cast<int>(png_get_image_height(png_ptr, info_ptr)));
 
-  SoftwareSurface surface = SoftwareSurface::create(format, size);
+  SoftwareSurface surface = SoftwareSurface::create(format, size, no_init);
   { // read data from .png
     std::vector<png_bytep> row_pointers(surface.get_height());
     for (int y = 0; y < surface.get_height(); ++y) {
-      row_pointers[y] = static_cast<png_bytep>(surface.get_row_data(y));
+      row_pointers[y] = static_cast<png_bytep>(surface.get_row_data_detached(y));
     }
     png_read_image(png_ptr, row_pointers.data());
   }
@@ -30,44 +30,53 @@ SoftwareSurface load_from_mem(std::span<uint8_t const> data)
 {
   PNMMemReader pnm(data);
 
-  PixelData<RGBPixel> dst(pnm.get_size());
+  PixelData<RGBPixel> dst(pnm.get_size(), no_init);
   uint8_t const* src_pixels = pnm.get_pixel_data();
-  RGBPixel* dst_pixels = dst.get_data();
   //std::cout << "MaxVal: " << pnm.get_maxval() << std::endl;
   assert(pnm.get_maxval() == 255);
 
-  const int pixel_data_len = static_cast<int>((data.data() + data.size()) - src_pixels);
+  const size_t pixel_data_len = static_cast<size_t>((data.data() + data.size()) - src_pixels);
 
   if (pnm.get_magic() == "P6") // RGB
   {
-    if (dst.get_width() * dst.get_height() * 3 > pixel_data_len)
+    if (static_cast<size_t>(dst.get_width()) * static_cast<size_t>(dst.get_height()) * 3 > pixel_data_len)
     {
       throw std::runtime_error("PNM::load_from_mem(): premature end of pixel data");
     }
 
-    for(int i = 0; i < dst.get_width() * dst.get_height(); ++i)
+    for(int y = 0; y < dst.get_height(); ++y)
     {
-      dst_pixels[i+0] = RGBPixel{
-        src_pixels[3*i+0],
-        src_pixels[3*i+1],
-        src_pixels[3*i+2]
-      };
+      uint8_t const* src_row = src_pixels + 3 * static_cast<size_t>(y) * static_cast<size_t>(dst.get_width());
+      RGBPixel* dst_row = dst.get_row(y);
+      for(int x = 0; x < dst.get_width(); ++x)
+      {
+        dst_row[x] = RGBPixel{
+          src_row[3*x+0],
+          src_row[3*x+1],
+          src_row[3*x+2]
+        };
+      }
     }
   }
   else if (pnm.get_magic() == "P5") // Grayscale
   {
-    if (dst.get_width() * dst.get_height()  > pixel_data_len)
+    if (static_cast<size_t>(dst.get_width()) * static_cast<size_t>(dst.get_height()) > pixel_data_len)
     {
       throw std::runtime_error("PNM::load_from_mem(): premature end of pixel data");
     }
 
-    for(int i = 0; i < dst.get_width() * dst.get_height(); ++i)
+    for(int y = 0; y < dst.get_height(); ++y)
     {
-      dst_pixels[i+0] = RGBPixel{
-        src_pixels[i],
-        src_pixels[i],
-        src_pixels[i]
-      };
+      uint8_t const* src_row = src_pixels + static_cast<size_t>(y) * static_cast<size_t>(dst.get_width());
+      RGBPixel* dst_row = dst.get_row(y);
+      for(int x = 0; x < dst.get_width(); ++x)
+      {
+        dst_row[x] = RGBPixel{
+          src_row[x],
+          src_row[x],
+          src_row[x]
+        };
+      }
     }
   }
   else
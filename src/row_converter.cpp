@@ -0,0 +1,58 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "row_converter.hpp"
+
+#include <stdexcept>
+
+namespace surf {
+
+RowConverter::RowConverter(PixelFormat src, PixelFormat dst) :
+  m_src(src),
+  m_dst(dst),
+  m_kernel(KernelRegistry::instance().get(src, dst, BlendFunc::COPY))
+{
+}
+
+void
+RowConverter::convert_rows(SoftwareSurface const& src, int y, SoftwareSurface& dst) const
+{
+  check_rows(src, y, dst.get_format(), dst.get_size());
+
+  for (int i = 0; i < dst.get_height(); ++i) {
+    convert_row(src.get_row_data(y + i), dst.get_row_data_detached(i), dst.get_width());
+  }
+}
+
+void
+RowConverter::check_rows(SoftwareSurface const& src, int y, PixelFormat dst_format, geom::isize const& dst_size) const
+{
+  if (src.get_format() != m_src || dst_format != m_dst) {
+    throw std::invalid_argument("RowConverter: format mismatch");
+  }
+
+  if (src.get_width() != dst_size.width()) {
+    throw std::invalid_argument("RowConverter: width mismatch");
+  }
+
+  if (y < 0 || y + dst_size.height() > src.get_height()) {
+    throw std::invalid_argument("RowConverter: rows out of range");
+  }
+}
+
+} // namespace surf
+
+/* EOF */
@@ -0,0 +1,134 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "scale_filter.hpp"
+
+#include <stdexcept>
+
+#include "kernels/scale_kernels.hpp"
+
+namespace surf {
+
+ScaleFilter ScaleFilter_from_string(std::string_view text)
+{
+  if (text == "NEAREST") {
+    return ScaleFilter::NEAREST;
+  } else if (text == "BILINEAR") {
+    return ScaleFilter::BILINEAR;
+  } else if (text == "BOX") {
+    return ScaleFilter::BOX;
+  } else {
+    throw std::invalid_argument("invalid ScaleFilter");
+  }
+}
+
+std::string_view to_string(ScaleFilter filter)
+{
+  switch (filter) {
+    case ScaleFilter::NEAREST: return "NEAREST";
+    case ScaleFilter::BILINEAR: return "BILINEAR";
+    case ScaleFilter::BOX: return "BOX";
+    default: throw std::invalid_argument("invalid ScaleFilter");
+  }
+}
+
+namespace detail {
+
+std::vector<ScaleTap> make_scale_taps(ScaleFilter filter, int srclen, int dstlen)
+{
+  if (dstlen <= 0) {
+    return {};
+  }
+
+  if (srclen <= 0) {
+    throw std::invalid_argument("make_scale_taps: empty source");
+  }
+
+  std::vector<ScaleTap> taps(static_cast<size_t>(dstlen));
+
+  if (filter == ScaleFilter::BILINEAR) {
+    // destination pixel centers in source coordinates, 16.16 fixed point
+    int64_t const step = (static_cast<int64_t>(srclen) << 16) / dstlen;
+    int64_t pos = step / 2 - (1 << 15);
+    for (ScaleTap& tap : taps) {
+      if (pos <= 0) {
+        tap = {0, std::min(1, srclen - 1), 0};
+      } else if ((pos >> 16) >= srclen - 1) {
+        tap = {srclen - 1, srclen - 1, 0};
+      } else {
+        int const index = static_cast<int>(pos >> 16);
+        tap = {index, index + 1, static_cast<uint32_t>(pos >> 8) & 0xff};
+      }
+      pos += step;
+    }
+  } else {
+    // floor(x * srclen / dstlen) as quotient and remainder steps
+    int const quot = srclen / dstlen;
+    int const rem = srclen % dstlen;
+    int index = 0;
+    int acc = 0;
+    for (ScaleTap& tap : taps) {
+      int next = index + quot;
+      acc += rem;
+      if (acc >= dstlen) {
+        acc -= dstlen;
+        next += 1;
+      }
+      tap = {index, std::max(index + 1, next), 0};
+      index = next;
+    }
+  }
+
+  return taps;
+}
+
+void lerp_bytes(uint8_t const* a, uint8_t const* b, uint8_t* out, size_t count, uint32_t frac)
+{
+  static kernels::LerpBytesKernel const kernel = kernels::get_lerp_bytes_kernel();
+
+  if (kernel != nullptr) {
+    kernel(a, b, out, count, frac);
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = lerp_channel(a[i], b[i], frac);
+    }
+  }
+}
+
+void bilinear_row_4x8(void const* srcrow, ScaleTap const* taps, void* out, size_t count)
+{
+  static kernels::BilinearRowKernel const kernel = kernels::get_bilinear_row_4x8_kernel();
+
+  if (kernel != nullptr) {
+    kernel(srcrow, taps, out, count);
+  } else {
+    uint8_t const* const src = static_cast<uint8_t const*>(srcrow);
+    uint8_t* const dst = static_cast<uint8_t*>(out);
+    for (size_t x = 0; x < count; ++x) {
+      for (size_t c = 0; c < 4; ++c) {
+        dst[x * 4 + c] = lerp_channel(src[static_cast<size_t>(taps[x].index) * 4 + c],
+                                      src[static_cast<size_t>(taps[x].next) * 4 + c],
+                                      taps[x].frac);
+      }
+    }
+  }
+}
+
+} // namespace detail
+
+} // namespace surf
+
+/* EOF */
@@ -27,6 +27,7 @@
 #include "blendfunc.hpp"
 #include "blit.hpp"
 #include "convert.hpp"
+#include "external_pixel_data.hpp"
 #include "fill.hpp"
 #include "pixel.hpp"
 #include "software_surface_factory.hpp"
@@ -61,42 +62,102 @@ SoftwareSurface::create(PixelFormat format, geom::isize const& size, Color const
 }
 
 SoftwareSurface
-SoftwareSurface::create_view(PixelFormat format, geom::isize const& size, void* ptr, int pitch)
+SoftwareSurface::create(PixelFormat format, geom::isize const& size, NoInit)
+{
+  PIXELFORMAT_TO_TYPE(
+    format,
+    pixeltype,
+    return SoftwareSurface(PixelData<pixeltype>(size, no_init)));
+}
+
+SoftwareSurface
+SoftwareSurface::create_view(PixelFormat format, geom::isize const& size, void* ptr, ptrdiff_t pitch)
 {
   PIXELFORMAT_TO_TYPE(
     format,
     pixeltype,
     return SoftwareSurface(std::make_unique<PixelView<pixeltype>>(
-                             size, static_cast<pixeltype*>(ptr), pitch / sizeof(pixeltype))));
+                             size, static_cast<pixeltype*>(ptr), pitch / static_cast<ptrdiff_t>(sizeof(pixeltype)))));
 }
 
 SoftwareSurface
-SoftwareSurface::create_view(PixelFormat format, geom::isize const& size, void const* ptr, int pitch)
+SoftwareSurface::create_view(PixelFormat format, geom::isize const& size, void const* ptr, ptrdiff_t pitch)
 {
   PIXELFORMAT_TO_TYPE(
     format,
     pixeltype,
     return SoftwareSurface(std::make_unique<PixelView<pixeltype>>(
-                             size, static_cast<pixeltype const*>(ptr), pitch / sizeof(pixeltype))));
+                             size, static_cast<pixeltype const*>(ptr), pitch / static_cast<ptrdiff_t>(sizeof(pixeltype)))));
+}
+
+SoftwareSurface
+SoftwareSurface::adopt(PixelFormat format, geom::isize const& size, void* ptr, ptrdiff_t pitch,
+                       std::function<void (void*)> deleter)
+{
+  PIXELFORMAT_TO_TYPE(
+    format,
+    pixeltype,
+    return SoftwareSurface(ExternalPixelData<pixeltype>(
+                             size, static_cast<pixeltype*>(ptr), pitch, std::move(deleter))));
 }
 
 SoftwareSurface::SoftwareSurface() :
-  m_pixel_data()
+  m_pixel_data(),
+  m_shareable(true)
 {
 }
 
+SoftwareSurface::SoftwareSurface(std::unique_ptr<IPixelData> pixel_data) :
+  m_pixel_data(std::move(pixel_data)),
+  m_shareable(true)
+{
+  if (!m_pixel_data) {
+    return;
+  }
+
+  PIXELFORMAT_TO_TYPE(
+    m_pixel_data->get_format(),
+    pixeltype,
+    if (dynamic_cast<PixelView<pixeltype>*>(m_pixel_data.get()) == nullptr) {
+      throw std::invalid_argument("SoftwareSurface: IPixelData is not a PixelView of its format");
+    });
+}
+
 SoftwareSurface::SoftwareSurface(SoftwareSurface const& other) :
-  m_pixel_data(other.m_pixel_data->copy())
+  m_pixel_data(),
+  m_shareable(true)
 {
+  *this = other;
 }
 
 SoftwareSurface&
 SoftwareSurface::operator=(SoftwareSurface const& other)
 {
-  m_pixel_data = other.m_pixel_data->copy();
+  if (this == &other) {
+    return *this;
+  }
+
+  if (!other.m_pixel_data) {
+    m_pixel_data.reset();
+  } else if (other.m_shareable && other.m_pixel_data->owns_data()) {
+    m_pixel_data = other.m_pixel_data;
+  } else {
+    // views and data with outstanding views are copied right away
+    m_pixel_data = other.m_pixel_data->copy();
+  }
+  m_shareable = true;
+
   return *this;
 }
 
+void
+SoftwareSurface::detach()
+{
+  if (m_pixel_data && m_pixel_data.use_count() > 1) {
+    m_pixel_data = m_pixel_data->copy();
+  }
+}
+
 geom::isize
 SoftwareSurface::get_size()  const
 {
@@ -121,7 +182,7 @@ SoftwareSurface::get_height() const
   return m_pixel_data->get_height();
 }
 
-int
+ptrdiff_t
 SoftwareSurface::get_pitch() const
 {
   if (!m_pixel_data) { return 0; }
@@ -142,6 +203,8 @@ SoftwareSurface::get_data()
 {
   if (!m_pixel_data) { return nullptr; }
 
+  detach();
+  m_shareable = false;
   return m_pixel_data->get_row_data(0);
 }
 
@@ -150,6 +213,17 @@ SoftwareSurface::get_row_data(int y)
 {
   if (!m_pixel_data) { return nullptr; }
 
+  detach();
+  m_shareable = false;
+  return m_pixel_data->get_row_data(y);
+}
+
+void*
+SoftwareSurface::get_row_data_detached(int y)
+{
+  if (!m_pixel_data) { return nullptr; }
+
+  detach();
   return m_pixel_data->get_row_data(y);
 }
 
@@ -178,15 +252,46 @@ SoftwareSurface::get_pixel(geom::ipoint const& position) const
 void
 SoftwareSurface::put_pixel(geom::ipoint const& position, Color const& color)
 {
+  detach();
   m_pixel_data->put_pixel_color(position, color);
 }
 
+void
+SoftwareSurface::read_row_colors(int y, int x, int count, Color* out) const
+{
+  m_pixel_data->read_row_colors(y, x, count, out);
+}
+
+void
+SoftwareSurface::write_row_colors(int y, int x, int count, Color const* in)
+{
+  detach();
+  m_pixel_data->write_row_colors(y, x, count, in);
+}
+
 SoftwareSurface
-SoftwareSurface::get_view(geom::irect const& rect) const
+SoftwareSurface::get_view(geom::irect const& rect)
 {
+  detach();
+  m_shareable = false;
   return SoftwareSurface(m_pixel_data->create_view(rect));
 }
 
+SoftwareSurface const
+SoftwareSurface::get_view(geom::irect const& rect) const
+{
+  // the view only ever reaches the caller as const, so it can point
+  // into pixel data that is shared with other surfaces. It holds a
+  // reference to that data, which keeps it alive for the view and
+  // makes this surface and its copies detach on their next write, so
+  // the view keeps showing the pixels as they were when it was taken.
+  std::shared_ptr<IPixelData> const parent = m_pixel_data;
+  SoftwareSurface view;
+  view.m_pixel_data = std::shared_ptr<IPixelData>(m_pixel_data->create_view(rect).release(),
+                                                  [parent](IPixelData* pixel_data) { delete pixel_data; });
+  return view;
+}
+
 } // namespace surf
 
 /* EOF */
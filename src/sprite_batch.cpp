@@ -0,0 +1,271 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "sprite_batch.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "blit.hpp"
+#include "kernel_registry.hpp"
+#include "software_surface.hpp"
+#include "visit.hpp"
+
+namespace surf {
+
+namespace {
+
+/** A draw with its kernel looked up and its rectangles clipped */
+struct Job
+{
+  SpanKernel kernel;
+  SpriteBatch::Draw const* draw;
+  geom::irect srcrect;
+  geom::irect dstrect;
+  size_t src_pixel_size;
+};
+
+class BandRenderer
+{
+public:
+  BandRenderer(std::vector<Job> jobs, SoftwareSurface& dst, int band_height) :
+    m_jobs(std::move(jobs)),
+    m_dstrows(static_cast<size_t>(dst.get_height())),
+    m_dst_pixel_size(KernelRegistry::pixel_size(dst.get_format())),
+    m_band_height(band_height),
+    m_bands(static_cast<size_t>((dst.get_height() + band_height - 1) / band_height))
+  {
+    // resolving the rows up front also makes sure dst is detached
+    // before multiple threads write to it
+    for (int y = 0; y < dst.get_height(); ++y) {
+      m_dstrows[static_cast<size_t>(y)] = static_cast<uint8_t*>(dst.get_row_data_detached(y));
+    }
+
+    // bucket the jobs by band, each bucket keeps the draw order
+    for (size_t i = 0; i < m_jobs.size(); ++i) {
+      geom::irect const& rect = m_jobs[i].dstrect;
+      for (int band = rect.top() / m_band_height; band <= (rect.bottom() - 1) / m_band_height; ++band) {
+        m_bands[static_cast<size_t>(band)].push_back(i);
+      }
+    }
+  }
+
+  size_t get_band_count() const { return m_bands.size(); }
+
+  void render_band(size_t band) const
+  {
+    int const top = static_cast<int>(band) * m_band_height;
+    int const bottom = top + m_band_height;
+
+    for (size_t const i : m_bands[band]) {
+      Job const& job = m_jobs[i];
+      int const y_begin = std::max(top, job.dstrect.top());
+      int const y_end = std::min(bottom, job.dstrect.bottom());
+
+      if (job.draw->scaled) {
+        render_scaled(job, y_begin, y_end);
+      } else {
+        int const dy = job.srcrect.top() - job.dstrect.top();
+        size_t const dst_offset = static_cast<size_t>(job.dstrect.left()) * m_dst_pixel_size;
+        size_t const src_offset = static_cast<size_t>(job.srcrect.left()) * job.src_pixel_size;
+        for (int y = y_begin; y < y_end; ++y) {
+          job.kernel(static_cast<uint8_t const*>(job.draw->src->get_row_data(y + dy)) + src_offset,
+                     m_dstrows[static_cast<size_t>(y)] + dst_offset,
+                     static_cast<size_t>(job.dstrect.width()));
+        }
+      }
+    }
+  }
+
+private:
+  void render_scaled(Job const& job, int y_begin, int y_end) const
+  {
+    visit(*job.draw->src, [&](auto const& srcview) {
+      using SrcPixel = typename std::decay_t<decltype(srcview)>::value_type;
+
+      ScaledRowSampler<SrcPixel> sampler(srcview, job.srcrect, job.dstrect.size(), job.draw->filter);
+      std::vector<SrcPixel> samples(static_cast<size_t>(job.dstrect.width()));
+      size_t const dst_offset = static_cast<size_t>(job.dstrect.left()) * m_dst_pixel_size;
+
+      for (int y = y_begin; y < y_end; ++y) {
+        sampler.sample_row(y - job.dstrect.top(), samples.data());
+        job.kernel(samples.data(), m_dstrows[static_cast<size_t>(y)] + dst_offset, samples.size());
+      }
+    });
+  }
+
+private:
+  std::vector<Job> const m_jobs;
+  std::vector<uint8_t*> m_dstrows;
+  size_t const m_dst_pixel_size;
+  int const m_band_height;
+  std::vector<std::vector<size_t>> m_bands;
+};
+
+} // namespace
+
+SpriteBatch::SpriteBatch(int band_height) :
+  m_band_height(band_height),
+  m_draws()
+{
+  if (m_band_height <= 0) {
+    throw std::invalid_argument("SpriteBatch: band height must be positive");
+  }
+}
+
+void
+SpriteBatch::blit(SoftwareSurface const& src, geom::ipoint const& pos)
+{
+  blend(BlendFunc::COPY, src, geom::irect(src.get_size()), pos);
+}
+
+void
+SpriteBatch::blit(SoftwareSurface const& src, geom::irect const& srcrect, geom::ipoint const& pos)
+{
+  blend(BlendFunc::COPY, src, srcrect, pos);
+}
+
+void
+SpriteBatch::blend(BlendFunc blendfunc, SoftwareSurface const& src, geom::ipoint const& pos)
+{
+  blend(blendfunc, src, geom::irect(src.get_size()), pos);
+}
+
+void
+SpriteBatch::blend(BlendFunc blendfunc, SoftwareSurface const& src, geom::irect const& srcrect, geom::ipoint const& pos)
+{
+  assert(contains(geom::irect(src.get_size()), srcrect));
+
+  m_draws.push_back(Draw{&src, srcrect, geom::irect(pos, srcrect.size()), blendfunc, ScaleFilter::NEAREST, false});
+}
+
+void
+SpriteBatch::blend_scaled(BlendFunc blendfunc, SoftwareSurface const& src, geom::irect const& dstrect,
+                          ScaleFilter filter)
+{
+  blend_scaled(blendfunc, src, geom::irect(src.get_size()), dstrect, filter);
+}
+
+void
+SpriteBatch::blend_scaled(BlendFunc blendfunc, SoftwareSurface const& src, geom::irect const& srcrect,
+                          geom::irect const& dstrect, ScaleFilter filter)
+{
+  m_draws.push_back(Draw{&src, srcrect, dstrect, blendfunc, filter, true});
+}
+
+void
+SpriteBatch::render(SoftwareSurface& dst, unsigned int threads) const
+{
+  KernelRegistry const& registry = KernelRegistry::instance();
+  geom::irect const cliprect(dst.get_size());
+
+  std::vector<Job> jobs;
+  jobs.reserve(m_draws.size());
+
+  // consecutive draws mostly share their formats, so only look up the
+  // kernel when they change
+  PixelFormat last_format = PixelFormat::NONE;
+  BlendFunc last_blendfunc = BlendFunc::COPY;
+  SpanKernel kernel = nullptr;
+
+  for (Draw const& draw : m_draws) {
+    geom::irect srcrect = draw.srcrect;
+    geom::irect dstrect = draw.dstrect;
+
+    if (draw.scaled) {
+      if (!detail::clip_scaled(draw.src->get_size(), srcrect, dst.get_size(), dstrect)) {
+        continue;
+      }
+    } else {
+      dstrect = geom::intersection(draw.dstrect, cliprect);
+      if (dstrect.width() <= 0 || dstrect.height() <= 0) {
+        continue;
+      }
+      srcrect = dstrect + geom::ioffset(draw.srcrect.left() - draw.dstrect.left(),
+                                        draw.srcrect.top() - draw.dstrect.top());
+    }
+
+    if (kernel == nullptr || draw.src->get_format() != last_format || draw.blendfunc != last_blendfunc) {
+      last_format = draw.src->get_format();
+      last_blendfunc = draw.blendfunc;
+      kernel = registry.get(last_format, dst.get_format(), last_blendfunc);
+    }
+
+    jobs.push_back(Job{kernel, &draw, srcrect, dstrect, KernelRegistry::pixel_size(last_format)});
+  }
+
+  if (jobs.empty()) {
+    return;
+  }
+
+  BandRenderer const renderer(std::move(jobs), dst, m_band_height);
+
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threads = static_cast<unsigned int>(std::min<size_t>(threads, renderer.get_band_count()));
+
+  if (threads <= 1) {
+    for (size_t band = 0; band < renderer.get_band_count(); ++band) {
+      renderer.render_band(band);
+    }
+    return;
+  }
+
+  // bands don't overlap, so they can be handed out in any order
+  std::atomic<size_t> next_band = 0;
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  auto const worker = [&] {
+    try {
+      for (size_t band = next_band++; band < renderer.get_band_count(); band = next_band++) {
+        renderer.render_band(band);
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (unsigned int i = 1; i < threads; ++i) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& thread : workers) {
+    thread.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace surf
+
+/* EOF */
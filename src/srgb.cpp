@@ -0,0 +1,119 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "srgb.hpp"
+
+#include "kernels/srgb_kernels.hpp"
+#include "unwrap.hpp"
+
+namespace surf {
+
+namespace {
+
+template<typename Pixel>
+void srgb_decode_kernel_t(void const* src, void* dst, size_t count)
+{
+  srgb_decode_n(static_cast<Pixel const*>(src), static_cast<RGBA16Pixel*>(dst), count);
+}
+
+template<typename Pixel>
+void srgb_encode_kernel_t(void const* src, void* dst, size_t count)
+{
+  srgb_encode_n(static_cast<RGBA16Pixel const*>(src), static_cast<Pixel*>(dst), count);
+}
+
+uint32_t round_unorm16(double v)
+{
+  return static_cast<uint32_t>(v * 65535.0 + 0.5);
+}
+
+} // namespace
+
+SRGBLut const&
+SRGBLut::instance()
+{
+  static SRGBLut const lut;
+  return lut;
+}
+
+SRGBLut::SRGBLut() :
+  m_decode8(),
+  m_decode16(),
+  m_encode(),
+  m_decode_rgba8(kernels::get_srgb_decode_rgba8_kernel()),
+  m_encode_rgba8(kernels::get_srgb_encode_rgba8_kernel())
+{
+  // built in double, so the float helpers' rounding doesn't leak into
+  // the tables
+  auto const to_linear = [](double v) {
+    return v <= 0.04045 ? v / 12.92 : std::pow((v + 0.055) / 1.055, 2.4);
+  };
+  auto const to_srgb = [](double v) {
+    return v <= 0.0031308 ? v * 12.92 : 1.055 * std::pow(v, 1.0 / 2.4) - 0.055;
+  };
+
+  for (size_t i = 0; i < m_decode8.size(); ++i) {
+    m_decode8[i] = round_unorm16(to_linear(static_cast<double>(i) / 255.0));
+  }
+
+  // the last entry lies just past 1.0, so interpolating up to 65535
+  // stays on the curve
+  for (size_t i = 0; i < m_decode16.size(); ++i) {
+    m_decode16[i] = round_unorm16(to_linear(static_cast<double>(i * 16) / 65535.0));
+    m_encode[i] = round_unorm16(to_srgb(static_cast<double>(i * 16) / 65535.0));
+  }
+}
+
+void
+SRGBLut::decode_n(RGBA8Pixel const* src, RGBA16Pixel* dst, size_t count) const
+{
+  if (m_decode_rgba8 != nullptr) {
+    m_decode_rgba8(*this, src, dst, count);
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      dst[i] = srgb_decode(*this, src[i]);
+    }
+  }
+}
+
+void
+SRGBLut::encode_n(RGBA16Pixel const* src, RGBA8Pixel* dst, size_t count) const
+{
+  if (m_encode_rgba8 != nullptr) {
+    m_encode_rgba8(*this, src, dst, count);
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      dst[i] = srgb_encode<RGBA8Pixel>(*this, src[i]);
+    }
+  }
+}
+
+SpanKernel srgb_decode_kernel(PixelFormat format)
+{
+  PIXELFORMAT_TO_TYPE(format, srctype, return &srgb_decode_kernel_t<srctype>);
+  return nullptr;
+}
+
+SpanKernel srgb_encode_kernel(PixelFormat format)
+{
+  PIXELFORMAT_TO_TYPE(format, dsttype, return &srgb_encode_kernel_t<dsttype>);
+  return nullptr;
+}
+
+} // namespace surf
+
+/* EOF */
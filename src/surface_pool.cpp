@@ -0,0 +1,201 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "surface_pool.hpp"
+
+#include <bit>
+
+namespace surf {
+
+namespace {
+
+thread_local SurfacePool* g_current_pool = nullptr;
+
+} // namespace
+
+SurfacePool*
+current_surface_pool()
+{
+  return g_current_pool;
+}
+
+void*
+allocate_pixels(SurfacePool* pool, size_t bytes)
+{
+  if (pool == nullptr) {
+    return allocate_pixels(bytes);
+  } else {
+    return pool->allocate(bytes);
+  }
+}
+
+void
+deallocate_pixels(SurfacePool* pool, void* ptr, size_t bytes) noexcept
+{
+  if (pool == nullptr) {
+    deallocate_pixels(ptr, bytes);
+  } else {
+    pool->deallocate(ptr, bytes);
+  }
+}
+
+SurfacePool::SurfacePool(size_t budget) :
+  m_mutex(),
+  m_budget(budget),
+  m_free_lists(),
+  m_stats()
+{
+}
+
+SurfacePool::~SurfacePool()
+{
+  trim();
+}
+
+size_t
+SurfacePool::size_class(size_t bytes)
+{
+  if (bytes <= 4096) {
+    return (bytes + PIXEL_ALIGNMENT - 1) / PIXEL_ALIGNMENT * PIXEL_ALIGNMENT;
+  } else {
+    // eight classes per power of two, wasting at most 12.5%
+    size_t const step = std::bit_floor(bytes - 1) / 8;
+    return (bytes + step - 1) / step * step;
+  }
+}
+
+void*
+SurfacePool::allocate(size_t bytes)
+{
+  size_t const size = size_class(bytes);
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_free_lists.find(size);
+    if (it != m_free_lists.end() && !it->second.empty()) {
+      void* ptr = it->second.back();
+      it->second.pop_back();
+      m_stats.hits += 1;
+      m_stats.cached_bytes -= size;
+      m_stats.cached_buffers -= 1;
+      return ptr;
+    }
+    m_stats.misses += 1;
+  }
+
+  return allocate_pixels(size);
+}
+
+void
+SurfacePool::deallocate(void* ptr, size_t bytes) noexcept
+{
+  if (ptr == nullptr) {
+    return;
+  }
+
+  size_t const size = size_class(bytes);
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stats.cached_bytes + size <= m_budget) {
+      try {
+        m_free_lists[size].push_back(ptr);
+        m_stats.recycled += 1;
+        m_stats.cached_bytes += size;
+        m_stats.cached_buffers += 1;
+        return;
+      } catch (...) {
+        // out of memory for the free list, release the buffer instead
+      }
+    }
+    m_stats.released += 1;
+  }
+
+  deallocate_pixels(ptr, size);
+}
+
+void
+SurfacePool::trim()
+{
+  trim_to(0);
+}
+
+void
+SurfacePool::set_budget(size_t budget)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = budget;
+  }
+  trim_to(budget);
+}
+
+size_t
+SurfacePool::get_budget() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_budget;
+}
+
+SurfacePool::Stats
+SurfacePool::get_stats() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+void
+SurfacePool::trim_to(size_t budget)
+{
+  std::vector<std::pair<void*, size_t>> garbage;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_free_lists.begin(); it != m_free_lists.end() && m_stats.cached_bytes > budget; ) {
+      while (!it->second.empty() && m_stats.cached_bytes > budget) {
+        garbage.emplace_back(it->second.back(), it->first);
+        it->second.pop_back();
+        m_stats.cached_bytes -= it->first;
+        m_stats.cached_buffers -= 1;
+      }
+
+      if (it->second.empty()) {
+        it = m_free_lists.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  for (auto const& [ptr, size] : garbage) {
+    deallocate_pixels(ptr, size);
+  }
+}
+
+SurfacePoolScope::SurfacePoolScope(SurfacePool& pool) :
+  m_previous(g_current_pool)
+{
+  g_current_pool = &pool;
+}
+
+SurfacePoolScope::~SurfacePoolScope()
+{
+  g_current_pool = m_previous;
+}
+
+} // namespace surf
+
+/* EOF */
@@ -0,0 +1,264 @@
+// surf - Software surface library
+// Copyright (C) 2008-2020 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "tile_store.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "pixel_allocator.hpp"
+
+namespace surf {
+
+namespace {
+
+[[noreturn]]
+void throw_errno(std::string_view context, int errnum)
+{
+  throw std::runtime_error(fmt::format("TileStore: {}: {}", context, strerror(errnum)));
+}
+
+int open_scratch_file(std::filesystem::path const& scratch_dir)
+{
+#ifdef O_TMPFILE
+  int const fd = open(scratch_dir.c_str(), O_RDWR | O_TMPFILE | O_CLOEXEC, 0600);
+  if (fd >= 0) {
+    return fd;
+  }
+  // not supported by the filesystem, fall back to mkstemp()
+#endif
+
+  std::string pattern = (scratch_dir / "surf-tiles-XXXXXX").string();
+  int const tmp_fd = mkstemp(pattern.data());
+  if (tmp_fd < 0) {
+    throw_errno(pattern, errno);
+  }
+  // keep the fd, the file vanishes once it is closed
+  unlink(pattern.c_str());
+  return tmp_fd;
+}
+
+} // namespace
+
+TileStore::TileStore(size_t tile_bytes, size_t tile_count,
+                     void const* initial_tile, size_t cache_budget,
+                     std::filesystem::path const& scratch_dir) :
+  m_mutex(),
+  m_tile_bytes(tile_bytes),
+  m_tile_count(tile_count),
+  m_cache_budget(cache_budget),
+  m_fd(open_scratch_file(scratch_dir)),
+  m_initial_tile(static_cast<std::byte const*>(initial_tile),
+                 static_cast<std::byte const*>(initial_tile) + tile_bytes),
+  m_entries(tile_count),
+  m_lru(),
+  m_stats()
+{
+  // reserve the full size up front, sparse on most filesystems
+  if (ftruncate(m_fd, static_cast<off_t>(tile_bytes * tile_count)) != 0) {
+    int const errnum = errno;
+    close(m_fd);
+    throw_errno("ftruncate()", errnum);
+  }
+}
+
+TileStore::~TileStore()
+{
+  for (Entry& entry : m_entries) {
+    if (entry.data != nullptr) {
+      deallocate_pixels(entry.data, m_tile_bytes);
+    }
+  }
+  close(m_fd);
+}
+
+void*
+TileStore::lock(size_t index, bool write)
+{
+  assert(index < m_tile_count);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  Entry& entry = m_entries[index];
+  if (entry.data != nullptr) {
+    m_stats.hits += 1;
+    m_lru.splice(m_lru.begin(), m_lru, entry.lru);
+
+    if (m_stats.resident_bytes > m_cache_budget) {
+      // catch up on the eviction unlock() leaves to us, with the tile
+      // pinned so it stays resident
+      entry.pins += 1;
+      try {
+        evict_to(m_cache_budget);
+      } catch (...) {
+        entry.pins -= 1;
+        throw;
+      }
+      entry.pins -= 1;
+    }
+  } else {
+    m_stats.misses += 1;
+
+    // make room for the new tile before allocating it, this also
+    // catches up on the eviction unlock() leaves to us
+    evict_to(m_cache_budget > m_tile_bytes ? m_cache_budget - m_tile_bytes : 0);
+
+    entry.data = static_cast<std::byte*>(allocate_pixels(m_tile_bytes));
+    try {
+      read_in(index, entry);
+    } catch (...) {
+      deallocate_pixels(entry.data, m_tile_bytes);
+      entry.data = nullptr;
+      throw;
+    }
+
+    m_lru.push_front(index);
+    entry.lru = m_lru.begin();
+    m_stats.resident_bytes += m_tile_bytes;
+    m_stats.resident_tiles += 1;
+  }
+
+  entry.pins += 1;
+  entry.dirty = entry.dirty || write;
+  return entry.data;
+}
+
+void
+TileStore::unlock(size_t index) noexcept
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  // no eviction here, a failed write back could only be reported by
+  // throwing from a destructor, the next lock() evicts instead
+  Entry& entry = m_entries[index];
+  assert(entry.pins > 0);
+  entry.pins -= 1;
+}
+
+void
+TileStore::flush()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  for (size_t index = 0; index < m_tile_count; ++index) {
+    Entry& entry = m_entries[index];
+    if (entry.data != nullptr && entry.dirty) {
+      write_back(index, entry);
+    }
+  }
+}
+
+void
+TileStore::set_cache_budget(size_t budget)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_cache_budget = budget;
+  evict_to(budget);
+}
+
+size_t
+TileStore::get_cache_budget() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_cache_budget;
+}
+
+TileStore::Stats
+TileStore::get_stats() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+void
+TileStore::evict_to(size_t budget)
+{
+  // walk from the least recently used end, skipping pinned tiles
+  auto it = m_lru.end();
+  while (m_stats.resident_bytes > budget && it != m_lru.begin()) {
+    --it;
+    Entry& entry = m_entries[*it];
+    if (entry.pins > 0) {
+      continue;
+    }
+
+    if (entry.dirty) {
+      write_back(*it, entry);
+    }
+
+    deallocate_pixels(entry.data, m_tile_bytes);
+    entry.data = nullptr;
+    it = m_lru.erase(it);
+    m_stats.resident_bytes -= m_tile_bytes;
+    m_stats.resident_tiles -= 1;
+  }
+}
+
+void
+TileStore::write_back(size_t index, Entry& entry)
+{
+  off_t const offset = static_cast<off_t>(index * m_tile_bytes);
+  size_t done = 0;
+  while (done < m_tile_bytes) {
+    ssize_t const ret = pwrite(m_fd, entry.data + done, m_tile_bytes - done,
+                               offset + static_cast<off_t>(done));
+    if (ret < 0) {
+      if (errno == EINTR) { continue; }
+      throw_errno("pwrite()", errno);
+    }
+    done += static_cast<size_t>(ret);
+  }
+
+  entry.dirty = false;
+  entry.on_disk = true;
+  m_stats.writebacks += 1;
+}
+
+void
+TileStore::read_in(size_t index, Entry& entry)
+{
+  if (!entry.on_disk) {
+    std::memcpy(entry.data, m_initial_tile.data(), m_tile_bytes);
+    return;
+  }
+
+  off_t const offset = static_cast<off_t>(index * m_tile_bytes);
+  size_t done = 0;
+  while (done < m_tile_bytes) {
+    ssize_t const ret = pread(m_fd, entry.data + done, m_tile_bytes - done,
+                              offset + static_cast<off_t>(done));
+    if (ret < 0) {
+      if (errno == EINTR) { continue; }
+      throw_errno("pread()", errno);
+    } else if (ret == 0) {
+      throw std::runtime_error("TileStore: unexpected end of scratch file");
+    }
+    done += static_cast<size_t>(ret);
+  }
+}
+
+} // namespace surf
+
+/* EOF */
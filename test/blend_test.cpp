@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <surf/blend.hpp>
+#include <surf/blendfunc.hpp>
+#include <surf/pixel.hpp>
+#include <surf/pixel_data.hpp>
+#include <surf/software_surface.hpp>
+
+using namespace surf;
+
+TEST(BlendTest, float_over)
+{
+  // half coverage over an opaque background
+  EXPECT_EQ((pixel_blend<RGBA32fPixel, RGB32fPixel>()(RGBA32fPixel{1.0f, 0.5f, 0.0f, 0.5f}, RGB32fPixel{0.0f, 0.5f, 1.0f})),
+            (RGB32fPixel{0.5f, 0.5f, 0.5f}));
+
+  // straight alpha over a translucent destination
+  RGBA32fPixel const over = pixel_blend<RGBA32fPixel, RGBA32fPixel>()(RGBA32fPixel{1.0f, 0.0f, 0.0f, 0.5f},
+                                                                       RGBA32fPixel{0.0f, 0.0f, 1.0f, 0.5f});
+  EXPECT_FLOAT_EQ(over.r, 2.0f / 3.0f);
+  EXPECT_FLOAT_EQ(over.g, 0.0f);
+  EXPECT_FLOAT_EQ(over.b, 1.0f / 3.0f);
+  EXPECT_FLOAT_EQ(over.a, 0.75f);
+
+  // transparent sources leave the destination alone, HDR values survive
+  EXPECT_EQ((pixel_blend<RGBA32fPixel, RGBA32fPixel>()(RGBA32fPixel{1.0f, 1.0f, 1.0f, 0.0f}, RGBA32fPixel{0.25f, 0.5f, 0.75f, 0.0f})),
+            (RGBA32fPixel{0.25f, 0.5f, 0.75f, 0.0f}));
+  EXPECT_EQ((pixel_blend<RGBA32fPixel, RGBA32fPixel>()(RGBA32fPixel{4.0f, 2.0f, 0.0f, 1.0f}, RGBA32fPixel{0.25f, 0.5f, 0.75f, 1.0f})),
+            (RGBA32fPixel{4.0f, 2.0f, 0.0f, 1.0f}));
+
+  // half and luminance formats
+  EXPECT_EQ((pixel_blend<RGBA16fPixel, LA16fPixel>()(RGBA16fPixel{1.0f, 1.0f, 1.0f, 0.5f}, LA16fPixel{0.0f, 1.0f})),
+            (LA16fPixel{0.5f, 1.0f}));
+  EXPECT_EQ((pixel_blend<LA32fPixel, L32fPixel>()(LA32fPixel{1.0f, 0.25f}, L32fPixel{0.0f})),
+            (L32fPixel{0.25f}));
+
+  // integer formats on either side, integer destinations clamp
+  EXPECT_EQ((pixel_blend<RGBA32fPixel, RGBA8Pixel>()(RGBA32fPixel{2.0f, 0.5f, 0.0f, 1.0f}, RGBA8Pixel{0, 0, 0, 0})),
+            (RGBA8Pixel{255, 127, 0, 255}));
+  EXPECT_EQ((pixel_blend<RGBA8Pixel, RGBA32fPixel>()(RGBA8Pixel{255, 0, 0, 255}, RGBA32fPixel{0.0f, 0.0f, 1.0f, 1.0f})),
+            (RGBA32fPixel{1.0f, 0.0f, 0.0f, 1.0f}));
+}
+
+TEST(BlendTest, float_surface)
+{
+  geom::isize const size(13, 3);
+  SoftwareSurface const src(PixelData<RGBA32fPixel>(size, RGBA32fPixel{2.0f, 1.0f, 0.5f, 0.5f}));
+
+  struct { BlendFunc op; RGBA32fPixel expected; } const cases[] = {
+    { BlendFunc::BLEND, RGBA32fPixel{1.5f, 1.0f, 0.75f, 1.0f} },
+    { BlendFunc::ADD, RGBA32fPixel{2.0f, 1.5f, 1.25f, 1.0f} },
+    { BlendFunc::MULTIPLY, RGBA32fPixel{1.5f, 1.0f, 0.75f, 1.0f} },
+    { BlendFunc::SCREEN, RGBA32fPixel{1.0f, 1.0f, 1.0f, 1.0f} },
+    { BlendFunc::DARKEN, RGBA32fPixel{1.0f, 1.0f, 0.75f, 1.0f} },
+    { BlendFunc::SRC_ATOP, RGBA32fPixel{1.5f, 1.0f, 0.75f, 1.0f} },
+  };
+
+  for (auto const& c : cases) {
+    for (PixelFormat format : { PixelFormat::RGBA32f, PixelFormat::RGBA16f }) {
+      SoftwareSurface dst = convert(SoftwareSurface(PixelData<RGBA32fPixel>(size, RGBA32fPixel{1.0f, 1.0f, 1.0f, 1.0f})), format);
+      blend(c.op, src, dst, geom::ipoint(0, 0));
+
+      SoftwareSurface const result = convert(dst, PixelFormat::RGBA32f);
+      EXPECT_EQ(result.as_pixelview<RGBA32fPixel>().get_pixel(geom::ipoint(12, 2)), c.expected)
+        << to_string(format) << " op " << static_cast<int>(c.op);
+    }
+  }
+}
+
+TEST(BlendTest, modes)
+{
+  // the separable mix functions on their own
+  float const cs = 0.25f;
+  float const cb = 0.75f;
+  using Ops = blendmode::ScalarOps;
+  EXPECT_FLOAT_EQ(blendmode::Screen::mix<Ops>(cb, cs), 0.8125f);
+  EXPECT_FLOAT_EQ(blendmode::Overlay::mix<Ops>(cb, cs), 0.625f);
+  EXPECT_FLOAT_EQ(blendmode::Darken::mix<Ops>(cb, cs), 0.25f);
+  EXPECT_FLOAT_EQ(blendmode::Lighten::mix<Ops>(cb, cs), 0.75f);
+  EXPECT_FLOAT_EQ(blendmode::Difference::mix<Ops>(cb, cs), 0.5f);
+  EXPECT_FLOAT_EQ(blendmode::Subtract::mix<Ops>(cb, cs), 0.5f);
+  EXPECT_FLOAT_EQ(blendmode::Subtract::mix<Ops>(cs, cb), 0.0f);
+  EXPECT_FLOAT_EQ(blendmode::SoftLight::mix<Ops>(cb, cs), 0.65625f);
+
+  // separable modes on an opaque destination are the plain mix
+  EXPECT_EQ((pixel_screen<RGBA32fPixel, RGBA32fPixel>()(RGBA32fPixel{cs, cs, cs, 1.0f}, RGBA32fPixel{cb, cb, cb, 1.0f})),
+            (RGBA32fPixel{0.8125f, 0.8125f, 0.8125f, 1.0f}));
+  // and the source itself on a transparent one
+  EXPECT_EQ((pixel_darken<RGBA32fPixel, RGBA32fPixel>()(RGBA32fPixel{cb, cb, cb, 1.0f}, RGBA32fPixel{cs, cs, cs, 0.0f})),
+            (RGBA32fPixel{cb, cb, cb, 1.0f}));
+
+  // Porter-Duff operators with half coverage on both sides
+  RGBA32fPixel const src{1.0f, 0.0f, 0.0f, 0.5f};
+  RGBA32fPixel const dst{0.0f, 0.0f, 1.0f, 0.5f};
+  EXPECT_EQ((pixel_src_in<RGBA32fPixel, RGBA32fPixel>()(src, dst)), (RGBA32fPixel{1.0f, 0.0f, 0.0f, 0.25f}));
+  EXPECT_EQ((pixel_src_out<RGBA32fPixel, RGBA32fPixel>()(src, dst)), (RGBA32fPixel{1.0f, 0.0f, 0.0f, 0.25f}));
+  EXPECT_EQ((pixel_src_atop<RGBA32fPixel, RGBA32fPixel>()(src, dst)), (RGBA32fPixel{0.5f, 0.0f, 0.5f, 0.5f}));
+  EXPECT_EQ((pixel_xor<RGBA32fPixel, RGBA32fPixel>()(src, dst)), (RGBA32fPixel{0.5f, 0.0f, 0.5f, 0.5f}));
+
+  // no coverage left gives transparent black
+  EXPECT_EQ((pixel_src_in<RGBA32fPixel, RGBA32fPixel>()(src, RGBA32fPixel{0.0f, 1.0f, 0.0f, 0.0f})),
+            (RGBA32fPixel{0.0f, 0.0f, 0.0f, 0.0f}));
+  EXPECT_EQ((pixel_xor<RGBA8Pixel, RGBA8Pixel>()(RGBA8Pixel{255, 0, 0, 255}, RGBA8Pixel{0, 255, 0, 255})),
+            (RGBA8Pixel{0, 0, 0, 0}));
+
+  // multiply fades the source by its alpha
+  EXPECT_EQ((pixel_multiply<RGBA8Pixel, RGB8Pixel>()(RGBA8Pixel{0, 0, 0, 0}, RGB8Pixel{200, 100, 50})),
+            (RGB8Pixel{200, 100, 50}));
+  EXPECT_EQ((pixel_multiply<RGBA8Pixel, RGB8Pixel>()(RGBA8Pixel{0, 0, 0, 255}, RGB8Pixel{200, 100, 50})),
+            (RGB8Pixel{0, 0, 0}));
+  EXPECT_EQ((pixel_multiply<RGBA16Pixel, RGBA16Pixel>()(RGBA16Pixel{65535, 32768, 0, 65535}, RGBA16Pixel{65535, 65535, 65535, 65535})),
+            (RGBA16Pixel{65535, 32768, 0, 65535}));
+}
+
+TEST(BlendTest, blendfunc_names)
+{
+  for (size_t i = 0; i < BLEND_FUNC_COUNT; ++i) {
+    BlendFunc const func = static_cast<BlendFunc>(i);
+    EXPECT_EQ(BlendFunc_from_string(to_string(func)), func);
+  }
+  EXPECT_EQ(BlendFunc_from_string("SOFT_LIGHT"), BlendFunc::SOFT_LIGHT);
+  EXPECT_THROW(BlendFunc_from_string("nonsense"), std::invalid_argument);
+}
+
+/* EOF */
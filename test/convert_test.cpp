@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <limits>
+
 #include <surf/convert.hpp>
 #include <surf/pixel.hpp>
 
@@ -11,6 +13,38 @@ TEST(ConvertTest, convert_value)
   EXPECT_EQ((convert_value<Color, RGB32Pixel>(1.0f)), 4294967295);
 }
 
+TEST(ConvertTest, convert_value__round_to_nearest)
+{
+  EXPECT_EQ((convert_value<Color, RGB8Pixel>(0.5f)), 128);
+  EXPECT_EQ((convert_value<Color, RGB8Pixel>(0.499f)), 127);
+  EXPECT_EQ((convert_value<Color, RGB8Pixel>(1.0f / 255.0f * 0.6f)), 1);
+  EXPECT_EQ((convert_value<Color, RGB16Pixel>(0.5f)), 32768);
+  EXPECT_EQ((convert_value<Color, RGB32Pixel>(0.5f)), 2147483648);
+
+  for (int i = 0; i <= 255; ++i) {
+    float const f = convert_value<RGB8Pixel, Color>(static_cast<uint8_t>(i));
+    EXPECT_EQ((convert_value<Color, RGB8Pixel>(f)), i);
+  }
+
+  for (int i = 0; i <= 65535; i += 257 * 3 + 1) {
+    float const f = convert_value<RGB16Pixel, Color>(static_cast<uint16_t>(i));
+    EXPECT_EQ((convert_value<Color, RGB16Pixel>(f)), i);
+  }
+}
+
+TEST(ConvertTest, convert_value__out_of_range)
+{
+  float const nan = std::numeric_limits<float>::quiet_NaN();
+
+  EXPECT_EQ((convert_value<Color, RGB8Pixel>(-0.5f)), 0);
+  EXPECT_EQ((convert_value<Color, RGB8Pixel>(2.0f)), 255);
+  EXPECT_EQ((convert_value<Color, RGB8Pixel>(nan)), 0);
+
+  EXPECT_EQ((convert_value<Color, RGB32Pixel>(-0.5f)), 0);
+  EXPECT_EQ((convert_value<Color, RGB32Pixel>(2.0f)), 4294967295);
+  EXPECT_EQ((convert_value<Color, RGB32Pixel>(nan)), 0);
+}
+
 TEST(ConvertTest, convert_rgb)
 {
   RGB32Pixel rgb32 = convert<Color, RGB32Pixel>(Color(1.0f, 1.0f, 1.0f));
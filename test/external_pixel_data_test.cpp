@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+
+#include <utility>
+#include <vector>
+
+#include <surf/external_pixel_data.hpp>
+#include <surf/software_surface.hpp>
+
+using namespace surf;
+
+TEST(ExternalPixelDataTest, deleter)
+{
+  int deleted = 0;
+  RGBAPixel* pixels = new RGBAPixel[8 * 4]();
+
+  {
+    ExternalPixelData<RGBAPixel> pixeldata(geom::isize(6, 4), pixels, 8 * sizeof(RGBAPixel),
+                                           [&deleted](void* ptr) {
+                                             delete[] static_cast<RGBAPixel*>(ptr);
+                                             deleted += 1;
+                                           });
+    EXPECT_EQ(pixeldata.get_row_length(), 8);
+    EXPECT_EQ(pixeldata.get_row(1), pixels + 8);
+
+    ExternalPixelData<RGBAPixel> moved = std::move(pixeldata);
+    EXPECT_TRUE(pixeldata.empty());
+    EXPECT_EQ(moved.get_data(), pixels);
+  }
+
+  EXPECT_EQ(deleted, 1);
+}
+
+TEST(ExternalPixelDataTest, adopt)
+{
+  int deleted = 0;
+  void* pixels = malloc(16 * 8 * 3);
+
+  {
+    SoftwareSurface surface = SoftwareSurface::adopt(PixelFormat::RGB8, geom::isize(16, 8),
+                                                     pixels, 16 * 3,
+                                                     [&deleted](void* ptr) { free(ptr); deleted += 1; });
+    EXPECT_EQ(surface.get_format(), PixelFormat::RGB8);
+    EXPECT_EQ(std::as_const(surface).get_data(), pixels);
+
+    SoftwareSurface const copy = surface;
+    surface = SoftwareSurface();
+    EXPECT_EQ(deleted, 0);
+  }
+
+  EXPECT_EQ(deleted, 1);
+}
+
+TEST(ExternalPixelDataTest, bad_pitch)
+{
+  int deleted = 0;
+  RGBAPixel* pixels = new RGBAPixel[8 * 4]();
+
+  EXPECT_THROW(ExternalPixelData<RGBAPixel>(geom::isize(8, 4), pixels, 7,
+                                            [&deleted](void* ptr) {
+                                              delete[] static_cast<RGBAPixel*>(ptr);
+                                              deleted += 1;
+                                            }),
+               std::invalid_argument);
+  EXPECT_EQ(deleted, 1);
+}
+
+TEST(ExternalPixelDataTest, empty_deleter)
+{
+  std::vector<RGBAPixel> pixels(8 * 4);
+
+  EXPECT_THROW(ExternalPixelData<RGBAPixel>(geom::isize(8, 4), pixels.data(), 8 * sizeof(RGBAPixel), nullptr),
+               std::invalid_argument);
+  EXPECT_THROW(SoftwareSurface::adopt(PixelFormat::RGBA8, geom::isize(8, 4), pixels.data(),
+                                      8 * sizeof(RGBAPixel), PixelDeleter()),
+               std::invalid_argument);
+}
+
+/* EOF */
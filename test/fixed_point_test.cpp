@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include <surf/blend.hpp>
+#include <surf/convert.hpp>
+#include <surf/fixed_point.hpp>
+#include <surf/pixel.hpp>
+
+using namespace surf;
+
+namespace {
+
+// the division based formulas the fixed point versions replace
+namespace reference {
+
+RGB8Pixel blend(RGBA8Pixel src, RGB8Pixel dst)
+{
+  int const sa = src.a;
+  return {static_cast<uint8_t>((src.r * sa + dst.r * (255 - sa)) / 255),
+          static_cast<uint8_t>((src.g * sa + dst.g * (255 - sa)) / 255),
+          static_cast<uint8_t>((src.b * sa + dst.b * (255 - sa)) / 255)};
+}
+
+RGBA8Pixel blend(RGBA8Pixel src, RGBA8Pixel dst)
+{
+  int const sa = src.a;
+  int const da = dst.a;
+  uint8_t const out_a = static_cast<uint8_t>(sa + da * (255 - sa) / 255);
+  if (sa == 0) {
+    return dst;
+  }
+  auto const mix = [&](int s, int d) {
+    return static_cast<uint8_t>(std::min((s * sa * 255 / 255 + d * da * (255 - sa) / 255) / out_a, 255));
+  };
+  return {mix(src.r, dst.r), mix(src.g, dst.g), mix(src.b, dst.b), out_a};
+}
+
+RGBA8Pixel add(RGBA8Pixel src, RGBA8Pixel dst)
+{
+  if (src.a == 0) {
+    return dst;
+  }
+  auto const add = [&](int s, int d) { return static_cast<uint8_t>(std::min(d + s * src.a / 255, 255)); };
+  return {add(src.r, dst.r), add(src.g, dst.g), add(src.b, dst.b), dst.a};
+}
+
+RGBA8Pixel multiply(RGBA8Pixel src, RGBA8Pixel dst)
+{
+  if (src.a == 0) {
+    return dst;
+  }
+  // the source fades towards white with its alpha
+  int const a = src.a;
+  auto const mul = [a](int s, int d) { return static_cast<uint8_t>(d * (255 - a + s * a / 255) / 255); };
+  return {mul(src.r, dst.r), mul(src.g, dst.g), mul(src.b, dst.b), dst.a};
+}
+
+PRGBA8Pixel premultiply(RGBA8Pixel src)
+{
+  auto const mul = [&](uint32_t v) { return static_cast<uint8_t>((v * src.a + 127) / 255); };
+  return {mul(src.r), mul(src.g), mul(src.b), src.a};
+}
+
+RGBA8Pixel unpremultiply(PRGBA8Pixel src)
+{
+  if (src.a == 0) {
+    return {0, 0, 0, 0};
+  }
+  auto const div = [&](uint32_t v) { return static_cast<uint8_t>(std::min<uint32_t>((v * 255 + src.a / 2) / src.a, 255)); };
+  return {div(src.r), div(src.g), div(src.b), src.a};
+}
+
+PRGBA8Pixel over(PRGBA8Pixel src, PRGBA8Pixel dst)
+{
+  uint32_t const inv = 255 - src.a;
+  auto const over = [&](uint32_t s, uint32_t d) { return static_cast<uint8_t>(std::min<uint32_t>(s + (d * inv + 127) / 255, 255)); };
+  return {over(src.r, dst.r), over(src.g, dst.g), over(src.b, dst.b), over(src.a, dst.a)};
+}
+
+} // namespace reference
+
+// a spread of channel values, the loops below go over all alphas
+constexpr std::array<uint8_t, 12> values = {0, 1, 2, 3, 64, 127, 128, 129, 200, 253, 254, 255};
+
+} // namespace
+
+TEST(FixedPointTest, div)
+{
+  for (uint32_t x = 0; x < 65790; ++x) {
+    ASSERT_EQ(fixed::div255(x), x / 255) << x;
+  }
+
+  std::mt19937_64 rng(1);
+  std::uniform_int_distribution<uint64_t> dist(0, 4295032829);
+  for (int i = 0; i < 1000000; ++i) {
+    uint64_t const x = dist(rng);
+    ASSERT_EQ(fixed::div65535(x), x / 65535) << x;
+  }
+  for (uint64_t k = 0; k <= 65537; ++k) {
+    ASSERT_EQ(fixed::div65535(k * 65535), k);
+    ASSERT_EQ(fixed::div65535(k * 65535 + 65534), k);
+  }
+
+  for (uint32_t a = 1; a < 256; ++a) {
+    for (uint32_t x = 0; x < (1u << 17); ++x) {
+      ASSERT_EQ(fixed::div_u8(x, static_cast<uint8_t>(a)), x / a) << x << " / " << a;
+    }
+    ASSERT_EQ(fixed::div_u8((1u << 24) - 1, static_cast<uint8_t>(a)), ((1u << 24) - 1) / a);
+  }
+}
+
+TEST(FixedPointTest, saturate)
+{
+  EXPECT_EQ(fixed::add_sat(uint8_t{200}, uint8_t{55}), 255);
+  EXPECT_EQ(fixed::add_sat(uint8_t{200}, uint8_t{56}), 255);
+  EXPECT_EQ(fixed::add_sat(uint8_t{200}, 54u), 254);
+  EXPECT_EQ(fixed::add_sat(uint16_t{65000}, uint16_t{1000}), 65535);
+  EXPECT_EQ(fixed::add_sat(uint32_t{4294967295u}, uint32_t{1}), 4294967295u);
+  EXPECT_EQ(fixed::sub_sat(uint8_t{10}, uint8_t{11}), 0);
+  EXPECT_EQ(fixed::sub_sat(uint8_t{11}, uint8_t{10}), 1);
+}
+
+TEST(FixedPointTest, rescale)
+{
+  for (uint32_t v = 0; v < 256; ++v) {
+    ASSERT_EQ((convert_value<RGB8Pixel, RGB16Pixel>(static_cast<uint8_t>(v))), v * 65535 / 255);
+    ASSERT_EQ((convert_value<RGB8Pixel, RGB32Pixel>(static_cast<uint8_t>(v))), uint64_t{v} * 4294967295 / 255);
+  }
+
+  for (uint32_t v = 0; v < 65536; ++v) {
+    ASSERT_EQ((convert_value<RGB16Pixel, RGB8Pixel>(static_cast<uint16_t>(v))), v * 255 / 65535);
+    ASSERT_EQ((convert_value<RGB16Pixel, RGB32Pixel>(static_cast<uint16_t>(v))), uint64_t{v} * 4294967295 / 65535);
+  }
+
+  std::mt19937 rng(2);
+  for (int i = 0; i < 100000; ++i) {
+    uint32_t const v = rng();
+    ASSERT_EQ((convert_value<RGB32Pixel, RGB8Pixel>(v)), uint64_t{v} * 255 / 4294967295);
+    ASSERT_EQ((convert_value<RGB32Pixel, RGB16Pixel>(v)), uint64_t{v} * 65535 / 4294967295);
+  }
+  EXPECT_EQ((convert_value<RGB32Pixel, RGB8Pixel>(4294967295u)), 255);
+}
+
+TEST(FixedPointTest, premultiply)
+{
+  for (int a = 0; a < 256; ++a) {
+    for (int v = 0; v < 256; ++v) {
+      uint8_t const c = static_cast<uint8_t>(v);
+      uint8_t const alpha = static_cast<uint8_t>(a);
+      ASSERT_EQ(premultiply(RGBA8Pixel{c, c, c, alpha}), reference::premultiply(RGBA8Pixel{c, c, c, alpha}));
+      ASSERT_EQ(unpremultiply(PRGBA8Pixel{c, c, c, alpha}), reference::unpremultiply(PRGBA8Pixel{c, c, c, alpha}));
+    }
+  }
+}
+
+TEST(FixedPointTest, blend)
+{
+  for (int sa = 0; sa < 256; ++sa) {
+    for (int da = 0; da < 256; ++da) {
+      for (uint8_t s : values) {
+        for (uint8_t d : values) {
+          RGBA8Pixel const src{s, d, 255, static_cast<uint8_t>(sa)};
+          RGBA8Pixel const dst{d, s, 0, static_cast<uint8_t>(da)};
+          PRGBA8Pixel const psrc{std::min<uint8_t>(s, src.a), std::min<uint8_t>(d, src.a), 0, src.a};
+          PRGBA8Pixel const pdst{std::min<uint8_t>(d, dst.a), std::min<uint8_t>(s, dst.a), 0, dst.a};
+
+          ASSERT_EQ((pixel_blend<RGBA8Pixel, RGBA8Pixel>()(src, dst)), reference::blend(src, dst));
+          ASSERT_EQ((pixel_blend<RGBA8Pixel, RGB8Pixel>()(src, RGB8Pixel{d, s, 0})),
+                    reference::blend(src, RGB8Pixel{d, s, 0}));
+          ASSERT_EQ((pixel_add<RGBA8Pixel, RGBA8Pixel>()(src, dst)), reference::add(src, dst));
+          ASSERT_EQ((pixel_multiply<RGBA8Pixel, RGBA8Pixel>()(src, dst)), reference::multiply(src, dst));
+          ASSERT_EQ(detail::premultiplied_over(psrc, pdst), reference::over(psrc, pdst));
+        }
+      }
+    }
+  }
+}
+
+/* EOF */
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+
+#include <surf/convert.hpp>
+#include <surf/half.hpp>
+#include <surf/pixel.hpp>
+#include <surf/pixel_data.hpp>
+#include <surf/software_surface.hpp>
+
+using namespace surf;
+
+TEST(HalfTest, conversion)
+{
+  EXPECT_EQ(half(1.0f).bits(), 0x3c00);
+  EXPECT_EQ(half(-2.0f).bits(), 0xc000);
+  EXPECT_EQ(half(0.0f).bits(), 0x0000);
+  EXPECT_EQ(half(65504.0f).bits(), 0x7bff);
+  EXPECT_EQ(half(65520.0f).bits(), 0x7c00);
+  EXPECT_EQ(half(std::numeric_limits<float>::infinity()).bits(), 0x7c00);
+
+  // smallest subnormal
+  EXPECT_EQ(half(5.9604645e-8f).bits(), 0x0001);
+  EXPECT_EQ(static_cast<float>(half::from_bits(0x0001)), 5.9604645e-8f);
+
+  // ties round to even
+  EXPECT_EQ(half(1.0f + 1.0f / 2048.0f).bits(), 0x3c00);
+  EXPECT_EQ(half(1.0f + 3.0f / 2048.0f).bits(), 0x3c02);
+
+  for (uint32_t bits = 0; bits < 0x7c00; ++bits) {
+    half const h = half::from_bits(static_cast<uint16_t>(bits));
+    ASSERT_EQ(half(static_cast<float>(h)).bits(), bits);
+  }
+}
+
+TEST(HalfTest, convert)
+{
+  EXPECT_EQ(RGBA16fPixel::max(), 1.0f);
+  EXPECT_TRUE(RGBA16fPixel::is_floating_point());
+  EXPECT_EQ(sizeof(RGBA16fPixel), 8);
+
+  EXPECT_EQ((convert<RGBA32fPixel, RGBA16fPixel>(RGBA32fPixel{1.0f, 0.5f, 0.25f, 0.0f})),
+            (RGBA16fPixel{1.0f, 0.5f, 0.25f, 0.0f}));
+  EXPECT_EQ((convert<RGBA16fPixel, L8Pixel>(RGBA16fPixel{1.0f, 1.0f, 1.0f, 1.0f})), L8Pixel{255});
+  EXPECT_EQ((convert_value<RGBA16fPixel, RGBA16Pixel>(0.5f)), 32768);
+
+  // 8-bit values survive the trip through half
+  for (int v = 0; v < 256; ++v) {
+    RGBA8Pixel const pixel{static_cast<uint8_t>(v), static_cast<uint8_t>(255 - v), 0, 255};
+    EXPECT_EQ((convert<RGBA16fPixel, RGBA8Pixel>(convert<RGBA8Pixel, RGBA16fPixel>(pixel))), pixel);
+  }
+}
+
+TEST(HalfTest, software_surface)
+{
+  PixelData<RGBA8Pixel> const pixeldata(geom::isize(13, 7), RGBA8Pixel{10, 20, 30, 40});
+  SoftwareSurface const surface(pixeldata);
+
+  SoftwareSurface const half_surface = convert(surface, PixelFormat::RGBA16f);
+  EXPECT_EQ(half_surface.get_format(), PixelFormat::RGBA16f);
+  EXPECT_EQ(convert(half_surface, PixelFormat::RGBA8), surface);
+  EXPECT_EQ(pixelformat_from_string("la16f"), PixelFormat::LA16f);
+}
+
+/* EOF */
@@ -0,0 +1,530 @@
+#include <gtest/gtest.h>
+
+#include <string.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <surf/blit.hpp>
+#include <surf/convert.hpp>
+#include <surf/kernel_registry.hpp>
+#include <surf/pixel_data.hpp>
+#include <surf/software_surface.hpp>
+
+#include "test_util.hpp"
+
+using namespace surf;
+
+namespace {
+
+int g_calls = 0;
+
+void counting_kernel(void const* src, void* dst, size_t count)
+{
+  g_calls += 1;
+  KernelRegistry::instance().get_generic(PixelFormat::RGBA8, PixelFormat::RGB8, BlendFunc::BLEND)(src, dst, count);
+}
+
+/** Run the registered BLEND kernel over \a src and \a dst and
+    compare it against pixel_blend applied pixel by pixel */
+template<typename SrcPixel, typename DstPixel>
+void check_blend_kernel(std::vector<SrcPixel> const& src, std::vector<DstPixel> const& dst)
+{
+  std::vector<DstPixel> expected = dst;
+  for (size_t i = 0; i < src.size(); ++i) {
+    expected[i] = pixel_blend<SrcPixel, DstPixel>()(src[i], dst[i]);
+  }
+
+  std::vector<DstPixel> result = dst;
+  KernelRegistry::instance().get(PPixelFormat<SrcPixel>::format, PPixelFormat<DstPixel>::format, BlendFunc::BLEND)(
+    src.data(), result.data(), src.size());
+
+  for (size_t i = 0; i < src.size(); ++i) {
+    ASSERT_EQ(result[i], expected[i]) << to_string(PPixelFormat<SrcPixel>::format) << " -> "
+                                      << to_string(PPixelFormat<DstPixel>::format) << " at " << i;
+  }
+}
+
+/** Like check_blend_kernel() for float formats, allowing for the
+    rounding of a compiler that contracts the scalar code to FMA */
+template<typename SrcPixel, typename DstPixel>
+void check_float_kernel(BlendFunc op, std::vector<SrcPixel> const& src, std::vector<DstPixel> const& dst)
+{
+  std::vector<DstPixel> result = dst;
+  KernelRegistry::instance().get(PPixelFormat<SrcPixel>::format, PPixelFormat<DstPixel>::format, op)(
+    src.data(), result.data(), src.size());
+
+  float const eps = sizeof(DstPixel) == sizeof(RGBA32fPixel) ? 1e-6f : 1e-3f;
+  for (size_t i = 0; i < src.size(); ++i) {
+    DstPixel expected;
+    using srctype = SrcPixel;
+    using dsttype = DstPixel;
+    BLENDFUNC_TO_TYPE(op, blendfunc_t, expected = blendfunc_t()(src[i], dst[i]));
+
+    float const want[] = { red_f(expected), green_f(expected), blue_f(expected), alpha_f(expected) };
+    float const got[] = { red_f(result[i]), green_f(result[i]), blue_f(result[i]), alpha_f(result[i]) };
+    for (size_t c = 0; c < 4; ++c) {
+      ASSERT_NEAR(got[c], want[c], eps * std::max(1.0f, std::abs(want[c])))
+        << to_string(PPixelFormat<SrcPixel>::format) << " -> " << to_string(PPixelFormat<DstPixel>::format)
+        << " op " << static_cast<int>(op) << " at " << i << "." << c;
+    }
+  }
+}
+
+/** Pack a stream of channel values into pixels */
+template<typename Pixel, typename T>
+std::vector<Pixel> make_pixels(std::vector<T> const& channels)
+{
+  std::vector<Pixel> pixels(channels.size() * sizeof(T) / sizeof(Pixel));
+  memcpy(pixels.data(), channels.data(), pixels.size() * sizeof(Pixel));
+  return pixels;
+}
+
+/** Run the registered conversion kernel over \a src and compare each
+    pixel bit for bit with convert(), so NaN payloads and the sign of
+    zero count as well. Guard bytes catch writes past the end. */
+template<typename SrcPixel, typename DstPixel>
+void check_convert_kernel(std::vector<SrcPixel> const& src)
+{
+  PixelFormat const srcformat = PPixelFormat<SrcPixel>::format;
+  PixelFormat const dstformat = PPixelFormat<DstPixel>::format;
+
+  std::vector<uint8_t> result((src.size() + 2) * sizeof(DstPixel), 0xcd);
+  KernelRegistry::instance().get(srcformat, dstformat, BlendFunc::COPY)(src.data(), result.data(), src.size());
+
+  for (size_t i = 0; i < src.size(); ++i) {
+    DstPixel const expected = convert<SrcPixel, DstPixel>(src[i]);
+    ASSERT_EQ(memcmp(result.data() + i * sizeof(DstPixel), &expected, sizeof(DstPixel)), 0)
+      << to_string(srcformat) << " -> " << to_string(dstformat) << " at " << i << " of " << src.size();
+  }
+
+  for (size_t i = src.size() * sizeof(DstPixel); i < result.size(); ++i) {
+    ASSERT_EQ(result[i], 0xcd) << to_string(srcformat) << " -> " << to_string(dstformat) << " wrote past the end";
+  }
+}
+
+/** check_convert_kernel() on the first \a count pixels of \a bytes,
+    for counts around the SIMD block sizes */
+template<typename SrcPixel, typename DstPixel>
+void check_convert_counts(std::vector<uint8_t> const& bytes)
+{
+  std::vector<SrcPixel> const pixels = make_pixels<SrcPixel>(bytes);
+  for (size_t count : {size_t{0}, size_t{1}, size_t{7}, size_t{17}, size_t{18}, size_t{33}, size_t{1031}}) {
+    check_convert_kernel<SrcPixel, DstPixel>(std::vector<SrcPixel>(pixels.begin(), pixels.begin() + count));
+  }
+}
+
+/** Alpha for pixel \a i: runs of sixteen fully transparent, fully
+    opaque and mixed pixels */
+uint32_t run_alpha(size_t i, uint32_t mixed, uint32_t max)
+{
+  switch ((i / 16) % 3) {
+    case 0: return 0;
+    case 1: return max;
+    default: return mixed;
+  }
+}
+
+} // namespace
+
+TEST(KernelRegistryTest, lookup)
+{
+  KernelRegistry& registry = KernelRegistry::instance();
+
+  EXPECT_NE(registry.get(PixelFormat::RGBA8, PixelFormat::RGB8, BlendFunc::BLEND), nullptr);
+  EXPECT_NE(registry.get(PixelFormat::LA32f, PixelFormat::L16, BlendFunc::MULTIPLY), nullptr);
+  EXPECT_THROW(registry.get(PixelFormat::NONE, PixelFormat::RGB8, BlendFunc::COPY), std::invalid_argument);
+  EXPECT_THROW(registry.get(PixelFormat::RGB64f, PixelFormat::RGB8, BlendFunc::COPY), std::invalid_argument);
+
+  EXPECT_EQ(KernelRegistry::pixel_size(PixelFormat::RGB8), 3);
+  EXPECT_EQ(KernelRegistry::pixel_size(PixelFormat::LA32f), 8);
+  EXPECT_EQ(KernelRegistry::pixel_size(PixelFormat::NONE), 0);
+}
+
+TEST(KernelRegistryTest, override)
+{
+  KernelRegistry& registry = KernelRegistry::instance();
+
+  SoftwareSurface const src(make_test_pattern(geom::isize(31, 17)));
+  PixelData<RGBPixel> expected(geom::isize(40, 40), RGBPixel{128, 64, 255});
+  SoftwareSurface dst{PixelData<RGBPixel>(expected)};
+
+  blend(pixel_blend<RGBAPixel, RGBPixel>(), src.as_pixelview<RGBAPixel>(), expected, geom::ipoint(20, -3));
+
+  g_calls = 0;
+  registry.set(PixelFormat::RGBA8, PixelFormat::RGB8, BlendFunc::BLEND, &counting_kernel);
+  blend(BlendFunc::BLEND, src, dst, geom::ipoint(20, -3));
+  registry.reset(PixelFormat::RGBA8, PixelFormat::RGB8, BlendFunc::BLEND);
+  EXPECT_EQ(registry.get(PixelFormat::RGBA8, PixelFormat::RGB8, BlendFunc::BLEND),
+            registry.get_default(PixelFormat::RGBA8, PixelFormat::RGB8, BlendFunc::BLEND));
+
+  // one call per clipped row
+  EXPECT_EQ(g_calls, 14);
+  EXPECT_EQ(dst.as_pixelview<RGBPixel>(), expected);
+
+  blend(BlendFunc::BLEND, src, dst, geom::ipoint(0, 0));
+  EXPECT_EQ(g_calls, 14);
+}
+
+TEST(KernelRegistryTest, matches_templates)
+{
+  PixelData<RGBAPixel> const pattern = make_test_pattern(geom::isize(31, 17));
+  SoftwareSurface const src(pattern);
+
+  SoftwareSurface const converted = convert(src, PixelFormat::LA16);
+  EXPECT_EQ(converted.as_pixelview<LA16Pixel>(), pattern.convert_to<LA16Pixel>());
+
+  SoftwareSurface blitted = SoftwareSurface::create(PixelFormat::RGB32f, geom::isize(20, 20));
+  PixelData<RGB32fPixel> expected(geom::isize(20, 20));
+  blit(src, geom::irect(3, 2, 25, 15), blitted, geom::ipoint(-1, 9));
+  blit(pattern, geom::irect(3, 2, 25, 15), expected, geom::ipoint(-1, 9));
+  EXPECT_EQ(blitted.as_pixelview<RGB32fPixel>(), expected);
+
+  SoftwareSurface scaled = SoftwareSurface::create(PixelFormat::RGBA8, geom::isize(64, 64));
+  PixelData<RGBAPixel> expected_scaled(geom::isize(64, 64));
+  blend_scaled(BlendFunc::ADD, src, geom::irect(4, 3, 20, 14), scaled, geom::irect(-10, 5, 70, 50));
+  blend_scaled(pixel_add<RGBAPixel, RGBAPixel>(), pattern, geom::irect(4, 3, 20, 14),
+               expected_scaled, geom::irect(-10, 5, 70, 50));
+  EXPECT_EQ(scaled.as_pixelview<RGBAPixel>(), expected_scaled);
+}
+
+TEST(KernelRegistryTest, swizzle)
+{
+  KernelRegistry& registry = KernelRegistry::instance();
+
+  std::vector<uint8_t> src(4 * 37);
+  for (size_t i = 0; i < src.size(); ++i) {
+    src[i] = static_cast<uint8_t>(i * 7 + 3);
+  }
+
+  // odd counts exercise both the SIMD body and the scalar tail
+  PixelFormat const formats[] = { PixelFormat::RGBA8, PixelFormat::BGRA8, PixelFormat::ARGB8 };
+  for (PixelFormat srcformat : formats) {
+    for (PixelFormat dstformat : formats) {
+      std::vector<uint8_t> expected(src.size());
+      std::vector<uint8_t> result(src.size());
+      registry.get_generic(srcformat, dstformat, BlendFunc::COPY)(src.data(), expected.data(), 37);
+      registry.get(srcformat, dstformat, BlendFunc::COPY)(src.data(), result.data(), 37);
+      EXPECT_EQ(result, expected) << to_string(srcformat) << " -> " << to_string(dstformat);
+    }
+  }
+
+  for (size_t count : {size_t{0}, size_t{5}, size_t{6}, size_t{37}}) {
+    std::vector<uint8_t> bgr(3 * count);
+    registry.get(PixelFormat::RGB8, PixelFormat::BGR8, BlendFunc::COPY)(src.data(), bgr.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_EQ(bgr[3 * i + 0], src[3 * i + 2]);
+      EXPECT_EQ(bgr[3 * i + 1], src[3 * i + 1]);
+      EXPECT_EQ(bgr[3 * i + 2], src[3 * i + 0]);
+    }
+  }
+
+  std::vector<uint8_t> bytes(4 * 1031);
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    bytes[i] = static_cast<uint8_t>((i * 2654435761u) >> 13);
+  }
+
+  check_convert_counts<RGB8Pixel, BGRA8Pixel>(bytes);
+  check_convert_counts<RGB8Pixel, ARGB8Pixel>(bytes);
+  check_convert_counts<BGR8Pixel, RGBA8Pixel>(bytes);
+  check_convert_counts<BGR8Pixel, BGRA8Pixel>(bytes);
+  check_convert_counts<BGR8Pixel, ARGB8Pixel>(bytes);
+  check_convert_counts<RGBA8Pixel, BGR8Pixel>(bytes);
+  check_convert_counts<BGRA8Pixel, RGB8Pixel>(bytes);
+  check_convert_counts<BGRA8Pixel, BGR8Pixel>(bytes);
+  check_convert_counts<ARGB8Pixel, RGB8Pixel>(bytes);
+  check_convert_counts<ARGB8Pixel, BGR8Pixel>(bytes);
+  check_convert_counts<RGB565Pixel, RGBA8Pixel>(bytes);
+  check_convert_counts<RGBA8Pixel, RGB565Pixel>(bytes);
+
+  SoftwareSurface const rgba(make_test_pattern(geom::isize(31, 17)));
+  SoftwareSurface const bgra = convert(rgba, PixelFormat::BGRA8);
+  EXPECT_EQ(bgra.get_pixel(geom::ipoint(5, 6)), rgba.get_pixel(geom::ipoint(5, 6)));
+  EXPECT_EQ(convert(bgra, PixelFormat::RGBA8), rgba);
+}
+
+TEST(KernelRegistryTest, premultiply)
+{
+  KernelRegistry& registry = KernelRegistry::instance();
+
+  // every channel/alpha combination, plus a scalar tail
+  size_t const count = 256 * 256 + 3;
+  std::vector<RGBA8Pixel> straight(count);
+  std::vector<PRGBA8Pixel> premultiplied(count);
+  std::vector<PRGBA8Pixel> dst(count);
+  for (size_t i = 0; i < count; ++i) {
+    straight[i] = RGBA8Pixel{static_cast<uint8_t>(i), static_cast<uint8_t>(i * 3),
+                             static_cast<uint8_t>(i >> 9), static_cast<uint8_t>(i >> 8)};
+    premultiplied[i] = PRGBA8Pixel{straight[i].r, straight[i].g, straight[i].b, straight[i].a};
+    dst[i] = PRGBA8Pixel{static_cast<uint8_t>(i * 13), static_cast<uint8_t>(i * 13 + 71),
+                         static_cast<uint8_t>(i * 13 + 142), static_cast<uint8_t>(i * 13 + 213)};
+  }
+
+  std::vector<PRGBA8Pixel> premultiply_result(count);
+  registry.get(PixelFormat::RGBA8, PixelFormat::PRGBA8, BlendFunc::COPY)(
+    straight.data(), premultiply_result.data(), count);
+
+  std::vector<RGBA8Pixel> unpremultiply_result(count);
+  registry.get(PixelFormat::PRGBA8, PixelFormat::RGBA8, BlendFunc::COPY)(
+    premultiplied.data(), unpremultiply_result.data(), count);
+
+  std::vector<PRGBA8Pixel> over_result = dst;
+  registry.get(PixelFormat::PRGBA8, PixelFormat::PRGBA8, BlendFunc::BLEND)(
+    premultiplied.data(), over_result.data(), count);
+
+  for (size_t i = 0; i < count; ++i) {
+    ASSERT_EQ(premultiply_result[i], premultiply(straight[i])) << i;
+    ASSERT_EQ(unpremultiply_result[i], unpremultiply(premultiplied[i])) << i;
+    ASSERT_EQ(over_result[i], detail::premultiplied_over(premultiplied[i], dst[i])) << i;
+  }
+
+  SoftwareSurface const rgba(make_test_pattern(geom::isize(31, 17)));
+  SoftwareSurface const converted = convert(rgba, PixelFormat::PRGBA8);
+  EXPECT_EQ(converted.as_pixelview<PRGBA8Pixel>().get_pixel(geom::ipoint(5, 6)),
+            (convert<RGBAPixel, PRGBA8Pixel>(rgba.as_pixelview<RGBAPixel>().get_pixel(geom::ipoint(5, 6)))));
+}
+
+TEST(KernelRegistryTest, half)
+{
+  // every half, including NaNs, Inf and subnormals
+  std::vector<uint16_t> halfs;
+  for (uint32_t bits = 0; bits < 0x10000; ++bits) {
+    halfs.push_back(static_cast<uint16_t>(bits));
+  }
+
+  // the floats every half stands for, the ties halfway between
+  // neighbouring halfs and their float neighbours on both sides
+  std::vector<float> floats;
+  for (uint16_t bits = 0; bits < 0x7c00; ++bits) {
+    float const value = half::from_bits(bits);
+    float const tie = (value + static_cast<float>(half::from_bits(static_cast<uint16_t>(bits + 1)))) / 2.0f;
+    for (float f : { value, tie, std::nextafter(tie, 0.0f), std::nextafter(tie, 1e10f) }) {
+      floats.push_back(f);
+      floats.push_back(-f);
+    }
+  }
+  for (uint32_t bits : { 0x7f800000u, 0x7f800001u, 0x7fa00000u, 0x7fc00000u, 0x7fc01234u, 0x7fffffffu,
+                         0x00000001u, 0x007fffffu, 0x33000000u, 0x33000001u, 0x387fe000u, 0x387ff000u }) {
+    floats.push_back(std::bit_cast<float>(bits));
+    floats.push_back(std::bit_cast<float>(bits | 0x80000000u));
+  }
+  floats.push_back(65519.0f);
+  floats.push_back(65520.0f);
+  floats.push_back(1e10f);
+
+  std::vector<uint8_t> bytes;
+  for (uint32_t v = 0; v < 256; ++v) {
+    bytes.push_back(static_cast<uint8_t>(v));
+  }
+
+  // 3 * 4 channels leave a scalar tail for both channel counts, on top
+  // of the 8 channel SIMD body
+  auto const pad = []<typename T>(std::vector<T> values) {
+    while (values.size() % 24 != 12) {
+      values.push_back(values[values.size() % 7]);
+    }
+    return values;
+  };
+  halfs = pad(halfs);
+  floats = pad(floats);
+  bytes = pad(bytes);
+
+  check_convert_kernel<RGB32fPixel, RGB16fPixel>(make_pixels<RGB32fPixel>(floats));
+  check_convert_kernel<RGBA32fPixel, RGBA16fPixel>(make_pixels<RGBA32fPixel>(floats));
+  check_convert_kernel<RGB16fPixel, RGB32fPixel>(make_pixels<RGB16fPixel>(halfs));
+  check_convert_kernel<RGBA16fPixel, RGBA32fPixel>(make_pixels<RGBA16fPixel>(halfs));
+  check_convert_kernel<RGB8Pixel, RGB16fPixel>(make_pixels<RGB8Pixel>(bytes));
+  check_convert_kernel<RGBA8Pixel, RGBA16fPixel>(make_pixels<RGBA8Pixel>(bytes));
+  check_convert_kernel<RGB16fPixel, RGB8Pixel>(make_pixels<RGB16fPixel>(halfs));
+  check_convert_kernel<RGBA16fPixel, RGBA8Pixel>(make_pixels<RGBA16fPixel>(halfs));
+}
+
+TEST(KernelRegistryTest, convert)
+{
+  std::vector<uint8_t> bytes(16 * 1031);
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    bytes[i] = static_cast<uint8_t>((i * 2654435761u) >> 13);
+  }
+
+  check_convert_counts<RGB8Pixel, RGBA8Pixel>(bytes);
+  check_convert_counts<RGBA8Pixel, RGB8Pixel>(bytes);
+  check_convert_counts<RGB8Pixel, L8Pixel>(bytes);
+  check_convert_counts<RGBA8Pixel, L8Pixel>(bytes);
+  check_convert_counts<LA8Pixel, RGBA8Pixel>(bytes);
+  check_convert_counts<RGBA8Pixel, LA8Pixel>(bytes);
+  check_convert_counts<RGB8Pixel, RGB16Pixel>(bytes);
+  check_convert_counts<RGBA8Pixel, RGBA16Pixel>(bytes);
+  check_convert_counts<L8Pixel, L16Pixel>(bytes);
+  check_convert_counts<LA8Pixel, LA16Pixel>(bytes);
+  check_convert_counts<RGB8Pixel, RGB32fPixel>(bytes);
+  check_convert_counts<RGBA8Pixel, RGBA32fPixel>(bytes);
+  check_convert_counts<RGB16Pixel, RGB32fPixel>(bytes);
+  check_convert_counts<RGBA16Pixel, RGBA32fPixel>(bytes);
+  check_convert_counts<RGB16Pixel, RGB8Pixel>(bytes);
+  check_convert_counts<RGBA16Pixel, RGBA8Pixel>(bytes);
+  check_convert_counts<L16Pixel, L8Pixel>(bytes);
+  check_convert_counts<LA16Pixel, LA8Pixel>(bytes);
+
+  // clamping, NaN and the rounding ties on the way back from float
+  std::vector<float> floats;
+  for (uint32_t v = 0; v <= 1020; ++v) {
+    floats.push_back(static_cast<float>(v) / 1020.0f);
+    floats.push_back((static_cast<float>(v) + 0.5f) / 255.0f);
+  }
+  for (float v : { -0.0f, -1.0f, 1.0f, 1.5f, 1e10f, -1e10f, 0.5f / 65535.0f,
+                   std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+                   std::numeric_limits<float>::quiet_NaN(), -std::numeric_limits<float>::quiet_NaN() }) {
+    floats.push_back(v);
+  }
+  std::vector<uint8_t> float_bytes(floats.size() * sizeof(float));
+  memcpy(float_bytes.data(), floats.data(), float_bytes.size());
+  float_bytes.insert(float_bytes.end(), bytes.begin(), bytes.end());
+
+  check_convert_counts<RGB32fPixel, RGB8Pixel>(float_bytes);
+  check_convert_counts<RGBA32fPixel, RGBA8Pixel>(float_bytes);
+  check_convert_counts<RGB32fPixel, RGB16Pixel>(float_bytes);
+  check_convert_counts<RGBA32fPixel, RGBA16Pixel>(float_bytes);
+
+  PixelData<RGBAPixel> const pattern = make_test_pattern(geom::isize(31, 17));
+  PixelData<L8Pixel> expected(pattern.get_size());
+  for (int y = 0; y < pattern.get_height(); ++y) {
+    for (int x = 0; x < pattern.get_width(); ++x) {
+      expected.put_pixel({x, y}, convert<RGBAPixel, L8Pixel>(pattern.get_pixel({x, y})));
+    }
+  }
+  EXPECT_EQ(pattern.convert_to<L8Pixel>(), expected);
+
+  // convert_to() goes through the SIMD kernels, the results stay those of convert()
+  PixelData<RGBA32fPixel> const floats32 = pattern.convert_to<RGBA32fPixel>();
+  PixelData<RGBA8Pixel> roundtrip(pattern.get_size());
+  for (int y = 0; y < pattern.get_height(); ++y) {
+    for (int x = 0; x < pattern.get_width(); ++x) {
+      roundtrip.put_pixel({x, y}, convert<RGBA32fPixel, RGBA8Pixel>(floats32.get_pixel({x, y})));
+    }
+  }
+  EXPECT_EQ(floats32.convert_to<RGBA8Pixel>(), roundtrip);
+  EXPECT_EQ(roundtrip, pattern);
+}
+
+TEST(KernelRegistryTest, blend)
+{
+  auto const hash = [](size_t i) { return static_cast<uint32_t>((i * 2654435761u) >> 7); };
+
+  // every alpha pair, then runs the kernels skip or copy, plus a scalar tail
+  size_t const count8 = 2 * 256 * 256 + 5;
+  std::vector<RGBA8Pixel> src8(count8);
+  std::vector<RGBA8Pixel> dst8(count8);
+  std::vector<RGB8Pixel> rgb8(count8);
+  for (size_t i = 0; i < count8; ++i) {
+    uint32_t const h = hash(i);
+    bool const pairs = i < 256 * 256;
+    uint8_t const sa = static_cast<uint8_t>(pairs ? i : run_alpha(i, h >> 24, 255));
+    uint8_t const da = static_cast<uint8_t>(pairs ? i >> 8 : h >> 16);
+    src8[i] = RGBA8Pixel{static_cast<uint8_t>(h), static_cast<uint8_t>(h >> 8), static_cast<uint8_t>(i * 255 % 7 ? 255 : 0), sa};
+    dst8[i] = RGBA8Pixel{static_cast<uint8_t>(h >> 3), static_cast<uint8_t>(~h), static_cast<uint8_t>(h >> 13), da};
+    rgb8[i] = RGB8Pixel{dst8[i].r, dst8[i].g, dst8[i].b};
+  }
+  check_blend_kernel(src8, dst8);
+  check_blend_kernel(src8, rgb8);
+
+  uint16_t const edges[] = { 0, 1, 2, 255, 256, 32767, 32768, 65534, 65535 };
+  size_t const count16 = 81 * 256 + 3;
+  std::vector<RGBA16Pixel> src16(count16);
+  std::vector<RGBA16Pixel> dst16(count16);
+  std::vector<RGB16Pixel> rgb16(count16);
+  for (size_t i = 0; i < count16; ++i) {
+    uint32_t const h = hash(i);
+    bool const pairs = i < 81 * 128;
+    uint16_t const sa = static_cast<uint16_t>(pairs ? edges[i % 9] : run_alpha(i, h, 65535));
+    uint16_t const da = pairs ? edges[i / 9 % 9] : static_cast<uint16_t>(h >> 16);
+    src16[i] = RGBA16Pixel{static_cast<uint16_t>(h), edges[i % 7], static_cast<uint16_t>(h >> 5), sa};
+    dst16[i] = RGBA16Pixel{static_cast<uint16_t>(h >> 16), edges[i / 7 % 9], static_cast<uint16_t>(~h), da};
+    rgb16[i] = RGB16Pixel{dst16[i].r, dst16[i].g, dst16[i].b};
+  }
+  check_blend_kernel(src16, dst16);
+  check_blend_kernel(src16, rgb16);
+}
+
+TEST(KernelRegistryTest, blend_float)
+{
+  // HDR colors up to 4.0, alpha runs plus a scalar tail
+  size_t const count = 4099;
+  std::vector<RGBA32fPixel> src32(count);
+  std::vector<RGBA32fPixel> dst32(count);
+  std::vector<RGBA16fPixel> src16(count);
+  std::vector<RGBA16fPixel> dst16(count);
+  std::vector<RGB32fPixel> rgb32(count);
+  std::vector<L32fPixel> l32(count);
+  std::vector<LA32fPixel> la32(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto const value = [i](uint32_t salt) {
+      return static_cast<float>(((i + salt) * 2654435761u) >> 16 & 0xffff) / 16384.0f;
+    };
+    float const sa = static_cast<float>(run_alpha(i, static_cast<uint32_t>(value(1) * 16383.0f), 65535)) / 65535.0f;
+    src32[i] = RGBA32fPixel{value(2), value(3), value(4), sa};
+    dst32[i] = RGBA32fPixel{value(5), value(6), value(7), value(8) / 4.0f};
+    src16[i] = RGBA16fPixel{half(src32[i].r), half(src32[i].g), half(src32[i].b), half(src32[i].a)};
+    dst16[i] = RGBA16fPixel{half(dst32[i].r), half(dst32[i].g), half(dst32[i].b), half(dst32[i].a)};
+    rgb32[i] = RGB32fPixel{dst32[i].r, dst32[i].g, dst32[i].b};
+    l32[i] = L32fPixel{dst32[i].r};
+    la32[i] = LA32fPixel{dst32[i].g, dst32[i].a};
+  }
+
+  for (BlendFunc op : { BlendFunc::BLEND, BlendFunc::ADD, BlendFunc::MULTIPLY }) {
+    check_float_kernel(op, src32, dst32);
+    check_float_kernel(op, src32, dst16);
+    check_float_kernel(op, src16, dst32);
+    check_float_kernel(op, src16, dst16);
+    check_float_kernel(op, src32, rgb32);
+    check_float_kernel(op, src32, l32);
+    check_float_kernel(op, src32, la32);
+    check_float_kernel(op, src16, rgb32);
+    check_float_kernel(op, src16, l32);
+    check_float_kernel(op, src16, la32);
+  }
+}
+
+TEST(KernelRegistryTest, blend_modes)
+{
+  // alpha runs on both sides so every mode sees empty and full
+  // coverage, plus a scalar tail
+  size_t const count = 1029;
+  std::vector<RGBA32fPixel> src32(count);
+  std::vector<RGBA32fPixel> dst32(count);
+  std::vector<RGBA16fPixel> src16(count);
+  std::vector<RGBA16fPixel> dst16(count);
+  std::vector<RGBA8Pixel> src8(count);
+  std::vector<RGBA8Pixel> dst8(count);
+  std::vector<RGB8Pixel> rgb8(count);
+  std::vector<BGRA8Pixel> bgra8(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto const value = [i](uint32_t salt) {
+      return static_cast<uint8_t>(((i + salt) * 2654435761u) >> 16);
+    };
+    src8[i] = RGBA8Pixel{value(1), value(2), value(3), static_cast<uint8_t>(run_alpha(i, value(4), 255))};
+    dst8[i] = RGBA8Pixel{value(5), value(6), value(7), static_cast<uint8_t>(run_alpha(i / 3, value(8), 255))};
+    src32[i] = convert<RGBA8Pixel, RGBA32fPixel>(src8[i]);
+    dst32[i] = convert<RGBA8Pixel, RGBA32fPixel>(dst8[i]);
+    src16[i] = convert<RGBA8Pixel, RGBA16fPixel>(src8[i]);
+    dst16[i] = convert<RGBA8Pixel, RGBA16fPixel>(dst8[i]);
+    rgb8[i] = RGB8Pixel{dst8[i].r, dst8[i].g, dst8[i].b};
+    bgra8[i] = BGRA8Pixel{dst8[i].b, dst8[i].g, dst8[i].r, dst8[i].a};
+  }
+
+  for (size_t op = static_cast<size_t>(BlendFunc::SCREEN); op < BLEND_FUNC_COUNT; ++op) {
+    check_float_kernel(static_cast<BlendFunc>(op), src32, dst32);
+    check_float_kernel(static_cast<BlendFunc>(op), src16, dst16);
+    check_float_kernel(static_cast<BlendFunc>(op), src8, dst8);
+    check_float_kernel(static_cast<BlendFunc>(op), src8, dst32);
+
+    // pairs without a kernel of their own go through RGBA32f
+    check_float_kernel(static_cast<BlendFunc>(op), src8, rgb8);
+    check_float_kernel(static_cast<BlendFunc>(op), src8, bgra8);
+    check_float_kernel(static_cast<BlendFunc>(op), src16, rgb8);
+  }
+}
+
+/* EOF */
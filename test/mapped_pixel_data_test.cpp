@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+
+#include <surf/fill.hpp>
+#include <surf/mapped_pixel_data.hpp>
+#include <surf/palette.hpp>
+#include <surf/transform.hpp>
+
+using namespace surf;
+
+TEST(MappedPixelDataTest, memfd)
+{
+  MappedPixelData<RGBAPixel> pixeldata = MappedPixelData<RGBAPixel>::create_memfd(geom::isize(64, 32));
+  EXPECT_GE(pixeldata.get_fd(), 0);
+
+  fill_rect(pixeldata, geom::irect(0, 0, 64, 32), RGBAPixel{1, 2, 3, 4});
+
+  // a second mapping of the same fd sees the same pixels
+  MemoryMapping mapping = MemoryMapping::from_fd(dup(pixeldata.get_fd()));
+  MappedPixelData<RGBAPixel> const other(std::move(mapping), geom::isize(64, 32));
+  EXPECT_EQ(other.get_pixel(geom::ipoint(63, 31)), (RGBAPixel{1, 2, 3, 4}));
+}
+
+TEST(MappedPixelDataTest, file)
+{
+  std::filesystem::path const filename = std::filesystem::temp_directory_path() / "surf_mapped_pixel_data_test.raw";
+
+  {
+    MappedPixelData<RGBPixel> pixeldata = MappedPixelData<RGBPixel>::create(filename, geom::isize(16, 8));
+    pixeldata.put_pixel(geom::ipoint(3, 5), RGBPixel{10, 20, 30});
+    pixeldata.sync();
+  }
+
+  EXPECT_EQ(std::filesystem::file_size(filename), 16 * 8 * 3);
+
+  {
+    SoftwareSurface surface(MappedPixelData<RGBPixel>::open(filename, geom::isize(16, 8)));
+    EXPECT_EQ(surface.get_pixel(geom::ipoint(3, 5)), Color::from_rgb888(10, 20, 30));
+
+    fill(surface, palette::white);
+
+    // copies are deep, the mapped surface keeps writing to the file
+    SoftwareSurface copy = surface;
+    fill(surface, palette::black);
+    EXPECT_EQ(copy.get_pixel(geom::ipoint(0, 0)), palette::white);
+  }
+
+  {
+    SoftwareSurface const surface = create_mapped_surface(PixelFormat::RGB8, geom::isize(16, 8),
+                                                          MemoryMapping::open_file(filename, 0, 0, false));
+    EXPECT_EQ(surface.get_pixel(geom::ipoint(3, 5)), palette::black);
+    EXPECT_EQ(rotate90(surface).get_size(), geom::isize(8, 16));
+  }
+
+  {
+    // read-only mappings are copy-on-write, drawing doesn't reach the file
+    SoftwareSurface surface = create_mapped_surface(PixelFormat::RGB8, geom::isize(16, 8),
+                                                    MemoryMapping::open_file(filename, 0, 0, false));
+    fill(surface, palette::white);
+    surface.put_pixel(geom::ipoint(3, 5), palette::black);
+    EXPECT_EQ(surface.get_pixel(geom::ipoint(0, 0)), palette::white);
+
+    SoftwareSurface const reopened = create_mapped_surface(PixelFormat::RGB8, geom::isize(16, 8),
+                                                           MemoryMapping::open_file(filename, 0, 0, false));
+    EXPECT_EQ(reopened.get_pixel(geom::ipoint(0, 0)), palette::black);
+  }
+
+  // a pitch that isn't a whole number of pixels
+  EXPECT_THROW(create_mapped_surface(PixelFormat::RGB8, geom::isize(15, 8),
+                                     MemoryMapping::open_file(filename, 0, 0, false), 46),
+               std::invalid_argument);
+
+  std::filesystem::remove(filename);
+}
+
+TEST(MappedPixelDataTest, too_small)
+{
+  EXPECT_THROW(MappedPixelData<RGBAPixel>(MemoryMapping::create_memfd("surf", 100), geom::isize(64, 32)),
+               std::invalid_argument);
+}
+
+TEST(MappedPixelDataTest, short_file)
+{
+  std::filesystem::path const filename = std::filesystem::temp_directory_path() / "surf_mapped_pixel_data_test.short";
+  std::ofstream(filename, std::ios::binary) << "1234";
+
+  // mapping pages past the end of the file would raise SIGBUS on access
+  EXPECT_THROW(MappedPixelData<RGBA8Pixel>::open(filename, geom::isize(256, 256), 0, false), std::runtime_error);
+  EXPECT_THROW(MemoryMapping::open_file(filename, 2, 4, false), std::runtime_error);
+  EXPECT_THROW(MemoryMapping::open_file(filename, 8, 0, false), std::runtime_error);
+  EXPECT_EQ(MemoryMapping::open_file(filename, 0, 4, false).get_length(), 4);
+
+  std::filesystem::remove(filename);
+}
+
+TEST(MappedPixelDataTest, create_shm_failure)
+{
+  std::string const name = "/surf_mapped_pixel_data_test." + std::to_string(getpid());
+
+  // ftruncate() rejects the size, the shm object must not stay behind
+  EXPECT_THROW(MemoryMapping::create_shm(name, std::numeric_limits<size_t>::max()), std::runtime_error);
+  EXPECT_THROW(MemoryMapping::open_shm(name, false), std::runtime_error);
+
+  MemoryMapping::create_shm(name, 4096);
+  MemoryMapping::unlink_shm(name);
+}
+
+/* EOF */
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <surf/blend.hpp>
+#include <surf/out_of_core_pixel_data.hpp>
+#include <surf/pixel_data.hpp>
+#include <surf/transform.hpp>
+
+#include "test_util.hpp"
+
+using namespace surf;
+
+namespace {
+
+// room for two RGBA tiles, so almost every tile access goes to disk
+constexpr size_t TWO_TILES = 2 * 256 * 256 * sizeof(RGBAPixel);
+
+template<typename Pixel>
+PixelData<Pixel> to_pixeldata(OutOfCorePixelData<Pixel> const& src)
+{
+  PixelData<Pixel> dst(src.get_size());
+  blit(src, dst, geom::ipoint(0, 0));
+  return dst;
+}
+
+} // namespace
+
+TEST(OutOfCorePixelDataTest, roundtrip)
+{
+  PixelData<RGBAPixel> const pixeldata = make_test_pattern(geom::isize(700, 600));
+  OutOfCorePixelData<RGBAPixel> ooc(pixeldata.get_size(), TWO_TILES, RGBAPixel{9, 9, 9, 9});
+
+  EXPECT_EQ(ooc.get_pixel(geom::ipoint(699, 599)), (RGBAPixel{9, 9, 9, 9}));
+
+  blit(pixeldata, ooc, geom::ipoint(0, 0));
+  EXPECT_LE(ooc.get_stats().resident_bytes, TWO_TILES);
+  EXPECT_GT(ooc.get_stats().writebacks, 0);
+  EXPECT_EQ(to_pixeldata(ooc), pixeldata);
+}
+
+TEST(OutOfCorePixelDataTest, fill_rect)
+{
+  PixelData<RGBAPixel> pixeldata = make_test_pattern(geom::isize(700, 600));
+  OutOfCorePixelData<RGBAPixel> ooc(pixeldata.get_size(), TWO_TILES);
+  blit(pixeldata, ooc, geom::ipoint(0, 0));
+
+  fill_rect(pixeldata, geom::irect(100, 50, 650, 590), RGBAPixel{1, 2, 3, 4});
+  fill_rect(ooc, geom::irect(100, 50, 650, 590), RGBAPixel{1, 2, 3, 4});
+  EXPECT_EQ(to_pixeldata(ooc), pixeldata);
+}
+
+TEST(OutOfCorePixelDataTest, blend)
+{
+  PixelData<RGBAPixel> const src = make_test_pattern(geom::isize(300, 280));
+  PixelData<RGBAPixel> expected(geom::isize(700, 600), RGBAPixel{50, 60, 70, 255});
+  OutOfCorePixelData<RGBAPixel> ooc(expected.get_size(), TWO_TILES, RGBAPixel{50, 60, 70, 255});
+
+  blend(pixel_blend<RGBAPixel, RGBAPixel>(), src, expected, geom::ipoint(200, 230));
+  blend(pixel_blend<RGBAPixel, RGBAPixel>(), src, ooc, geom::ipoint(200, 230));
+  EXPECT_EQ(to_pixeldata(ooc), expected);
+
+  OutOfCorePixelData<RGBAPixel> other(geom::isize(300, 280), TWO_TILES);
+  blit(src, other, geom::ipoint(0, 0));
+  blend(pixel_blend<RGBAPixel, RGBAPixel>(), other, ooc, geom::ipoint(-20, 400));
+  blend(pixel_blend<RGBAPixel, RGBAPixel>(), src, expected, geom::ipoint(-20, 400));
+  EXPECT_EQ(to_pixeldata(ooc), expected);
+}
+
+TEST(OutOfCorePixelDataTest, crop)
+{
+  PixelData<RGBAPixel> const pixeldata = make_test_pattern(geom::isize(700, 600));
+  OutOfCorePixelData<RGBAPixel> ooc(pixeldata.get_size(), TWO_TILES);
+  blit(pixeldata, ooc, geom::ipoint(0, 0));
+
+  OutOfCorePixelData<RGBAPixel> const cropped = crop(ooc, geom::irect(130, 270, 690, 1000));
+  EXPECT_EQ(cropped.get_size(), geom::isize(560, 330));
+  EXPECT_EQ(to_pixeldata(cropped), crop(pixeldata, geom::irect(130, 270, 690, 600)));
+}
+
+TEST(OutOfCorePixelDataTest, rows)
+{
+  OutOfCorePixelData<RGBAPixel> ooc(geom::isize(700, 600), TWO_TILES);
+
+  std::vector<RGBAPixel> row(700, RGBAPixel{5, 6, 7, 8});
+  row[699] = RGBAPixel{1, 1, 1, 1};
+  ooc.write_row(300, row.data());
+
+  std::vector<RGBAPixel> out(700);
+  ooc.read_row(300, out.data());
+  EXPECT_EQ(out, row);
+  EXPECT_EQ(ooc.get_pixel(geom::ipoint(699, 300)), (RGBAPixel{1, 1, 1, 1}));
+  EXPECT_EQ(ooc.get_pixel(geom::ipoint(699, 301)), (RGBAPixel{0, 0, 0, 0}));
+}
+
+/* EOF */
@@ -6,6 +6,7 @@
 #include <surf/blend.hpp>
 #include <surf/blit.hpp>
 #include <surf/color.hpp>
+#include <surf/fill.hpp>
 #include <surf/pixel_data.hpp>
 #include <surf/sdl.hpp>
 #include <surf/transform.hpp>
@@ -46,6 +47,20 @@ TEST(PixelDataTest, creation)
   EXPECT_EQ(pixeldata.get_size(), geom::isize(64, 32));
 }
 
+TEST(PixelDataTest, creation__vector)
+{
+  std::vector<RGBPixel> pixels(6 * 4, RGBPixel{1, 2, 3});
+  pixels[6 + 5] = RGBPixel{4, 5, 6};
+
+  PixelData<RGBPixel> const copied(geom::isize(6, 4), pixels);
+  EXPECT_EQ(pixels.size(), 6u * 4u);
+  EXPECT_EQ(copied.get_pixel(geom::ipoint(5, 1)), (RGBPixel{4, 5, 6}));
+
+  PixelData<RGBPixel> const moved(geom::isize(6, 4), std::move(pixels));
+  EXPECT_TRUE(pixels.empty()); // NOLINT(bugprone-use-after-move)
+  EXPECT_EQ(moved, copied);
+}
+
 TEST(PixelDataTest, equality)
 {
   PixelData<RGBPixel> const black(geom::isize(64, 32), RGBPixel{0, 0, 0});
@@ -160,6 +175,76 @@ TEST(PixelDataTest, empty)
   EXPECT_TRUE(pixeldata.empty());
 }
 
+TEST(PixelDataTest, aligned_rows)
+{
+  PixelData<RGBPixel> const rgb(geom::isize(13, 7));
+  EXPECT_EQ(rgb.get_row_length(), 64);
+  for (int y = 0; y < rgb.get_height(); ++y) {
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(rgb.get_row(y)) % PIXEL_ALIGNMENT, 0);
+  }
+
+  PixelData<RGBA32fPixel> const rgba32f(geom::isize(13, 7));
+  EXPECT_EQ(rgba32f.get_row_length(), 16);
+  for (int y = 0; y < rgba32f.get_height(); ++y) {
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(rgba32f.get_row(y)) % PIXEL_ALIGNMENT, 0);
+  }
+
+  PixelData<RGBPixel> const packed(geom::isize(13, 7), RGBPixel{}, 1);
+  EXPECT_EQ(packed.get_row_length(), 13);
+}
+
+TEST(PixelDataTest, copy_from_view)
+{
+  PixelData<RGBPixel> pixeldata(geom::isize(100, 10), RGBPixel{1, 2, 3});
+  PixelView<RGBPixel> const view = pixeldata.get_view(geom::irect(10, 2, 20, 8));
+  PixelData<RGBPixel> const copy(view);
+
+  EXPECT_EQ(copy.get_size(), geom::isize(10, 6));
+  EXPECT_EQ(copy.get_row_length(), 64);
+  EXPECT_EQ(copy, PixelData<RGBPixel>(geom::isize(10, 6), RGBPixel{1, 2, 3}));
+}
+
+TEST(PixelDataTest, rotate__non_square)
+{
+  PixelData<RGBPixel> pixeldata(geom::isize(3, 2), RGBPixel{0, 0, 0});
+  pixeldata.put_pixel(geom::ipoint(0, 0), RGBPixel{1, 1, 1});
+
+  PixelData<RGBPixel> const rot90 = rotate90(pixeldata);
+  EXPECT_EQ(rot90.get_size(), geom::isize(2, 3));
+  EXPECT_EQ(rot90.get_pixel(geom::ipoint(1, 0)), (RGBPixel{1, 1, 1}));
+
+  PixelData<RGBPixel> const rot270 = rotate270(pixeldata);
+  EXPECT_EQ(rot270.get_size(), geom::isize(2, 3));
+  EXPECT_EQ(rot270.get_pixel(geom::ipoint(0, 2)), (RGBPixel{1, 1, 1}));
+
+  EXPECT_EQ(rotate90(rot270), pixeldata);
+}
+
+TEST(PixelDataTest, hugepage)
+{
+  size_t const threshold = get_hugepage_threshold();
+  set_hugepage_threshold(1024);
+  PixelData<RGBAPixel> const pixeldata(geom::isize(256, 256), RGBAPixel{1, 2, 3, 4});
+  set_hugepage_threshold(threshold);
+
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(pixeldata.get_data()) % PIXEL_ALIGNMENT, 0);
+  EXPECT_EQ(pixeldata.get_pixel(geom::ipoint(255, 255)), (RGBAPixel{1, 2, 3, 4}));
+}
+
+TEST(PixelDataTest, no_init)
+{
+  PixelData<RGBPixel> pixeldata(geom::isize(37, 5), no_init);
+  EXPECT_EQ(pixeldata.get_size(), geom::isize(37, 5));
+  EXPECT_EQ(pixeldata.get_row_length(), aligned_row_length<RGBPixel>(37));
+
+  fill(pixeldata, RGBPixel{1, 2, 3});
+  EXPECT_EQ(pixeldata, PixelData<RGBPixel>(geom::isize(37, 5), RGBPixel{1, 2, 3}));
+
+  // copies from a view skip the zero fill, but still copy every pixel
+  PixelData<RGBPixel> const copy(static_cast<PixelView<RGBPixel> const&>(pixeldata));
+  EXPECT_EQ(copy, pixeldata);
+}
+
 TEST(PixelDataTest, create_view__const)
 {
   PixelData<RGBPixel> const pixeldata(geom::isize(64, 32));
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <surf/convert.hpp>
 #include <surf/pixel.hpp>
 
 TEST(PixelTest, validate_sizeof)
@@ -66,4 +67,35 @@ TEST(PixelTest, f2value)
   EXPECT_EQ(surf::f2value<surf::RGB64fPixel>(0.0f), 0.0);
 }
 
+TEST(PixelTest, swizzled)
+{
+  EXPECT_EQ(3, sizeof(surf::BGR8Pixel));
+  EXPECT_EQ(4, sizeof(surf::BGRA8Pixel));
+  EXPECT_EQ(4, sizeof(surf::ARGB8Pixel));
+  EXPECT_EQ(2, sizeof(surf::RGB565Pixel));
+
+  surf::BGRA8Pixel const bgra = surf::make_pixel<surf::BGRA8Pixel>(1, 2, 3, 4);
+  EXPECT_EQ(bgra, (surf::BGRA8Pixel{3, 2, 1, 4}));
+  EXPECT_EQ(surf::red(bgra), 1);
+
+  surf::RGBA8Pixel const rgba{10, 20, 30, 40};
+  EXPECT_EQ((surf::convert<surf::RGBA8Pixel, surf::ARGB8Pixel>(rgba)), (surf::ARGB8Pixel{40, 10, 20, 30}));
+  EXPECT_EQ((surf::convert<surf::ARGB8Pixel, surf::BGR8Pixel>(surf::ARGB8Pixel{40, 10, 20, 30})), (surf::BGR8Pixel{30, 20, 10}));
+}
+
+TEST(PixelTest, rgb565)
+{
+  surf::RGB565Pixel const pixel = surf::make_pixel<surf::RGB565Pixel>(255, 0, 255);
+  EXPECT_EQ(pixel.value, 0xf81f);
+  EXPECT_EQ(surf::red(pixel), 255);
+  EXPECT_EQ(surf::green(pixel), 0);
+  EXPECT_EQ(surf::blue(pixel), 255);
+
+  // 5 and 6 bit values survive the roundtrip through 8 bits
+  for (uint16_t v = 0; v < 0xffff; v += 97) {
+    surf::RGB565Pixel const p{v};
+    EXPECT_EQ((surf::convert<surf::RGB8Pixel, surf::RGB565Pixel>(surf::convert<surf::RGB565Pixel, surf::RGB8Pixel>(p))), p);
+  }
+}
+
 /* EOF */
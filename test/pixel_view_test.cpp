@@ -1,4 +1,5 @@
 #include <iostream>
+#include <vector>
 #include <gtest/gtest.h>
 
 #include <geom/rect.hpp>
@@ -13,9 +14,38 @@
 #include <surf/io.hpp>
 
 #include "plugins/png.hpp"
+#include "test_util.hpp"
 
 using namespace surf;
 
+namespace {
+
+/** The row span path has to give the same Colors as convert() */
+template<typename Pixel>
+void check_row_colors()
+{
+  PixelData<Pixel> const original = make_test_pattern(geom::isize(37, 5)).convert_to<Pixel>();
+  PixelData<Pixel> pixeldata = original;
+
+  std::vector<Color> colors(30);
+  pixeldata.read_row_colors(2, 5, 30, colors.data());
+  for (int i = 0; i < 30; ++i) {
+    EXPECT_EQ(colors[i], (convert<Pixel, Color>(pixeldata.get_pixel(geom::ipoint(5 + i, 2)))));
+  }
+
+  for (size_t i = 0; i < colors.size(); ++i) {
+    colors[i] = Color(colors[i].r * 0.7f, colors[i].g * 1.3f, colors[i].b - 0.1f, colors[i].a * 0.5f);
+  }
+  pixeldata.write_row_colors(3, 5, 30, colors.data());
+  for (int i = 0; i < 30; ++i) {
+    EXPECT_EQ(pixeldata.get_pixel(geom::ipoint(5 + i, 3)), (convert<Color, Pixel>(colors[static_cast<size_t>(i)])));
+  }
+  EXPECT_EQ(pixeldata.get_pixel(geom::ipoint(4, 3)), original.get_pixel(geom::ipoint(4, 3)));
+  EXPECT_EQ(pixeldata.get_pixel(geom::ipoint(35, 3)), original.get_pixel(geom::ipoint(35, 3)));
+}
+
+} // namespace
+
 TEST(PixelViewTest, get_view)
 {
   PixelData<RGBPixel> const black(geom::isize(16, 8), RGBPixel{0, 0, 0});
@@ -30,4 +60,23 @@ TEST(PixelViewTest, get_view)
   EXPECT_EQ(pixeldata, expected);
 }
 
+TEST(PixelViewTest, large_pitch)
+{
+  // only the address computations are tested, nothing is dereferenced
+  PixelView<RGBA32fPixel> const view(geom::isize(200'000'000, 16),
+                                     static_cast<RGBA32fPixel const*>(nullptr), 200'000'000);
+
+  EXPECT_EQ(view.get_row_length(), 200'000'000);
+  EXPECT_EQ(view.get_pitch(), 3'200'000'000LL);
+}
+
+TEST(PixelViewTest, row_colors)
+{
+  check_row_colors<RGB8Pixel>();
+  check_row_colors<RGBA8Pixel>();
+  check_row_colors<RGBA16Pixel>();
+  check_row_colors<RGBA32fPixel>();
+  check_row_colors<LA16Pixel>();
+}
+
 /* EOF */
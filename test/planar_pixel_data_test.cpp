@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include <surf/channel.hpp>
+#include <surf/filter.hpp>
+#include <surf/pixel_data.hpp>
+#include <surf/planar_pixel_data.hpp>
+
+#include "test_util.hpp"
+
+using namespace surf;
+
+TEST(PlanarPixelDataTest, roundtrip)
+{
+  PixelData<RGBAPixel> const pixeldata = make_test_pattern(geom::isize(37, 21));
+  PlanarPixelData<RGBAPixel> const planar(pixeldata);
+
+  EXPECT_EQ(planar.get_format(), PixelFormat::RGBA8);
+  EXPECT_EQ(planar.get_plane_format(), PixelFormat::L8);
+  EXPECT_EQ(planar.get_pixel(geom::ipoint(36, 20)), pixeldata.get_pixel(geom::ipoint(36, 20)));
+  EXPECT_EQ(planar.get_plane(3).get_pixel(geom::ipoint(5, 3)).l, pixeldata.get_pixel(geom::ipoint(5, 3)).a);
+  EXPECT_EQ(planar.to_pixeldata(), pixeldata);
+}
+
+TEST(PlanarPixelDataTest, row_colors)
+{
+  PixelData<RGBAPixel> pixeldata = make_test_pattern(geom::isize(37, 21));
+  PlanarPixelData<RGBAPixel> planar(pixeldata);
+
+  std::vector<Color> expected(20);
+  std::vector<Color> colors(20);
+  pixeldata.read_row_colors(7, 11, 20, expected.data());
+  planar.read_row_colors(7, 11, 20, colors.data());
+  EXPECT_EQ(colors, expected);
+
+  std::reverse(colors.begin(), colors.end());
+  pixeldata.write_row_colors(3, 5, 20, colors.data());
+  planar.write_row_colors(3, 5, 20, colors.data());
+  EXPECT_EQ(planar.to_pixeldata(), pixeldata);
+}
+
+TEST(PlanarPixelDataTest, split_join)
+{
+  PixelData<RGBAPixel> const pixeldata = make_test_pattern(geom::isize(37, 21));
+  PlanarPixelData<RGBAPixel> planar(pixeldata);
+
+  std::vector<PixelView<L8Pixel>> planes = split_channel(planar);
+  ASSERT_EQ(planes.size(), 4);
+
+  // views share memory with the planes
+  planes[0].put_pixel(geom::ipoint(1, 1), L8Pixel{99});
+  EXPECT_EQ(planar.get_pixel(geom::ipoint(1, 1)).r, 99);
+
+  EXPECT_EQ(join_channel_planar(planes[0], planes[1], planes[2], planes[3]), planar);
+
+  // matches the interleaved split_channel()
+  std::vector<PixelData<L8Pixel>> const copies = split_channel(pixeldata);
+  ASSERT_EQ(copies.size(), 4);
+  EXPECT_EQ(copies[3], PixelData<L8Pixel>(planes[3]));
+}
+
+TEST(PlanarPixelDataTest, point_filters)
+{
+  PixelData<RGBAPixel> pixeldata = make_test_pattern(geom::isize(37, 21));
+  PlanarPixelData<RGBAPixel> planar(pixeldata);
+
+  apply_add(pixeldata, 0.25f);
+  apply_add(planar, 0.25f);
+  EXPECT_EQ(planar.to_pixeldata(), pixeldata);
+
+  apply_contrast(pixeldata, 0.5f);
+  apply_contrast(planar, 0.5f);
+  EXPECT_EQ(planar.to_pixeldata(), pixeldata);
+
+  apply_multiply(pixeldata, 0.75f);
+  apply_multiply(planar, 0.75f);
+  EXPECT_EQ(planar.to_pixeldata(), pixeldata);
+
+  PixelData<RGBPixel> rgb = make_test_pattern(geom::isize(37, 21)).convert_to<RGBPixel>();
+  PlanarPixelData<RGBPixel> planar_rgb(rgb);
+  apply_threshold(rgb, Color(0.5f, 0.25f, 0.75f));
+  apply_threshold(planar_rgb, Color(0.5f, 0.25f, 0.75f));
+  EXPECT_EQ(planar_rgb.to_pixeldata(), rgb);
+
+  apply_invert(planar_rgb);
+  EXPECT_EQ(planar_rgb.get_pixel(geom::ipoint(0, 0)), (RGBPixel{255, 255, 255}));
+
+  // the alpha plane turns opaque like the interleaved alpha
+  apply_threshold(pixeldata, Color(0.5f, 0.25f, 0.75f));
+  apply_threshold(planar, Color(0.5f, 0.25f, 0.75f));
+  EXPECT_EQ(planar.to_pixeldata(), pixeldata);
+}
+
+/* EOF */
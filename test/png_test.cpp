@@ -32,6 +32,13 @@ TEST(PNGTest, load_from_file)
   png::load_from_file("test/data/rgba.png");
 }
 
+TEST(PNGTest, load_from_file__shareable)
+{
+  SoftwareSurface const surface = png::load_from_file("test/data/rgb.png");
+  SoftwareSurface const copy = surface;
+  EXPECT_TRUE(surface.is_shared());
+}
+
 TEST(PNGTest, load_from_mem)
 {
 }
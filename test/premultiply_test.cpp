@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <surf/blend.hpp>
+#include <surf/convert.hpp>
+#include <surf/pixel.hpp>
+#include <surf/pixel_data.hpp>
+#include <surf/software_surface.hpp>
+#include <surf/transform.hpp>
+
+using namespace surf;
+
+TEST(PremultiplyTest, convert)
+{
+  EXPECT_EQ((convert<RGBA8Pixel, PRGBA8Pixel>(RGBA8Pixel{200, 100, 50, 128})), (PRGBA8Pixel{100, 50, 25, 128}));
+  EXPECT_EQ((convert<PRGBA8Pixel, RGBA8Pixel>(PRGBA8Pixel{100, 50, 25, 128})), (RGBA8Pixel{199, 100, 50, 128}));
+  EXPECT_EQ((convert<PRGBA8Pixel, RGB8Pixel>(PRGBA8Pixel{100, 50, 25, 128})), (RGB8Pixel{199, 100, 50}));
+  EXPECT_EQ((convert<PRGBA8Pixel, RGBA8Pixel>(PRGBA8Pixel{10, 20, 30, 0})), (RGBA8Pixel{0, 0, 0, 0}));
+
+  // opaque pixels pass through unchanged
+  for (int v = 0; v < 256; ++v) {
+    uint8_t const c = static_cast<uint8_t>(v);
+    EXPECT_EQ((convert<RGBA8Pixel, PRGBA8Pixel>(RGBA8Pixel{c, c, c, 255})), (PRGBA8Pixel{c, c, c, 255}));
+    EXPECT_EQ((convert<PRGBA8Pixel, RGBA8Pixel>(PRGBA8Pixel{c, c, c, 255})), (RGBA8Pixel{c, c, c, 255}));
+  }
+
+  EXPECT_EQ((convert<RGBA16Pixel, PRGBA16Pixel>(RGBA16Pixel{65535, 32768, 0, 32768})),
+            (PRGBA16Pixel{32768, 16384, 0, 32768}));
+  EXPECT_EQ((convert<Color, PRGBA32fPixel>(Color(1.0f, 0.5f, 0.25f, 0.5f))),
+            (PRGBA32fPixel{0.5f, 0.25f, 0.125f, 0.5f}));
+  EXPECT_EQ((convert<PRGBA8Pixel, PRGBA16Pixel>(PRGBA8Pixel{100, 50, 25, 128})),
+            (PRGBA16Pixel{25700, 12850, 6425, 32896}));
+}
+
+TEST(PremultiplyTest, blend)
+{
+  // same result as blending with straight alpha
+  EXPECT_EQ((pixel_blend<RGBA8Pixel, RGB8Pixel>()(RGBA8Pixel{255, 0, 0, 128}, RGB8Pixel{0, 0, 255})),
+            (RGB8Pixel{128, 0, 127}));
+  EXPECT_EQ((pixel_blend<PRGBA8Pixel, RGB8Pixel>()(PRGBA8Pixel{128, 0, 0, 128}, RGB8Pixel{0, 0, 255})),
+            (RGB8Pixel{128, 0, 127}));
+
+  EXPECT_EQ((pixel_blend<PRGBA8Pixel, PRGBA8Pixel>()(PRGBA8Pixel{0, 64, 0, 64}, PRGBA8Pixel{100, 0, 0, 200})),
+            (PRGBA8Pixel{75, 64, 0, 214}));
+  EXPECT_EQ((pixel_blend<RGBA8Pixel, PRGBA8Pixel>()(RGBA8Pixel{0, 255, 0, 64}, PRGBA8Pixel{100, 0, 0, 200})),
+            (PRGBA8Pixel{75, 64, 0, 214}));
+  EXPECT_EQ((pixel_blend<PRGBA32fPixel, PRGBA32fPixel>()(PRGBA32fPixel{0.25f, 0.0f, 0.0f, 0.5f},
+                                                         PRGBA32fPixel{0.0f, 0.5f, 0.0f, 0.5f})),
+            (PRGBA32fPixel{0.25f, 0.25f, 0.0f, 0.75f}));
+
+  // fully transparent and fully opaque sources
+  EXPECT_EQ((pixel_blend<PRGBA8Pixel, PRGBA8Pixel>()(PRGBA8Pixel{0, 0, 0, 0}, PRGBA8Pixel{1, 2, 3, 4})),
+            (PRGBA8Pixel{1, 2, 3, 4}));
+  EXPECT_EQ((pixel_blend<PRGBA8Pixel, PRGBA8Pixel>()(PRGBA8Pixel{5, 6, 7, 255}, PRGBA8Pixel{1, 2, 3, 4})),
+            (PRGBA8Pixel{5, 6, 7, 255}));
+
+  EXPECT_EQ((pixel_add<PRGBA8Pixel, RGB8Pixel>()(PRGBA8Pixel{64, 0, 0, 128}, RGB8Pixel{10, 10, 10})),
+            (pixel_add<RGBA8Pixel, RGB8Pixel>()(RGBA8Pixel{128, 0, 0, 128}, RGB8Pixel{10, 10, 10})));
+}
+
+TEST(PremultiplyTest, halve_scale)
+{
+  // the transparent pixels don't bleed their color into the result
+  PixelData<PRGBA8Pixel> pixeldata(geom::isize(2, 2), PRGBA8Pixel{0, 0, 0, 0});
+  pixeldata.put_pixel(geom::ipoint(0, 0), PRGBA8Pixel{255, 0, 0, 255});
+
+  PixelData<PRGBA8Pixel> const halved = halve(pixeldata);
+  EXPECT_EQ(halved.get_pixel(geom::ipoint(0, 0)), (PRGBA8Pixel{63, 0, 0, 63}));
+  EXPECT_EQ((convert<PRGBA8Pixel, RGBA8Pixel>(halved.get_pixel(geom::ipoint(0, 0)))), (RGBA8Pixel{255, 0, 0, 63}));
+
+  SoftwareSurface const surface(pixeldata);
+  SoftwareSurface const scaled = scale(surface, geom::isize(4, 4));
+  EXPECT_EQ(scaled.get_format(), PixelFormat::PRGBA8);
+  EXPECT_EQ(scaled.as_pixelview<PRGBA8Pixel>().get_pixel(geom::ipoint(1, 1)), (PRGBA8Pixel{255, 0, 0, 255}));
+  EXPECT_EQ(scaled.as_pixelview<PRGBA8Pixel>().get_pixel(geom::ipoint(2, 1)), (PRGBA8Pixel{0, 0, 0, 0}));
+  EXPECT_EQ(halve(halve(scaled)).get_pixel(geom::ipoint(0, 0)), (Color(1.0f, 0.0f, 0.0f, 63.0f / 255.0f)));
+}
+
+/* EOF */
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include <surf/pixel_data.hpp>
+#include <surf/plugins/jpeg.hpp>
+#include <surf/row_converter.hpp>
+#include <surf/software_surface.hpp>
+
+#include "test_util.hpp"
+
+using namespace surf;
+
+namespace {
+
+SoftwareSurface make_test_surface(geom::isize const& size)
+{
+  return SoftwareSurface(make_test_pattern(size));
+}
+
+} // namespace
+
+TEST(RowConverterTest, convert_into)
+{
+  SoftwareSurface const src = make_test_surface(geom::isize(37, 21));
+
+  SoftwareSurface dst = SoftwareSurface::create(PixelFormat::RGB16, src.get_size());
+  convert_into(src, dst);
+  EXPECT_EQ(dst, convert(src, PixelFormat::RGB16));
+
+  PixelData<L8Pixel> view(src.get_size());
+  convert_into(src, view);
+  EXPECT_EQ(view, src.as_pixelview<RGBA8Pixel>().convert_to<L8Pixel>());
+
+  SoftwareSurface wrong_size = SoftwareSurface::create(PixelFormat::RGB16, geom::isize(36, 21));
+  EXPECT_THROW(convert_into(src, wrong_size), std::invalid_argument);
+}
+
+TEST(RowConverterTest, convert_rows)
+{
+  SoftwareSurface const src = make_test_surface(geom::isize(37, 21));
+  SoftwareSurface const expected = convert(src, PixelFormat::RGB8);
+
+  RowConverter const converter(PixelFormat::RGBA8, PixelFormat::RGB8);
+  EXPECT_EQ(converter.get_src_format(), PixelFormat::RGBA8);
+  EXPECT_EQ(converter.get_dst_format(), PixelFormat::RGB8);
+
+  PixelData<RGB8Pixel> strip(geom::isize(37, 4));
+  for (int y = 0; y + strip.get_height() <= src.get_height(); y += strip.get_height()) {
+    converter.convert_rows(src, y, strip);
+    for (int i = 0; i < strip.get_height(); ++i) {
+      EXPECT_EQ(strip.get_pixel(geom::ipoint(36, i)),
+                expected.as_pixelview<RGB8Pixel>().get_pixel(geom::ipoint(36, y + i)));
+    }
+  }
+
+  EXPECT_THROW(converter.convert_rows(src, 18, strip), std::invalid_argument);
+  EXPECT_THROW(converter.convert_rows(expected, 0, strip), std::invalid_argument);
+}
+
+TEST(RowConverterTest, jpeg_save)
+{
+  SoftwareSurface const src = make_test_surface(geom::isize(37, 21));
+  std::vector<uint8_t> const streamed = jpeg::save(src, 90);
+  std::vector<uint8_t> const copied = jpeg::save(convert(src, PixelFormat::RGB8), 90);
+  EXPECT_EQ(streamed, copied);
+}
+
+/* EOF */
@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+
+#include <surf/blit.hpp>
+#include <surf/pixel_data.hpp>
+#include <surf/scale_filter.hpp>
+#include <surf/software_surface.hpp>
+
+#include "test_util.hpp"
+
+using namespace surf;
+
+TEST(ScaleFilterTest, taps)
+{
+  // same source pixels as the old x * srclen / dstlen
+  for (int srclen : { 1, 7, 64, 100 }) {
+    for (int dstlen : { 1, 3, 64, 99, 250 }) {
+      std::vector<detail::ScaleTap> const nearest = detail::make_scale_taps(ScaleFilter::NEAREST, srclen, dstlen);
+      std::vector<detail::ScaleTap> const box = detail::make_scale_taps(ScaleFilter::BOX, srclen, dstlen);
+      ASSERT_EQ(nearest.size(), static_cast<size_t>(dstlen));
+      for (int x = 0; x < dstlen; ++x) {
+        ASSERT_EQ(nearest[x].index, x * srclen / dstlen);
+        ASSERT_EQ(box[x].index, x * srclen / dstlen);
+        ASSERT_EQ(box[x].next, std::max(box[x].index + 1, (x + 1) * srclen / dstlen));
+      }
+    }
+  }
+
+  // BILINEAR samples the pixel centers and is the identity unscaled
+  std::vector<detail::ScaleTap> const same = detail::make_scale_taps(ScaleFilter::BILINEAR, 5, 5);
+  for (int x = 0; x < 5; ++x) {
+    EXPECT_EQ(same[x].index, x);
+    EXPECT_EQ(same[x].frac, 0u);
+  }
+
+  std::vector<detail::ScaleTap> const twice = detail::make_scale_taps(ScaleFilter::BILINEAR, 2, 4);
+  EXPECT_EQ(twice[0].index, 0);
+  EXPECT_EQ(twice[0].frac, 0u);
+  EXPECT_EQ(twice[1].index, 0);
+  EXPECT_EQ(twice[1].frac, 64u);
+  EXPECT_EQ(twice[2].index, 0);
+  EXPECT_EQ(twice[2].frac, 192u);
+  EXPECT_EQ(twice[3].index, 1);
+  EXPECT_EQ(twice[3].frac, 0u);
+
+  EXPECT_TRUE(detail::make_scale_taps(ScaleFilter::BOX, 10, 0).empty());
+  EXPECT_THROW(detail::make_scale_taps(ScaleFilter::BOX, 0, 10), std::invalid_argument);
+}
+
+TEST(ScaleFilterTest, filters)
+{
+  PixelData<RGBAPixel> src(geom::isize(2, 2));
+  src.put_pixel(geom::ipoint(0, 0), RGBAPixel{0, 0, 0, 255});
+  src.put_pixel(geom::ipoint(1, 0), RGBAPixel{255, 0, 0, 255});
+  src.put_pixel(geom::ipoint(0, 1), RGBAPixel{0, 255, 0, 255});
+  src.put_pixel(geom::ipoint(1, 1), RGBAPixel{255, 255, 0, 255});
+
+  // area average
+  PixelData<RGBAPixel> box(geom::isize(1, 1));
+  blend_scaled(pixel_copy<RGBAPixel, RGBAPixel>(), src, geom::irect(src.get_size()),
+               box, geom::irect(0, 0, 1, 1), ScaleFilter::BOX);
+  EXPECT_EQ(box.get_pixel(geom::ipoint(0, 0)), (RGBAPixel{128, 128, 0, 255}));
+
+  // interpolated in between, the corners stay
+  PixelData<RGBAPixel> bilinear(geom::isize(4, 4));
+  blend_scaled(pixel_copy<RGBAPixel, RGBAPixel>(), src, geom::irect(src.get_size()),
+               bilinear, geom::irect(0, 0, 4, 4), ScaleFilter::BILINEAR);
+  EXPECT_EQ(bilinear.get_pixel(geom::ipoint(0, 0)), (RGBAPixel{0, 0, 0, 255}));
+  EXPECT_EQ(bilinear.get_pixel(geom::ipoint(3, 3)), (RGBAPixel{255, 255, 0, 255}));
+  EXPECT_EQ(bilinear.get_pixel(geom::ipoint(1, 0)), (RGBAPixel{64, 0, 0, 255}));
+  EXPECT_EQ(bilinear.get_pixel(geom::ipoint(2, 1)), (RGBAPixel{191, 64, 0, 255}));
+
+  // float formats give the same in float
+  PixelData<RGBA32fPixel> srcf = src.convert_to<RGBA32fPixel>();
+  PixelData<RGBA32fPixel> bilinearf(geom::isize(4, 4));
+  blend_scaled(pixel_copy<RGBA32fPixel, RGBA32fPixel>(), srcf, geom::irect(srcf.get_size()),
+               bilinearf, geom::irect(0, 0, 4, 4), ScaleFilter::BILINEAR);
+  EXPECT_FLOAT_EQ(bilinearf.get_pixel(geom::ipoint(2, 1)).r, 0.75f);
+  EXPECT_FLOAT_EQ(bilinearf.get_pixel(geom::ipoint(2, 1)).g, 0.25f);
+}
+
+TEST(ScaleFilterTest, bilinear_rgba8)
+{
+  // the SIMD passes against the scalar lerp, up and down, odd sizes
+  PixelData<RGBAPixel> const src = make_test_pattern(geom::isize(37, 23));
+
+  for (geom::isize const dstsize : { geom::isize(101, 53), geom::isize(17, 9), geom::isize(1, 1) }) {
+    PixelData<RGBAPixel> result(dstsize);
+    blend_scaled(pixel_copy<RGBAPixel, RGBAPixel>(), src, geom::irect(src.get_size()),
+                 result, geom::irect(dstsize), ScaleFilter::BILINEAR);
+
+    std::vector<detail::ScaleTap> const xtaps = detail::make_scale_taps(ScaleFilter::BILINEAR, 37, dstsize.width());
+    std::vector<detail::ScaleTap> const ytaps = detail::make_scale_taps(ScaleFilter::BILINEAR, 23, dstsize.height());
+    for (int y = 0; y < dstsize.height(); ++y) {
+      for (int x = 0; x < dstsize.width(); ++x) {
+        detail::ScaleTap const& tx = xtaps[x];
+        detail::ScaleTap const& ty = ytaps[y];
+        auto const at = [&](int sx, int sy) { return src.get_pixel(geom::ipoint(sx, sy)); };
+        RGBAPixel const row0 = detail::lerp_pixel(at(tx.index, ty.index), at(tx.next, ty.index), tx.frac);
+        RGBAPixel const row1 = detail::lerp_pixel(at(tx.index, ty.next), at(tx.next, ty.next), tx.frac);
+        ASSERT_EQ(result.get_pixel(geom::ipoint(x, y)), detail::lerp_pixel(row0, row1, ty.frac))
+          << x << ", " << y;
+      }
+    }
+  }
+}
+
+TEST(ScaleFilterTest, box_rgba8)
+{
+  // rounded like an exact integer average, for uneven box sizes
+  PixelData<RGBAPixel> const src = make_test_pattern(geom::isize(37, 23));
+
+  for (geom::isize const dstsize : { geom::isize(5, 3), geom::isize(12, 7), geom::isize(37, 23) }) {
+    PixelData<RGBAPixel> result(dstsize);
+    blend_scaled(pixel_copy<RGBAPixel, RGBAPixel>(), src, geom::irect(src.get_size()),
+                 result, geom::irect(dstsize), ScaleFilter::BOX);
+
+    std::vector<detail::ScaleTap> const xtaps = detail::make_scale_taps(ScaleFilter::BOX, 37, dstsize.width());
+    std::vector<detail::ScaleTap> const ytaps = detail::make_scale_taps(ScaleFilter::BOX, 23, dstsize.height());
+    for (int y = 0; y < dstsize.height(); ++y) {
+      for (int x = 0; x < dstsize.width(); ++x) {
+        uint32_t sum[4] = { 0, 0, 0, 0 };
+        for (int sy = ytaps[y].index; sy < ytaps[y].next; ++sy) {
+          for (int sx = xtaps[x].index; sx < xtaps[x].next; ++sx) {
+            RGBAPixel const p = src.get_pixel(geom::ipoint(sx, sy));
+            sum[0] += p.r; sum[1] += p.g; sum[2] += p.b; sum[3] += p.a;
+          }
+        }
+        uint32_t const n = static_cast<uint32_t>((ytaps[y].next - ytaps[y].index) * (xtaps[x].next - xtaps[x].index));
+        RGBAPixel const expected{
+          static_cast<uint8_t>((sum[0] + n / 2) / n), static_cast<uint8_t>((sum[1] + n / 2) / n),
+          static_cast<uint8_t>((sum[2] + n / 2) / n), static_cast<uint8_t>((sum[3] + n / 2) / n)};
+        ASSERT_EQ(result.get_pixel(geom::ipoint(x, y)), expected) << x << ", " << y;
+      }
+    }
+  }
+}
+
+TEST(ScaleFilterTest, box_large)
+{
+  // a box big enough that its 32-bit channel sum doesn't fit a
+  // double's mantissa, dividing by a reciprocal would round this to
+  // max - 1
+  geom::isize const size(1450, 1450);
+  uint64_t const n = static_cast<uint64_t>(size.width()) * static_cast<uint64_t>(size.height());
+  uint32_t const max = 0xffffffff;
+  PixelData<L32Pixel> src(size, L32Pixel{max});
+  src.put_pixel(geom::ipoint(7, 3), L32Pixel{static_cast<uint32_t>(max - n / 2)});
+
+  PixelData<L32Pixel> result(geom::isize(1, 1));
+  blend_scaled(pixel_copy<L32Pixel, L32Pixel>(), src, geom::irect(size),
+               result, geom::irect(0, 0, 1, 1), ScaleFilter::BOX);
+  EXPECT_EQ(result.get_pixel(geom::ipoint(0, 0)).l, max);
+
+  // averaged as a single channel, without summing three copies
+  PixelData<L32Pixel> bilinear(geom::isize(3, 3));
+  blend_scaled(pixel_copy<L32Pixel, L32Pixel>(), src, geom::irect(10, 10, 12, 12),
+               bilinear, geom::irect(0, 0, 3, 3), ScaleFilter::BILINEAR);
+  EXPECT_EQ(bilinear.get_pixel(geom::ipoint(1, 1)).l, max);
+}
+
+TEST(ScaleFilterTest, nearest_srcrect_offset)
+{
+  // the source row is srcrect.top() + y * srcheight / dstheight, the
+  // code before the scale taps used (srcrect.top() + y) * srcheight /
+  // dstheight and sampled the wrong rows for any srcrect not at the top
+  PixelData<RGBAPixel> const pattern = make_test_pattern(geom::isize(16, 16));
+  geom::irect const srcrect(2, 5, 10, 13);
+  geom::irect const dstrect(0, 0, 16, 4);
+
+  PixelData<RGBAPixel> dst(dstrect.size());
+  blend_scaled(pixel_copy<RGBAPixel, RGBAPixel>(), pattern, srcrect, dst, dstrect);
+
+  SoftwareSurface surface = SoftwareSurface::create(PixelFormat::RGBA8, dstrect.size());
+  blend_scaled(BlendFunc::COPY, SoftwareSurface(pattern), srcrect, surface, dstrect);
+
+  for (int y = 0; y < dstrect.height(); ++y) {
+    for (int x = 0; x < dstrect.width(); ++x) {
+      RGBAPixel const expected = pattern.get_pixel(geom::ipoint(srcrect.left() + x * srcrect.width() / dstrect.width(),
+                                                                srcrect.top() + y * srcrect.height() / dstrect.height()));
+      EXPECT_EQ(dst.get_pixel(geom::ipoint(x, y)), expected);
+      EXPECT_EQ(surface.as_pixelview<RGBAPixel>().get_pixel(geom::ipoint(x, y)), expected);
+    }
+  }
+}
+
+TEST(ScaleFilterTest, surface)
+{
+  // the SoftwareSurface path matches the template one, clipped
+  PixelData<RGBAPixel> const pattern = make_test_pattern(geom::isize(32, 24));
+  SoftwareSurface const src(pattern);
+
+  for (ScaleFilter filter : { ScaleFilter::NEAREST, ScaleFilter::BILINEAR, ScaleFilter::BOX }) {
+    for (geom::irect const dstrect : { geom::irect(-10, 5, 70, 50), geom::irect(3, 2, 13, 9), geom::irect(5, -12, 36, 0) }) {
+      SoftwareSurface dst = SoftwareSurface::create(PixelFormat::RGBA8, geom::isize(64, 64));
+      PixelData<RGBAPixel> expected(geom::isize(64, 64));
+      blend_scaled(BlendFunc::BLEND, src, geom::irect(4, 3, 20, 14), dst, dstrect, filter);
+      blend_scaled(pixel_blend<RGBAPixel, RGBAPixel>(), pattern, geom::irect(4, 3, 20, 14),
+                   expected, dstrect, filter);
+      EXPECT_EQ(dst.as_pixelview<RGBAPixel>(), expected) << to_string(filter);
+    }
+  }
+
+  EXPECT_EQ(ScaleFilter_from_string("BILINEAR"), ScaleFilter::BILINEAR);
+  EXPECT_EQ(to_string(ScaleFilter::BOX), "BOX");
+  EXPECT_THROW(ScaleFilter_from_string("nonsense"), std::invalid_argument);
+}
+
+/* EOF */
@@ -44,4 +44,16 @@ TEST(SDLTest, from_sdl_surface)
   EXPECT_EQ(red, red_out);
 }
 
+TEST(SDLTest, adopt_sdl_surface)
+{
+  PixelData<RGBAPixel> const red(geom::isize{8, 16}, RGBAPixel{255, 0, 0, 255});
+  SDLSurfacePtr sdl_red = create_sdl_surface(red);
+  void const* pixels = sdl_red->pixels;
+
+  SoftwareSurface const surface = softwaresurface_adopt_sdl_surface(std::move(sdl_red));
+  EXPECT_EQ(sdl_red.get(), nullptr);
+  EXPECT_EQ(surface.get_data(), pixels);
+  EXPECT_EQ(surface, SoftwareSurface(red));
+}
+
 /* EOF */
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <optional>
+#include <utility>
 #include <gtest/gtest.h>
 
 #include <geom/rect.hpp>
@@ -65,6 +67,123 @@ TEST(SoftwareSurfaceTest, move)
   // EXPECT_EQ(geom::isize(32, 16), tmp.get_size());
 }
 
+TEST(SoftwareSurfaceTest, copy_on_write)
+{
+  SoftwareSurface lhs(PixelData<RGBPixel>(geom::isize(32, 16), {1, 2, 3}));
+  SoftwareSurface rhs = lhs;
+
+  EXPECT_TRUE(lhs.is_shared());
+  EXPECT_EQ(std::as_const(lhs).get_data(), std::as_const(rhs).get_data());
+
+  rhs.put_pixel(geom::ipoint(0, 0), Color(1.0f, 1.0f, 1.0f));
+
+  EXPECT_FALSE(lhs.is_shared());
+  EXPECT_FALSE(rhs.is_shared());
+  EXPECT_NE(std::as_const(lhs).get_data(), std::as_const(rhs).get_data());
+  EXPECT_EQ(lhs.get_pixel(geom::ipoint(0, 0)), Color::from_rgb888(1, 2, 3));
+  EXPECT_EQ(rhs.get_pixel(geom::ipoint(0, 0)), Color(1.0f, 1.0f, 1.0f));
+}
+
+TEST(SoftwareSurfaceTest, copy_on_write__view)
+{
+  SoftwareSurface src(PixelData<RGBPixel>(geom::isize(8, 6), {255, 0, 0}));
+  SoftwareSurface view = src.get_view(geom::irect(2, 2, 5, 5));
+  SoftwareSurface copy = src;
+
+  EXPECT_FALSE(src.is_shared());
+
+  fill(view, Color(0, 0, 0));
+
+  EXPECT_EQ(src.get_pixel(geom::ipoint(2, 2)), Color(0, 0, 0));
+  EXPECT_EQ(copy.get_pixel(geom::ipoint(2, 2)), Color::from_rgb888(255, 0, 0));
+}
+
+TEST(SoftwareSurfaceTest, copy_on_write__mutable_pointer)
+{
+  SoftwareSurface src(PixelData<RGBPixel>(geom::isize(8, 6), {0, 0, 0}));
+  RGBPixel* data = static_cast<RGBPixel*>(src.get_data());
+  SoftwareSurface copy = src;
+
+  EXPECT_FALSE(src.is_shared());
+  data->r = 42;
+  EXPECT_EQ(src.get_pixel(geom::ipoint(0, 0)), Color::from_rgb888(42, 0, 0));
+  EXPECT_EQ(copy.get_pixel(geom::ipoint(0, 0)), Color::from_rgb888(0, 0, 0));
+
+  SoftwareSurface other(PixelData<RGBPixel>(geom::isize(8, 6), {0, 0, 0}));
+  PixelView<RGBPixel>& view = other.as_pixelview<RGBPixel>();
+  SoftwareSurface other_copy = other;
+
+  EXPECT_FALSE(other.is_shared());
+  view.put_pixel(geom::ipoint(1, 0), RGBPixel{7, 0, 0});
+  EXPECT_EQ(other.get_pixel(geom::ipoint(1, 0)), Color::from_rgb888(7, 0, 0));
+  EXPECT_EQ(other_copy.get_pixel(geom::ipoint(1, 0)), Color::from_rgb888(0, 0, 0));
+}
+
+TEST(SoftwareSurfaceTest, copy_on_write__drawn_to)
+{
+  SoftwareSurface const src(PixelData<RGB8Pixel>(geom::isize(4, 2), {255, 0, 0}));
+  SoftwareSurface dst(PixelData<RGBA8Pixel>(geom::isize(8, 4), {0, 0, 0, 0}));
+
+  fill_rect(dst, geom::irect(0, 0, 2, 2), palette::white);
+  blit(src, dst, geom::ipoint(1, 2));
+  SoftwareSurface const copy = dst;
+  EXPECT_TRUE(dst.is_shared());
+
+  blit(src, dst, geom::ipoint(4, 0));
+  EXPECT_FALSE(dst.is_shared());
+  EXPECT_EQ(dst.get_pixel(geom::ipoint(4, 0)), Color::from_rgb888(255, 0, 0));
+  EXPECT_EQ(copy.get_pixel(geom::ipoint(4, 0)), Color(0, 0, 0, 0));
+  EXPECT_EQ(copy.get_pixel(geom::ipoint(1, 2)), Color::from_rgb888(255, 0, 0));
+}
+
+TEST(SoftwareSurfaceTest, copy_on_write__const_view)
+{
+  SoftwareSurface src(PixelData<RGBPixel>(geom::isize(8, 6), {255, 0, 0}));
+  SoftwareSurface const view = std::as_const(src).get_view(geom::irect(2, 2, 5, 5));
+  SoftwareSurface const copy = src;
+
+  EXPECT_TRUE(src.is_shared());
+  EXPECT_EQ(view.get_pixel(geom::ipoint(0, 0)), Color::from_rgb888(255, 0, 0));
+
+  SoftwareSurface view_copy = view;
+  fill(view_copy, Color(0, 0, 0));
+  EXPECT_EQ(src.get_pixel(geom::ipoint(2, 2)), Color::from_rgb888(255, 0, 0));
+}
+
+TEST(SoftwareSurfaceTest, copy_on_write__const_view_lifetime)
+{
+  SoftwareSurface src(PixelData<RGBA32fPixel>(geom::isize(8, 6), {1.0f, 1.0f, 1.0f, 1.0f}));
+  std::optional<SoftwareSurface> copy = src;
+  SoftwareSurface const view = std::as_const(src).get_view(geom::irect(2, 2, 5, 5));
+
+  // neither write reaches the pixels the view points into
+  src.put_pixel(geom::ipoint(2, 2), Color(0.25f, 0.25f, 0.25f));
+  copy->put_pixel(geom::ipoint(2, 2), Color(0.5f, 0.5f, 0.5f));
+  EXPECT_EQ(view.get_pixel(geom::ipoint(0, 0)), Color(1.0f, 1.0f, 1.0f));
+  EXPECT_EQ(src.get_pixel(geom::ipoint(2, 2)), Color(0.25f, 0.25f, 0.25f));
+  EXPECT_EQ(copy->get_pixel(geom::ipoint(2, 2)), Color(0.5f, 0.5f, 0.5f));
+
+  // the view outlives every surface that shared its pixels
+  copy.reset();
+  src = SoftwareSurface();
+  EXPECT_EQ(view.get_pixel(geom::ipoint(0, 0)), Color(1.0f, 1.0f, 1.0f));
+  EXPECT_EQ(view.get_pixel(geom::ipoint(2, 2)), Color(1.0f, 1.0f, 1.0f));
+}
+
+TEST(SoftwareSurfaceTest, foreign_pixel_data)
+{
+  // claims a format it does not have the PixelView type of
+  class MislabeledPixelData : public PixelData<RGBPixel>
+  {
+  public:
+    using PixelData<RGBPixel>::PixelData;
+    PixelFormat get_format() const override { return PixelFormat::RGBA8; }
+  };
+
+  EXPECT_THROW(SoftwareSurface(std::make_unique<MislabeledPixelData>(geom::isize(4, 4))), std::invalid_argument);
+  EXPECT_NO_THROW(SoftwareSurface(std::make_unique<PixelData<RGBPixel>>(geom::isize(4, 4))));
+}
+
 TEST(SoftwareSurfaceTest, convert)
 {
   SoftwareSurface const lhs(PixelData<RGBPixel>(geom::isize(32, 16)));
@@ -97,6 +216,23 @@ TEST(SoftwareSurfaceTest, fill_rect)
   fill_rect(dst, geom::irect(1, 2, 4, 4), palette::white);
 }
 
+TEST(SoftwareSurfaceTest, row_colors)
+{
+  SoftwareSurface surface(PixelData<RGB8Pixel>(geom::isize(8, 4), {255, 0, 0}));
+  SoftwareSurface const copy = surface;
+
+  std::vector<Color> const white(3, palette::white);
+  surface.write_row_colors(2, 4, 3, white.data());
+  EXPECT_EQ(copy.get_pixel(geom::ipoint(5, 2)), Color::from_rgb888(255, 0, 0));
+
+  std::vector<Color> colors(5);
+  surface.read_row_colors(2, 3, 5, colors.data());
+  EXPECT_EQ(colors[0], Color::from_rgb888(255, 0, 0));
+  EXPECT_EQ(colors[1], palette::white);
+  EXPECT_EQ(colors[3], palette::white);
+  EXPECT_EQ(colors[4], Color::from_rgb888(255, 0, 0));
+}
+
 TEST(SoftwareSurfaceTest, get_view)
 {
   SoftwareSurface const src(PixelData<RGB8Pixel>(geom::isize(8, 6), {255, 0, 0}));
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <surf/blit.hpp>
+#include <surf/pixel_data.hpp>
+#include <surf/software_surface.hpp>
+#include <surf/sprite_batch.hpp>
+
+#include "test_util.hpp"
+
+using namespace surf;
+
+namespace {
+
+template<typename Pixel>
+SoftwareSurface make_sprite(geom::isize const& size, int seed)
+{
+  return SoftwareSurface(make_test_pattern(size, seed).convert_to<Pixel>());
+}
+
+} // namespace
+
+TEST(SpriteBatchTest, matches_individual_draws)
+{
+  SoftwareSurface const sprite_a = make_sprite<RGBAPixel>(geom::isize(23, 17), 1);
+  SoftwareSurface const sprite_b = make_sprite<RGBPixel>(geom::isize(16, 40), 2);
+  SoftwareSurface const sprite_c = make_sprite<RGBA16Pixel>(geom::isize(9, 9), 3);
+  SoftwareSurface const background = make_sprite<RGBAPixel>(geom::isize(100, 90), 4);
+
+  // overlapping, partly clipped and entirely offscreen draws, mixed formats
+  SpriteBatch batch(7);
+  batch.blit(background, geom::ipoint(0, 0));
+  for (int i = 0; i < 40; ++i) {
+    geom::ipoint const pos(i * 13 % 120 - 15, i * 7 % 110 - 12);
+    batch.blend(BlendFunc::BLEND, sprite_a, pos);
+    batch.blend(BlendFunc::ADD, sprite_c, geom::irect(2, 3, 8, 9), pos + geom::ioffset(5, 5));
+    batch.blit(sprite_b, geom::irect(0, i % 20, 16, 40), pos + geom::ioffset(10, -4));
+    batch.blend_scaled(BlendFunc::BLEND, sprite_a, geom::irect(pos, geom::isize(31, 12)), ScaleFilter::BILINEAR);
+  }
+  batch.blend(BlendFunc::BLEND, sprite_a, geom::ipoint(200, 200));
+  batch.blend_scaled(BlendFunc::MULTIPLY, sprite_b, geom::irect(3, 4, 10, 15), geom::irect(-20, 30, 90, 120),
+                     ScaleFilter::BOX);
+  ASSERT_EQ(batch.size(), 163);
+
+  SoftwareSurface expected = SoftwareSurface::create(PixelFormat::RGBA8, geom::isize(100, 90));
+  for (SpriteBatch::Draw const& draw : batch.get_draws()) {
+    if (draw.scaled) {
+      blend_scaled(draw.blendfunc, *draw.src, draw.srcrect, expected, draw.dstrect, draw.filter);
+    } else {
+      blend(draw.blendfunc, *draw.src, draw.srcrect, expected, draw.dstrect.topleft());
+    }
+  }
+
+  for (unsigned int threads : { 1u, 3u, 0u }) {
+    SoftwareSurface result = SoftwareSurface::create(PixelFormat::RGBA8, geom::isize(100, 90));
+    batch.render(result, threads);
+    EXPECT_EQ(result, expected) << threads;
+  }
+
+  // a band taller than the surface
+  SpriteBatch single_band(1000);
+  for (SpriteBatch::Draw const& draw : batch.get_draws()) {
+    if (draw.scaled) {
+      single_band.blend_scaled(draw.blendfunc, *draw.src, draw.srcrect, draw.dstrect, draw.filter);
+    } else {
+      single_band.blend(draw.blendfunc, *draw.src, draw.srcrect, draw.dstrect.topleft());
+    }
+  }
+  SoftwareSurface result = SoftwareSurface::create(PixelFormat::RGBA8, geom::isize(100, 90));
+  single_band.render(result, 4);
+  EXPECT_EQ(result, expected);
+}
+
+TEST(SpriteBatchTest, shared_destination)
+{
+  // rendering detaches a copy-on-write destination first
+  SoftwareSurface const sprite = make_sprite<RGBAPixel>(geom::isize(8, 8), 5);
+  SoftwareSurface canvas = SoftwareSurface::create(PixelFormat::RGBA8, geom::isize(32, 32));
+  SoftwareSurface const copy = canvas;
+
+  SpriteBatch batch(4);
+  batch.blit(sprite, geom::ipoint(4, 4));
+  batch.render(canvas, 2);
+
+  EXPECT_EQ(canvas.get_pixel(geom::ipoint(4, 4)), sprite.get_pixel(geom::ipoint(0, 0)));
+  EXPECT_NE(canvas, copy);
+
+  batch.clear();
+  EXPECT_TRUE(batch.empty());
+  EXPECT_THROW(SpriteBatch(0), std::invalid_argument);
+}
+
+/* EOF */
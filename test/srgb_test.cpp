@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include <surf/blend.hpp>
+#include <surf/fill.hpp>
+#include <surf/pixel_data.hpp>
+#include <surf/software_surface.hpp>
+#include <surf/srgb.hpp>
+#include <surf/transform.hpp>
+
+using namespace surf;
+
+namespace {
+
+PixelData<RGBA8Pixel> make_checker(geom::isize const& size)
+{
+  PixelData<RGBA8Pixel> pixeldata(size);
+  for (int y = 0; y < size.height(); ++y) {
+    for (int x = 0; x < size.width(); ++x) {
+      uint8_t const v = ((x + y) % 2) ? 255 : 0;
+      pixeldata.put_pixel(geom::ipoint(x, y), RGBA8Pixel{v, v, v, 255});
+    }
+  }
+  return pixeldata;
+}
+
+} // namespace
+
+TEST(SRGBTest, lut)
+{
+  SRGBLut const& lut = SRGBLut::instance();
+
+  for (int i = 0; i < 256; ++i) {
+    uint8_t const v = static_cast<uint8_t>(i);
+    EXPECT_NEAR(lut.decode(v), srgb_to_linear(static_cast<float>(i) / 255.0f) * 65535.0f, 0.6f);
+    EXPECT_EQ(lut.encode8(lut.decode(v)), v);
+  }
+
+  for (int i = 0; i < 65536; i += 7) {
+    uint16_t const v = static_cast<uint16_t>(i);
+    EXPECT_NEAR(lut.decode(v), srgb_to_linear(static_cast<float>(i) / 65535.0f) * 65535.0f, 1.5f);
+    EXPECT_NEAR(lut.encode(v), linear_to_srgb(static_cast<float>(i) / 65535.0f) * 65535.0f, 2.0f);
+  }
+
+  EXPECT_EQ(lut.decode(uint16_t{65535}), 65535);
+  EXPECT_EQ(lut.encode(uint16_t{65535}), 65535);
+  EXPECT_EQ(lut.encode(uint16_t{0}), 0);
+}
+
+TEST(SRGBTest, span)
+{
+  SRGBLut const& lut = SRGBLut::instance();
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> dist(0, 65535);
+
+  // odd length to cover the scalar tails of the SIMD kernels
+  std::vector<RGBA8Pixel> src(37);
+  std::vector<RGBA16Pixel> linear(src.size());
+  for (auto& pixel : src) {
+    pixel = RGBA8Pixel{static_cast<uint8_t>(dist(rng)), static_cast<uint8_t>(dist(rng)),
+                       static_cast<uint8_t>(dist(rng)), static_cast<uint8_t>(dist(rng))};
+  }
+
+  srgb_decode_n(src.data(), linear.data(), src.size());
+  for (size_t i = 0; i < src.size(); ++i) {
+    EXPECT_EQ(linear[i], srgb_decode(lut, src[i]));
+  }
+
+  std::vector<RGBA8Pixel> roundtrip(src.size());
+  srgb_encode_n(linear.data(), roundtrip.data(), linear.size());
+  EXPECT_EQ(roundtrip, src);
+
+  for (auto& pixel : linear) {
+    pixel = RGBA16Pixel{static_cast<uint16_t>(dist(rng)), static_cast<uint16_t>(dist(rng)),
+                        static_cast<uint16_t>(dist(rng)), static_cast<uint16_t>(dist(rng))};
+  }
+
+  std::vector<RGBA8Pixel> encoded(linear.size());
+  srgb_encode_n(linear.data(), encoded.data(), linear.size());
+  for (size_t i = 0; i < linear.size(); ++i) {
+    EXPECT_EQ(encoded[i], srgb_encode<RGBA8Pixel>(lut, linear[i]));
+  }
+
+  // everything else goes through the per pixel functions
+  EXPECT_EQ(srgb_encode<L8Pixel>(lut, srgb_decode(lut, L8Pixel{99})), L8Pixel{99});
+  RGB16Pixel const rgb16 = srgb_encode<RGB16Pixel>(lut, srgb_decode(lut, RGB16Pixel{0, 32768, 65535}));
+  EXPECT_EQ(rgb16.r, 0);
+  EXPECT_NEAR(rgb16.g, 32768, 2);
+  EXPECT_EQ(rgb16.b, 65535);
+  EXPECT_NEAR(srgb_encode<RGB32fPixel>(lut, srgb_decode(lut, RGB32fPixel{0.0f, 0.5f, 1.0f})).g, 0.5f, 0.001f);
+}
+
+TEST(SRGBTest, halve)
+{
+  PixelData<RGBA8Pixel> const src = make_checker(geom::isize(9, 4));
+
+  PixelData<RGBA8Pixel> const encoded = halve(src, Gamma::ENCODED);
+  EXPECT_EQ(encoded, halve(src));
+  EXPECT_EQ(encoded.get_pixel(geom::ipoint(0, 0)), (RGBA8Pixel{127, 127, 127, 255}));
+
+  PixelData<RGBA8Pixel> const linear = halve(src, Gamma::LINEAR);
+  EXPECT_EQ(linear.get_size(), geom::isize(4, 2));
+  EXPECT_EQ(linear.get_pixel(geom::ipoint(3, 1)), (RGBA8Pixel{188, 188, 188, 255}));
+
+  SoftwareSurface const surface(make_checker(geom::isize(4, 4)).convert_to<RGB16Pixel>());
+  SoftwareSurface const result = halve(surface, Gamma::LINEAR);
+  EXPECT_NEAR(result.as_pixelview<RGB16Pixel>().get_pixel(geom::ipoint(1, 1)).r, 48196, 4);
+}
+
+TEST(SRGBTest, scale)
+{
+  PixelData<RGBA8Pixel> const src = make_checker(geom::isize(12, 6));
+
+  EXPECT_EQ(scale(src, geom::isize(4, 2), Gamma::ENCODED), scale(src, geom::isize(4, 2)));
+
+  // every 3x3 block has 4 or 5 white pixels of 9
+  PixelData<RGBA8Pixel> const linear = scale(src, geom::isize(4, 2), Gamma::LINEAR);
+  EXPECT_EQ(linear.get_pixel(geom::ipoint(0, 0)), (RGBA8Pixel{178, 178, 178, 255}));
+  EXPECT_EQ(linear.get_pixel(geom::ipoint(1, 0)), (RGBA8Pixel{197, 197, 197, 255}));
+
+  // upscaling stays nearest neighbour, without a trip through the LUT
+  EXPECT_EQ(scale(src, geom::isize(24, 12), Gamma::LINEAR), scale(src, geom::isize(24, 12)));
+  PixelData<RGBA16Pixel> const src16(geom::isize(3, 2), RGBA16Pixel{1000, 32769, 65534, 12345});
+  EXPECT_EQ(scale(src16, geom::isize(7, 5), Gamma::LINEAR), scale(src16, geom::isize(7, 5)));
+
+  // x * srcw no longer fits an int here
+  PixelData<RGBA8Pixel> wide(geom::isize(50000, 1), RGBA8Pixel{0, 0, 0, 255});
+  fill_rect(wide, geom::irect(25000, 0, 50000, 1), RGBA8Pixel{255, 255, 255, 255});
+  PixelData<RGBA8Pixel> const narrow = scale(wide, geom::isize(49999, 1), Gamma::LINEAR);
+  EXPECT_EQ(narrow.get_pixel(geom::ipoint(0, 0)), (RGBA8Pixel{0, 0, 0, 255}));
+  EXPECT_EQ(narrow.get_pixel(geom::ipoint(49998, 0)), (RGBA8Pixel{255, 255, 255, 255}));
+}
+
+TEST(SRGBTest, scale_premultiplied)
+{
+  // transparent pixels don't darken the edge of an opaque white one
+  PixelData<PRGBA8Pixel> src(geom::isize(2, 2), PRGBA8Pixel{0, 0, 0, 0});
+  src.put_pixel(geom::ipoint(0, 0), PRGBA8Pixel{255, 255, 255, 255});
+  src.put_pixel(geom::ipoint(0, 1), PRGBA8Pixel{255, 255, 255, 255});
+
+  EXPECT_EQ(scale(src, geom::isize(1, 1), Gamma::LINEAR).get_pixel(geom::ipoint(0, 0)),
+            (PRGBA8Pixel{128, 128, 128, 128}));
+  EXPECT_EQ(halve(src, Gamma::LINEAR).get_pixel(geom::ipoint(0, 0)),
+            (PRGBA8Pixel{128, 128, 128, 128}));
+}
+
+TEST(SRGBTest, blend)
+{
+  SoftwareSurface const src(PixelData<RGBA8Pixel>(geom::isize(8, 8), RGBA8Pixel{255, 255, 255, 128}));
+
+  SoftwareSurface encoded(PixelData<RGB8Pixel>(geom::isize(8, 8), RGB8Pixel{0, 0, 0}));
+  blend(BlendFunc::BLEND, src, encoded, geom::ipoint(0, 0), Gamma::ENCODED);
+  EXPECT_EQ(encoded.as_pixelview<RGB8Pixel>().get_pixel(geom::ipoint(3, 3)), (RGB8Pixel{128, 128, 128}));
+
+  SoftwareSurface linear(PixelData<RGB8Pixel>(geom::isize(8, 8), RGB8Pixel{0, 0, 0}));
+  blend(BlendFunc::BLEND, src, linear, geom::ipoint(4, 4), Gamma::LINEAR);
+  EXPECT_EQ(linear.as_pixelview<RGB8Pixel>().get_pixel(geom::ipoint(3, 3)), (RGB8Pixel{0, 0, 0}));
+  EXPECT_EQ(linear.as_pixelview<RGB8Pixel>().get_pixel(geom::ipoint(4, 4)), (RGB8Pixel{188, 188, 188}));
+
+  SoftwareSurface linear16(PixelData<RGBA16Pixel>(geom::isize(8, 8), RGBA16Pixel{0, 0, 0, 65535}));
+  blend(BlendFunc::BLEND, src, linear16, geom::ipoint(0, 0), Gamma::LINEAR);
+  EXPECT_NEAR(linear16.as_pixelview<RGBA16Pixel>().get_pixel(geom::ipoint(0, 0)).r, 48350, 100);
+}
+
+TEST(SRGBTest, blend16)
+{
+  // used to overflow int in the straight alpha integer path
+  EXPECT_EQ((pixel_blend<RGBA16Pixel, RGBA16Pixel>()(RGBA16Pixel{65535, 65535, 65535, 32768},
+                                                       RGBA16Pixel{0, 0, 0, 65535})),
+            (RGBA16Pixel{32768, 32768, 32768, 65535}));
+  EXPECT_EQ((pixel_blend<RGBA16Pixel, RGB16Pixel>()(RGBA16Pixel{65535, 65535, 65535, 65535},
+                                                      RGB16Pixel{0, 0, 0})),
+            (RGB16Pixel{65535, 65535, 65535}));
+}
+
+/* EOF */
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <thread>
+
+#include <surf/pixel_data.hpp>
+#include <surf/software_surface.hpp>
+#include <surf/surface_pool.hpp>
+#include <surf/transform.hpp>
+
+using namespace surf;
+
+TEST(SurfacePoolTest, size_class)
+{
+  EXPECT_EQ(SurfacePool::size_class(1), 64);
+  EXPECT_EQ(SurfacePool::size_class(4096), 4096);
+  EXPECT_EQ(SurfacePool::size_class(4097), 4608);
+  EXPECT_EQ(SurfacePool::size_class(1024 * 1024), 1024 * 1024);
+
+  for (size_t bytes = 1; bytes < 1024 * 1024; bytes += 997) {
+    size_t const size = SurfacePool::size_class(bytes);
+    EXPECT_GE(size, bytes);
+    EXPECT_LE(size, bytes + bytes / 8 + PIXEL_ALIGNMENT);
+  }
+}
+
+TEST(SurfacePoolTest, recycle)
+{
+  SurfacePool pool(16 * 1024 * 1024);
+
+  {
+    SurfacePoolScope scope(pool);
+    PixelData<RGBAPixel> const pixeldata(geom::isize(256, 256));
+  }
+  EXPECT_EQ(pool.get_stats().misses, 1);
+  EXPECT_EQ(pool.get_stats().cached_buffers, 1);
+
+  {
+    SurfacePoolScope scope(pool);
+    PixelData<RGBAPixel> const pixeldata(geom::isize(256, 256), RGBAPixel{1, 2, 3, 4});
+    EXPECT_EQ(pixeldata.get_pixel(geom::ipoint(255, 255)), (RGBAPixel{1, 2, 3, 4}));
+    EXPECT_EQ(pool.get_stats().hits, 1);
+
+    PixelData<RGBAPixel> const rotated = rotate90(pixeldata);
+    EXPECT_EQ(pool.get_stats().misses, 2);
+  }
+  EXPECT_EQ(pool.get_stats().cached_buffers, 2);
+
+  pool.trim();
+  EXPECT_EQ(pool.get_stats().cached_buffers, 0);
+  EXPECT_EQ(pool.get_stats().cached_bytes, 0);
+}
+
+TEST(SurfacePoolTest, budget)
+{
+  SurfacePool pool(300 * 1024);
+
+  {
+    SurfacePoolScope scope(pool);
+    PixelData<RGBAPixel> const a(geom::isize(256, 256));
+    PixelData<RGBAPixel> const b(geom::isize(256, 256));
+  }
+  EXPECT_EQ(pool.get_stats().cached_buffers, 1);
+  EXPECT_EQ(pool.get_stats().released, 1);
+
+  pool.set_budget(0);
+  EXPECT_EQ(pool.get_stats().cached_bytes, 0);
+}
+
+TEST(SurfacePoolTest, outside_scope)
+{
+  SurfacePool pool(16 * 1024 * 1024);
+
+  PixelData<RGBAPixel> pixeldata;
+  {
+    SurfacePoolScope scope(pool);
+    pixeldata = PixelData<RGBAPixel>(geom::isize(64, 64));
+  }
+
+  // returned to the pool it came from, even outside the scope
+  pixeldata = PixelData<RGBAPixel>();
+  EXPECT_EQ(pool.get_stats().recycled, 1);
+}
+
+TEST(SurfacePoolTest, copy_outside_scope)
+{
+  std::optional<SurfacePool> pool(std::in_place, 16 * 1024 * 1024);
+  std::optional<PixelData<RGBAPixel>> copy;
+  std::optional<PixelData<RGBAPixel>> assigned(std::in_place, geom::isize(8, 8));
+  std::optional<SoftwareSurface> detached;
+
+  {
+    PixelData<RGBAPixel> pooled;
+    {
+      SurfacePoolScope scope(*pool);
+      pooled = PixelData<RGBAPixel>(geom::isize(64, 64), RGBAPixel{1, 2, 3, 4});
+    }
+
+    // copies made after the scope ended don't allocate from the pool
+    copy.emplace(pooled);
+    *assigned = pooled;
+
+    SoftwareSurface const surface(std::move(pooled));
+    detached = surface;
+    detached->put_pixel(geom::ipoint(0, 0), Color(1.0f, 1.0f, 1.0f));
+  }
+  EXPECT_EQ(pool->get_stats().misses, 1);
+  EXPECT_EQ(pool->get_stats().recycled, 1);
+
+  // the copies outlive the pool
+  pool.reset();
+  EXPECT_EQ(copy->get_pixel(geom::ipoint(63, 63)), (RGBAPixel{1, 2, 3, 4}));
+  EXPECT_EQ(assigned->get_pixel(geom::ipoint(63, 63)), (RGBAPixel{1, 2, 3, 4}));
+  EXPECT_EQ(detached->get_pixel(geom::ipoint(63, 63)), Color::from_rgba8888(1, 2, 3, 4));
+}
+
+TEST(SurfacePoolTest, threads)
+{
+  SurfacePool pool(64 * 1024 * 1024);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&pool]{
+      SurfacePoolScope scope(pool);
+      for (int j = 0; j < 100; ++j) {
+        PixelData<RGBAPixel> const pixeldata(geom::isize(128, 128));
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  SurfacePool::Stats const stats = pool.get_stats();
+  EXPECT_EQ(stats.hits + stats.misses, 400);
+  EXPECT_LE(stats.cached_buffers, 4);
+}
+
+/* EOF */
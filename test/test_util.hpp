@@ -0,0 +1,31 @@
+#ifndef HEADER_SURF_TEST_UTIL_HPP
+#define HEADER_SURF_TEST_UTIL_HPP
+
+#include <stdint.h>
+
+#include <surf/pixel_data.hpp>
+
+namespace surf {
+
+/** A hashed pattern with every channel covering the full range, so
+    that blending, scaling and conversion see more than gradients,
+    different seeds give unrelated patterns */
+inline PixelData<RGBAPixel> make_test_pattern(geom::isize const& size, int seed = 0)
+{
+  PixelData<RGBAPixel> pixeldata(size);
+  for (int y = 0; y < size.height(); ++y) {
+    for (int x = 0; x < size.width(); ++x) {
+      uint32_t const h = static_cast<uint32_t>(x * 7919 + y * 104729 + seed) * 2654435761u;
+      pixeldata.put_pixel(geom::ipoint(x, y), RGBAPixel{
+          static_cast<uint8_t>(h >> 24), static_cast<uint8_t>(h >> 16),
+          static_cast<uint8_t>(h >> 8), static_cast<uint8_t>(h)});
+    }
+  }
+  return pixeldata;
+}
+
+} // namespace surf
+
+#endif
+
+/* EOF */
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <signal.h>
+#include <sys/resource.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <surf/tile_store.hpp>
+
+using namespace surf;
+
+namespace {
+
+/** Limit the size of files written by the process, writes beyond it
+    fail with EFBIG instead of raising SIGXFSZ */
+class FileSizeLimit
+{
+public:
+  explicit FileSizeLimit(rlim_t limit) :
+    m_old_limit(),
+    m_old_handler(signal(SIGXFSZ, SIG_IGN))
+  {
+    getrlimit(RLIMIT_FSIZE, &m_old_limit);
+    rlimit new_limit = m_old_limit;
+    new_limit.rlim_cur = limit;
+    setrlimit(RLIMIT_FSIZE, &new_limit);
+  }
+
+  ~FileSizeLimit()
+  {
+    setrlimit(RLIMIT_FSIZE, &m_old_limit);
+    signal(SIGXFSZ, m_old_handler);
+  }
+
+private:
+  rlimit m_old_limit;
+  sighandler_t m_old_handler;
+};
+
+} // namespace
+
+TEST(TileStoreTest, evict)
+{
+  std::vector<std::byte> const initial_tile(64, std::byte{7});
+  TileStore store(64, 4, initial_tile.data(), 128);
+
+  for (size_t index = 0; index < 4; ++index) {
+    static_cast<std::byte*>(store.lock(index, true))[0] = std::byte{static_cast<unsigned char>(index)};
+    store.unlock(index);
+  }
+  EXPECT_LE(store.get_stats().resident_bytes, 128);
+  EXPECT_EQ(store.get_stats().writebacks, 2);
+
+  for (size_t index = 0; index < 4; ++index) {
+    std::byte const* const tile = static_cast<std::byte const*>(store.lock(index, false));
+    EXPECT_EQ(tile[0], std::byte{static_cast<unsigned char>(index)});
+    EXPECT_EQ(tile[63], std::byte{7});
+    store.unlock(index);
+  }
+}
+
+TEST(TileStoreTest, write_error)
+{
+  std::vector<std::byte> const initial_tile(64, std::byte{0});
+  TileStore store(64, 4, initial_tile.data(), 64);
+
+  // tile 0 is dirty and the cache over budget while tile 1 is locked
+  static_cast<std::byte*>(store.lock(0, true))[0] = std::byte{42};
+  store.lock(1, false);
+
+  {
+    FileSizeLimit const no_writes(0);
+
+    // the write back of tile 0 must not happen on unlock(), where it
+    // could only fail with std::terminate()
+    store.unlock(0);
+    store.unlock(1);
+    EXPECT_THROW(store.lock(2, false), std::runtime_error);
+  }
+
+  // the tile stayed resident and dirty and is written back once the
+  // scratch file is writable again
+  EXPECT_EQ(static_cast<std::byte const*>(store.lock(0, false))[0], std::byte{42});
+  store.unlock(0);
+  store.lock(2, false);
+  store.unlock(2);
+  EXPECT_EQ(static_cast<std::byte const*>(store.lock(0, false))[0], std::byte{42});
+  store.unlock(0);
+  EXPECT_GT(store.get_stats().writebacks, 0);
+}
+
+/* EOF */
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <geom/rect.hpp>
+
+#include <surf/pixel_data.hpp>
+#include <surf/tiled_pixel_data.hpp>
+#include <surf/transform.hpp>
+
+#include "test_util.hpp"
+
+using namespace surf;
+
+TEST(TiledPixelDataTest, roundtrip)
+{
+  PixelData<RGBAPixel> const pixeldata = make_test_pattern(geom::isize(150, 97));
+  TiledPixelData<RGBAPixel> const tiled(pixeldata);
+
+  EXPECT_EQ(tiled.get_tiles_x(), 3);
+  EXPECT_EQ(tiled.get_tiles_y(), 2);
+  EXPECT_EQ(tiled.get_pixel(geom::ipoint(149, 96)), pixeldata.get_pixel(geom::ipoint(149, 96)));
+  EXPECT_EQ(tiled.to_pixeldata(), pixeldata);
+}
+
+TEST(TiledPixelDataTest, copy_on_write)
+{
+  TiledPixelData<RGBAPixel> const tiled(make_test_pattern(geom::isize(130, 70)));
+  TiledPixelData<RGBAPixel> copy = tiled;
+
+  EXPECT_TRUE(copy.is_tile_shared(1, 1));
+  copy.put_pixel(geom::ipoint(100, 65), RGBAPixel{1, 2, 3, 4});
+  EXPECT_FALSE(copy.is_tile_shared(1, 1));
+  EXPECT_TRUE(copy.is_tile_shared(0, 0));
+
+  EXPECT_NE(tiled.get_pixel(geom::ipoint(100, 65)), (RGBAPixel{1, 2, 3, 4}));
+  EXPECT_EQ(copy.get_pixel(geom::ipoint(100, 65)), (RGBAPixel{1, 2, 3, 4}));
+}
+
+TEST(TiledPixelDataTest, rotate)
+{
+  PixelData<RGBAPixel> const pixeldata = make_test_pattern(geom::isize(150, 97));
+  TiledPixelData<RGBAPixel> const tiled(pixeldata);
+
+  EXPECT_EQ(rotate90(tiled).to_pixeldata(), rotate90(pixeldata));
+  EXPECT_EQ(rotate270(tiled).to_pixeldata(), rotate270(pixeldata));
+  EXPECT_EQ(rotate270(rotate90(tiled)), tiled);
+}
+
+TEST(TiledPixelDataTest, fill_rect)
+{
+  PixelData<RGBAPixel> pixeldata = make_test_pattern(geom::isize(150, 97));
+  TiledPixelData<RGBAPixel> tiled(pixeldata);
+
+  fill_rect(pixeldata, geom::irect(10, 5, 140, 90), RGBAPixel{9, 8, 7, 6});
+  fill_rect(tiled, geom::irect(10, 5, 140, 90), RGBAPixel{9, 8, 7, 6});
+  EXPECT_EQ(tiled.to_pixeldata(), pixeldata);
+
+  fill_rect(pixeldata, geom::irect(-10, -10, 200, 200), RGBAPixel{1, 1, 1, 1});
+  fill_rect(tiled, geom::irect(-10, -10, 200, 200), RGBAPixel{1, 1, 1, 1});
+  EXPECT_EQ(tiled.to_pixeldata(), pixeldata);
+}
+
+TEST(TiledPixelDataTest, blit)
+{
+  PixelData<RGBAPixel> const src = make_test_pattern(geom::isize(50, 70));
+  PixelData<RGBAPixel> expected(geom::isize(150, 97));
+  TiledPixelData<RGBAPixel> tiled(geom::isize(150, 97));
+
+  blit(src, expected, geom::ipoint(40, 60));
+  blit(src, tiled, geom::ipoint(40, 60));
+  EXPECT_EQ(tiled.to_pixeldata(), expected);
+
+  PixelData<RGBAPixel> out(geom::isize(150, 97));
+  blit(tiled, out, geom::ipoint(0, 0));
+  EXPECT_EQ(out, expected);
+}
+
+TEST(TiledPixelDataTest, crop)
+{
+  PixelData<RGBAPixel> const pixeldata = make_test_pattern(geom::isize(150, 97));
+  TiledPixelData<RGBAPixel> const tiled(pixeldata);
+
+  EXPECT_EQ(crop(tiled, geom::irect(13, 7, 120, 90)).to_pixeldata(),
+            crop(pixeldata, geom::irect(13, 7, 120, 90)));
+
+  // tile aligned crops share their tiles with the source
+  TiledPixelData<RGBAPixel> const aligned = crop(tiled, geom::irect(64, 0, 150, 97));
+  EXPECT_TRUE(aligned.is_tile_shared(0, 0));
+  EXPECT_EQ(aligned.to_pixeldata(), crop(pixeldata, geom::irect(64, 0, 150, 97)));
+}
+
+TEST(TiledPixelDataTest, for_each_pixel)
+{
+  TiledPixelData<RGBAPixel> tiled(geom::isize(150, 97), RGBAPixel{1, 2, 3, 4});
+
+  int count = 0;
+  for_each_pixel(tiled, [&count](RGBAPixel& pixel) {
+    pixel.r = 5;
+    count += 1;
+  });
+
+  EXPECT_EQ(count, 150 * 97);
+  EXPECT_EQ(tiled.to_pixeldata(), PixelData<RGBAPixel>(geom::isize(150, 97), RGBAPixel{5, 2, 3, 4}));
+}
+
+/* EOF */
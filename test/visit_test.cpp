@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include <type_traits>
+
+#include <surf/blit.hpp>
+#include <surf/pixel_data.hpp>
+#include <surf/software_surface.hpp>
+#include <surf/visit.hpp>
+
+using namespace surf;
+
+TEST(VisitTest, visit)
+{
+  SoftwareSurface surface = SoftwareSurface::create(PixelFormat::LA16, geom::isize(16, 8));
+
+  PixelFormat const format = visit(surface, [](auto& view) {
+    using Pixel = typename std::decay_t<decltype(view)>::value_type;
+    for (int y = 0; y < view.get_height(); ++y) {
+      Pixel* const row = view.get_row(y);
+      for (int x = 0; x < view.get_width(); ++x) {
+        row[x] = convert<RGBA8Pixel, Pixel>(RGBA8Pixel{255, 255, 255, static_cast<uint8_t>(x * 16)});
+      }
+    }
+    return view.get_format();
+  });
+
+  EXPECT_EQ(format, PixelFormat::LA16);
+  EXPECT_EQ(surface.as_pixelview<LA16Pixel>().get_pixel(geom::ipoint(3, 2)), (LA16Pixel{0xffff, 0x3030}));
+
+  SoftwareSurface const copy = surface;
+  int const width = visit(copy, [](auto const& view) { return view.get_width(); });
+  EXPECT_EQ(width, 16);
+
+  // mutable visit detaches shared pixel data
+  visit(surface, [](auto& view) { view.put_pixel(geom::ipoint(0, 0), {}); });
+  EXPECT_FALSE(copy == surface);
+
+  SoftwareSurface const empty;
+  EXPECT_THROW(visit(empty, [](auto const&) {}), std::invalid_argument);
+}
+
+TEST(VisitTest, visit2)
+{
+  SoftwareSurface const src(PixelData<RGBAPixel>(geom::isize(4, 4), RGBAPixel{10, 20, 30, 40}));
+  SoftwareSurface dst = SoftwareSurface::create(PixelFormat::RGB32f, geom::isize(4, 4));
+
+  visit2(src, dst, [](auto const& srcview, auto& dstview) {
+    blit(srcview, dstview, geom::ipoint(1, 1));
+  });
+
+  EXPECT_EQ(dst.as_pixelview<RGB32fPixel>().get_pixel(geom::ipoint(3, 3)),
+            (convert<RGBAPixel, RGB32fPixel>(RGBAPixel{10, 20, 30, 40})));
+  EXPECT_EQ(dst.as_pixelview<RGB32fPixel>().get_pixel(geom::ipoint(0, 0)), (RGB32fPixel{0.0f, 0.0f, 0.0f}));
+}
+
+/* EOF */